@@ -46,8 +46,12 @@ std::shared_ptr<Query> Analyze::do_analyze(std::shared_ptr<ast::TreeNode> parse)
         check_clause({x->tab_name}, query->conds);        
     } else if (auto x = std::dynamic_pointer_cast<ast::InsertStmt>(parse)) {
         // 处理insert 的values值
-        for (auto &sv_val : x->vals) {
-            query->values.push_back(convert_sv_value(sv_val));
+        for (auto &sv_row : x->rows) {
+            std::vector<Value> row;
+            for (auto &sv_val : sv_row) {
+                row.push_back(convert_sv_value(sv_val));
+            }
+            query->values.push_back(std::move(row));
         }
     } else {
         // do nothing
@@ -128,7 +132,7 @@ void Analyze::check_clause(const std::vector<std::string> &tab_names, std::vecto
             auto rhs_col = rhs_tab.get_col(cond.rhs_col.col_name);
             rhs_type = rhs_col->type;
         }
-        if (lhs_type != rhs_type) {
+        if (lhs_type != rhs_type && !(is_string_type(lhs_type) && is_string_type(rhs_type))) {
             throw IncompatibleTypeError(coltype2str(lhs_type), coltype2str(rhs_type));
         }
     }
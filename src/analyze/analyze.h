@@ -22,8 +22,8 @@ class Query{
     std::vector<std::string> tables;
     // update 的set 值
     std::vector<SetClause> set_clauses;
-    //insert 的values值
-    std::vector<Value> values;
+    //insert 的values值，每行一个
+    std::vector<std::vector<Value>> values;
 
     Query(){}
 
@@ -3,6 +3,7 @@
 #include <atomic>
 #include <chrono>
 #include <cstdint>
+#include <string>
 
 #define BUFFER_LENGTH 8192
 
@@ -22,8 +23,31 @@ static constexpr int INVALID_TIMESTAMP = -1;                                  //
 static constexpr int INVALID_LSN = -1;                                        // invalid log sequence number
 static constexpr int HEADER_PAGE_ID = 0;                                      // the header page id
 static constexpr int PAGE_SIZE = 4096;                                        // size of a data page in byte  4KB
+static constexpr int MAX_PAGE_SIZE = 65536;                                   // largest per-file page size, a power of two
+static constexpr int NUM_PAGE_SIZE_CLASSES = 5;                               // page sizes PAGE_SIZE << 0 .. MAX_PAGE_SIZE
 static constexpr int BUFFER_POOL_SIZE = 65536;                                // size of buffer pool 256MB
-// static constexpr int BUFFER_POOL_SIZE = 262144;                                // size of buffer pool 1GB
+static constexpr int BUFFER_POOL_MAX_SIZE = 262144;                           // largest online resize of the buffer pool 1GB
+static constexpr int BUFFER_POOL_NUM_SHARDS = 16;                             // number of buffer pool shards
+static constexpr int BUFFER_POOL_RESIZE_TIMEOUT_MS = 5000;                    // how long a shrink waits for pinned frames
+static constexpr double BUFFER_POOL_LARGE_PAGE_FRACTION = 0.25;               // large page pool size / default pool size
+static constexpr int BUFFER_POOL_MIN_CLASS_FRAMES = 64;                       // minimum frames of a large page pool
+static constexpr double BUFFER_POOL_CLEAN_FRACTION = 0.25;                    // fraction of unpinned frames kept clean
+static constexpr int BG_WRITER_INTERVAL_MS = 100;                             // background writer wakeup interval
+static constexpr bool BUFFER_POOL_HUGE_PAGES = true;                          // back buffer pool frames with huge pages if possible
+static constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;                     // size of a huge page (x86-64 default)
+static constexpr int BUFFER_RING_SIZE = 32;                                   // frames recycled by a large sequential scan
+static constexpr int READ_AHEAD_MIN_PAGES = 4;                                // initial sequential read-ahead window
+static constexpr int READ_AHEAD_MAX_PAGES = 32;                               // maximum sequential read-ahead window
+static constexpr int BUFFER_STATS_STRIPES = 16;                               // per-thread slots of a statistics counter
+static constexpr int BUFFER_STATS_HIT_SAMPLE_INTERVAL = 64;                   // time one buffer pool hit out of this many
+static constexpr int BUFFER_STATS_DUMP_INTERVAL_MS = 60000;                   // period of the statistics dump, 0 disables it
+static constexpr bool VERIFY_PAGE_CHECKSUMS = true;                           // verify page checksums when reading pages from disk
+static constexpr int SCRUB_BATCH_PAGES = 32;                                  // pages read per batch when scrubbing a file
+static constexpr bool ENABLE_IO_URING = true;                                 // use io_uring for async I/O when available
+static constexpr bool ENABLE_DIRECT_IO = false;                               // open table and index files with O_DIRECT
+static constexpr int DIRECT_IO_ALIGNMENT = 4096;                              // buffer/offset/size alignment for O_DIRECT
+static constexpr int IO_QUEUE_DEPTH = 64;                                     // max in-flight requests per async I/O context
+static constexpr int FILE_EXTENT_SIZE = 1024 * 1024;                          // data files grow by fallocate-ing extents this large, 0 disables
 static constexpr int LOG_BUFFER_SIZE = (1024 * PAGE_SIZE);                    // size of a log buffer in byte
 static constexpr int BUCKET_SIZE = 50;                                        // size of extendible hash bucket
 
@@ -37,8 +61,11 @@ using timestamp_t = int32_t;  // timestamp type, used for transaction concurrenc
 
 // log file
 static const std::string LOG_FILE_NAME = "db.log";
+// periodic buffer pool statistics dump
+static const std::string BUFFER_STATS_FILE_NAME = "buffer_stats.log";
 
-// replacer
+// replacer: "LRU", "CLOCK" or "LRU-K"
 static const std::string REPLACER_TYPE = "LRU";
+static constexpr int REPLACER_LRU_K = 2;                                      // K of the LRU-K replacer
 
 static const std::string DB_META_NAME = "db.meta";
@@ -30,18 +30,22 @@ struct Rid {
 };
 
 enum ColType {
-    TYPE_INT, TYPE_FLOAT, TYPE_STRING
+    TYPE_INT, TYPE_FLOAT, TYPE_STRING, TYPE_VARCHAR
 };
 
 inline std::string coltype2str(ColType type) {
     std::map<ColType, std::string> m = {
             {TYPE_INT,    "INT"},
             {TYPE_FLOAT,  "FLOAT"},
-            {TYPE_STRING, "STRING"}
+            {TYPE_STRING, "STRING"},
+            {TYPE_VARCHAR, "VARCHAR"}
     };
     return m.at(type);
 }
 
+// 定长字符串CHAR和变长字符串VARCHAR，两者之间可以互相比较，字符串常量可以写入两者
+inline bool is_string_type(ColType type) { return type == TYPE_STRING || type == TYPE_VARCHAR; }
+
 class RecScan {
 public:
     virtual ~RecScan() = default;
@@ -49,6 +49,29 @@ class FileNotFoundError : public UniBaseError {
     FileNotFoundError(const std::string &filename) : UniBaseError("File not found: " + filename) {}
 };
 
+class InvalidPageSizeError : public UniBaseError {
+   public:
+    InvalidPageSizeError(int page_size) : UniBaseError("Invalid page size: " + std::to_string(page_size)) {}
+};
+
+class InvalidBufferPoolSizeError : public UniBaseError {
+   public:
+    InvalidBufferPoolSizeError(size_t pool_size, size_t min_size, size_t max_size)
+        : UniBaseError("Invalid buffer pool size: " + std::to_string(pool_size) + ", expected " +
+                       std::to_string(min_size) + " to " + std::to_string(max_size) + " pages") {}
+};
+
+class BufferPoolResizeTimeoutError : public UniBaseError {
+   public:
+    BufferPoolResizeTimeoutError() : UniBaseError("Timed out shrinking buffer pool: pages are still pinned") {}
+};
+
+class PageChecksumError : public UniBaseError {
+   public:
+    PageChecksumError(const std::string &file_name, int page_no)
+        : UniBaseError("Page checksum mismatch: page " + std::to_string(page_no) + " in file " + file_name) {}
+};
+
 // RM errors
 class RecordNotFoundError : public UniBaseError {
    public:
@@ -83,6 +106,11 @@ class DatabaseExistsError : public UniBaseError {
     DatabaseExistsError(const std::string &db_name) : UniBaseError("Database already exists: " + db_name) {}
 };
 
+class DatabaseReadOnlyError : public UniBaseError {
+   public:
+    DatabaseReadOnlyError(const std::string &db_name) : UniBaseError("Database is opened read-only: " + db_name) {}
+};
+
 class TableNotFoundError : public UniBaseError {
    public:
     TableNotFoundError(const std::string &tab_name) : UniBaseError("Table not found: " + tab_name) {}
@@ -21,6 +21,8 @@ const char *help_info = "Supported SQL syntax:\n"
                    "  DELETE FROM table_name [WHERE where_clause]\n"
                    "  UPDATE table_name SET column_name = value [, column_name = value ...] [WHERE where_clause]\n"
                    "  SELECT selector FROM table_name [WHERE where_clause]\n"
+                   "  SET BUFFER_POOL_SIZE = number_of_pages\n"
+                   "  SHOW BUFFER STATUS\n"
                    "type:\n"
                    "  {INT | FLOAT | CHAR(n)}\n"
                    "where_clause:\n"
@@ -40,7 +42,7 @@ void QlManager::run_mutli_query(std::shared_ptr<Plan> plan, Context *context){
         switch(x->tag) {
             case T_CreateTable:
             {
-                sm_manager_->create_table(x->tab_name_, x->cols_, context);
+                sm_manager_->create_table(x->tab_name_, x->cols_, context, x->page_size_);
                 break;
             }
             case T_DropTable:
@@ -50,7 +52,7 @@ void QlManager::run_mutli_query(std::shared_ptr<Plan> plan, Context *context){
             }
             case T_CreateIndex:
             {
-                sm_manager_->create_index(x->tab_name_, x->tab_col_names_, context);
+                sm_manager_->create_index(x->tab_name_, x->tab_col_names_, context, x->page_size_);
                 break;
             }
             case T_DropIndex:
@@ -65,7 +67,7 @@ void QlManager::run_mutli_query(std::shared_ptr<Plan> plan, Context *context){
     }
 }
 
-// 执行help; show tables; desc table; begin; commit; abort;语句
+// 执行help; show tables; show buffer status; desc table; set; begin; commit; abort;语句
 void QlManager::run_cmd_utility(std::shared_ptr<Plan> plan, txn_id_t *txn_id, Context *context) {
     if (auto x = std::dynamic_pointer_cast<OtherPlan>(plan)) {
         switch(x->tag) {
@@ -80,11 +82,22 @@ void QlManager::run_cmd_utility(std::shared_ptr<Plan> plan, txn_id_t *txn_id, Co
                 sm_manager_->show_tables(context);
                 break;
             }
+            case T_ShowBufferStatus:
+            {
+                sm_manager_->show_buffer_status(context);
+                break;
+            }
             case T_DescTable:
             {
                 sm_manager_->desc_table(x->tab_name_, context);
                 break;
             }
+            case T_SetVariable:
+            {
+                // 目前只有buffer_pool_size，在线调整缓冲池的大小
+                sm_manager_->get_bpm()->resize(static_cast<size_t>(std::max(0, x->value_)));
+                break;
+            }
             case T_Transaction_begin:
             {
                 // 显示开启一个事务
@@ -156,6 +169,10 @@ void QlManager::select_from(std::unique_ptr<AbstractExecutor> executorTreeRoot,
             } else if (col.type == TYPE_STRING) {
                 col_str = std::string((char *)rec_buf, col.len);
                 col_str.resize(strlen(col_str.c_str()));
+            } else if (col.type == TYPE_VARCHAR) {
+                int value_len;
+                const char *value = col.get_value(Tuple->data, &value_len);
+                col_str = std::string(value, value_len);
             }
             columns.push_back(col_str);
         }
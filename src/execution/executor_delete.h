@@ -18,6 +18,7 @@ class DeleteExecutor : public AbstractExecutor {
     DeleteExecutor(SmManager *sm_manager, const std::string &tab_name, std::vector<Condition> conds,
                    std::vector<Rid> rids, Context *context) {
         sm_manager_ = sm_manager;
+        sm_manager_->check_writable();
         tab_name_ = tab_name;
         tab_ = sm_manager_->db_.get_table(tab_name);
         fh_ = sm_manager_->fhs_.at(tab_name).get();
@@ -7,54 +7,105 @@
 
 class InsertExecutor : public AbstractExecutor {
    private:
-    TabMeta tab_;                   // 表的元数据
-    std::vector<Value> values_;     // 需要插入的数据
-    RmFileHandle *fh_;              // 表的数据文件句柄
-    std::string tab_name_;          // 表名称
-    Rid rid_;                       // 插入的位置，由于系统默认插入时不指定位置，因此当前rid_在插入后才赋值
+    TabMeta tab_;                               // 表的元数据
+    std::vector<std::vector<Value>> values_;    // 需要插入的数据，每行一条记录
+    RmFileHandle *fh_;                          // 表的数据文件句柄
+    std::string tab_name_;                      // 表名称
+    Rid rid_;                                   // 插入的位置，由于系统默认插入时不指定位置，因此当前rid_在插入后才赋值，多行时为最后一行的位置
     SmManager *sm_manager_;
 
    public:
-    InsertExecutor(SmManager *sm_manager, const std::string &tab_name, std::vector<Value> values, Context *context) {
+    InsertExecutor(SmManager *sm_manager, const std::string &tab_name, std::vector<std::vector<Value>> values,
+                   Context *context) {
         sm_manager_ = sm_manager;
+        sm_manager_->check_writable();
         tab_ = sm_manager_->db_.get_table(tab_name);
-        values_ = values;
+        values_ = std::move(values);
         tab_name_ = tab_name;
-        if (values.size() != tab_.cols.size()) {
-            throw InvalidValueCountError();
+        for (auto &row : values_) {
+            if (row.size() != tab_.cols.size()) {
+                throw InvalidValueCountError();
+            }
         }
         fh_ = sm_manager_->fhs_.at(tab_name).get();
         context_ = context;
     };
 
+    // 所有行一次插入：记录文件按页面批量写入，每个索引的键排序后批量插入
     std::unique_ptr<RmRecord> Next() override {
-        // Make record buffer
-        RmRecord rec(fh_->get_file_hdr().record_size);
-        for (size_t i = 0; i < values_.size(); i++) {
-            auto &col = tab_.cols[i];
-            auto &val = values_[i];
-            if (col.type != val.type) {
-                throw IncompatibleTypeError(coltype2str(col.type), coltype2str(val.type));
-            }
-            val.init_raw(col.len);
-            memcpy(rec.data + col.offset, val.raw->data, col.len);
+        if (values_.empty()) {
+            return nullptr;
         }
+        // Make record buffer，有VARCHAR字段时每行的长度不同，record_offsets记录每行的起始位置
+        std::vector<char> buf;
+        std::vector<size_t> record_offsets;
+        for (auto &row : values_) {
+            record_offsets.push_back(buf.size());
+            append_record(row, &buf);
+        }
+        record_offsets.push_back(buf.size());
         // Insert into record file
-        rid_ = fh_->insert_record(rec.data, context_);
-        
+        std::vector<Rid> rids;
+        if (fh_->is_slotted()) {
+            std::vector<RecordView> records;
+            for (size_t r = 0; r < values_.size(); r++) {
+                records.emplace_back(buf.data() + record_offsets[r],
+                                     static_cast<int>(record_offsets[r + 1] - record_offsets[r]));
+            }
+            rids = fh_->insert_records(records, context_);
+        } else {
+            rids = fh_->insert_records(buf.data(), static_cast<int>(values_.size()), context_);
+        }
+        rid_ = rids.back();
+
         // Insert into index
         for(size_t i = 0; i < tab_.indexes.size(); ++i) {
             auto& index = tab_.indexes[i];
             auto ih = sm_manager_->ihs_.at(sm_manager_->get_ix_manager()->get_index_name(tab_name_, index.cols)).get();
-            char* key = new char[index.col_tot_len];
-            int offset = 0;
-            for(size_t i = 0; i < index.col_num; ++i) {
-                memcpy(key + offset, rec.data + index.cols[i].offset, index.cols[i].len);
-                offset += index.cols[i].len;
+            std::vector<char> keys(rids.size() * index.col_tot_len);
+            std::vector<std::pair<const char *, Rid>> entries;
+            entries.reserve(rids.size());
+            for (size_t r = 0; r < rids.size(); r++) {
+                char *key = keys.data() + r * index.col_tot_len;
+                int offset = 0;
+                for(size_t j = 0; j < index.col_num; ++j) {
+                    index.cols[j].copy_key(buf.data() + record_offsets[r], key + offset);
+                    offset += index.cols[j].len;
+                }
+                entries.emplace_back(key, rids[r]);
             }
-            ih->insert_entry(key, rid_, context_->txn_);
+            ih->insert_entries(std::move(entries), context_->txn_);
         }
         return nullptr;
     }
     Rid &rid() override { return rid_; }
+
+   private:
+    // 把一行的值编码为记录追加到buf末尾：先是各字段的定长部分，VARCHAR字段的值依次存放在定长部分之后
+    void append_record(std::vector<Value> &row, std::vector<char> *buf) {
+        const size_t begin = buf->size();
+        int fixed_size = 0;
+        for (auto &col : tab_.cols) {
+            fixed_size = std::max(fixed_size, col.offset + col.fixed_len());
+        }
+        buf->resize(begin + fixed_size);
+        for (size_t i = 0; i < row.size(); i++) {
+            auto &col = tab_.cols[i];
+            auto &val = row[i];
+            if (col.type != val.type && !(is_string_type(col.type) && is_string_type(val.type))) {
+                throw IncompatibleTypeError(coltype2str(col.type), coltype2str(val.type));
+            }
+            if (col.type == TYPE_VARCHAR) {
+                if (static_cast<int>(val.str_val.size()) > col.len) {
+                    throw StringOverflowError();
+                }
+                VarcharRef ref{static_cast<uint16_t>(buf->size() - begin), static_cast<uint16_t>(val.str_val.size())};
+                memcpy(buf->data() + begin + col.offset, &ref, sizeof(ref));
+                buf->insert(buf->end(), val.str_val.begin(), val.str_val.end());
+                continue;
+            }
+            val.init_raw(col.len);
+            memcpy(buf->data() + begin + col.offset, val.raw->data, col.len);
+        }
+    }
 };
\ No newline at end of file
@@ -11,11 +11,12 @@ constexpr int IX_LEAF_HEADER_PAGE = 1;
 constexpr int IX_INIT_ROOT_PAGE = 2;
 constexpr int IX_INIT_NUM_PAGES = 3;
 constexpr int IX_MAX_COL_LEN = 512;
+constexpr int IX_LEGACY_PAGE_HDR_OFFSET = 0;    // Page::LAYOUT_LEGACY布局中IxPageHdr位于页面开头
 
 class IxFileHdr {
 public: 
     page_id_t first_free_page_no_;      // 文件中第一个空闲的磁盘页面的页面号
-    int num_pages_;                     // 磁盘文件中页面的数量
+    int num_pages_;                     // 磁盘文件中页面的数量（包括空闲页面）
     page_id_t root_page_;               // B+树根节点对应的页面号
     int col_num_;                       // 索引包含的字段数量
     std::vector<ColType> col_types_;    // 字段的类型
@@ -26,22 +27,33 @@ public:
     // first_leaf初始化之后没有进行修改，只不过是在测试文件中遍历叶子结点的时候用了
     page_id_t first_leaf_;              // 首叶节点对应的页号，在上层IxManager的open函数进行初始化，初始化为root page_no
     page_id_t last_leaf_;               // 尾叶节点对应的页号
+    int page_size_;                     // 索引文件的页面大小，旧文件的文件头中没有该字段，视为PAGE_SIZE
+    int layout_version_;                // 页面布局版本，旧文件的文件头中没有该字段，视为Page::LAYOUT_LEGACY
     int tot_len_;                       // 记录结构体的整体长度
 
     IxFileHdr() {
         tot_len_ = col_num_ = 0;
+        page_size_ = PAGE_SIZE;
+        layout_version_ = Page::LAYOUT_CHECKSUM;
     }
 
     IxFileHdr(page_id_t first_free_page_no, int num_pages, page_id_t root_page, int col_num,
-                int col_tot_len, int btree_order, int keys_size, page_id_t first_leaf, page_id_t last_leaf)
+                int col_tot_len, int btree_order, int keys_size, page_id_t first_leaf, page_id_t last_leaf,
+                int page_size = PAGE_SIZE)
                 : first_free_page_no_(first_free_page_no), num_pages_(num_pages), root_page_(root_page), col_num_(col_num),
-                col_tot_len_(col_tot_len), btree_order_(btree_order), keys_size_(keys_size), first_leaf_(first_leaf), last_leaf_(last_leaf) {
+                col_tot_len_(col_tot_len), btree_order_(btree_order), keys_size_(keys_size), first_leaf_(first_leaf), last_leaf_(last_leaf),
+                page_size_(page_size), layout_version_(Page::LAYOUT_CHECKSUM) {
                     tot_len_ = 0;
                 } 
 
+    // 节点页面中IxPageHdr的偏移量
+    int page_hdr_offset() const {
+        return layout_version_ == Page::LAYOUT_LEGACY ? IX_LEGACY_PAGE_HDR_OFFSET : static_cast<int>(Page::OFFSET_PAGE_HDR);
+    }
+
     void update_tot_len() {
         tot_len_ = 0;
-        tot_len_ += sizeof(page_id_t) * 4 + sizeof(int) * 6;
+        tot_len_ += sizeof(page_id_t) * 4 + sizeof(int) * 8;
         tot_len_ += sizeof(ColType) * col_num_ + sizeof(int) * col_num_;
     }
 
@@ -75,6 +87,10 @@ public:
         offset += sizeof(page_id_t);
         memcpy(dest + offset, &last_leaf_, sizeof(page_id_t));
         offset += sizeof(page_id_t);
+        memcpy(dest + offset, &page_size_, sizeof(int));
+        offset += sizeof(int);
+        memcpy(dest + offset, &layout_version_, sizeof(int));
+        offset += sizeof(int);
         assert(offset == tot_len_);
     }
 
@@ -113,13 +129,25 @@ public:
         offset += sizeof(page_id_t);
         last_leaf_ = *reinterpret_cast<const page_id_t*>(src + offset);
         offset += sizeof(page_id_t);
+        page_size_ = PAGE_SIZE;
+        if (offset < tot_len_) {
+            page_size_ = *reinterpret_cast<const int*>(src + offset);
+            offset += sizeof(int);
+        }
+        layout_version_ = Page::LAYOUT_LEGACY;
+        if (offset < tot_len_) {
+            layout_version_ = *reinterpret_cast<const int*>(src + offset);
+            offset += sizeof(int);
+        }
         assert(offset == tot_len_);
+        // 旧文件头缺少的字段已取默认值，关闭文件时按当前格式写回，布局版本保持不变
+        update_tot_len();
     }
 };
 
 class IxPageHdr {
 public:
-    page_id_t next_free_page_no;    // unused
+    page_id_t next_free_page_no;    // 页面被释放后，指向文件空闲链表中的下一个空闲页面
     page_id_t parent;               // 父亲节点所在页面的叶号
     int num_key;                    // # current keys (always equals to #child - 1) 已插入的keys数量，key_idx∈[0,num_key)
     bool is_leaf;                   // 是否为叶节点
@@ -172,15 +172,28 @@ int IxNodeHandle::remove(const char *key) {
 IxIndexHandle::IxIndexHandle(DiskManager *disk_manager, BufferPoolManager *buffer_pool_manager, int fd)
     : disk_manager_(disk_manager), buffer_pool_manager_(buffer_pool_manager), fd_(fd) {
     // init file_hdr_
-    char *buf = new char[PAGE_SIZE];
-    memset(buf, 0, PAGE_SIZE);
-    disk_manager_->read_page(fd, IX_FILE_HDR_PAGE, buf, PAGE_SIZE);
+    AlignedBuffer buf = DiskManager::alloc_aligned(PAGE_SIZE);
+    disk_manager_->read_page(fd, IX_FILE_HDR_PAGE, buf.get(), PAGE_SIZE);
     file_hdr_ = new IxFileHdr();
-    file_hdr_->deserialize(buf);
-    delete[] buf;
+    file_hdr_->deserialize(buf.get());
     
     // disk_manager管理的fd对应的文件中，设置从file_hdr_->num_pages开始分配page_no
     disk_manager_->set_fd2pageno(fd, file_hdr_->num_pages_);
+    disk_manager_->set_page_size(fd, file_hdr_->page_size_);
+    disk_manager_->set_legacy_layout(fd, file_hdr_->layout_version_ == Page::LAYOUT_LEGACY);
+
+    // 沿空闲链表恢复被释放的页面，链表头（最近释放的页面）放在末尾，最先被分配
+    std::vector<page_id_t> free_pages;
+    IxPageHdr page_hdr;
+    char hdr_buf[Page::OFFSET_PAGE_HDR + sizeof(IxPageHdr)];
+    for (page_id_t page_no = file_hdr_->first_free_page_no_; page_no != IX_NO_PAGE;
+         page_no = page_hdr.next_free_page_no) {
+        free_pages.push_back(page_no);
+        disk_manager_->read_page(fd, page_no, hdr_buf, sizeof(hdr_buf));
+        memcpy(&page_hdr, hdr_buf + file_hdr_->page_hdr_offset(), sizeof(IxPageHdr));
+    }
+    std::reverse(free_pages.begin(), free_pages.end());
+    disk_manager_->set_free_pages(fd, std::move(free_pages));
 }
 
 /**
@@ -336,6 +349,17 @@ page_id_t IxIndexHandle::insert_entry(const char *key, const Rid &value, Transac
     if (leaf == nullptr) {
         return IX_NO_PAGE;
     }
+    return insert_into_leaf(leaf, key, value, transaction);
+}
+
+/**
+ * @brief 将键值对插入到已经找到的叶结点中，必要时分裂叶结点
+ * @param leaf 键所在的叶结点，调用者需持有root_latch_
+ * @return page_id_t 插入到的叶结点的page_no
+ * @note 函数返回前unpin叶结点
+ */
+page_id_t IxIndexHandle::insert_into_leaf(IxNodeHandle *leaf, const char *key, const Rid &value,
+                                          Transaction *transaction) {
     int before = leaf->get_size();
     int after = leaf->insert(key, value);
     if (after == before) {
@@ -365,6 +389,82 @@ page_id_t IxIndexHandle::insert_entry(const char *key, const Rid &value, Transac
     return ret_page;
 }
 
+/**
+ * @brief 批量插入键值对。先按键排序，相邻的键通常落在同一个叶结点中：叶结点在后续的键超出其范围或需要分裂之前
+ * 一直被pin住，这些键直接插入叶结点，不需要每个键都从根结点查找、pin和unpin路径上的结点
+ * @param entries 要插入的键值对，键指向的数据在函数返回前必须有效
+ * @param transaction 事务指针
+ * @note 与逐个调用insert_entry的结果相同，已经存在的键被跳过
+ */
+void IxIndexHandle::insert_entries(std::vector<std::pair<const char *, Rid>> entries, Transaction *transaction) {
+    std::stable_sort(entries.begin(), entries.end(), [&](const auto &a, const auto &b) {
+        return ix_compare(a.first, b.first, file_hdr_->col_types_, file_hdr_->col_lens_) < 0;
+    });
+    std::lock_guard<std::mutex> guard(root_latch_);
+    if (is_empty()) {
+        return;
+    }
+    IxNodeHandle *leaf = nullptr;
+    bool leaf_dirty = false;
+    std::string fence;  // 叶结点范围的上界，为空表示叶结点是最右边的叶结点
+    for (auto &[key, rid] : entries) {
+        // 1. 键超出当前叶结点的范围，或插入后需要分裂时，释放当前叶结点
+        if (leaf != nullptr &&
+            ((!fence.empty() &&
+              ix_compare(key, fence.data(), file_hdr_->col_types_, file_hdr_->col_lens_) >= 0) ||
+             leaf->get_size() + 1 >= leaf->get_max_size())) {
+            buffer_pool_manager_->unpin_page(leaf->get_page_id(), leaf_dirty);
+            leaf = nullptr;
+        }
+        // 2. 从根结点查找键所在的叶结点；插入后需要分裂的按单个键插入
+        if (leaf == nullptr) {
+            leaf = find_leaf_with_fence(key, &fence);
+            leaf_dirty = false;
+            if (leaf->get_size() + 1 >= leaf->get_max_size()) {
+                insert_into_leaf(leaf, key, rid, transaction);
+                leaf = nullptr;
+                continue;
+            }
+        }
+        // 3. 直接插入叶结点，键成为叶结点的第一个键时更新父结点
+        int before = leaf->get_size();
+        if (leaf->insert(key, rid) == before) {
+            continue;
+        }
+        leaf_dirty = true;
+        if (ix_compare(leaf->get_key(0), key, file_hdr_->col_types_, file_hdr_->col_lens_) == 0) {
+            maintain_parent(leaf);
+        }
+        if (file_hdr_->last_leaf_ == IX_NO_PAGE && leaf->get_next_leaf() == IX_LEAF_HEADER_PAGE) {
+            file_hdr_->last_leaf_ = leaf->get_page_no();
+        }
+    }
+    if (leaf != nullptr) {
+        buffer_pool_manager_->unpin_page(leaf->get_page_id(), leaf_dirty);
+    }
+}
+
+/**
+ * @brief 查找键所在的叶结点，同时求出叶结点所含键的上界：路径上最深的、位于所选孩子右边的分隔键
+ * @param fence 返回上界，叶结点是最右边的叶结点时为空串
+ * @return 键所在的叶结点，需要在函数外unpin
+ */
+IxNodeHandle *IxIndexHandle::find_leaf_with_fence(const char *key, std::string *fence) {
+    fence->clear();
+    IxNodeHandle *node = fetch_node(file_hdr_->root_page_);
+    while (!node->is_leaf_page()) {
+        int idx = node->upper_bound(key);
+        int child_idx = (idx == 0) ? 0 : idx - 1;
+        if (child_idx + 1 < node->get_size()) {
+            fence->assign(node->get_key(child_idx + 1), file_hdr_->col_tot_len_);
+        }
+        page_id_t child = node->value_at(child_idx);
+        buffer_pool_manager_->unpin_page(node->get_page_id(), false);
+        node = fetch_node(child);
+    }
+    return node;
+}
+
 /**
  * @brief 用于删除B+树中含有指定key的键值对
  * @param key 要删除的key值
@@ -454,12 +554,14 @@ bool IxIndexHandle::adjust_root(IxNodeHandle *old_root_node) {
         IxNodeHandle *child = fetch_node(child_page_no);
         child->set_parent_page_no(IX_NO_PAGE);
         buffer_pool_manager_->unpin_page(child->get_page_id(), true);
+        release_node_handle(*old_root_node);
         return true;
     }
     if (old_root_node->is_leaf_page() && old_root_node->get_size() == 0) {
         update_root_page_no(IX_NO_PAGE);
         file_hdr_->first_leaf_ = IX_NO_PAGE;
         file_hdr_->last_leaf_ = IX_NO_PAGE;
+        release_node_handle(*old_root_node);
         return true;
     }
     return false;
@@ -550,6 +652,7 @@ bool IxIndexHandle::coalesce(IxNodeHandle **neighbor_node, IxNodeHandle **node,
     }
     (*parent)->erase_pair(index);
     right->set_size(0);
+    release_node_handle(*right);
     bool delete_parent;
     if ((*parent)->is_root_page()) {
         delete_parent = (*parent)->get_size() <= 1;
@@ -569,12 +672,13 @@ bool IxIndexHandle::coalesce(IxNodeHandle **neighbor_node, IxNodeHandle **node,
  * @note iid和rid存的不是一个东西，rid是上层传过来的记录位置，iid是索引内部生成的索引槽位置
  */
 Rid IxIndexHandle::get_rid(const Iid &iid) const {
-    IxNodeHandle *node = fetch_node(iid.page_no);
-    if (iid.slot_no >= node->get_size()) {
+    auto guard = buffer_pool_manager_->fetch_page_read({fd_, iid.page_no});
+    assert(guard.is_valid());
+    IxNodeHandle node(file_hdr_, guard.get_page());
+    if (iid.slot_no >= node.get_size()) {
         throw IndexEntryNotFoundError();
     }
-    buffer_pool_manager_->unpin_page(node->get_page_id(), false);  // unpin it!
-    return *node->get_rid(iid.slot_no);
+    return *node.get_rid(iid.slot_no);
 }
 
 /**
@@ -648,10 +752,10 @@ Iid IxIndexHandle::upper_bound(const char *key) {
  * @return Iid
  */
 Iid IxIndexHandle::leaf_end() const {
-    IxNodeHandle *node = fetch_node(file_hdr_->last_leaf_);
-    Iid iid = {.page_no = file_hdr_->last_leaf_, .slot_no = node->get_size()};
-    buffer_pool_manager_->unpin_page(node->get_page_id(), false);  // unpin it!
-    return iid;
+    auto guard = buffer_pool_manager_->fetch_page_read({fd_, file_hdr_->last_leaf_});
+    assert(guard.is_valid());
+    IxNodeHandle node(file_hdr_, guard.get_page());
+    return {.page_no = file_hdr_->last_leaf_, .slot_no = node.get_size()};
 }
 
 /**
@@ -688,15 +792,32 @@ IxNodeHandle *IxIndexHandle::fetch_node(int page_no) const {
  * 注意：对于Index的处理是，删除某个页面后，认为该被删除的页面是free_page
  * 而first_free_page实际上就是最新被删除的页面，初始为IX_NO_PAGE
  * 在最开始插入时，一直是create node，那么first_page_no一直没变，一直是IX_NO_PAGE
+ * 空闲链表不为空时优先复用链表头的页面（disk_manager分配的也正是该页面），否则在文件末尾分配新页面
  * 与Record的处理不同，Record将未插入满的记录页认为是free_page
  */
 IxNodeHandle *IxIndexHandle::create_node() {
     IxNodeHandle *node;
-    file_hdr_->num_pages_++;
+    page_id_t next_free_page_no = IX_NO_PAGE;
+    if (file_hdr_->first_free_page_no_ != IX_NO_PAGE) {
+        // 新页面的内容会被清零，先取出空闲链表中的下一个页面
+        IxNodeHandle *free_node = fetch_node(file_hdr_->first_free_page_no_);
+        next_free_page_no = free_node->page_hdr->next_free_page_no;
+        buffer_pool_manager_->unpin_page(free_node->get_page_id(), false);
+        delete free_node;
+    }
 
     PageId new_page_id = {.fd = fd_, .page_no = INVALID_PAGE_ID};
     // 从3开始分配page_no，第一次分配之后，new_page_id.page_no=3，file_hdr_.num_pages=4
     Page *page = buffer_pool_manager_->new_page(&new_page_id);
+    if (page == nullptr) {
+        throw InternalError("IxIndexHandle::create_node: buffer pool is full");
+    }
+    if (file_hdr_->first_free_page_no_ != IX_NO_PAGE) {
+        assert(new_page_id.page_no == file_hdr_->first_free_page_no_);
+        file_hdr_->first_free_page_no_ = next_free_page_no;
+    } else {
+        file_hdr_->num_pages_++;
+    }
     node = new IxNodeHandle(file_hdr_, page);
     return node;
 }
@@ -743,12 +864,15 @@ void IxIndexHandle::erase_leaf(IxNodeHandle *leaf) {
 }
 
 /**
- * @brief 删除node时，更新file_hdr_.num_pages
+ * @brief 删除node时，将其页面放入文件的空闲链表头部，并交给disk_manager回收，之后create_node会复用该页面
  *
- * @param node
+ * @param node 被删除的结点，调用者需在之后以脏页的方式unpin它，使链表指针被写回磁盘
+ * @note file_hdr_.num_pages是文件中已分配的页面个数，空闲页面仍在文件中，因此不减少
  */
 void IxIndexHandle::release_node_handle(IxNodeHandle &node) {
-    file_hdr_->num_pages_--;
+    node.page_hdr->next_free_page_no = file_hdr_->first_free_page_no_;
+    file_hdr_->first_free_page_no_ = node.get_page_no();
+    disk_manager_->deallocate_page(fd_, node.get_page_no());
 }
 
 /**
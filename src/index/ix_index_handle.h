@@ -20,6 +20,7 @@ inline int ix_compare(const char *a, const char *b, ColType type, int col_len) {
             return (fa < fb) ? -1 : ((fa > fb) ? 1 : 0);
         }
         case TYPE_STRING:
+        case TYPE_VARCHAR:
             return memcmp(a, b, col_len);
         default:
             throw InternalError("Unexpected data type");
@@ -44,7 +45,7 @@ class IxNodeHandle {
    private:
     const IxFileHdr *file_hdr;      // 节点所在文件的头部信息
     Page *page;                     // 存储节点的页面
-    IxPageHdr *page_hdr;            // page->data的第一部分，指针指向首地址，长度为sizeof(IxPageHdr)
+    IxPageHdr *page_hdr;            // page->data的第一部分，位于页面公共的页头之后（旧布局中位于页面开头），长度为sizeof(IxPageHdr)
     char *keys;                     // page->data的第二部分，指针指向首地址，长度为file_hdr->keys_size，每个key的长度为file_hdr->col_len
     Rid *rids;                      // page->data的第三部分，指针指向首地址
 
@@ -52,8 +53,8 @@ class IxNodeHandle {
     IxNodeHandle() = default;
 
     IxNodeHandle(const IxFileHdr *file_hdr_, Page *page_) : file_hdr(file_hdr_), page(page_) {
-        page_hdr = reinterpret_cast<IxPageHdr *>(page->get_data());
-        keys = page->get_data() + sizeof(IxPageHdr);
+        page_hdr = reinterpret_cast<IxPageHdr *>(page->get_data() + file_hdr->page_hdr_offset());
+        keys = page->get_data() + file_hdr->page_hdr_offset() + sizeof(IxPageHdr);
         rids = reinterpret_cast<Rid *>(keys + file_hdr->keys_size_);
     }
 
@@ -162,6 +163,8 @@ class IxIndexHandle {
    public:
     IxIndexHandle(DiskManager *disk_manager, BufferPoolManager *buffer_pool_manager, int fd);
 
+    int get_fd() const { return fd_; }
+
     // for search
     bool get_value(const char *key, std::vector<Rid> *result, Transaction *transaction);
 
@@ -171,6 +174,8 @@ class IxIndexHandle {
     // for insert
     page_id_t insert_entry(const char *key, const Rid &value, Transaction *transaction);
 
+    void insert_entries(std::vector<std::pair<const char *, Rid>> entries, Transaction *transaction);
+
     IxNodeHandle *split(IxNodeHandle *node);
 
     void insert_into_parent(IxNodeHandle *old_node, const char *key, IxNodeHandle *new_node, Transaction *transaction);
@@ -206,6 +211,11 @@ class IxIndexHandle {
 
     IxNodeHandle *create_node();
 
+    // for insert
+    page_id_t insert_into_leaf(IxNodeHandle *leaf, const char *key, const Rid &value, Transaction *transaction);
+
+    IxNodeHandle *find_leaf_with_fence(const char *key, std::string *fence);
+
     // for maintain data structure
     void maintain_parent(IxNodeHandle *node);
 
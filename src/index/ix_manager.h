@@ -1,5 +1,6 @@
 #pragma once
 
+#include <algorithm>
 #include <memory>
 #include <string>
 
@@ -44,12 +45,19 @@ class IxManager {
         return disk_manager_->is_file(ix_name);
     }
 
-    void create_index(const std::string &filename, const std::vector<ColMeta>& index_cols) {
+    void create_index(const std::string &filename, const std::vector<ColMeta>& index_cols, int page_size = PAGE_SIZE) {
         std::string ix_name = get_index_name(filename, index_cols);
         // Create index file
         disk_manager_->create_file(ix_name);
         // Open index file
         int fd = disk_manager_->open_file(ix_name);
+        try {
+            disk_manager_->set_page_size(fd, page_size);
+        } catch (InvalidPageSizeError &) {
+            disk_manager_->close_file(fd);
+            disk_manager_->destroy_file(ix_name);
+            throw;
+        }
 
         // Create file header and write to file
         // Theoretically we have: |page_hdr| + (|attr| + |rid|) * n <= PAGE_SIZE
@@ -61,35 +69,40 @@ class IxManager {
             col_tot_len += col.len;
         }
         if (col_tot_len > IX_MAX_COL_LEN) {
+            disk_manager_->close_file(fd);
+            disk_manager_->destroy_file(ix_name);
             throw InvalidColLengthError(col_tot_len);
         }
-        // 根据 |page_hdr| + (|attr| + |rid|) * (n + 1) <= PAGE_SIZE 求得n的最大值btree_order
+        // 根据 |公共页头| + |page_hdr| + (|attr| + |rid|) * (n + 1) <= PAGE_SIZE 求得n的最大值btree_order
         // 即 n <= btree_order，那么btree_order就是每个结点最多可插入的键值对数量（实际还多留了一个空位，但其不可插入）
-        int btree_order = static_cast<int>((PAGE_SIZE - sizeof(IxPageHdr)) / (col_tot_len + sizeof(Rid)) - 1);
+        int btree_order = static_cast<int>((page_size - Page::OFFSET_PAGE_HDR - sizeof(IxPageHdr)) /
+                                           (col_tot_len + sizeof(Rid)) - 1);
         assert(btree_order > 2);
 
         // Create file header and write to file
         IxFileHdr* fhdr = new IxFileHdr(IX_NO_PAGE, IX_INIT_NUM_PAGES, IX_INIT_ROOT_PAGE,
                                 col_num, col_tot_len, btree_order, (btree_order + 1) * col_tot_len,
-                                IX_INIT_ROOT_PAGE, IX_INIT_ROOT_PAGE);
+                                IX_INIT_ROOT_PAGE, IX_INIT_ROOT_PAGE, page_size);
         for(int i = 0; i < col_num; ++i) {
             fhdr->col_types_.push_back(index_cols[i].type);
             fhdr->col_lens_.push_back(index_cols[i].len);
         }
         fhdr->update_tot_len();
         
-        char* data = new char[fhdr->tot_len_];
-        fhdr->serialize(data);
-
-        disk_manager_->write_page(fd, IX_FILE_HDR_PAGE, data, fhdr->tot_len_);
-
-        char page_buf[PAGE_SIZE];  // 在内存中初始化page_buf中的内容，然后将其写入磁盘
-        memset(page_buf, 0, PAGE_SIZE);
+        // 按页对齐并写入整页，O_DIRECT模式下不需要经过中转缓冲区
+        int hdr_len = std::max(fhdr->tot_len_, page_size);
+        AlignedBuffer data = DiskManager::alloc_aligned(hdr_len);
+        fhdr->serialize(data.get());
+        disk_manager_->write_page(fd, IX_FILE_HDR_PAGE, data.get(), hdr_len);
+        delete fhdr;
+
+        AlignedBuffer buf = DiskManager::alloc_aligned(page_size);  // 在内存中初始化page_buf中的内容，然后将其写入磁盘
+        char *page_buf = buf.get();
         // 注意leaf header页号为1，也标记为叶子结点，其前一个/后一个叶子均指向root node
         // Create leaf list header page and write to file
         {
-            memset(page_buf, 0, PAGE_SIZE);
-            auto phdr = reinterpret_cast<IxPageHdr *>(page_buf);
+            memset(page_buf, 0, page_size);
+            auto phdr = reinterpret_cast<IxPageHdr *>(page_buf + Page::OFFSET_PAGE_HDR);
             *phdr = {
                 .next_free_page_no = IX_NO_PAGE,
                 .parent = IX_NO_PAGE,
@@ -98,13 +111,15 @@ class IxManager {
                 .prev_leaf = IX_INIT_ROOT_PAGE,
                 .next_leaf = IX_INIT_ROOT_PAGE,
             };
-            disk_manager_->write_page(fd, IX_LEAF_HEADER_PAGE, page_buf, PAGE_SIZE);
+            // 不经过缓冲池直接写入磁盘，需要自己计算校验和
+            set_page_checksum(page_buf, page_size, IX_LEAF_HEADER_PAGE);
+            disk_manager_->write_page(fd, IX_LEAF_HEADER_PAGE, page_buf, page_size);
         }
         // 注意root node页号为2，也标记为叶子结点，其前一个/后一个叶子均指向leaf header
         // Create root node and write to file
         {
-            memset(page_buf, 0, PAGE_SIZE);
-            auto phdr = reinterpret_cast<IxPageHdr *>(page_buf);
+            memset(page_buf, 0, page_size);
+            auto phdr = reinterpret_cast<IxPageHdr *>(page_buf + Page::OFFSET_PAGE_HDR);
             *phdr = {
                 .next_free_page_no = IX_NO_PAGE,
                 .parent = IX_NO_PAGE,
@@ -113,8 +128,9 @@ class IxManager {
                 .prev_leaf = IX_LEAF_HEADER_PAGE,
                 .next_leaf = IX_LEAF_HEADER_PAGE,
             };
-            // Must write PAGE_SIZE here in case of future fetch_node()
-            disk_manager_->write_page(fd, IX_INIT_ROOT_PAGE, page_buf, PAGE_SIZE);
+            // Must write a whole page here in case of future fetch_node()
+            set_page_checksum(page_buf, page_size, IX_INIT_ROOT_PAGE);
+            disk_manager_->write_page(fd, IX_INIT_ROOT_PAGE, page_buf, page_size);
         }
 
         disk_manager_->set_fd2pageno(fd, IX_INIT_NUM_PAGES - 1);  // DEBUG
@@ -147,9 +163,10 @@ class IxManager {
     }
 
     void close_index(const IxIndexHandle *ih) {
-        char* data = new char[ih->file_hdr_->tot_len_];
-        ih->file_hdr_->serialize(data);
-        disk_manager_->write_page(ih->fd_, IX_FILE_HDR_PAGE, data, ih->file_hdr_->tot_len_);
+        int hdr_len = std::max(ih->file_hdr_->tot_len_, disk_manager_->get_page_size(ih->fd_));
+        AlignedBuffer data = DiskManager::alloc_aligned(hdr_len);
+        ih->file_hdr_->serialize(data.get());
+        disk_manager_->write_page(ih->fd_, IX_FILE_HDR_PAGE, data.get(), hdr_len);
         // 缓冲区的所有页刷到磁盘，注意这句话必须写在close_file前面
         buffer_pool_manager_->flush_all_pages(ih->fd_);
         disk_manager_->close_file(ih->fd_);
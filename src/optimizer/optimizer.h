@@ -28,6 +28,12 @@ class Optimizer {
         } else if (auto x = std::dynamic_pointer_cast<ast::ShowTables>(query->parse)) {
             // show tables;
             return std::make_shared<OtherPlan>(T_ShowTable, std::string());
+        } else if (auto x = std::dynamic_pointer_cast<ast::ShowBufferStatus>(query->parse)) {
+            // show buffer status;
+            return std::make_shared<OtherPlan>(T_ShowBufferStatus, std::string());
+        } else if (auto x = std::dynamic_pointer_cast<ast::SetVariable>(query->parse)) {
+            // set buffer_pool_size = n;
+            return std::make_shared<OtherPlan>(T_SetVariable, x->name, x->value);
         } else if (auto x = std::dynamic_pointer_cast<ast::DescTable>(query->parse)) {
             // desc table;
             return std::make_shared<OtherPlan>(T_DescTable, x->tab_name);
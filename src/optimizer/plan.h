@@ -13,6 +13,8 @@ typedef enum PlanTag{
     T_Invalid = 1,
     T_Help,
     T_ShowTable,
+    T_ShowBufferStatus,
+    T_SetVariable,
     T_DescTable,
     T_CreateTable,
     T_DropTable,
@@ -127,7 +129,7 @@ class DMLPlan : public Plan
 {
     public:
         DMLPlan(PlanTag tag, std::shared_ptr<Plan> subplan,std::string tab_name,
-                std::vector<Value> values, std::vector<Condition> conds,
+                std::vector<std::vector<Value>> values, std::vector<Condition> conds,
                 std::vector<SetClause> set_clauses)
         {
             Plan::tag = tag;
@@ -140,7 +142,7 @@ class DMLPlan : public Plan
         ~DMLPlan(){}
         std::shared_ptr<Plan> subplan_;
         std::string tab_name_;
-        std::vector<Value> values_;
+        std::vector<std::vector<Value>> values_;     // insert的每一行
         std::vector<Condition> conds_;
         std::vector<SetClause> set_clauses_;
 };
@@ -149,30 +151,35 @@ class DMLPlan : public Plan
 class DDLPlan : public Plan
 {
     public:
-        DDLPlan(PlanTag tag, std::string tab_name, std::vector<std::string> col_names, std::vector<ColDef> cols)
+        DDLPlan(PlanTag tag, std::string tab_name, std::vector<std::string> col_names, std::vector<ColDef> cols,
+                int page_size = PAGE_SIZE)
         {
             Plan::tag = tag;
             tab_name_ = std::move(tab_name);
             cols_ = std::move(cols);
             tab_col_names_ = std::move(col_names);
+            page_size_ = page_size;
         }
         ~DDLPlan(){}
         std::string tab_name_;
         std::vector<std::string> tab_col_names_;
         std::vector<ColDef> cols_;
+        int page_size_;     // create table/index时文件的页面大小
 };
 
 // help; show tables; desc tables; begin; abort; commit; rollback语句对应的plan
 class OtherPlan : public Plan
 {
     public:
-        OtherPlan(PlanTag tag, std::string tab_name)
+        OtherPlan(PlanTag tag, std::string tab_name, int value = 0)
         {
             Plan::tag = tag;
             tab_name_ = std::move(tab_name);            
+            value_ = value;
         }
         ~OtherPlan(){}
-        std::string tab_name_;
+        std::string tab_name_;  // 表名称，T_SetVariable时为参数名称
+        int value_;             // T_SetVariable的参数值
 };
 
 class plannerInfo{
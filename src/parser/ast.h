@@ -10,7 +10,7 @@ enum JoinType {
 namespace ast {
 
 enum SvType {
-    SV_TYPE_INT, SV_TYPE_FLOAT, SV_TYPE_STRING
+    SV_TYPE_INT, SV_TYPE_FLOAT, SV_TYPE_STRING, SV_TYPE_VARCHAR
 };
 
 enum SvCompOp {
@@ -34,6 +34,18 @@ struct Help : public TreeNode {
 struct ShowTables : public TreeNode {
 };
 
+// 显示缓冲池和磁盘I/O的统计，show buffer status;
+struct ShowBufferStatus : public TreeNode {
+};
+
+// 修改系统参数，如 set buffer_pool_size = 131072;
+struct SetVariable : public TreeNode {
+    std::string name;   // 参数名称，小写
+    int value;
+
+    SetVariable(std::string name_, int value_) : name(std::move(name_)), value(value_) {}
+};
+
 struct TxnBegin : public TreeNode {
 };
 
@@ -67,9 +79,10 @@ struct ColDef : public Field {
 struct CreateTable : public TreeNode {
     std::string tab_name;
     std::vector<std::shared_ptr<Field>> fields;
+    int page_size;      // 数据文件的页面大小，0表示使用默认的PAGE_SIZE
 
-    CreateTable(std::string tab_name_, std::vector<std::shared_ptr<Field>> fields_) :
-            tab_name(std::move(tab_name_)), fields(std::move(fields_)) {}
+    CreateTable(std::string tab_name_, std::vector<std::shared_ptr<Field>> fields_, int page_size_ = 0) :
+            tab_name(std::move(tab_name_)), fields(std::move(fields_)), page_size(page_size_) {}
 };
 
 struct DropTable : public TreeNode {
@@ -87,9 +100,10 @@ struct DescTable : public TreeNode {
 struct CreateIndex : public TreeNode {
     std::string tab_name;
     std::vector<std::string> col_names;
+    int page_size;      // 索引文件的页面大小，0表示使用默认的PAGE_SIZE
 
-    CreateIndex(std::string tab_name_, std::vector<std::string> col_names_) :
-            tab_name(std::move(tab_name_)), col_names(std::move(col_names_)) {}
+    CreateIndex(std::string tab_name_, std::vector<std::string> col_names_, int page_size_ = 0) :
+            tab_name(std::move(tab_name_)), col_names(std::move(col_names_)), page_size(page_size_) {}
 };
 
 struct DropIndex : public TreeNode {
@@ -159,10 +173,10 @@ struct OrderBy : public TreeNode
 
 struct InsertStmt : public TreeNode {
     std::string tab_name;
-    std::vector<std::shared_ptr<Value>> vals;
+    std::vector<std::vector<std::shared_ptr<Value>>> rows;  // VALUES后的每一行
 
-    InsertStmt(std::string tab_name_, std::vector<std::shared_ptr<Value>> vals_) :
-            tab_name(std::move(tab_name_)), vals(std::move(vals_)) {}
+    InsertStmt(std::string tab_name_, std::vector<std::vector<std::shared_ptr<Value>>> rows_) :
+            tab_name(std::move(tab_name_)), rows(std::move(rows_)) {}
 };
 
 struct DeleteStmt : public TreeNode {
@@ -237,6 +251,7 @@ struct SemValue {
 
     std::shared_ptr<Value> sv_val;
     std::vector<std::shared_ptr<Value>> sv_vals;
+    std::vector<std::vector<std::shared_ptr<Value>>> sv_val_rows;
 
     std::shared_ptr<Col> sv_col;
     std::vector<std::shared_ptr<Col>> sv_cols;
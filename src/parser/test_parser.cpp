@@ -9,15 +9,19 @@ int main() {
         "show tables;",
         "desc tb;",
         "create table tb (a int, b float, c char(4));",
+        "create table tb (a int, b varchar(255), c char(4));",
         "drop table tb;",
         "create index tb(a);",
         "create index tb(a, b, c);",
         "drop index tb(a, b, c);",
         "drop index tb(b);",
         "insert into tb values (1, 3.14, 'pi');",
+        "insert into tb values (1, 3.14, 'pi'), (2, 2.72, 'e');",
         "delete from tb where a = 1;",
         "update tb set a = 1, b = 2.2, c = 'xyz' where x = 2 and y < 1.1 and z > 'abc';",
         "select * from tb;",
+        "set buffer_pool_size = 131072;",
+        "show buffer status;",
         "select * from tb where x <> 2 and y >= 3. and z <= '123' and b < tb.a;",
         "select x.a, y.b from x, y where x.a = y.b and c = d;",
         "select x.a, y.b from x join y where x.a = y.b and c = d;",
@@ -40,6 +40,7 @@ WHERE UPDATE SET SELECT INT CHAR FLOAT INDEX AND JOIN EXIT HELP TXN_BEGIN TXN_CO
 %type <sv_expr> expr
 %type <sv_val> value
 %type <sv_vals> valueList
+%type <sv_val_rows> valueRows
 %type <sv_str> tbName colName
 %type <sv_strs> tableList colNameList
 %type <sv_col> col
@@ -50,6 +51,7 @@ WHERE UPDATE SET SELECT INT CHAR FLOAT INDEX AND JOIN EXIT HELP TXN_BEGIN TXN_CO
 %type <sv_conds> whereClause optWhereClause
 %type <sv_orderby>  order_clause opt_order_clause
 %type <sv_orderby_dir> opt_asc_desc
+%type <sv_int> optPageSize
 
 %%
 start:
@@ -106,12 +108,28 @@ dbStmt:
     {
         $$ = std::make_shared<ShowTables>();
     }
+    |   SHOW IDENTIFIER IDENTIFIER
+    {
+        if (($2 != "buffer" && $2 != "BUFFER") || ($3 != "status" && $3 != "STATUS")) {
+            yyerror(&@2, "unknown show target, expected buffer status");
+            YYERROR;
+        }
+        $$ = std::make_shared<ShowBufferStatus>();
+    }
+    |   SET IDENTIFIER '=' VALUE_INT
+    {
+        if ($2 != "buffer_pool_size" && $2 != "BUFFER_POOL_SIZE") {
+            yyerror(&@2, "unknown variable, expected buffer_pool_size");
+            YYERROR;
+        }
+        $$ = std::make_shared<SetVariable>("buffer_pool_size", $4);
+    }
     ;
 
 ddl:
-        CREATE TABLE tbName '(' fieldList ')'
+        CREATE TABLE tbName '(' fieldList ')' optPageSize
     {
-        $$ = std::make_shared<CreateTable>($3, $5);
+        $$ = std::make_shared<CreateTable>($3, $5, $7);
     }
     |   DROP TABLE tbName
     {
@@ -121,9 +139,9 @@ ddl:
     {
         $$ = std::make_shared<DescTable>($2);
     }
-    |   CREATE INDEX tbName '(' colNameList ')'
+    |   CREATE INDEX tbName '(' colNameList ')' optPageSize
     {
-        $$ = std::make_shared<CreateIndex>($3, $5);
+        $$ = std::make_shared<CreateIndex>($3, $5, $7);
     }
     |   DROP INDEX tbName '(' colNameList ')'
     {
@@ -132,9 +150,9 @@ ddl:
     ;
 
 dml:
-        INSERT INTO tbName VALUES '(' valueList ')'
+        INSERT INTO tbName VALUES valueRows
     {
-        $$ = std::make_shared<InsertStmt>($3, $6);
+        $$ = std::make_shared<InsertStmt>($3, $5);
     }
     |   DELETE FROM tbName optWhereClause
     {
@@ -188,6 +206,14 @@ type:
     {
         $$ = std::make_shared<TypeLen>(SV_TYPE_STRING, $3);
     }
+    |   IDENTIFIER '(' VALUE_INT ')'
+    {
+        if ($1 != "varchar" && $1 != "VARCHAR") {
+            yyerror(&@1, "unknown column type, expected varchar");
+            YYERROR;
+        }
+        $$ = std::make_shared<TypeLen>(SV_TYPE_VARCHAR, $3);
+    }
     |   FLOAT
     {
         $$ = std::make_shared<TypeLen>(SV_TYPE_FLOAT, sizeof(float));
@@ -205,6 +231,17 @@ valueList:
     }
     ;
 
+valueRows:
+        '(' valueList ')'
+    {
+        $$ = std::vector<std::vector<std::shared_ptr<Value>>>{$2};
+    }
+    |   valueRows ',' '(' valueList ')'
+    {
+        $$.push_back($4);
+    }
+    ;
+
 value:
         VALUE_INT
     {
@@ -368,6 +405,22 @@ opt_asc_desc:
     |       { $$ = OrderBy_DEFAULT; }
     ;    
 
+// 建表/建索引时可选的页面大小，如 create table t (a int) page_size = 32768;
+optPageSize:
+        /* epsilon */
+    {
+        $$ = 0;
+    }
+    |   IDENTIFIER '=' VALUE_INT
+    {
+        if ($1 != "page_size" && $1 != "PAGE_SIZE") {
+            yyerror(&@1, "unknown table option, expected page_size");
+            YYERROR;
+        }
+        $$ = $3;
+    }
+    ;
+
 tbName: IDENTIFIER;
 
 colName: IDENTIFIER;
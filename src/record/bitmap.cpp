@@ -0,0 +1,55 @@
+#include "bitmap.h"
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+namespace {
+
+#if defined(__x86_64__)
+const bool HAS_AVX2 = __builtin_cpu_supports("avx2");
+
+/**
+ * @description: 从第word_no个字开始，每次检查32个字节，跳过全部为skip_byte的块
+ * @return {int} 第一个包含目标位的块（或剩余不足32个字节的部分）的起始字编号
+ */
+__attribute__((target("avx2"))) int skip_words_avx2(const char *bm, int num_bytes, int word_no, bool bit) {
+    const __m256i skip = bit ? _mm256_setzero_si256() : _mm256_set1_epi8(static_cast<char>(0xff));
+    while ((word_no + 4) * 8 <= num_bytes) {
+        __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(bm + word_no * 8));
+        if (_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, skip)) != -1) {
+            break;
+        }
+        word_no += 4;
+    }
+    return word_no;
+}
+#endif
+
+}  // namespace
+
+/**
+ * @description: 从第word_no个字开始找下一个为bit的位，scan_bits在第一个字中没有找到时调用
+ * @param {bool} use_avx2 是否用AVX2跳过连续不含目标位的字
+ */
+int Bitmap::scan_words(bool bit, const char *bm, int max_n, int word_no, bool use_avx2) {
+    const int num_words = (num_bytes(max_n) + 7) / 8;
+    const uint64_t flip = bit ? 0 : ~0ULL;
+    while (word_no < num_words) {
+#if defined(__x86_64__)
+        if (use_avx2 && HAS_AVX2) {
+            word_no = skip_words_avx2(bm, num_bytes(max_n), word_no, bit);
+            if (word_no >= num_words) {
+                break;
+            }
+        }
+#endif
+        uint64_t word = load_word(bm, max_n, word_no) ^ flip;
+        if (word != 0) {
+            int pos = word_no * 64 + __builtin_clzll(word);
+            return pos < max_n ? pos : max_n;
+        }
+        word_no++;
+    }
+    return max_n;
+}
@@ -17,6 +17,20 @@ class Bitmap {
     // pos位 置0
     static void reset(char *bm, int pos) { bm[get_bucket(pos)] &= static_cast<char>(~get_bit(pos)); }
 
+    // [pos, pos + n)位 置1，中间的整字节一次写入
+    static void set_range(char *bm, int pos, int n) {
+        int end = pos + n;
+        while (pos < end && pos % BITMAP_WIDTH != 0) {
+            set(bm, pos++);
+        }
+        int num_full_bytes = (end - pos) / BITMAP_WIDTH;
+        memset(bm + get_bucket(pos), 0xff, num_full_bytes);
+        pos += num_full_bytes * BITMAP_WIDTH;
+        while (pos < end) {
+            set(bm, pos++);
+        }
+    }
+
     // 如果pos位是1，则返回true
     static bool is_set(const char *bm, int pos) { return (bm[get_bucket(pos)] & get_bit(pos)) != 0; }
 
@@ -29,12 +43,33 @@ class Bitmap {
      * @return 找到了就返回偏移位置，没找到就返回max_n
      */
     static int next_bit(bool bit, const char *bm, int max_n, int curr) {
-        for (int i = curr + 1; i < max_n; i++) {
-            if (is_set(bm, i) == bit) {
-                return i;
-            }
+        return scan_bits(bit, bm, max_n, curr, true);
+    }
+
+    /**
+     * @brief next_bit的实现，每次处理一个64位字：找0时先把字取反，用clz得到字中第一个为1的位。
+     * 位图中的第i位是第i / 8个字节从高位数起的第i % 8位，按大端序读取字可以保持这个顺序，不改变磁盘上的格式
+     * @param use_avx2 是否用AVX2跳过连续不含目标位的字，CPU不支持AVX2时忽略
+     */
+    static int scan_bits(bool bit, const char *bm, int max_n, int curr, bool use_avx2) {
+        int start = curr + 1;
+        if (start >= max_n) {
+            return max_n;
         }
-        return max_n;
+        // 目标位紧接在curr之后时直接返回：扫描较满的位图时大多数查找在这里结束，且返回值不依赖读出的数据，
+        // 连续的查找不会被读取和计算字的延迟串行化
+        if (is_set(bm, start) == bit) {
+            return start;
+        }
+        // 在start所在的字中查找，start之前的位不参与查找
+        int word_no = start / 64;
+        uint64_t word = (load_word(bm, max_n, word_no) ^ (bit ? 0 : ~0ULL)) & (~0ULL >> (start % 64));
+        if (word == 0) {
+            return scan_words(bit, bm, max_n, word_no + 1, use_avx2);
+        }
+        // 找0时，最后一个字节中超出max_n的位和超出位图的字节取反后为1，结果可能不小于max_n
+        int pos = word_no * 64 + __builtin_clzll(word);
+        return pos < max_n ? pos : max_n;
     }
 
     // 找第一个为0 or 1的位
@@ -47,5 +82,26 @@ class Bitmap {
    private:
     static int get_bucket(int pos) { return pos / BITMAP_WIDTH; }
 
+    // 位图的字节数
+    static int num_bytes(int max_n) { return (max_n + BITMAP_WIDTH - 1) / BITMAP_WIDTH; }
+
+    // 按大端序读取第word_no个64位字，使第i位对应整数从高位数起的第i % 64位；超出位图的字节按0处理
+    static uint64_t load_word(const char *bm, int max_n, int word_no) {
+        int offset = word_no * 8;
+        int size = num_bytes(max_n);
+        if (offset + 8 <= size) {
+            uint64_t word;
+            memcpy(&word, bm + offset, sizeof(word));
+            return __builtin_bswap64(word);
+        }
+        uint64_t word = 0;
+        for (int i = 0; offset + i < size; i++) {
+            word |= static_cast<uint64_t>(static_cast<unsigned char>(bm[offset + i])) << (56 - 8 * i);
+        }
+        return word;
+    }
+
+    static int scan_words(bool bit, const char *bm, int max_n, int word_no, bool use_avx2);
+
     static char get_bit(int pos) { return BITMAP_HIGHEST_BIT >> static_cast<char>(pos % BITMAP_WIDTH); }
 };
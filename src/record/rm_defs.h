@@ -6,23 +6,63 @@
 constexpr int RM_NO_PAGE = -1;
 constexpr int RM_FILE_HDR_PAGE = 0;
 constexpr int RM_FIRST_RECORD_PAGE = 1;
-constexpr int RM_MAX_RECORD_SIZE = 512;
+constexpr int RM_MAX_RECORD_SIZE = 512;    // 定长格式的记录大小上限，分槽格式的上限由页面大小决定
+constexpr int RM_LEGACY_PAGE_HDR_OFFSET = 4;    // Page::LAYOUT_LEGACY布局中RmPageHdr在页面中的偏移量，紧跟在LSN之后
+
+/* 表数据文件的页面格式 */
+enum RmFormat {
+    RM_FORMAT_FIXED = 0,    // 定长记录：页面中是bitmap和等长的slot
+    RM_FORMAT_SLOTTED = 1   // 变长记录：页面中是槽目录，记录数据从页面末尾向前存放，见RmSlottedPage
+};
 
 /* 文件头，记录表数据文件的元信息，写入磁盘中文件的第0号页面 */
 struct RmFileHdr {
-    int record_size;            // 表中每条记录的大小，由于不包含变长字段，因此当前字段初始化后保持不变
+    int record_size;            // 表中每条记录的大小；分槽格式中为记录的最大长度
     int num_pages;              // 文件中分配的页面个数（初始化为1）
     int num_records_per_page;   // 每个页面最多能存储的元组个数
-    int first_free_page_no;     // 文件中当前第一个包含空闲空间的页面号（初始化为-1）
+    int first_free_page_no;     // 不再使用，空闲页面由空闲空间映射记录，保留以兼容已有文件（初始化为-1）
     int bitmap_size;            // 每个页面bitmap大小
+    int page_size;              // 文件的页面大小，旧文件中为0，表示PAGE_SIZE
+    int format;                 // 页面格式RmFormat，旧文件中为0，即RM_FORMAT_FIXED
+    int layout_version;         // 页面布局版本，旧文件中为0，即Page::LAYOUT_LEGACY，页面没有校验和
+
+    // 数据页面中RmPageHdr的偏移量
+    int page_hdr_offset() const {
+        return layout_version == Page::LAYOUT_LEGACY ? RM_LEGACY_PAGE_HDR_OFFSET : static_cast<int>(Page::OFFSET_PAGE_HDR);
+    }
 };
 
 /* 表数据文件中每个页面的页头，记录每个页面的元信息 */
 struct RmPageHdr {
-    int next_free_page_no;  // 当前页面满了之后，下一个包含空闲空间的页面号（初始化为-1）
+    int next_free_page_no;  // 不再使用，保留以兼容已有文件（初始化为-1）
     int num_records;        // 当前页面中当前已经存储的记录个数（初始化为0）
 };
 
+/* 分槽格式页面中RmPageHdr之后的槽目录头 */
+struct RmSlotDirHdr {
+    int num_slots;      // 槽目录中槽的个数，包括空闲槽
+    int free_upper;     // 记录数据区的起始位置（相对于页面首地址），记录从页面末尾向前存放
+    int used_bytes;     // 记录数据占用的字节数，被删除或缩短的记录留下的碎片不计入
+};
+
+/* 分槽格式页面中槽的状态 */
+enum RmSlotState : uint16_t {
+    RM_SLOT_FREE = 0,       // 空闲槽，可以被新记录使用
+    RM_SLOT_NORMAL = 1,     // 记录就存放在该槽中
+    RM_SLOT_FORWARD = 2,    // 记录因更新变长而迁移到其他页面，该槽中存放记录新位置的Rid
+    RM_SLOT_MOVED = 3       // 迁移来的记录，槽中先存放记录原位置的Rid，之后是记录的数据
+};
+
+/* 槽目录中的一项，记录的Rid始终是它最初所在的槽，迁移后通过RM_SLOT_FORWARD找到记录 */
+struct RmSlot {
+    uint16_t offset;    // 记录数据在页面中的偏移量，空闲槽为0
+    uint16_t len;       // 记录数据的长度，空间按max(len, RM_SLOT_MIN_LEN)分配
+    uint16_t state;     // 槽的状态RmSlotState
+};
+
+// 分槽格式中每条记录至少占用的空间，保证记录原地替换为RM_SLOT_FORWARD时总能放下新位置的Rid
+constexpr int RM_SLOT_MIN_LEN = sizeof(Rid);
+
 /* 表中的记录 */
 struct RmRecord {
     char* data;  // 记录的数据
@@ -38,21 +78,50 @@ struct RmRecord {
         allocated_ = true;
     };
 
+    // 移动时接管other的数据，不重新分配
+    RmRecord(RmRecord&& other) noexcept : data(other.data), size(other.size), allocated_(other.allocated_) {
+        other.data = nullptr;
+        other.allocated_ = false;
+    }
+
     RmRecord &operator=(const RmRecord& other) {
+        if (this == &other) {
+            return *this;
+        }
+        // 大小相同时复用已分配的空间
+        if (!allocated_ || size != other.size) {
+            if (allocated_) {
+                delete[] data;
+            }
+            data = new char[other.size];
+            allocated_ = true;
+        }
         size = other.size;
-        data = new char[size];
         memcpy(data, other.data, size);
-        allocated_ = true;
         return *this;
     };
 
+    RmRecord &operator=(RmRecord&& other) noexcept {
+        if (this != &other) {
+            if (allocated_) {
+                delete[] data;
+            }
+            data = other.data;
+            size = other.size;
+            allocated_ = other.allocated_;
+            other.data = nullptr;
+            other.allocated_ = false;
+        }
+        return *this;
+    }
+
     RmRecord(int size_) {
         size = size_;
         data = new char[size_];
         allocated_ = true;
     }
 
-    RmRecord(int size_, char* data_) {
+    RmRecord(int size_, const char* data_) {
         size = size_;
         data = new char[size_];
         memcpy(data, data_, size_);
@@ -70,6 +139,7 @@ struct RmRecord {
         }
         data = new char[size];
         memcpy(data, data_ + sizeof(int), size);
+        allocated_ = true;
     }
 
     ~RmRecord() {
@@ -80,3 +150,21 @@ struct RmRecord {
         data = nullptr;
     }
 };
+
+/**
+ * @description: 表中记录的只读视图，不拥有数据：data直接指向缓冲池页面中记录所在的slot，读取记录不需要分配和拷贝。
+ * 视图只在记录所在页面被pin住并持有共享锁期间有效，由产生视图的RmScan或ReadPageGuard保证；
+ * 记录需要在页面释放后继续使用时，调用to_record()拷贝出一个RmRecord
+ */
+struct RecordView {
+    const char* data = nullptr;     // 记录在页面中的首地址
+    int size = 0;                   // 记录的大小
+
+    RecordView() = default;
+
+    RecordView(const char* data_, int size_) : data(data_), size(size_) {}
+
+    bool is_valid() const { return data != nullptr; }
+
+    RmRecord to_record() const { return RmRecord(size, data); }
+};
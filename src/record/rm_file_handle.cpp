@@ -5,35 +5,101 @@
  * @param {Rid&} rid 记录号，指定记录的位置
  * @param {Context*} context
  * @return {unique_ptr<RmRecord>} rid对应的记录对象指针
+ * @note 返回记录的拷贝，只需要读取记录时使用get_record_view，避免分配和拷贝
  */
 std::unique_ptr<RmRecord> RmFileHandle::get_record(const Rid& rid, Context* context) const {
-    // 1. 获取指定记录所在的page handle
-    auto page_handle = fetch_page_handle(rid.page_no);
+    ReadPageGuard guard;
+    RecordView view = get_record_view(rid, &guard, context);
+    return std::make_unique<RmRecord>(view.size, view.data);
+}
+
+/**
+ * @description: 获取当前表中记录号为rid的记录的只读视图，不拷贝记录
+ * @param {Rid&} rid 记录号，指定记录的位置
+ * @param {ReadPageGuard*} guard 返回记录所在页面的读守卫，视图在守卫释放前有效
+ * @param {Context*} context
+ * @return {RecordView} 指向页面中记录的视图
+ */
+RecordView RmFileHandle::get_record_view(const Rid& rid, ReadPageGuard* guard, Context* context) const {
+    // 1. 获取指定记录所在的页面，持有共享锁，读取同一页面上不同记录的事务可以并行
+    *guard = fetch_page_read(rid.page_no);
+    if (is_slotted()) {
+        return get_slotted_view(rid, guard);
+    }
+    RmPageHandle page_handle(&file_hdr_, guard->get_page());
     // 2. 若对应slot不存在记录则抛出异常
     if (!Bitmap::is_set(page_handle.bitmap, rid.slot_no)) {
-        buffer_pool_manager_->unpin_page({fd_, rid.page_no}, false);
+        guard->drop();
         throw RecordNotFoundError(rid.page_no, rid.slot_no);
     }
-    // 3. 拷贝记录内容返回
-    auto rec = std::make_unique<RmRecord>(file_hdr_.record_size, page_handle.get_slot(rid.slot_no));
-    buffer_pool_manager_->unpin_page({fd_, rid.page_no}, false);
-    return rec;
+    return RecordView(page_handle.get_slot(rid.slot_no), file_hdr_.record_size);
 }
 
 /**
- * @description: 在当前表中插入一条记录，不指定插入位置
+ * @description: 分槽格式中读取记录，记录已迁移时释放原页面，再获取记录所在的页面
+ * @param {Rid&} rid 记录号
+ * @param {ReadPageGuard*} guard 调用时持有rid所在页面，返回时持有记录所在的页面
+ * @return {RecordView} 指向页面中记录的视图
+ * @note 同一时刻只持有一个页面的锁。释放原页面后记录可能再次被迁移，新位置上的槽不再指回rid，此时重新从原位置读取
+ */
+RecordView RmFileHandle::get_slotted_view(const Rid& rid, ReadPageGuard* guard) const {
+    Rid last_target{RM_NO_PAGE, RM_NO_PAGE};
+    while (true) {
+        RmSlottedPage page(guard->get_page(), get_page_size());
+        if (!is_home_slot(page, rid.slot_no)) {
+            guard->drop();
+            throw RecordNotFoundError(rid.page_no, rid.slot_no);
+        }
+        const RmSlot& slot = page.get_slot(rid.slot_no);
+        if (slot.state == RM_SLOT_NORMAL) {
+            return RecordView(page.get_data(rid.slot_no), slot.len);
+        }
+        Rid target = read_rid(page.get_data(rid.slot_no));
+        guard->drop();
+        if (target == last_target) {
+            throw InternalError("Forwarded record does not point back to its slot");
+        }
+        last_target = target;
+        *guard = fetch_page_read(target.page_no);
+        RmSlottedPage target_page(guard->get_page(), get_page_size());
+        if (is_moved_from(target_page, target.slot_no, rid)) {
+            return RecordView(target_page.get_data(target.slot_no) + sizeof(Rid),
+                              target_page.get_slot(target.slot_no).len - static_cast<int>(sizeof(Rid)));
+        }
+        guard->drop();
+        *guard = fetch_page_read(rid.page_no);
+    }
+}
+
+/**
+ * @description: 在当前表中插入一条长度为record_size的记录，不指定插入位置
  * @param {char*} buf 要插入的记录的数据
  * @param {Context*} context
  * @return {Rid} 插入的记录的记录号（位置）
  */
 Rid RmFileHandle::insert_record(char* buf, Context* context) {
-    // 1. 获取当前未满的page handle
-    auto page_handle = create_page_handle();
-    auto page_no = page_handle.page->get_page_id().page_no;
+    return insert_record(buf, file_hdr_.record_size, context);
+}
+
+/**
+ * @description: 在当前表中插入一条记录，不指定插入位置
+ * @param {char*} buf 要插入的记录的数据
+ * @param {int} size 记录的长度，定长格式中必须等于record_size，分槽格式中不超过record_size
+ * @param {Context*} context
+ * @return {Rid} 插入的记录的记录号（位置）
+ */
+Rid RmFileHandle::insert_record(const char* buf, int size, Context* context) {
+    check_record_size(size);
+    if (is_slotted()) {
+        return insert_slotted(buf, size, nullptr);
+    }
+    // 1. 获取当前未满的页面
+    auto guard = create_page_handle(size);
+    RmPageHandle page_handle(&file_hdr_, guard.get_page());
+    auto page_no = guard.get_page_id().page_no;
     // 2. 在page handle中找到空闲slot位置
     int slot_no = Bitmap::first_bit(false, page_handle.bitmap, file_hdr_.num_records_per_page);
     if (slot_no >= file_hdr_.num_records_per_page) {
-        buffer_pool_manager_->unpin_page({fd_, page_no}, false);
         throw InternalError("No free slot found when inserting record");
     }
     // 3. 将buf复制到空闲slot位置
@@ -41,51 +107,201 @@ Rid RmFileHandle::insert_record(char* buf, Context* context) {
     Bitmap::set(page_handle.bitmap, slot_no);
     // 4. 更新page_handle.page_hdr中的数据结构
     page_handle.page_hdr->num_records++;
-    // 页面已满则更新空闲链表头
+    // 页面已满则在FSM中记录，之后的插入不再尝试该页面
     if (page_handle.page_hdr->num_records == file_hdr_.num_records_per_page) {
-        file_hdr_.first_free_page_no = page_handle.page_hdr->next_free_page_no;
-        page_handle.page_hdr->next_free_page_no = RM_NO_PAGE;
+        fsm_->update(page_no, 0);
+        insert_page_no_ = RM_NO_PAGE;
+    }
+    guard.set_dirty();
+    return Rid{page_no, slot_no};
+}
+
+/**
+ * @description: 在当前表中批量插入记录，不指定插入位置。每个页面只获取一次，填满页面的空闲slot后再换下一个页面；
+ * 连续的空闲slot用一次拷贝写入记录，并一次设置bitmap中对应的位
+ * @param {char*} buf 要插入的记录的数据，num_records条记录依次存放，每条记录的长度为record_size
+ * @param {int} num_records 记录的条数
+ * @param {Context*} context
+ * @return {vector<Rid>} 按顺序返回每条记录的记录号
+ */
+std::vector<Rid> RmFileHandle::insert_records(const char* buf, int num_records, Context* context) {
+    if (is_slotted()) {
+        std::vector<RecordView> records;
+        records.reserve(num_records);
+        for (int i = 0; i < num_records; i++) {
+            records.emplace_back(buf + static_cast<size_t>(i) * file_hdr_.record_size, file_hdr_.record_size);
+        }
+        return insert_records(records, context);
+    }
+    std::vector<Rid> rids;
+    rids.reserve(num_records);
+    const int record_size = file_hdr_.record_size;
+    const int records_per_page = file_hdr_.num_records_per_page;
+    int inserted = 0;
+    while (inserted < num_records) {
+        // 1. 获取当前未满的页面
+        auto guard = create_page_handle(record_size);
+        RmPageHandle page_handle(&file_hdr_, guard.get_page());
+        auto page_no = guard.get_page_id().page_no;
+        // 2. 依次找出页面中连续的空闲slot，写入尽可能多的记录
+        int slot_no = Bitmap::first_bit(false, page_handle.bitmap, records_per_page);
+        while (inserted < num_records && slot_no < records_per_page) {
+            int run_end = Bitmap::next_bit(true, page_handle.bitmap, records_per_page, slot_no);
+            int n = std::min(run_end - slot_no, num_records - inserted);
+            memcpy(page_handle.get_slot(slot_no), buf + static_cast<size_t>(inserted) * record_size,
+                   static_cast<size_t>(n) * record_size);
+            Bitmap::set_range(page_handle.bitmap, slot_no, n);
+            for (int i = 0; i < n; i++) {
+                rids.push_back(Rid{page_no, slot_no + i});
+            }
+            page_handle.page_hdr->num_records += n;
+            inserted += n;
+            slot_no = Bitmap::next_bit(false, page_handle.bitmap, records_per_page, slot_no + n - 1);
+        }
+        // 3. 页面已满则在FSM中记录
+        if (page_handle.page_hdr->num_records == records_per_page) {
+            fsm_->update(page_no, 0);
+            insert_page_no_ = RM_NO_PAGE;
+        }
+        guard.set_dirty();
+    }
+    return rids;
+}
+
+/**
+ * @description: 在当前表中批量插入长度不同的记录，不指定插入位置。每个页面只获取一次，页面放不下下一条记录时再换页面
+ * @param {vector<RecordView>&} records 要插入的记录，定长格式中每条记录的长度都必须等于record_size
+ * @param {Context*} context
+ * @return {vector<Rid>} 按顺序返回每条记录的记录号
+ */
+std::vector<Rid> RmFileHandle::insert_records(const std::vector<RecordView>& records, Context* context) {
+    for (auto& record : records) {
+        check_record_size(record.size);
     }
-    buffer_pool_manager_->unpin_page({fd_, page_no}, true);
+    if (!is_slotted()) {
+        std::vector<char> buf(records.size() * file_hdr_.record_size);
+        for (size_t i = 0; i < records.size(); i++) {
+            memcpy(buf.data() + i * file_hdr_.record_size, records[i].data, file_hdr_.record_size);
+        }
+        return insert_records(buf.data(), static_cast<int>(records.size()), context);
+    }
+    std::vector<Rid> rids;
+    rids.reserve(records.size());
+    size_t i = 0;
+    while (i < records.size()) {
+        auto guard = create_page_handle(records[i].size);
+        RmSlottedPage page(guard.get_page(), get_page_size());
+        auto page_no = guard.get_page_id().page_no;
+        do {
+            int slot_no = page.insert(records[i].size, RM_SLOT_NORMAL);
+            memcpy(page.get_data(slot_no), records[i].data, records[i].size);
+            rids.push_back(Rid{page_no, slot_no});
+            i++;
+        } while (i < records.size() && page.can_insert(records[i].size));
+        // 页面放不下下一条记录，在FSM中记录剩余空间
+        if (i < records.size() || !page.can_insert(records[i - 1].size)) {
+            fsm_->update(page_no, page.free_space());
+            insert_page_no_ = RM_NO_PAGE;
+        }
+        guard.set_dirty();
+    }
+    return rids;
+}
+
+/**
+ * @description: 分槽格式中插入一条记录，home不为空时插入的是从home迁移来的记录，在记录之前存放home
+ * @param {char*} buf 记录的数据
+ * @param {int} size 记录的长度
+ * @param {Rid*} home 迁移记录的原位置，普通插入时为nullptr
+ * @return {Rid} 记录存放的位置
+ */
+Rid RmFileHandle::insert_slotted(const char* buf, int size, const Rid* home) {
+    int len = home == nullptr ? size : size + static_cast<int>(sizeof(Rid));
+    auto guard = create_page_handle(len);
+    RmSlottedPage page(guard.get_page(), get_page_size());
+    auto page_no = guard.get_page_id().page_no;
+    int slot_no = page.insert(len, home == nullptr ? RM_SLOT_NORMAL : RM_SLOT_MOVED);
+    char* data = page.get_data(slot_no);
+    if (home != nullptr) {
+        memcpy(data, home, sizeof(Rid));
+        data += sizeof(Rid);
+    }
+    memcpy(data, buf, size);
+    // 页面放不下下一条同样长度的记录时在FSM中记录剩余空间，之后的插入不再尝试该页面
+    if (!page.can_insert(len)) {
+        fsm_->update(page_no, page.free_space());
+        insert_page_no_ = RM_NO_PAGE;
+    }
+    guard.set_dirty();
     return Rid{page_no, slot_no};
 }
 
 /**
- * @description: 在当前表中的指定位置插入一条记录
+ * @description: 在当前表中的指定位置插入一条长度为record_size的记录
  * @param {Rid&} rid 要插入记录的位置
  * @param {char*} buf 要插入记录的数据
  */
 void RmFileHandle::insert_record(const Rid& rid, char* buf) {
-    auto page_handle = fetch_page_handle(rid.page_no);
+    insert_record(rid, buf, file_hdr_.record_size);
+}
+
+/**
+ * @description: 在当前表中的指定位置插入一条记录，用于回滚删除操作
+ * @param {Rid&} rid 要插入记录的位置
+ * @param {char*} buf 要插入记录的数据
+ * @param {int} size 要插入记录的长度
+ * @note 分槽格式中原页面的空间可能已经被其他记录使用，放不下记录时记录存放在其他页面，原位置指向新位置；
+ * 原页面在删除后作为文件末尾的空页面被释放时，重新分配页面直到该页面
+ */
+void RmFileHandle::insert_record(const Rid& rid, const char* buf, int size) {
+    check_record_size(size);
+    // 持有排他锁直到记录写入，新建的页面在此之前不会作为末尾的空页面被释放
+    std::unique_lock lock{pages_latch_};
+    while (file_hdr_.num_pages <= rid.page_no) {
+        create_new_page_handle();
+    }
+    if (is_slotted()) {
+        {
+            auto guard = fetch_page_write(rid.page_no);
+            RmSlottedPage page(guard.get_page(), get_page_size());
+            if (rid.slot_no < page.num_slots() && page.get_slot(rid.slot_no).state != RM_SLOT_FREE) {
+                throw RecordNotFoundError(rid.page_no, rid.slot_no);
+            }
+            if (page.insert_at(rid.slot_no, size, RM_SLOT_NORMAL)) {
+                memcpy(page.get_data(rid.slot_no), buf, size);
+                fsm_->update(rid.page_no, page.free_space());
+                guard.set_dirty();
+                return;
+            }
+        }
+        // 先写入新位置，再在原位置记录新位置，同一时刻只持有一个页面的锁。原页面放不下记录，不会被释放
+        lock.unlock();
+        Rid target = insert_slotted(buf, size, &rid);
+        auto guard = fetch_page_write(rid.page_no);
+        RmSlottedPage page(guard.get_page(), get_page_size());
+        if (!page.insert_at(rid.slot_no, sizeof(Rid), RM_SLOT_FORWARD)) {
+            guard.drop();
+            erase_moved(target, rid);
+            throw InternalError("No space left on page to restore record");
+        }
+        memcpy(page.get_data(rid.slot_no), &target, sizeof(Rid));
+        fsm_->update(rid.page_no, page.free_space());
+        guard.set_dirty();
+        return;
+    }
+    auto guard = fetch_page_write(rid.page_no);
+    RmPageHandle page_handle(&file_hdr_, guard.get_page());
     if (Bitmap::is_set(page_handle.bitmap, rid.slot_no)) {
-        buffer_pool_manager_->unpin_page({fd_, rid.page_no}, false);
         throw RecordNotFoundError(rid.page_no, rid.slot_no);
     }
-    memcpy(page_handle.get_slot(rid.slot_no), buf, file_hdr_.record_size);
+    memcpy(page_handle.get_slot(rid.slot_no), buf, size);
     Bitmap::set(page_handle.bitmap, rid.slot_no);
     page_handle.page_hdr->num_records++;
-    // 如果页面写满，需要将其从空闲链表中移除
+    guard.set_dirty();
+    // 如果页面写满，只需要更新FSM中该页面的记录
     if (page_handle.page_hdr->num_records == file_hdr_.num_records_per_page) {
-        int target = rid.page_no;
-        if (file_hdr_.first_free_page_no == target) {
-            file_hdr_.first_free_page_no = page_handle.page_hdr->next_free_page_no;
-        } else {
-            int prev = file_hdr_.first_free_page_no;
-            while (prev != RM_NO_PAGE) {
-                auto prev_handle = fetch_page_handle(prev);
-                if (prev_handle.page_hdr->next_free_page_no == target) {
-                    prev_handle.page_hdr->next_free_page_no = page_handle.page_hdr->next_free_page_no;
-                    buffer_pool_manager_->unpin_page({fd_, prev}, true);
-                    break;
-                }
-                int next = prev_handle.page_hdr->next_free_page_no;
-                buffer_pool_manager_->unpin_page({fd_, prev}, false);
-                prev = next;
-            }
-        }
-        page_handle.page_hdr->next_free_page_no = RM_NO_PAGE;
+        fsm_->update(rid.page_no, 0);
     }
-    buffer_pool_manager_->unpin_page({fd_, rid.page_no}, true);
 }
 
 /**
@@ -94,109 +310,340 @@ void RmFileHandle::insert_record(const Rid& rid, char* buf) {
  * @param {Context*} context
  */
 void RmFileHandle::delete_record(const Rid& rid, Context* context) {
-    // 1. 获取指定记录所在的page handle
-    auto page_handle = fetch_page_handle(rid.page_no);
+    // 1. 获取指定记录所在的页面
+    auto guard = fetch_page_write(rid.page_no);
+    if (is_slotted()) {
+        RmSlottedPage page(guard.get_page(), get_page_size());
+        if (!is_home_slot(page, rid.slot_no)) {
+            throw RecordNotFoundError(rid.page_no, rid.slot_no);
+        }
+        Rid target{RM_NO_PAGE, RM_NO_PAGE};
+        if (page.get_slot(rid.slot_no).state == RM_SLOT_FORWARD) {
+            target = read_rid(page.get_data(rid.slot_no));
+        }
+        page.erase(rid.slot_no);
+        fsm_->update(rid.page_no, page.free_space());
+        guard.set_dirty();
+        bool tail_emptied = page.num_records() == 0 && rid.page_no == file_hdr_.num_pages - 1;
+        guard.drop();
+        // 2. 已迁移的记录还要删除新位置上的数据
+        if (target.page_no != RM_NO_PAGE) {
+            erase_moved(target, rid);
+        }
+        if (tail_emptied) {
+            release_empty_tail();
+        }
+        return;
+    }
+    RmPageHandle page_handle(&file_hdr_, guard.get_page());
     if (!Bitmap::is_set(page_handle.bitmap, rid.slot_no)) {
-        buffer_pool_manager_->unpin_page({fd_, rid.page_no}, false);
         throw RecordNotFoundError(rid.page_no, rid.slot_no);
     }
-    bool was_full = page_handle.page_hdr->num_records == file_hdr_.num_records_per_page;
     Bitmap::reset(page_handle.bitmap, rid.slot_no);
     page_handle.page_hdr->num_records--;
-    // 2. 如果原本已满，删除后需要将该页加入空闲链表
-    if (was_full) {
-        release_page_handle(page_handle);
+    // 2. 在FSM中记录页面新的空闲空间，等级没有变化时FSM页面不会被修改
+    fsm_->update(rid.page_no, free_space(guard.get_page()));
+    guard.set_dirty();
+    // 3. 文件末尾的页面被删空时释放它
+    if (page_handle.page_hdr->num_records == 0 && rid.page_no == file_hdr_.num_pages - 1) {
+        guard.drop();
+        release_empty_tail();
     }
-    buffer_pool_manager_->unpin_page({fd_, rid.page_no}, true);
 }
 
 
 /**
- * @description: 更新记录文件中记录号为rid的记录
+ * @description: 删除从home迁移到target的记录数据，target上已经不是该记录时不做修改
+ * @param {Rid&} target 记录迁移后的位置
+ * @param {Rid&} home 记录的原位置
+ */
+void RmFileHandle::erase_moved(const Rid& target, const Rid& home) {
+    auto guard = fetch_page_write(target.page_no);
+    RmSlottedPage page(guard.get_page(), get_page_size());
+    if (is_moved_from(page, target.slot_no, home)) {
+        page.erase(target.slot_no);
+        fsm_->update(target.page_no, page.free_space());
+        guard.set_dirty();
+        if (page.num_records() == 0 && target.page_no == file_hdr_.num_pages - 1) {
+            guard.drop();
+            release_empty_tail();
+        }
+    }
+}
+
+/**
+ * @description: 更新记录文件中记录号为rid的记录，新记录的长度为record_size
  * @param {Rid&} rid 要更新的记录的记录号（位置）
  * @param {char*} buf 新记录的数据
  * @param {Context*} context
  */
 void RmFileHandle::update_record(const Rid& rid, char* buf, Context* context) {
-    // 1. 获取指定记录所在的page handle
-    auto page_handle = fetch_page_handle(rid.page_no);
+    update_record(rid, buf, file_hdr_.record_size, context);
+}
+
+/**
+ * @description: 更新记录文件中记录号为rid的记录
+ * @param {Rid&} rid 要更新的记录的记录号（位置）
+ * @param {char*} buf 新记录的数据
+ * @param {int} size 新记录的长度
+ * @param {Context*} context
+ * @note 分槽格式中记录变长后原页面放不下时，记录迁移到其他页面，原位置改为指向新位置，rid保持不变；
+ * 已迁移的记录在原页面重新放得下时迁移回原位置。同一时刻只持有一个页面的锁，对同一记录的并发修改由上层的锁保证互斥
+ */
+void RmFileHandle::update_record(const Rid& rid, const char* buf, int size, Context* context) {
+    check_record_size(size);
+    // 1. 获取指定记录所在的页面
+    auto guard = fetch_page_write(rid.page_no);
+    if (is_slotted()) {
+        Rid old_target{RM_NO_PAGE, RM_NO_PAGE};
+        {
+            RmSlottedPage page(guard.get_page(), get_page_size());
+            if (!is_home_slot(page, rid.slot_no)) {
+                throw RecordNotFoundError(rid.page_no, rid.slot_no);
+            }
+            if (page.get_slot(rid.slot_no).state == RM_SLOT_FORWARD) {
+                old_target = read_rid(page.get_data(rid.slot_no));
+            }
+            // 2. 原页面放得下新记录时直接写入原位置
+            if (page.resize(rid.slot_no, size)) {
+                page.set_state(rid.slot_no, RM_SLOT_NORMAL);
+                memcpy(page.get_data(rid.slot_no), buf, size);
+                fsm_->update(rid.page_no, page.free_space());
+                guard.set_dirty();
+                guard.drop();
+                if (old_target.page_no != RM_NO_PAGE) {
+                    erase_moved(old_target, rid);
+                }
+                return;
+            }
+        }
+        guard.drop();
+        // 3. 已经迁移的记录，在新位置放得下时在新位置更新
+        if (old_target.page_no != RM_NO_PAGE) {
+            auto target_guard = fetch_page_write(old_target.page_no);
+            RmSlottedPage page(target_guard.get_page(), get_page_size());
+            if (is_moved_from(page, old_target.slot_no, rid) &&
+                page.resize(old_target.slot_no, size + static_cast<int>(sizeof(Rid)))) {
+                memcpy(page.get_data(old_target.slot_no), &rid, sizeof(Rid));
+                memcpy(page.get_data(old_target.slot_no) + sizeof(Rid), buf, size);
+                fsm_->update(old_target.page_no, page.free_space());
+                target_guard.set_dirty();
+                return;
+            }
+        }
+        // 4. 迁移到有足够空间的页面，原位置只保留新位置的Rid
+        Rid target = insert_slotted(buf, size, &rid);
+        guard = fetch_page_write(rid.page_no);
+        RmSlottedPage page(guard.get_page(), get_page_size());
+        if (!is_home_slot(page, rid.slot_no)) {
+            guard.drop();
+            erase_moved(target, rid);
+            throw RecordNotFoundError(rid.page_no, rid.slot_no);
+        }
+        page.resize(rid.slot_no, sizeof(Rid));
+        page.set_state(rid.slot_no, RM_SLOT_FORWARD);
+        memcpy(page.get_data(rid.slot_no), &target, sizeof(Rid));
+        fsm_->update(rid.page_no, page.free_space());
+        guard.set_dirty();
+        guard.drop();
+        if (old_target.page_no != RM_NO_PAGE) {
+            erase_moved(old_target, rid);
+        }
+        return;
+    }
+    RmPageHandle page_handle(&file_hdr_, guard.get_page());
     if (!Bitmap::is_set(page_handle.bitmap, rid.slot_no)) {
-        buffer_pool_manager_->unpin_page({fd_, rid.page_no}, false);
         throw RecordNotFoundError(rid.page_no, rid.slot_no);
     }
     // 2. 更新记录
-    memcpy(page_handle.get_slot(rid.slot_no), buf, file_hdr_.record_size);
-    buffer_pool_manager_->unpin_page({fd_, rid.page_no}, true);
-
+    memcpy(page_handle.get_slot(rid.slot_no), buf, size);
+    guard.set_dirty();
 }
 
 /**
  * 以下函数为辅助函数，仅提供参考，可以选择完成如下函数，也可以删除如下函数，在单元测试中不涉及如下函数接口的直接调用
 */
 /**
- * @description: 获取指定页面的页面句柄
+ * @description: 获取指定页面并加共享锁
  * @param {int} page_no 页面号
- * @return {RmPageHandle} 指定页面的句柄
+ * @param {BufferAccessStrategy*} strategy 缓冲区访问策略，大表顺序扫描时传入环形缓冲区，避免冲掉缓冲池中的热点页面
+ * @return {ReadPageGuard} 指定页面的读守卫
  */
-RmPageHandle RmFileHandle::fetch_page_handle(int page_no) const {
-    // 使用缓冲池获取指定页面，并生成page_handle返回给上层
+ReadPageGuard RmFileHandle::fetch_page_read(int page_no, BufferAccessStrategy *strategy) const {
     // if page_no is invalid, throw PageNotExistError exception
     if (page_no < RM_FIRST_RECORD_PAGE || page_no >= file_hdr_.num_pages) {
         throw PageNotExistError(disk_manager_->get_file_name(fd_), page_no);
     }
-    PageId pid{fd_, page_no};
-    auto page = buffer_pool_manager_->fetch_page(pid);
-    if (page == nullptr) {
+    auto guard = buffer_pool_manager_->fetch_page_read({fd_, page_no}, strategy);
+    if (!guard.is_valid()) {
         throw PageNotExistError(disk_manager_->get_file_name(fd_), page_no);
     }
-    return RmPageHandle(&file_hdr_, page);
+    return guard;
 }
 
 /**
- * @description: 创建一个新的page handle
- * @return {RmPageHandle} 新的PageHandle
+ * @description: 获取指定页面并加排他锁
+ * @param {int} page_no 页面号
+ * @return {WritePageGuard} 指定页面的写守卫
  */
-RmPageHandle RmFileHandle::create_new_page_handle() {
+WritePageGuard RmFileHandle::fetch_page_write(int page_no) const {
+    if (page_no < RM_FIRST_RECORD_PAGE || page_no >= file_hdr_.num_pages) {
+        throw PageNotExistError(disk_manager_->get_file_name(fd_), page_no);
+    }
+    auto guard = buffer_pool_manager_->fetch_page_write({fd_, page_no});
+    if (!guard.is_valid()) {
+        throw PageNotExistError(disk_manager_->get_file_name(fd_), page_no);
+    }
+    return guard;
+}
+
+/**
+ * @description: 创建一个新页面，初始化页头和bitmap，并在FSM中记录其空闲空间。调用者需持有pages_latch_的排他锁
+ * @return {WritePageGuard} 新页面的写守卫
+ */
+WritePageGuard RmFileHandle::create_new_page_handle() {
     // 1.使用缓冲池来创建一个新page
     PageId new_pid{fd_, INVALID_PAGE_ID};
-    auto page = buffer_pool_manager_->new_page(&new_pid);
-    if (page == nullptr) {
+    auto guard = buffer_pool_manager_->new_page_guarded(&new_pid);
+    if (!guard.is_valid()) {
         throw InternalError("Failed to allocate new page for record file");
     }
     // 2.更新page handle中的相关信息
-    RmPageHandle page_handle(&file_hdr_, page);
-    Bitmap::init(page_handle.bitmap, file_hdr_.bitmap_size);
-    page_handle.page_hdr->num_records = 0;
-    page_handle.page_hdr->next_free_page_no = file_hdr_.first_free_page_no;
-    // 3.更新file_hdr_
-    file_hdr_.first_free_page_no = new_pid.page_no;
+    if (is_slotted()) {
+        RmSlottedPage(guard.get_page(), get_page_size()).init();
+    } else {
+        RmPageHandle page_handle(&file_hdr_, guard.get_page());
+        Bitmap::init(page_handle.bitmap, file_hdr_.bitmap_size);
+        page_handle.page_hdr->num_records = 0;
+        page_handle.page_hdr->next_free_page_no = RM_NO_PAGE;
+    }
+    // 3.更新file_hdr_和FSM，之后的插入先使用这个页面
     file_hdr_.num_pages++;
-    buffer_pool_manager_->unpin_page(new_pid, true);
-    // 返回新创建的page handle（重新fetch，保证page处于pinned状态供上层使用）
-    return fetch_page_handle(new_pid.page_no);
+    fsm_->update(new_pid.page_no, free_space(guard.get_page()));
+    insert_page_no_ = new_pid.page_no;
+    return guard;
 }
 
 /**
- * @brief 创建或获取一个空闲的page handle
+ * @brief 创建或获取一个能放下一条记录的页面
  *
- * @return RmPageHandle 返回生成的空闲page handle
- * @note pin the page, remember to unpin it outside!
+ * @param size 要插入的记录的长度
+ * @return WritePageGuard 空闲页面的写守卫
+ * @note 获取页面时持有pages_latch_，返回时页面已加写锁：release_empty_tail获取排他锁后再检查页面，
+ * 要么等到记录写入后看到页面非空，要么在插入获取页面之前就已将其释放，不会释放正在写入记录的页面
  */
-RmPageHandle RmFileHandle::create_page_handle() {
-    // 1. 判断file_hdr_中是否还有空闲页
-    if (file_hdr_.first_free_page_no == RM_NO_PAGE) {
-        // 1.1 没有空闲页：创建新页
-        return create_new_page_handle();
+WritePageGuard RmFileHandle::create_page_handle(int size) {
+    {
+        std::shared_lock lock{pages_latch_};
+        // 1. 先尝试最近插入记录的页面
+        int page_no = insert_page_no_;
+        if (page_no != RM_NO_PAGE) {
+            auto guard = fetch_page_write(page_no);
+            if (has_space(guard.get_page(), size)) {
+                return guard;
+            }
+            fsm_->update(page_no, free_space(guard.get_page()));
+        }
+        // 2. 在FSM中查找有足够空闲空间的页面，FSM的记录可能已经过时，需要在页面上确认。
+        //    空间差不到一个等级的页面更新FSM后等级不变，会被再次找到，此时不再查找
+        int need = is_slotted() ? RmSlottedPage::space_needed(size) : file_hdr_.record_size;
+        int missed = RM_NO_PAGE;
+        while ((page_no = fsm_->search(need)) != RM_NO_PAGE && page_no != missed) {
+            if (page_no < RM_FIRST_RECORD_PAGE || page_no >= file_hdr_.num_pages) {
+                fsm_->update(page_no, 0);
+                continue;
+            }
+            auto guard = fetch_page_write(page_no);
+            if (has_space(guard.get_page(), size)) {
+                insert_page_no_ = page_no;
+                return guard;
+            }
+            fsm_->update(page_no, free_space(guard.get_page()));
+            missed = page_no;
+        }
+    }
+    // 3. 没有空闲页面：创建新页
+    std::unique_lock lock{pages_latch_};
+    return create_new_page_handle();
+}
+
+/**
+ * @description: 扫描所有页面重建FSM，用于FSM文件缺失时，例如打开FSM出现之前创建的表
+ */
+void RmFileHandle::rebuild_free_space_map() {
+    for (int page_no = RM_FIRST_RECORD_PAGE; page_no < file_hdr_.num_pages; page_no++) {
+        auto guard = fetch_page_read(page_no);
+        fsm_->update(page_no, free_space(guard.get_page()));
+    }
+}
+
+/**
+ * @description: 从文件末尾开始释放没有记录的页面，num_pages随之减少，之后新建页面时按顺序重新使用这些页号，
+ *              扫描也不再访问它们。释放的页面从缓冲池中删除，在FSM中记为没有空闲空间
+ * @note 全程持有pages_latch_的排他锁，插入无法获取或新建页面；页面在写锁下确认为空，
+ * 之前取得该页面的插入已经写完记录。页面仍被其他线程固定（例如正在扫描）时停止释放
+ */
+void RmFileHandle::release_empty_tail() {
+    std::unique_lock lock{pages_latch_};
+    while (file_hdr_.num_pages > RM_FIRST_RECORD_PAGE) {
+        int page_no = file_hdr_.num_pages - 1;
+        {
+            auto guard = fetch_page_write(page_no);
+            if (num_records(guard.get_page()) > 0) {
+                return;
+            }
+        }
+        // 写锁释放后，插入路径只能在持有pages_latch_时获取页面，删除页面前页面不会再被写入
+        if (!buffer_pool_manager_->delete_page({fd_, page_no})) {
+            return;
+        }
+        file_hdr_.num_pages--;
+        disk_manager_->set_fd2pageno(fd_, file_hdr_.num_pages);
+        fsm_->update(page_no, 0);
+        int hint = page_no;
+        insert_page_no_.compare_exchange_strong(hint, RM_NO_PAGE);
     }
-    // 1.2 有空闲页：直接获取第一个空闲页
-    return fetch_page_handle(file_hdr_.first_free_page_no);
 }
 
 /**
- * @description: 当一个页面从没有空闲空间的状态变为有空闲空间状态时，更新文件头和页头中空闲页面相关的元数据
+ * @description: 检查记录的长度，定长格式中必须等于record_size，分槽格式中不超过record_size
+ * @param {int} size 记录的长度
  */
-void RmFileHandle::release_page_handle(RmPageHandle&page_handle) {
-    // 当page从已满变成未满，将其接入空闲链表头
-    page_handle.page_hdr->next_free_page_no = file_hdr_.first_free_page_no;
-    file_hdr_.first_free_page_no = page_handle.page->get_page_id().page_no;
+void RmFileHandle::check_record_size(int size) const {
+    bool valid = is_slotted() ? (size >= 1 && size <= file_hdr_.record_size) : size == file_hdr_.record_size;
+    if (!valid) {
+        throw InvalidRecordSizeError(size);
+    }
+}
+
+/**
+ * @description: 页面能否放下一条长度为size的记录
+ */
+bool RmFileHandle::has_space(Page* page, int size) const {
+    if (is_slotted()) {
+        return RmSlottedPage(page, get_page_size()).can_insert(size);
+    }
+    RmPageHandle page_handle(&file_hdr_, page);
+    return page_handle.page_hdr->num_records < file_hdr_.num_records_per_page;
+}
+
+/**
+ * @description: 页面中的记录个数，分槽格式中为非空闲槽的个数
+ */
+int RmFileHandle::num_records(Page* page) const {
+    if (is_slotted()) {
+        return RmSlottedPage(page, get_page_size()).num_records();
+    }
+    return RmPageHandle(&file_hdr_, page).page_hdr->num_records;
+}
+
+/**
+ * @description: 页面的空闲空间，定长格式中为空闲slot占用的字节数，分槽格式中包括碎片，记录在FSM中
+ */
+int RmFileHandle::free_space(Page* page) const {
+    if (is_slotted()) {
+        return RmSlottedPage(page, get_page_size()).free_space();
+    }
+    RmPageHandle page_handle(&file_hdr_, page);
+    return (file_hdr_.num_records_per_page - page_handle.page_hdr->num_records) * file_hdr_.record_size;
 }
@@ -3,14 +3,18 @@
 #include <assert.h>
 
 #include <memory>
+#include <shared_mutex>
+#include <vector>
 
 #include "bitmap.h"
 #include "common/context.h"
 #include "rm_defs.h"
+#include "rm_free_space_map.h"
+#include "rm_slotted_page.h"
 
 class RmManager;
 
-/* 对表数据文件中的页面进行封装 */
+/* 对表数据文件中定长格式（RM_FORMAT_FIXED）的页面进行封装，分槽格式的页面见RmSlottedPage */
 struct RmPageHandle {
     const RmFileHdr *file_hdr;  // 当前页面所在文件的文件头指针
     Page *page;                 // 页面的实际数据，包括页面存储的数据、元信息等
@@ -19,8 +23,8 @@ struct RmPageHandle {
     char *slots;                // page->data的第三部分，存储表的记录，指针指向首地址，每个slot的长度为file_hdr->record_size
 
     RmPageHandle(const RmFileHdr *fhdr_, Page *page_) : file_hdr(fhdr_), page(page_) {
-        page_hdr = reinterpret_cast<RmPageHdr *>(page->get_data() + page->OFFSET_PAGE_HDR);
-        bitmap = page->get_data() + sizeof(RmPageHdr) + page->OFFSET_PAGE_HDR;
+        page_hdr = reinterpret_cast<RmPageHdr *>(page->get_data() + file_hdr->page_hdr_offset());
+        bitmap = page->get_data() + sizeof(RmPageHdr) + file_hdr->page_hdr_offset();
         slots = bitmap + file_hdr->bitmap_size;
     }
 
@@ -30,7 +34,7 @@ struct RmPageHandle {
     }
 };
 
-/* 每个RmFileHandle对应一个表的数据文件，里面有多个page，每个page的数据封装在RmPageHandle中 */
+/* 每个RmFileHandle对应一个表的数据文件，里面有多个page，每个page的数据按文件的格式封装在RmPageHandle或RmSlottedPage中 */
 class RmFileHandle {      
     friend class RmScan;    
     friend class RmManager;
@@ -40,9 +44,12 @@ class RmFileHandle {
     BufferPoolManager *buffer_pool_manager_;
     int fd_;        // 打开文件后产生的文件句柄
     RmFileHdr file_hdr_;    // 文件头，维护当前表文件的元数据
+    std::unique_ptr<RmFreeSpaceMap> fsm_;   // 表的空闲空间映射，记录每个页面的空闲空间
+    std::atomic<int> insert_page_no_{RM_NO_PAGE};   // 最近插入记录的页面，连续插入时先尝试该页面，不访问FSM
+    std::shared_mutex pages_latch_;     // 保护页面个数：插入时获取已有页面持有共享锁，新建页面和释放末尾的空页面持有排他锁
 
    public:
-    RmFileHandle(DiskManager *disk_manager, BufferPoolManager *buffer_pool_manager, int fd)
+    RmFileHandle(DiskManager *disk_manager, BufferPoolManager *buffer_pool_manager, int fd, int fsm_fd)
         : disk_manager_(disk_manager), buffer_pool_manager_(buffer_pool_manager), fd_(fd) {
         // 注意：这里从磁盘中读出文件描述符为fd的文件的file_hdr，读到内存中
         // 这里实际就是初始化file_hdr，只不过是从磁盘中读出进行初始化
@@ -50,33 +57,98 @@ class RmFileHandle {
         disk_manager_->read_page(fd, RM_FILE_HDR_PAGE, (char *)&file_hdr_, sizeof(file_hdr_));
         // disk_manager管理的fd对应的文件中，设置从file_hdr_.num_pages开始分配page_no
         disk_manager_->set_fd2pageno(fd, file_hdr_.num_pages);
+        disk_manager_->set_page_size(fd, file_hdr_.page_size == 0 ? PAGE_SIZE : file_hdr_.page_size);
+        disk_manager_->set_legacy_layout(fd, file_hdr_.layout_version == Page::LAYOUT_LEGACY);
+        fsm_ = std::make_unique<RmFreeSpaceMap>(disk_manager_, buffer_pool_manager_, fsm_fd,
+                                                disk_manager_->get_page_size(fd), file_hdr_.num_pages);
     }
 
     RmFileHdr get_file_hdr() { return file_hdr_; }
     int GetFd() { return fd_; }
+    int get_fsm_fd() const { return fsm_->get_fd(); }
+    bool is_slotted() const { return file_hdr_.format == RM_FORMAT_SLOTTED; }
+    int get_page_size() const { return disk_manager_->get_page_size(fd_); }
 
-    /* 判断指定位置上是否已经存在一条记录，通过Bitmap来判断 */
+    /* 判断指定位置上是否已经存在一条记录，定长格式通过Bitmap来判断，分槽格式通过槽的状态来判断 */
     bool is_record(const Rid &rid) const {
-        RmPageHandle page_handle = fetch_page_handle(rid.page_no);
+        auto guard = fetch_page_read(rid.page_no);
+        if (is_slotted()) {
+            return is_home_slot(RmSlottedPage(guard.get_page(), get_page_size()), rid.slot_no);
+        }
+        RmPageHandle page_handle(&file_hdr_, guard.get_page());
         return Bitmap::is_set(page_handle.bitmap, rid.slot_no);  // page的slot_no位置上是否有record
     }
 
     std::unique_ptr<RmRecord> get_record(const Rid &rid, Context *context) const;
 
+    RecordView get_record_view(const Rid &rid, ReadPageGuard *guard, Context *context) const;
+
     Rid insert_record(char *buf, Context *context);
 
+    Rid insert_record(const char *buf, int size, Context *context);
+
+    std::vector<Rid> insert_records(const char *buf, int num_records, Context *context);
+
+    std::vector<Rid> insert_records(const std::vector<RecordView> &records, Context *context);
+
     void insert_record(const Rid &rid, char *buf);
 
+    void insert_record(const Rid &rid, const char *buf, int size);
+
     void delete_record(const Rid &rid, Context *context);
 
     void update_record(const Rid &rid, char *buf, Context *context);
 
-    RmPageHandle create_new_page_handle();
+    void update_record(const Rid &rid, const char *buf, int size, Context *context);
+
+    WritePageGuard create_new_page_handle();
 
-    RmPageHandle fetch_page_handle(int page_no) const;
+    ReadPageGuard fetch_page_read(int page_no, BufferAccessStrategy *strategy = nullptr) const;
+
+    WritePageGuard fetch_page_write(int page_no) const;
+
+    void rebuild_free_space_map();
+
+    // 分槽格式中记录的Rid对应的槽：记录存放在该槽中，或者该槽指向记录迁移后的位置
+    static bool is_home_slot(const RmSlottedPage &page, int slot_no) {
+        if (slot_no < 0 || slot_no >= page.num_slots()) {
+            return false;
+        }
+        auto state = page.get_slot(slot_no).state;
+        return state == RM_SLOT_NORMAL || state == RM_SLOT_FORWARD;
+    }
+
+    // 分槽格式中slot_no是否存放着从home迁移来的记录
+    static bool is_moved_from(const RmSlottedPage &page, int slot_no, const Rid &home) {
+        if (slot_no < 0 || slot_no >= page.num_slots() || page.get_slot(slot_no).state != RM_SLOT_MOVED) {
+            return false;
+        }
+        return read_rid(page.get_data(slot_no)) == home;
+    }
+
+    // 读取分槽格式的槽中存放的Rid，槽中的数据不保证对齐
+    static Rid read_rid(const char *data) {
+        Rid rid;
+        memcpy(&rid, data, sizeof(Rid));
+        return rid;
+    }
 
    private:
-    RmPageHandle create_page_handle();
+    WritePageGuard create_page_handle(int size);
+
+    void check_record_size(int size) const;
+
+    bool has_space(Page *page, int size) const;
+
+    int free_space(Page *page) const;
+
+    int num_records(Page *page) const;
+
+    void release_empty_tail();
+
+    RecordView get_slotted_view(const Rid &rid, ReadPageGuard *guard) const;
+
+    Rid insert_slotted(const char *buf, int size, const Rid *home);
 
-    void release_page_handle(RmPageHandle &page_handle);
+    void erase_moved(const Rid &target, const Rid &home);
 };
\ No newline at end of file
@@ -0,0 +1,123 @@
+#include "rm_free_space_map.h"
+
+#include <algorithm>
+
+/**
+ * @description: 打开表的FSM。打开时不读取FSM页面，各FSM页面的根节点先按最高等级缓存，第一次查找到该页面时再修正
+ * @param {int} fd FSM文件的文件句柄
+ * @param {int} page_size 数据文件的页面大小，FSM文件使用相同的页面大小
+ * @param {int} num_data_pages 数据文件的页面个数，决定FSM页面的个数；FSM文件中缺少的页面读出为全0，即没有空闲空间
+ */
+RmFreeSpaceMap::RmFreeSpaceMap(DiskManager *disk_manager, BufferPoolManager *buffer_pool_manager, int fd,
+                               int page_size, int num_data_pages)
+    : disk_manager_(disk_manager),
+      buffer_pool_manager_(buffer_pool_manager),
+      fd_(fd),
+      page_size_(page_size),
+      leaves_per_page_(leaves_per_page(page_size)) {
+    disk_manager_->set_page_size(fd_, page_size_);
+    int num_fsm_pages = (num_data_pages + leaves_per_page_ - 1) / leaves_per_page_;
+    // 文件的长度包含预分配的区段，FSM页面的个数由数据页面的个数决定
+    disk_manager_->set_fd2pageno(fd_, num_fsm_pages);
+    roots_.assign(num_fsm_pages, UINT8_MAX);
+}
+
+uint8_t RmFreeSpaceMap::space_category(int free_bytes) const {
+    if (free_bytes <= 0) {
+        return 0;
+    }
+    return static_cast<uint8_t>(std::clamp(free_bytes * 256 / page_size_, 1, 255));
+}
+
+uint8_t RmFreeSpaceMap::request_category(int need_bytes) const {
+    return static_cast<uint8_t>(std::clamp(need_bytes * 256 / page_size_, 1, 255));
+}
+
+/**
+ * @description: 查找一个空闲空间可能不少于need_bytes的数据页面
+ * @return {page_id_t} 数据页面的页面号，FSM中没有这样的页面时返回RM_NO_PAGE
+ * @param {int} need_bytes 需要的空闲空间
+ * @note 需要的空间和记录的空闲空间都向下取整到等级，空闲空间是need_bytes整数倍的页面（如定长格式）一定能找到；
+ * 返回的页面可能比need_bytes少不到一个等级的空间，调用者需要在页面上确认
+ */
+page_id_t RmFreeSpaceMap::search(int need_bytes) {
+    uint8_t category = request_category(need_bytes);
+    const int num_nodes = 2 * leaves_per_page_ - 1;
+    while (true) {
+        int fsm_page_no;
+        {
+            std::lock_guard<std::mutex> lock(latch_);
+            auto it = std::find_if(roots_.begin(), roots_.end(), [&](uint8_t root) { return root >= category; });
+            if (it == roots_.end()) {
+                return RM_NO_PAGE;
+            }
+            fsm_page_no = static_cast<int>(it - roots_.begin());
+        }
+        auto guard = buffer_pool_manager_->fetch_page_read({fd_, fsm_page_no});
+        if (!guard.is_valid()) {
+            throw PageNotExistError(disk_manager_->get_file_name(fd_), fsm_page_no);
+        }
+        auto tree = reinterpret_cast<const uint8_t *>(guard.get_data() + Page::OFFSET_PAGE_HDR);
+        if (tree[0] < category) {
+            // 缓存的根节点是打开文件时的初始值，或者FSM页面在这之后被并发修改了
+            std::lock_guard<std::mutex> lock(latch_);
+            roots_[fsm_page_no] = tree[0];
+            continue;
+        }
+        // 从根节点向下，每层选择最大值满足要求的子节点，先选左子节点使插入集中在文件前部
+        int node = 0;
+        while (2 * node + 1 < num_nodes) {
+            node = tree[2 * node + 1] >= category ? 2 * node + 1 : 2 * node + 2;
+        }
+        return fsm_page_no * leaves_per_page_ + (node - (leaves_per_page_ - 1));
+    }
+}
+
+/**
+ * @description: 记录数据页面当前的空闲空间，并更新从叶子到根路径上的最大值
+ * @param {page_id_t} page_no 数据页面的页面号
+ * @param {int} free_bytes 页面的空闲空间
+ */
+void RmFreeSpaceMap::update(page_id_t page_no, int free_bytes) {
+    uint8_t category = space_category(free_bytes);
+    int fsm_page_no = page_no / leaves_per_page_;
+    extend(fsm_page_no);
+    auto guard = buffer_pool_manager_->fetch_page_write({fd_, fsm_page_no});
+    if (!guard.is_valid()) {
+        throw PageNotExistError(disk_manager_->get_file_name(fd_), fsm_page_no);
+    }
+    auto tree = reinterpret_cast<uint8_t *>(guard.get_page()->get_data() + Page::OFFSET_PAGE_HDR);
+    int node = leaves_per_page_ - 1 + page_no % leaves_per_page_;
+    if (tree[node] == category) {
+        return;
+    }
+    tree[node] = category;
+    while (node > 0) {
+        int parent = (node - 1) / 2;
+        uint8_t max_child = std::max(tree[2 * parent + 1], tree[2 * parent + 2]);
+        if (tree[parent] == max_child) {
+            break;
+        }
+        tree[parent] = max_child;
+        node = parent;
+    }
+    guard.set_dirty();
+    std::lock_guard<std::mutex> lock(latch_);
+    roots_[fsm_page_no] = tree[0];
+}
+
+/**
+ * @description: 分配FSM页面，直到第fsm_page_no个FSM页面存在
+ */
+void RmFreeSpaceMap::extend(int fsm_page_no) {
+    std::lock_guard<std::mutex> lock(latch_);
+    while (static_cast<int>(roots_.size()) <= fsm_page_no) {
+        PageId page_id{fd_, INVALID_PAGE_ID};
+        auto guard = buffer_pool_manager_->new_page_guarded(&page_id);
+        if (!guard.is_valid()) {
+            throw InternalError("Failed to allocate new page for free space map");
+        }
+        assert(page_id.page_no == static_cast<int>(roots_.size()));
+        roots_.push_back(0);
+    }
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <mutex>
+#include <vector>
+
+#include "rm_defs.h"
+
+/**
+ * @description: 表数据文件的空闲空间映射（FSM），存放在单独的文件中，每个数据页面用一个字节记录空闲空间的等级
+ * （空闲字节数除以页面大小的1/256，向下取整，有空闲空间时至少为1）。FSM的每个页面是一棵存放在数组中的二叉树，叶子是数据页面的等级，
+ * 内部节点是两个子节点的最大值，查找和更新都只访问一条从根到叶子的路径；各FSM页面的根节点缓存在内存中，
+ * 查找时直接跳过没有足够空间的FSM页面。
+ * 查找时需要的空间同样向下取整，定长格式的页面剩余一个slot时也能被找到；找到的页面可能差不到一个等级的空间，
+ * FSM只是提示，记录的等级可以与页面实际的空闲空间不一致：使用前在数据页面上确认，不一致时更新FSM即可，
+ * 因此FSM的修改不需要写日志，回滚和恢复也不需要维护FSM
+ */
+class RmFreeSpaceMap {
+   public:
+    RmFreeSpaceMap(DiskManager *disk_manager, BufferPoolManager *buffer_pool_manager, int fd, int page_size,
+                   int num_data_pages);
+
+    int get_fd() const { return fd_; }
+
+    // 空闲空间为free_bytes的页面的等级
+    uint8_t space_category(int free_bytes) const;
+
+    // 查找需要need_bytes的页面时要求的最低等级
+    uint8_t request_category(int need_bytes) const;
+
+    page_id_t search(int need_bytes);
+
+    void update(page_id_t page_no, int free_bytes);
+
+   private:
+    // 一个FSM页面能记录的数据页面个数
+    static int leaves_per_page(int page_size) { return (page_size - Page::OFFSET_PAGE_HDR + 1) / 2; }
+
+    void extend(int fsm_page_no);
+
+    DiskManager *disk_manager_;
+    BufferPoolManager *buffer_pool_manager_;
+    int fd_;                        // FSM文件的文件句柄
+    int page_size_;                 // FSM文件和数据文件的页面大小
+    int leaves_per_page_;           // 每个FSM页面中叶子的个数，树的节点个数为2 * leaves_per_page_ - 1
+    std::mutex latch_;              // 保护roots_
+    std::vector<uint8_t> roots_;    // 每个FSM页面根节点的值，即该FSM页面记录的最高等级
+};
@@ -16,27 +16,48 @@ class RmManager {
     RmManager(DiskManager *disk_manager, BufferPoolManager *buffer_pool_manager)
         : disk_manager_(disk_manager), buffer_pool_manager_(buffer_pool_manager) {}
 
+    // 表的空闲空间映射文件的名称
+    static std::string get_fsm_name(const std::string& filename) { return filename + ".fsm"; }
+
     /**
      * @description: 创建表的数据文件并初始化相关信息
      * @param {string&} filename 要创建的文件名称
-     * @param {int} record_size 表中记录的大小
+     * @param {int} record_size 表中记录的大小，分槽格式中为记录的最大长度
+     * @param {int} page_size 文件的页面大小
+     * @param {RmFormat} format 页面格式，有变长字段的表使用分槽格式
      */ 
-    void create_file(const std::string& filename, int record_size) {
-        if (record_size < 1 || record_size > RM_MAX_RECORD_SIZE) {
+    void create_file(const std::string& filename, int record_size, int page_size = PAGE_SIZE,
+                     RmFormat format = RM_FORMAT_FIXED) {
+        int max_record_size =
+            format == RM_FORMAT_SLOTTED ? RmSlottedPage::max_record_len(page_size) : RM_MAX_RECORD_SIZE;
+        if (record_size < 1 || record_size > max_record_size) {
             throw InvalidRecordSizeError(record_size);
         }
         disk_manager_->create_file(filename);
         int fd = disk_manager_->open_file(filename);
+        try {
+            disk_manager_->set_page_size(fd, page_size);
+        } catch (InvalidPageSizeError &) {
+            disk_manager_->close_file(fd);
+            disk_manager_->destroy_file(filename);
+            throw;
+        }
 
         // 初始化file header
         RmFileHdr file_hdr{};
         file_hdr.record_size = record_size;
         file_hdr.num_pages = 1;
         file_hdr.first_free_page_no = RM_NO_PAGE;
-        // We have: sizeof(hdr) + (n + 7) / 8 + n * record_size <= PAGE_SIZE
-        file_hdr.num_records_per_page =
-            (BITMAP_WIDTH * (PAGE_SIZE - 1 - (int)sizeof(RmFileHdr)) + 1) / (1 + record_size * BITMAP_WIDTH);
-        file_hdr.bitmap_size = (file_hdr.num_records_per_page + BITMAP_WIDTH - 1) / BITMAP_WIDTH;
+        file_hdr.page_size = page_size;
+        file_hdr.format = format;
+        file_hdr.layout_version = Page::LAYOUT_CHECKSUM;
+        // 分槽格式的页面没有bitmap，每个页面的记录个数由记录的长度决定
+        if (format == RM_FORMAT_FIXED) {
+            // We have: sizeof(hdr) + (n + 7) / 8 + n * record_size <= page_size
+            file_hdr.num_records_per_page =
+                (BITMAP_WIDTH * (page_size - 1 - (int)sizeof(RmFileHdr)) + 1) / (1 + record_size * BITMAP_WIDTH);
+            file_hdr.bitmap_size = (file_hdr.num_records_per_page + BITMAP_WIDTH - 1) / BITMAP_WIDTH;
+        }
 
         // 将file header写入磁盘文件（名为file name，文件描述符为fd）中的第0页
         // head page直接写入磁盘，没有经过缓冲区的NewPage，那么也就不需要FlushPage
@@ -45,20 +66,36 @@ class RmManager {
     }
 
     /**
-     * @description: 删除表的数据文件
+     * @description: 删除表的数据文件和空闲空间映射文件
      * @param {string&} filename 要删除的文件名称
      */    
-    void destroy_file(const std::string& filename) { disk_manager_->destroy_file(filename); }
+    void destroy_file(const std::string& filename) {
+        disk_manager_->destroy_file(filename);
+        if (disk_manager_->is_file(get_fsm_name(filename))) {
+            disk_manager_->destroy_file(get_fsm_name(filename));
+        }
+    }
 
     // 注意这里打开文件，创建并返回了record file handle的指针
     /**
      * @description: 打开表的数据文件，并返回文件句柄
      * @param {string&} filename 要打开的文件名称
      * @return {unique_ptr<RmFileHandle>} 文件句柄的指针
+     * @note 空闲空间映射文件不存在时（新建的表或之前版本创建的表）创建该文件，并扫描数据文件重建
      */
     std::unique_ptr<RmFileHandle> open_file(const std::string& filename) {
         int fd = disk_manager_->open_file(filename);
-        return std::make_unique<RmFileHandle>(disk_manager_, buffer_pool_manager_, fd);
+        std::string fsm_name = get_fsm_name(filename);
+        bool rebuild_fsm = !disk_manager_->is_file(fsm_name);
+        if (rebuild_fsm) {
+            disk_manager_->create_file(fsm_name);
+        }
+        int fsm_fd = disk_manager_->open_file(fsm_name);
+        auto file_handle = std::make_unique<RmFileHandle>(disk_manager_, buffer_pool_manager_, fd, fsm_fd);
+        if (rebuild_fsm) {
+            file_handle->rebuild_free_space_map();
+        }
+        return file_handle;
     }
     /**
      * @description: 关闭表的数据文件
@@ -70,5 +107,7 @@ class RmManager {
         // 缓冲区的所有页刷到磁盘，注意这句话必须写在close_file前面
         buffer_pool_manager_->flush_all_pages(file_handle->fd_);
         disk_manager_->close_file(file_handle->fd_);
+        buffer_pool_manager_->flush_all_pages(file_handle->get_fsm_fd());
+        disk_manager_->close_file(file_handle->get_fsm_fd());
     }
 };
@@ -4,8 +4,14 @@
 /**
  * @brief 初始化file_handle和rid
  * @param file_handle
+ * @note 表的页面数超过缓冲池的1/4时，扫描通过环形缓冲区访问页面，避免冲掉缓冲池中的热点页面。
+ * 扫描持有当前页面的共享锁，扫描期间同一线程不能修改当前页面，也不能再对当前页面加锁
  */
 RmScan::RmScan(const RmFileHandle *file_handle) : file_handle_(file_handle) {
+    auto bpm = file_handle_->buffer_pool_manager_;
+    if (static_cast<size_t>(file_handle_->file_hdr_.num_pages) > bpm->get_pool_size(file_handle_->disk_manager_->get_page_size(file_handle_->fd_)) / 4) {
+        strategy_ = bpm->make_ring_strategy();
+    }
     // 初始化rid，指向第一个存放了记录的位置
     rid_ = Rid{RM_FIRST_RECORD_PAGE, -1};
     next();
@@ -13,6 +19,8 @@ RmScan::RmScan(const RmFileHandle *file_handle) : file_handle_(file_handle) {
 
 /**
  * @brief 找到文件中下一个存放了记录的位置
+ * @note 下一条记录和当前记录在同一页面时直接使用已持有的页面，不重新fetch。
+ * 分槽格式中迁移的记录在它实际存放的位置被扫描到，原位置上只有新位置的槽被跳过，因此每条记录只出现一次
  */
 void RmScan::next() {
     if (file_handle_->file_hdr_.num_pages <= RM_FIRST_RECORD_PAGE) {
@@ -23,16 +31,32 @@ void RmScan::next() {
     int start_page = rid_.page_no;
     int start_slot = rid_.slot_no;
     for (int page_no = start_page; page_no < file_handle_->file_hdr_.num_pages; page_no++) {
-        auto page_handle = file_handle_->fetch_page_handle(page_no);
+        if (!guard_.is_valid() || guard_.get_page_id().page_no != page_no) {
+            guard_.drop();
+            guard_ = file_handle_->fetch_page_read(page_no, strategy_.get());
+        }
         int begin_slot = (page_no == start_page ? start_slot : -1);
+        if (file_handle_->is_slotted()) {
+            RmSlottedPage page(guard_.get_page(), file_handle_->get_page_size());
+            for (int slot_no = begin_slot + 1; slot_no < page.num_slots(); slot_no++) {
+                auto state = page.get_slot(slot_no).state;
+                if (state == RM_SLOT_NORMAL || state == RM_SLOT_MOVED) {
+                    rid_.page_no = page_no;
+                    rid_.slot_no = slot_no;
+                    return;
+                }
+            }
+            continue;
+        }
+        RmPageHandle page_handle(&file_handle_->file_hdr_, guard_.get_page());
         int slot_no = Bitmap::next_bit(true, page_handle.bitmap, file_handle_->file_hdr_.num_records_per_page, begin_slot);
-        file_handle_->buffer_pool_manager_->unpin_page({file_handle_->fd_, page_no}, false);
         if (slot_no < file_handle_->file_hdr_.num_records_per_page) {
             rid_.page_no = page_no;
             rid_.slot_no = slot_no;
             return;
         }
     }
+    guard_.drop();
     rid_.page_no = RM_NO_PAGE;
     rid_.slot_no = RM_NO_PAGE;
 }
@@ -45,8 +69,31 @@ bool RmScan::is_end() const {
 }
 
 /**
- * @brief RmScan内部存放的rid
+ * @brief 当前记录的记录号，迁移的记录返回它原来的位置
  */
 Rid RmScan::rid() const {
+    if (!is_end() && file_handle_->is_slotted()) {
+        RmSlottedPage page(guard_.get_page(), file_handle_->get_page_size());
+        if (page.get_slot(rid_.slot_no).state == RM_SLOT_MOVED) {
+            return RmFileHandle::read_rid(page.get_data(rid_.slot_no));
+        }
+    }
     return rid_;
 }
+
+/**
+ * @brief 当前记录的只读视图，直接指向扫描持有的页面，下一次next()后失效
+ */
+RecordView RmScan::record() const {
+    assert(!is_end());
+    if (file_handle_->is_slotted()) {
+        RmSlottedPage page(guard_.get_page(), file_handle_->get_page_size());
+        const RmSlot &slot = page.get_slot(rid_.slot_no);
+        if (slot.state == RM_SLOT_MOVED) {
+            return RecordView(page.get_data(rid_.slot_no) + sizeof(Rid), slot.len - static_cast<int>(sizeof(Rid)));
+        }
+        return RecordView(page.get_data(rid_.slot_no), slot.len);
+    }
+    RmPageHandle page_handle(&file_handle_->file_hdr_, guard_.get_page());
+    return RecordView(page_handle.get_slot(rid_.slot_no), file_handle_->file_hdr_.record_size);
+}
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <memory>
+
 #include "rm_defs.h"
 
 class RmFileHandle;
@@ -7,6 +9,8 @@ class RmFileHandle;
 class RmScan : public RecScan {
     const RmFileHandle *file_handle_;
     Rid rid_;
+    std::shared_ptr<BufferAccessStrategy> strategy_;   // 大表扫描使用的环形缓冲区，小表为nullptr
+    ReadPageGuard guard_;   // rid_所在页面的读守卫，扫描停留在同一页面期间一直持有，换页或扫描结束时释放
 public:
     RmScan(const RmFileHandle *file_handle);
 
@@ -15,4 +19,6 @@ public:
     bool is_end() const override;
 
     Rid rid() const override;
+
+    RecordView record() const;
 };
@@ -0,0 +1,168 @@
+#include "rm_slotted_page.h"
+
+#include <vector>
+
+/**
+ * @description: 初始化一个新页面：没有槽，整个页面除页头外都是空闲空间
+ */
+void RmSlottedPage::init() {
+    page_hdr_->next_free_page_no = RM_NO_PAGE;
+    page_hdr_->num_records = 0;
+    dir_hdr_->num_slots = 0;
+    dir_hdr_->free_upper = page_size_;
+    dir_hdr_->used_bytes = 0;
+}
+
+/**
+ * @description: 插入一条记录，优先使用编号最小的空闲槽，没有空闲槽时在槽目录末尾增加一个槽
+ * @return {int} 记录的槽号，调用者随后通过get_data()写入记录数据
+ * @param {int} len 记录的长度
+ * @param {RmSlotState} state 槽的状态
+ * @note 调用前需要通过can_insert()确认页面能放下该记录
+ */
+int RmSlottedPage::insert(int len, RmSlotState state) {
+    assert(can_insert(len));
+    int slot_no = 0;
+    if (num_records() < num_slots()) {
+        while (slots_[slot_no].state != RM_SLOT_FREE) {
+            slot_no++;
+        }
+    } else {
+        slot_no = num_slots();
+    }
+    bool ok = insert_at(slot_no, len, state);
+    assert(ok);
+    (void)ok;
+    return slot_no;
+}
+
+/**
+ * @description: 在指定的空闲槽中插入一条记录，用于回滚删除时把记录放回原来的位置
+ * @return {bool} 页面空间不够时返回false，页面不被修改
+ * @param {int} slot_no 槽号，可以超出当前槽目录的末尾，槽目录随之扩展
+ * @param {int} len 记录的长度
+ * @param {RmSlotState} state 槽的状态
+ */
+bool RmSlottedPage::insert_at(int slot_no, int len, RmSlotState state) {
+    int n = alloc_len(len);
+    if (slot_no >= num_slots()) {
+        if (!extend_dir(slot_no + 1, n)) {
+            return false;
+        }
+    } else if (slots_[slot_no].state != RM_SLOT_FREE || free_space() < n) {
+        return false;
+    }
+    RmSlot &slot = slots_[slot_no];
+    slot.offset = static_cast<uint16_t>(allocate(n));
+    slot.len = static_cast<uint16_t>(len);
+    slot.state = state;
+    dir_hdr_->used_bytes += n;
+    page_hdr_->num_records++;
+    return true;
+}
+
+/**
+ * @description: 把槽中记录的长度改为len，缩短时原地截断，变长时在页面中重新分配空间
+ * @return {bool} 页面空间不够时返回false，页面不被修改
+ * @param {int} slot_no 槽号
+ * @param {int} len 新的长度
+ * @note 重新分配后记录数据的内容未定义，由调用者重新写入；槽号和槽的状态不变
+ */
+bool RmSlottedPage::resize(int slot_no, int len) {
+    RmSlot &slot = slots_[slot_no];
+    int old_n = alloc_len(slot.len);
+    int new_n = alloc_len(len);
+    if (new_n > old_n) {
+        if (free_space() + old_n < new_n) {
+            return false;
+        }
+        // 先释放原来的空间，整理页面时跳过该槽
+        dir_hdr_->used_bytes -= old_n;
+        slot.offset = 0;
+        slot.offset = static_cast<uint16_t>(allocate(new_n));
+        dir_hdr_->used_bytes += new_n;
+    } else {
+        dir_hdr_->used_bytes -= old_n - new_n;
+    }
+    slot.len = static_cast<uint16_t>(len);
+    return true;
+}
+
+/**
+ * @description: 删除槽中的记录，槽变为空闲；槽目录末尾的空闲槽被移除
+ * @param {int} slot_no 槽号
+ */
+void RmSlottedPage::erase(int slot_no) {
+    RmSlot &slot = slots_[slot_no];
+    int n = alloc_len(slot.len);
+    dir_hdr_->used_bytes -= n;
+    // 紧挨着空闲空间的记录直接归还，其余的成为碎片
+    if (slot.offset == dir_hdr_->free_upper) {
+        dir_hdr_->free_upper += n;
+    }
+    slot = RmSlot{0, 0, RM_SLOT_FREE};
+    page_hdr_->num_records--;
+    while (dir_hdr_->num_slots > 0 && slots_[dir_hdr_->num_slots - 1].state == RM_SLOT_FREE) {
+        dir_hdr_->num_slots--;
+    }
+}
+
+/**
+ * @description: 整理页面，把所有记录数据依次移到页面末尾，碎片合并为槽目录之后连续的空闲空间
+ * @note 按偏移量从大到小移动，每条记录只会向页面末尾移动，不会覆盖还没有移动的记录
+ */
+void RmSlottedPage::compact() {
+    std::vector<int> order;
+    order.reserve(num_records());
+    for (int slot_no = 0; slot_no < num_slots(); slot_no++) {
+        if (slots_[slot_no].offset != 0) {
+            order.push_back(slot_no);
+        }
+    }
+    std::sort(order.begin(), order.end(), [this](int a, int b) { return slots_[a].offset > slots_[b].offset; });
+    int upper = page_size_;
+    for (int slot_no : order) {
+        RmSlot &slot = slots_[slot_no];
+        int n = alloc_len(slot.len);
+        upper -= n;
+        if (upper != slot.offset) {
+            memmove(data_ + upper, data_ + slot.offset, n);
+            slot.offset = static_cast<uint16_t>(upper);
+        }
+    }
+    dir_hdr_->free_upper = upper;
+}
+
+/**
+ * @description: 把槽目录扩展到num_slots个槽，新增的槽都是空闲槽
+ * @return {bool} 页面放不下新增的槽和之后要分配的reserve字节时返回false，页面不被修改
+ */
+bool RmSlottedPage::extend_dir(int num_slots, int reserve) {
+    int bytes = (num_slots - dir_hdr_->num_slots) * static_cast<int>(sizeof(RmSlot));
+    if (free_space() < bytes + reserve) {
+        return false;
+    }
+    // 槽目录只能占用连续的空闲空间，必须在扩展之前整理
+    if (dir_hdr_->free_upper - dir_end() < bytes + reserve) {
+        compact();
+    }
+    for (int slot_no = dir_hdr_->num_slots; slot_no < num_slots; slot_no++) {
+        slots_[slot_no] = RmSlot{0, 0, RM_SLOT_FREE};
+    }
+    dir_hdr_->num_slots = num_slots;
+    return true;
+}
+
+/**
+ * @description: 从连续的空闲空间中分配n字节，不够时先整理页面
+ * @return {int} 分配的空间在页面中的偏移量
+ * @note 调用前需要确认页面的空闲空间（包括碎片）不少于n
+ */
+int RmSlottedPage::allocate(int n) {
+    if (dir_hdr_->free_upper - dir_end() < n) {
+        compact();
+    }
+    assert(dir_hdr_->free_upper - dir_end() >= n);
+    dir_hdr_->free_upper -= n;
+    return dir_hdr_->free_upper;
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <algorithm>
+
+#include "rm_defs.h"
+
+/**
+ * @description: 分槽格式（RM_FORMAT_SLOTTED）的数据页面，页面布局为
+ * [页头][RmPageHdr][RmSlotDirHdr][RmSlot * num_slots] ... 空闲空间 ... [记录数据]
+ * 槽目录向后增长，记录数据从页面末尾向前存放。删除或缩短记录留下的碎片不立即回收，
+ * 连续的空闲空间不够时整理页面，把所有记录数据移到页面末尾；整理只移动数据，不改变槽号，因此Rid不变。
+ * page_hdr->num_records为非空闲槽的个数
+ */
+class RmSlottedPage {
+   public:
+    RmSlottedPage(Page *page, int page_size) : data_(page->get_data()), page_size_(page_size) {
+        page_hdr_ = reinterpret_cast<RmPageHdr *>(data_ + Page::OFFSET_PAGE_HDR);
+        dir_hdr_ = reinterpret_cast<RmSlotDirHdr *>(data_ + Page::OFFSET_PAGE_HDR + sizeof(RmPageHdr));
+        slots_ = reinterpret_cast<RmSlot *>(data_ + SLOTS_OFFSET);
+    }
+
+    // 长度为len的记录实际占用的空间
+    static int alloc_len(int len) { return std::max(len, RM_SLOT_MIN_LEN); }
+
+    // 在一个空闲页面中插入长度为len的记录需要的空间，包括新的槽
+    static int space_needed(int len) { return alloc_len(len) + static_cast<int>(sizeof(RmSlot)); }
+
+    // 页面大小为page_size时记录的最大长度，迁移的记录还要存放原位置的Rid
+    static int max_record_len(int page_size) {
+        return std::min(page_size - SLOTS_OFFSET - static_cast<int>(sizeof(RmSlot)), UINT16_MAX) -
+               static_cast<int>(sizeof(Rid));
+    }
+
+    void init();
+
+    int num_slots() const { return dir_hdr_->num_slots; }
+
+    int num_records() const { return page_hdr_->num_records; }
+
+    const RmSlot &get_slot(int slot_no) const { return slots_[slot_no]; }
+
+    char *get_data(int slot_no) const { return data_ + slots_[slot_no].offset; }
+
+    void set_state(int slot_no, RmSlotState state) { slots_[slot_no].state = state; }
+
+    // 页面中的空闲空间，包括碎片
+    int free_space() const { return page_size_ - dir_end() - dir_hdr_->used_bytes; }
+
+    bool can_insert(int len) const {
+        int slot_bytes = num_records() < num_slots() ? 0 : static_cast<int>(sizeof(RmSlot));
+        return alloc_len(len) + slot_bytes <= free_space();
+    }
+
+    int insert(int len, RmSlotState state);
+
+    bool insert_at(int slot_no, int len, RmSlotState state);
+
+    bool resize(int slot_no, int len);
+
+    void erase(int slot_no);
+
+    void compact();
+
+   private:
+    static constexpr int SLOTS_OFFSET =
+        static_cast<int>(Page::OFFSET_PAGE_HDR + sizeof(RmPageHdr) + sizeof(RmSlotDirHdr));
+
+    // 槽目录的末尾
+    int dir_end() const { return SLOTS_OFFSET + dir_hdr_->num_slots * static_cast<int>(sizeof(RmSlot)); }
+
+    bool extend_dir(int num_slots, int reserve);
+
+    int allocate(int n);
+
+    char *data_;                // 页面首地址
+    int page_size_;             // 页面大小
+    RmPageHdr *page_hdr_;       // 页头
+    RmSlotDirHdr *dir_hdr_;     // 槽目录头
+    RmSlot *slots_;             // 槽目录
+};
@@ -0,0 +1,125 @@
+#include "clock_replacer.h"
+
+ClockReplacer::ClockReplacer(size_t num_pages) : in_replacer_(num_pages, 0), ref_(num_pages, 0), max_size_(num_pages) {}
+
+ClockReplacer::~ClockReplacer() = default;
+
+/**
+ * @description: 使用CLOCK策略删除一个victim frame，并返回该frame的id
+ * @param {frame_id_t*} frame_id 被移除的frame的id
+ * @return {bool} 如果成功淘汰了一个页面则返回true，否则返回false
+ */
+bool ClockReplacer::victim(frame_id_t* frame_id) {
+    std::scoped_lock lock{latch_};
+    if (size_ == 0) {
+        return false;
+    }
+    // 至多转两圈：第一圈清除所有引用位，第二圈一定能找到引用位为0的帧
+    while (true) {
+        size_t pos = hand_;
+        hand_ = (hand_ + 1) % max_size_;
+        if (!in_replacer_[pos]) {
+            continue;
+        }
+        if (ref_[pos]) {
+            ref_[pos] = 0;
+            continue;
+        }
+        in_replacer_[pos] = 0;
+        size_--;
+        *frame_id = static_cast<frame_id_t>(pos);
+        return true;
+    }
+}
+
+/**
+ * @description: 按淘汰顺序，淘汰第一个满足filter的frame。
+ *              淘汰顺序为：从时钟指针开始引用位为0的帧，然后是从时钟指针开始引用位为1的帧（时钟指针第一圈会清除它们的引用位）。
+ *              只有成功淘汰时才移动时钟指针并清除被扫过的帧的引用位
+ * @param {frame_id_t*} frame_id 被移除的frame的id
+ * @param {function} filter 只有filter返回true的frame才能被淘汰
+ * @param {size_t} max_scan 最多检查的frame个数，为0表示不限制
+ * @return {bool} 如果成功淘汰了一个页面则返回true，否则返回false
+ */
+bool ClockReplacer::victim_if(frame_id_t* frame_id, const std::function<bool(frame_id_t)>& filter, size_t max_scan) {
+    std::scoped_lock lock{latch_};
+    size_t scanned = 0;
+    for (char ref = 0; ref <= 1; ref++) {
+        for (size_t i = 0; i < max_size_; i++) {
+            size_t pos = (hand_ + i) % max_size_;
+            if (!in_replacer_[pos] || ref_[pos] != ref) {
+                continue;
+            }
+            if (max_scan != 0 && scanned++ >= max_scan) {
+                return false;
+            }
+            if (!filter(static_cast<frame_id_t>(pos))) {
+                continue;
+            }
+            // 时钟指针扫过的帧失去二次机会；若在第二轮找到，则指针已经转过一整圈
+            size_t passed = ref ? max_size_ : i;
+            for (size_t j = 0; j < passed; j++) {
+                ref_[(hand_ + j) % max_size_] = 0;
+            }
+            in_replacer_[pos] = 0;
+            ref_[pos] = 0;
+            size_--;
+            hand_ = (pos + 1) % max_size_;
+            *frame_id = static_cast<frame_id_t>(pos);
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @description: 按淘汰顺序列出至多max_scan个可淘汰的frame，不将其移出replacer，也不改变引用位
+ * @param {vector<frame_id_t>*} frames 结果追加到frames中
+ * @param {size_t} max_scan 最多列出的frame个数
+ */
+void ClockReplacer::candidates(std::vector<frame_id_t>* frames, size_t max_scan) {
+    std::scoped_lock lock{latch_};
+    for (char ref = 0; ref <= 1; ref++) {
+        for (size_t i = 0; i < max_size_ && max_scan > 0; i++) {
+            size_t pos = (hand_ + i) % max_size_;
+            if (in_replacer_[pos] && ref_[pos] == ref) {
+                frames->push_back(static_cast<frame_id_t>(pos));
+                max_scan--;
+            }
+        }
+    }
+}
+
+/**
+ * @description: 固定指定的frame，即该页面无法被淘汰
+ * @param {frame_id_t} 需要固定的frame的id
+ */
+void ClockReplacer::pin(frame_id_t frame_id) {
+    std::scoped_lock lock{latch_};
+    if (in_replacer_[frame_id]) {
+        in_replacer_[frame_id] = 0;
+        size_--;
+    }
+}
+
+/**
+ * @description: 取消固定一个frame，代表该页面可以被淘汰，同时设置其引用位
+ * @param {frame_id_t} frame_id 取消固定的frame的id
+ */
+void ClockReplacer::unpin(frame_id_t frame_id) {
+    std::scoped_lock lock{latch_};
+    if (in_replacer_[frame_id]) {
+        return;
+    }
+    in_replacer_[frame_id] = 1;
+    ref_[frame_id] = 1;
+    size_++;
+}
+
+/**
+ * @description: 获取当前replacer中可以被淘汰的页面数量
+ */
+size_t ClockReplacer::Size() {
+    std::scoped_lock lock{latch_};
+    return size_;
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <mutex>
+#include <vector>
+
+#include "common/config.h"
+#include "replacer/replacer.h"
+
+/*
+ClockReplacer实现了CLOCK（二次机会）替换策略，所有状态保存在按frame_id索引的定长数组中，pin/unpin不分配内存
+*/
+class ClockReplacer : public Replacer {
+   public:
+    /**
+     * @description: 创建一个新的ClockReplacer
+     * @param {size_t} num_pages ClockReplacer最多需要存储的page数量，frame_id的取值范围为[0, num_pages)
+     */
+    explicit ClockReplacer(size_t num_pages);
+
+    ~ClockReplacer();
+
+    bool victim(frame_id_t *frame_id);
+
+    bool victim_if(frame_id_t *frame_id, const std::function<bool(frame_id_t)> &filter, size_t max_scan);
+
+    void candidates(std::vector<frame_id_t> *frames, size_t max_scan);
+
+    void pin(frame_id_t frame_id);
+
+    void unpin(frame_id_t frame_id);
+
+    size_t Size();
+
+   private:
+    std::mutex latch_;                  // 互斥锁
+    std::vector<char> in_replacer_;     // 帧是否可被淘汰（已unpin）
+    std::vector<char> ref_;             // 帧的引用位，unpin时置1，时钟指针扫过时清0
+    size_t hand_ = 0;                   // 时钟指针
+    size_t size_ = 0;                   // 可被淘汰的帧的个数
+    size_t max_size_;                   // 最大容量（与缓冲池的容量相同）
+};
@@ -0,0 +1,158 @@
+#include "lru_k_replacer.h"
+
+#include <algorithm>
+
+LRUKReplacer::LRUKReplacer(size_t num_pages, size_t k)
+    : k_(std::max<size_t>(1, k)),
+      history_(num_pages * k_, 0),
+      history_len_(num_pages, 0),
+      in_replacer_(num_pages, 0),
+      max_size_(num_pages) {
+    order_.reserve(num_pages);
+}
+
+LRUKReplacer::~LRUKReplacer() = default;
+
+/**
+ * @description: 计算帧的淘汰键，键越小越先被淘汰。
+ *              访问不足k_次的帧最高位为0，按最早一次访问的时间排序；否则最高位为1，按倒数第k_次访问的时间排序
+ * @param {size_t} frame 帧的id
+ */
+uint64_t LRUKReplacer::evict_key(size_t frame) const {
+    uint32_t len = history_len_[frame];
+    if (len == 0) {
+        return 0;
+    }
+    uint64_t ts = history_[frame * k_ + len - 1];
+    return len < k_ ? ts : (ts | (1ULL << 63));
+}
+
+/**
+ * @description: 将所有可淘汰的帧按淘汰顺序排列到order_中，只保证前max_scan个有序（为0时全部排序）
+ * @param {size_t} max_scan 需要排序的帧的个数
+ */
+void LRUKReplacer::sort_candidates(size_t max_scan) {
+    order_.clear();
+    for (size_t i = 0; i < max_size_; i++) {
+        if (in_replacer_[i]) {
+            order_.push_back(static_cast<frame_id_t>(i));
+        }
+    }
+    size_t n = (max_scan == 0 || max_scan > order_.size()) ? order_.size() : max_scan;
+    std::partial_sort(order_.begin(), order_.begin() + n, order_.end(),
+                      [this](frame_id_t a, frame_id_t b) { return evict_key(a) < evict_key(b); });
+    order_.resize(n);
+}
+
+/**
+ * @description: 将帧移出replacer并清空其访问历史，帧中的页面即将被替换
+ * @param {size_t} frame 帧的id
+ */
+void LRUKReplacer::evict(size_t frame) {
+    in_replacer_[frame] = 0;
+    history_len_[frame] = 0;
+    size_--;
+}
+
+/**
+ * @description: 使用LRU-K策略删除一个victim frame，并返回该frame的id
+ * @param {frame_id_t*} frame_id 被移除的frame的id
+ * @return {bool} 如果成功淘汰了一个页面则返回true，否则返回false
+ */
+bool LRUKReplacer::victim(frame_id_t* frame_id) {
+    std::scoped_lock lock{latch_};
+    if (size_ == 0) {
+        return false;
+    }
+    size_t best = max_size_;
+    uint64_t best_key = 0;
+    for (size_t i = 0; i < max_size_; i++) {
+        if (!in_replacer_[i]) {
+            continue;
+        }
+        uint64_t key = evict_key(i);
+        if (best == max_size_ || key < best_key) {
+            best = i;
+            best_key = key;
+        }
+    }
+    evict(best);
+    *frame_id = static_cast<frame_id_t>(best);
+    return true;
+}
+
+/**
+ * @description: 按淘汰顺序，淘汰第一个满足filter的frame
+ * @param {frame_id_t*} frame_id 被移除的frame的id
+ * @param {function} filter 只有filter返回true的frame才能被淘汰
+ * @param {size_t} max_scan 最多检查的frame个数，为0表示不限制
+ * @return {bool} 如果成功淘汰了一个页面则返回true，否则返回false
+ */
+bool LRUKReplacer::victim_if(frame_id_t* frame_id, const std::function<bool(frame_id_t)>& filter, size_t max_scan) {
+    std::scoped_lock lock{latch_};
+    sort_candidates(max_scan);
+    for (frame_id_t frame : order_) {
+        if (filter(frame)) {
+            evict(frame);
+            *frame_id = frame;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @description: 按淘汰顺序列出至多max_scan个可淘汰的frame，不将其移出replacer
+ * @param {vector<frame_id_t>*} frames 结果追加到frames中
+ * @param {size_t} max_scan 最多列出的frame个数
+ */
+void LRUKReplacer::candidates(std::vector<frame_id_t>* frames, size_t max_scan) {
+    std::scoped_lock lock{latch_};
+    if (max_scan == 0) {
+        return;
+    }
+    sort_candidates(max_scan);
+    frames->insert(frames->end(), order_.begin(), order_.end());
+}
+
+/**
+ * @description: 固定指定的frame，即该页面无法被淘汰，并记录一次对该帧的访问
+ * @param {frame_id_t} 需要固定的frame的id
+ */
+void LRUKReplacer::pin(frame_id_t frame_id) {
+    std::scoped_lock lock{latch_};
+    if (in_replacer_[frame_id]) {
+        in_replacer_[frame_id] = 0;
+        size_--;
+    }
+    uint64_t *hist = &history_[frame_id * k_];
+    uint32_t &len = history_len_[frame_id];
+    std::copy_backward(hist, hist + std::min<size_t>(len, k_ - 1), hist + std::min<size_t>(len + 1, k_));
+    hist[0] = ++current_ts_;
+    len = std::min<size_t>(len + 1, k_);
+}
+
+/**
+ * @description: 取消固定一个frame，代表该页面可以被淘汰。从未被访问过的帧在unpin时记录一次访问
+ * @param {frame_id_t} frame_id 取消固定的frame的id
+ */
+void LRUKReplacer::unpin(frame_id_t frame_id) {
+    std::scoped_lock lock{latch_};
+    if (in_replacer_[frame_id]) {
+        return;
+    }
+    if (history_len_[frame_id] == 0) {
+        history_[frame_id * k_] = ++current_ts_;
+        history_len_[frame_id] = 1;
+    }
+    in_replacer_[frame_id] = 1;
+    size_++;
+}
+
+/**
+ * @description: 获取当前replacer中可以被淘汰的页面数量
+ */
+size_t LRUKReplacer::Size() {
+    std::scoped_lock lock{latch_};
+    return size_;
+}
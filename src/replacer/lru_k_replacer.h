@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include "common/config.h"
+#include "replacer/replacer.h"
+
+/*
+LRUKReplacer实现了LRU-K替换策略：淘汰后向K距离（当前时间与倒数第K次访问的时间差）最大的帧，
+访问次数不足K次的帧后向K距离视为无穷大，它们之间按最早一次访问的时间淘汰。
+每次pin记为一次访问，所有状态保存在按frame_id索引的定长数组中，pin/unpin不分配内存
+*/
+class LRUKReplacer : public Replacer {
+   public:
+    /**
+     * @description: 创建一个新的LRUKReplacer
+     * @param {size_t} num_pages LRUKReplacer最多需要存储的page数量，frame_id的取值范围为[0, num_pages)
+     * @param {size_t} k 计算后向K距离时使用的K
+     */
+    explicit LRUKReplacer(size_t num_pages, size_t k = REPLACER_LRU_K);
+
+    ~LRUKReplacer();
+
+    bool victim(frame_id_t *frame_id);
+
+    bool victim_if(frame_id_t *frame_id, const std::function<bool(frame_id_t)> &filter, size_t max_scan);
+
+    void candidates(std::vector<frame_id_t> *frames, size_t max_scan);
+
+    void pin(frame_id_t frame_id);
+
+    void unpin(frame_id_t frame_id);
+
+    size_t Size();
+
+   private:
+    uint64_t evict_key(size_t frame) const;
+
+    void sort_candidates(size_t max_scan);
+
+    void evict(size_t frame);
+
+    std::mutex latch_;                  // 互斥锁
+    size_t k_;                          // LRU-K中的K
+    std::vector<uint64_t> history_;     // 每个帧最近k_次访问的时间戳，帧f的记录位于[f*k_, f*k_+k_)，由近到远排列
+    std::vector<uint32_t> history_len_; // 每个帧已记录的访问次数，不超过k_
+    std::vector<char> in_replacer_;     // 帧是否可被淘汰（已unpin）
+    std::vector<frame_id_t> order_;     // victim_if/candidates排序用的缓冲区，预先分配避免运行时分配内存
+    uint64_t current_ts_ = 0;           // 逻辑时钟，每次访问加1
+    size_t size_ = 0;                   // 可被淘汰的帧的个数
+    size_t max_size_;                   // 最大容量（与缓冲池的容量相同）
+};
@@ -23,6 +23,42 @@ bool LRUReplacer::victim(frame_id_t* frame_id) {
     return true;
 }
 
+/**
+ * @description: 从LRU端开始，淘汰第一个满足filter的frame
+ * @param {frame_id_t*} frame_id 被移除的frame的id
+ * @param {function} filter 只有filter返回true的frame才能被淘汰
+ * @param {size_t} max_scan 最多检查的frame个数，为0表示不限制
+ * @return {bool} 如果成功淘汰了一个页面则返回true，否则返回false
+ */
+bool LRUReplacer::victim_if(frame_id_t* frame_id, const std::function<bool(frame_id_t)>& filter, size_t max_scan) {
+    std::scoped_lock lock{latch_};
+    size_t scanned = 0;
+    for (auto it = LRUlist_.rbegin(); it != LRUlist_.rend(); ++it) {
+        if (max_scan != 0 && scanned++ >= max_scan) {
+            break;
+        }
+        if (filter(*it)) {
+            *frame_id = *it;
+            LRUhash_.erase(*frame_id);
+            LRUlist_.erase(std::next(it).base());
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @description: 按淘汰顺序（从LRU端开始）列出至多max_scan个可淘汰的frame，不将其移出replacer
+ * @param {vector<frame_id_t>*} frames 结果追加到frames中
+ * @param {size_t} max_scan 最多列出的frame个数
+ */
+void LRUReplacer::candidates(std::vector<frame_id_t>* frames, size_t max_scan) {
+    std::scoped_lock lock{latch_};
+    for (auto it = LRUlist_.rbegin(); it != LRUlist_.rend() && max_scan > 0; ++it, --max_scan) {
+        frames->push_back(*it);
+    }
+}
+
 /**
  * @description: 固定指定的frame，即该页面无法被淘汰
  * @param {frame_id_t} 需要固定的frame的id
@@ -23,6 +23,10 @@ class LRUReplacer : public Replacer {
 
     bool victim(frame_id_t *frame_id);
 
+    bool victim_if(frame_id_t *frame_id, const std::function<bool(frame_id_t)> &filter, size_t max_scan);
+
+    void candidates(std::vector<frame_id_t> *frames, size_t max_scan);
+
     void pin(frame_id_t frame_id);
 
     void unpin(frame_id_t frame_id);
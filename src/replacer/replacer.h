@@ -1,5 +1,8 @@
 #pragma once
 
+#include <functional>
+#include <vector>
+
 #include "common/config.h"
 
 /**
@@ -17,6 +20,22 @@ class Replacer {
      */
     virtual bool victim(frame_id_t *frame_id) = 0;
 
+    /**
+     * Remove the first frame, in eviction order, that satisfies filter.
+     * @param[out] frame_id id of frame that was removed
+     * @param filter only frames for which filter returns true can be victimized
+     * @param max_scan examine at most max_scan frames, 0 means no limit
+     * @return true if a victim frame was found, false otherwise
+     */
+    virtual bool victim_if(frame_id_t *frame_id, const std::function<bool(frame_id_t)> &filter, size_t max_scan) = 0;
+
+    /**
+     * List frames in the order they would be victimized, without removing them.
+     * @param[out] frames the first max_scan candidates are appended to frames
+     * @param max_scan number of candidates to return at most
+     */
+    virtual void candidates(std::vector<frame_id_t> *frames, size_t max_scan) = 0;
+
     /**
      * Pins a frame, indicating that it should not be victimized until it is unpinned.
      * @param frame_id the id of the frame to pin
@@ -0,0 +1,244 @@
+#include "storage/async_io.h"
+
+#include <string.h>    // for memset
+#include <sys/mman.h>  // for mmap
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+#include "storage/disk_manager.h"
+
+AsyncIO::AsyncIO(DiskManager *disk_manager, unsigned queue_depth, bool use_io_uring)
+    : disk_manager_(disk_manager), queue_depth_(std::max(1u, queue_depth)), slots_(queue_depth_) {
+    for (unsigned i = 0; i < queue_depth_; i++) {
+        free_slots_.push_back(queue_depth_ - 1 - i);
+    }
+#ifdef UNIBASE_HAVE_IO_URING
+    if (!use_io_uring) {
+        return;
+    }
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    int fd = static_cast<int>(syscall(__NR_io_uring_setup, queue_depth_, &params));
+    if (fd < 0) {
+        // 内核不支持或被禁止使用io_uring，退化为同步模式
+        return;
+    }
+    sq_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    cq_size_ = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+    if (single_mmap) {
+        sq_size_ = cq_size_ = std::max(sq_size_, cq_size_);
+    }
+    sq_ptr_ = mmap(nullptr, sq_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+    cq_ptr_ = single_mmap ? sq_ptr_
+                          : mmap(nullptr, cq_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd,
+                                 IORING_OFF_CQ_RING);
+    sqes_size_ = params.sq_entries * sizeof(struct io_uring_sqe);
+    void *sqes = mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+    if (sq_ptr_ == MAP_FAILED || cq_ptr_ == MAP_FAILED || sqes == MAP_FAILED) {
+        if (sq_ptr_ != MAP_FAILED) munmap(sq_ptr_, sq_size_);
+        if (!single_mmap && cq_ptr_ != MAP_FAILED) munmap(cq_ptr_, cq_size_);
+        if (sqes != MAP_FAILED) munmap(sqes, sqes_size_);
+        sq_ptr_ = cq_ptr_ = nullptr;
+        close(fd);
+        return;
+    }
+    char *sq = static_cast<char *>(sq_ptr_);
+    char *cq = static_cast<char *>(cq_ptr_);
+    sq_head_ = reinterpret_cast<unsigned *>(sq + params.sq_off.head);
+    sq_tail_ = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+    sq_mask_ = reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+    sq_array_ = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+    cq_head_ = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+    cq_tail_ = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+    cq_mask_ = reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+    cqes_ = reinterpret_cast<struct io_uring_cqe *>(cq + params.cq_off.cqes);
+    sqes_ = static_cast<struct io_uring_sqe *>(sqes);
+    ring_fd_ = fd;
+#endif
+}
+
+AsyncIO::~AsyncIO() {
+#ifdef UNIBASE_HAVE_IO_URING
+    if (ring_fd_ < 0) {
+        return;
+    }
+    // 等待所有进行中的请求结束，内核完成前不能释放它们的缓冲区
+    std::vector<AsyncIOCompletion> completions;
+    while (in_flight_ > 0) {
+        if (to_submit_ > 0) {
+            submit();
+        }
+        wait(&completions, 1);
+    }
+    munmap(sqes_, sqes_size_);
+    if (cq_ptr_ != sq_ptr_) {
+        munmap(cq_ptr_, cq_size_);
+    }
+    munmap(sq_ptr_, sq_size_);
+    close(ring_fd_);
+#endif
+}
+
+/**
+ * @description: 准备一个读页面请求，调用submit后才真正提交给内核
+ * @return {bool} 进行中的请求数已达到queue_depth时返回false，此时需要先wait
+ * @param {int} fd 磁盘文件的文件句柄
+ * @param {page_id_t} page_no 页面编号
+ * @param {char*} buf 读入的目标缓冲区，大小为文件的页面大小，请求完成前不能释放；超出文件末尾的部分填充为0
+ * @param {uint64_t} user_data 完成结果中返回的用户数据
+ */
+bool AsyncIO::prep_read(int fd, page_id_t page_no, char *buf, uint64_t user_data) {
+    return prep(fd, page_no, buf, false, user_data);
+}
+
+/**
+ * @description: 准备一个写页面请求，调用submit后才真正提交给内核
+ * @return {bool} 进行中的请求数已达到queue_depth时返回false，此时需要先wait
+ * @param {int} fd 磁盘文件的文件句柄
+ * @param {page_id_t} page_no 页面编号
+ * @param {char*} buf 要写入的数据，大小为文件的页面大小，请求完成前不能修改
+ * @param {uint64_t} user_data 完成结果中返回的用户数据
+ */
+bool AsyncIO::prep_write(int fd, page_id_t page_no, const char *buf, uint64_t user_data) {
+    return prep(fd, page_no, const_cast<char *>(buf), true, user_data);
+}
+
+bool AsyncIO::prep(int fd, page_id_t page_no, char *buf, bool is_write, uint64_t user_data) {
+    if (free_slots_.empty()) {
+        return false;
+    }
+    unsigned slot_idx = free_slots_.back();
+    free_slots_.pop_back();
+    in_flight_++;
+    Slot &slot = slots_[slot_idx];
+    const int page_size = disk_manager_->get_page_size(fd);
+    slot = {fd, page_no, buf, is_write, user_data, {buf, static_cast<size_t>(page_size)}};
+    off_t pos = static_cast<off_t>(page_no) * page_size;
+
+    if (ring_fd_ < 0) {
+        // 同步模式：立即完成请求
+        ssize_t res = is_write ? pwrite(fd, buf, page_size, pos) : pread(fd, buf, page_size, pos);
+        finish(slot_idx, res < 0 ? -errno : static_cast<int>(res), &ready_);
+        return true;
+    }
+#ifdef UNIBASE_HAVE_IO_URING
+    unsigned tail = *sq_tail_;
+    unsigned index = tail & *sq_mask_;
+    struct io_uring_sqe *sqe = &sqes_[index];
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = is_write ? IORING_OP_WRITEV : IORING_OP_READV;
+    sqe->fd = fd;
+    sqe->addr = reinterpret_cast<uint64_t>(&slot.iov);
+    sqe->len = 1;
+    sqe->off = pos;
+    sqe->user_data = slot_idx;
+    sq_array_[index] = index;
+    // 内核看到新的tail之前，sqe的内容必须已经可见
+    __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+    to_submit_++;
+#endif
+    return true;
+}
+
+/**
+ * @description: 将已准备的请求提交给内核
+ * @return {int} 提交的请求数
+ */
+int AsyncIO::submit() {
+    if (ring_fd_ < 0 || to_submit_ == 0) {
+        return 0;
+    }
+#ifdef UNIBASE_HAVE_IO_URING
+    int submitted = 0;
+    while (to_submit_ > 0) {
+        int ret = static_cast<int>(syscall(__NR_io_uring_enter, ring_fd_, to_submit_, 0, 0, nullptr, 0));
+        if (ret < 0) {
+            if (errno == EINTR || errno == EAGAIN) {
+                continue;
+            }
+            throw UnixError();
+        }
+        to_submit_ -= ret;
+        submitted += ret;
+    }
+    return submitted;
+#else
+    return 0;
+#endif
+}
+
+/**
+ * @description: 等待至少min_complete个请求完成（不超过进行中的请求数），并返回所有已完成的请求
+ * @return {int} 本次返回的完成结果个数
+ * @param {vector<AsyncIOCompletion>*} completions 完成结果追加到其中
+ * @param {unsigned} min_complete 至少等待完成的请求数，为0时只收集已经完成的请求
+ */
+int AsyncIO::wait(std::vector<AsyncIOCompletion> *completions, unsigned min_complete) {
+    size_t before = completions->size();
+    if (!ready_.empty()) {
+        completions->insert(completions->end(), ready_.begin(), ready_.end());
+        ready_.clear();
+    }
+#ifdef UNIBASE_HAVE_IO_URING
+    if (ring_fd_ >= 0) {
+        min_complete = std::min(min_complete, in_flight_);
+        while (true) {
+            unsigned head = *cq_head_;
+            unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+            for (; head != tail; head++) {
+                struct io_uring_cqe *cqe = &cqes_[head & *cq_mask_];
+                finish(static_cast<unsigned>(cqe->user_data), cqe->res, completions);
+            }
+            __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+            if (completions->size() - before >= min_complete) {
+                break;
+            }
+            unsigned wait_nr = min_complete - static_cast<unsigned>(completions->size() - before);
+            int ret = static_cast<int>(
+                syscall(__NR_io_uring_enter, ring_fd_, to_submit_, wait_nr, IORING_ENTER_GETEVENTS, nullptr, 0));
+            if (ret < 0) {
+                if (errno == EINTR || errno == EAGAIN) {
+                    continue;
+                }
+                throw UnixError();
+            }
+            to_submit_ -= ret;
+        }
+    }
+#endif
+    return static_cast<int>(completions->size() - before);
+}
+
+/**
+ * @description: 处理一个完成的请求：读请求读到文件末尾时将剩余部分填0，写请求只写入部分数据时同步写完，然后释放槽位
+ * @param {unsigned} slot_idx 请求的槽位
+ * @param {int} res 系统调用的返回值，或负的errno
+ * @param {vector<AsyncIOCompletion>*} completions 完成结果追加到其中
+ */
+void AsyncIO::finish(unsigned slot_idx, int res, std::vector<AsyncIOCompletion> *completions) {
+    Slot &slot = slots_[slot_idx];
+    int result = res < 0 ? res : 0;
+    const int page_size = static_cast<int>(slot.iov.iov_len);
+    if (res >= 0 && res < page_size) {
+        if (slot.is_write) {
+            off_t pos = static_cast<off_t>(slot.page_no) * page_size + res;
+            ssize_t written = pwrite(slot.fd, slot.buf + res, page_size - res, pos);
+            result = written == page_size - res ? 0 : (written < 0 ? -errno : -EIO);
+        } else {
+            memset(slot.buf + res, 0, page_size - res);
+        }
+    }
+    if (result == 0) {
+        if (slot.is_write) {
+            disk_manager_->count_page_writes(slot.fd, 1);
+        } else {
+            disk_manager_->count_page_reads(slot.fd, 1);
+        }
+    }
+    completions->push_back({slot.user_data, result});
+    free_slots_.push_back(slot_idx);
+    in_flight_--;
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <sys/uio.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "common/config.h"
+
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#define UNIBASE_HAVE_IO_URING 1
+#endif
+
+class DiskManager;
+
+/* 一个异步页面读写请求的完成结果 */
+struct AsyncIOCompletion {
+    uint64_t user_data;     // 提交请求时传入的用户数据
+    int result;             // 成功时为0，失败时为负的errno
+};
+
+/**
+ * @description: 批量提交页面读写请求并轮询完成结果的异步I/O上下文。
+ * 内核支持时使用io_uring，可以在一个线程中保持多个I/O同时进行；否则退化为在提交时同步地pread/pwrite，
+ * 完成结果在下一次wait时返回，调用方式不变。上下文不是线程安全的，每个线程使用自己的上下文
+ */
+class AsyncIO {
+   public:
+    /**
+     * @param {DiskManager*} disk_manager 用于统计读取的页面数
+     * @param {unsigned} queue_depth 同时进行的最大请求数
+     * @param {bool} use_io_uring 为false时直接使用同步的pread/pwrite
+     */
+    AsyncIO(DiskManager *disk_manager, unsigned queue_depth, bool use_io_uring = ENABLE_IO_URING);
+
+    ~AsyncIO();
+
+    AsyncIO(const AsyncIO &) = delete;
+    AsyncIO &operator=(const AsyncIO &) = delete;
+
+    // 是否使用了io_uring
+    bool uses_io_uring() const { return ring_fd_ >= 0; }
+
+    unsigned queue_depth() const { return queue_depth_; }
+
+    // 已提交（或已排队等待提交）但还没有通过wait返回的请求数
+    unsigned in_flight() const { return in_flight_; }
+
+    // 以O_DIRECT打开的文件上buf必须按DIRECT_IO_ALIGNMENT对齐（缓冲池的帧都满足），否则请求以-EINVAL完成
+    bool prep_read(int fd, page_id_t page_no, char *buf, uint64_t user_data);
+
+    bool prep_write(int fd, page_id_t page_no, const char *buf, uint64_t user_data);
+
+    int submit();
+
+    int wait(std::vector<AsyncIOCompletion> *completions, unsigned min_complete);
+
+   private:
+    bool prep(int fd, page_id_t page_no, char *buf, bool is_write, uint64_t user_data);
+
+    void finish(unsigned slot, int res, std::vector<AsyncIOCompletion> *completions);
+
+    /* 每个进行中的请求占用一个槽位，io_uring的user_data为槽位编号 */
+    struct Slot {
+        int fd;
+        page_id_t page_no;
+        char *buf;
+        bool is_write;
+        uint64_t user_data;
+        struct iovec iov;
+    };
+
+    DiskManager *disk_manager_;
+    unsigned queue_depth_;
+    unsigned in_flight_ = 0;
+    std::vector<Slot> slots_;
+    std::vector<unsigned> free_slots_;
+    std::vector<AsyncIOCompletion> ready_;  // 同步模式下已完成、等待wait返回的请求
+
+    int ring_fd_ = -1;          // io_uring实例的文件描述符，为-1表示使用同步模式
+    unsigned to_submit_ = 0;    // 已写入提交队列但还没有提交给内核的请求数
+#ifdef UNIBASE_HAVE_IO_URING
+    void *sq_ptr_ = nullptr;
+    void *cq_ptr_ = nullptr;
+    size_t sq_size_ = 0;
+    size_t cq_size_ = 0;
+    struct io_uring_sqe *sqes_ = nullptr;
+    size_t sqes_size_ = 0;
+    unsigned *sq_head_, *sq_tail_, *sq_mask_, *sq_array_;
+    unsigned *cq_head_, *cq_tail_, *cq_mask_;
+    struct io_uring_cqe *cqes_;
+#endif
+};
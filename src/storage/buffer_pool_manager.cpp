@@ -1,177 +1,1548 @@
 #include "buffer_pool_manager.h"
 
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+#include <sys/mman.h>  // for MADV_WILLNEED
+
+BufferPoolShard::BufferPoolShard(size_t capacity, size_t pool_size, int page_size, char *frames,
+                                 const std::string &replacer_type)
+    : capacity_(capacity), pool_size_(pool_size), page_size_(page_size), frames_(frames), page_table_(2 * capacity) {
+    // 帧的元数据集中存放在pages_数组中，与帧数据分开，扫描元数据时不会访问帧所在的内存
+    pages_ = new Page[capacity_];
+    for (size_t i = 0; i < capacity_; ++i) {
+        pages_[i].data_ = frames_ + i * page_size_;
+        pages_[i].page_size_ = page_size_;
+    }
+    // 可以被Replacer改变
+    if (replacer_type == "CLOCK")
+        replacer_ = new ClockReplacer(capacity_);
+    else if (replacer_type == "LRU-K")
+        replacer_ = new LRUKReplacer(capacity_, REPLACER_LRU_K);
+    else {
+        replacer_ = new LRUReplacer(capacity_);
+    }
+    // 初始化时，所有可用的page都在free_list_中
+    for (size_t i = 0; i < pool_size_; ++i) {
+        free_list_.emplace_back(static_cast<frame_id_t>(i));  // static_cast转换数据类型
+    }
+}
+
+BufferPoolShard::~BufferPoolShard() {
+    delete[] pages_;
+    delete replacer_;
+}
+
 /**
- * @description: 从free_list或replacer中得到可淘汰帧页的 *frame_id
+ * @description: 分片中需要保持干净的未固定帧窗口大小，即淘汰顺序上最靠前的clean_fraction_比例的帧
+ * @param {BufferPoolShard&} shard 目标分片
+ */
+size_t BufferPoolManager::clean_window(BufferPoolShard &shard) const {
+    return static_cast<size_t>(shard.replacer_->Size() * clean_fraction_) + 1;
+}
+
+/**
+ * @description: 从环形缓冲区、分片的free_list或replacer中得到可淘汰帧页的 *frame_id，调用者需持有shard.latch_
+ *              使用访问策略时，优先复用环中该位置上次使用的帧（仍装着环上次装入的页面且未被固定）；
+ *              否则优先选择干净的帧，只有淘汰窗口内没有干净帧时才选择脏帧；正在进行I/O的帧不会被选中。
+ *              返回的帧已被占用（pin_count_为PIN_CLAIMED）并移出replacer，其他线程无法再无锁地固定它
  * @return {bool} true: 可替换帧查找成功 , false: 可替换帧查找失败
+ * @param {BufferPoolShard&} shard 目标分片
  * @param {frame_id_t*} frame_id 帧页id指针,返回成功找到的可替换帧id
+ * @param {RingSlot*} slot 访问策略的环位置，不使用访问策略时为nullptr
+ * @param {bool} clean_only 只返回不需要写回的帧（用于预读），此时淘汰窗口内没有干净帧则查找失败
+ * @note 返回false时若分片中有帧正在进行I/O（见io_pending），调用者应等待shard.io_cv_后重试
  */
-bool BufferPoolManager::find_victim_page(frame_id_t* frame_id) {
-    if (!free_list_.empty()) {
-        *frame_id = free_list_.front();
-        free_list_.pop_front();
+bool BufferPoolManager::find_victim_page(BufferPoolShard &shard, frame_id_t* frame_id,
+                                         BufferAccessStrategy::RingSlot *slot, bool clean_only) {
+    if (slot != nullptr && slot->frame_id != INVALID_FRAME_ID &&
+        static_cast<size_t>(slot->frame_id) < shard.pool_size_) {
+        Page *page = shard.pages_ + slot->frame_id;
+        if (page->id_.load() == slot->page_id && !page->io_in_progress_ && !(clean_only && page->is_dirty_) &&
+            page->try_claim()) {
+            shard.replacer_->pin(slot->frame_id);
+            *frame_id = slot->frame_id;
+            return true;
+        }
+    }
+    if (!shard.free_list_.empty()) {
+        *frame_id = shard.free_list_.front();
+        shard.free_list_.pop_front();
+        // 空闲帧只可能被查到过期页表项的线程短暂固定，它们验证失败后会立即释放
+        while (!shard.pages_[*frame_id].try_claim()) {
+            std::this_thread::yield();
+        }
         return true;
     }
-    return replacer_->victim(frame_id);
+    if (victim_if(shard, frame_id, true, clean_window(shard))) {
+        return true;
+    }
+    if (clean_only) {
+        return false;
+    }
+    return victim_if(shard, frame_id, false, 0);
 }
 
 /**
- * @description: 更新页面数据, 如果为脏页则需写入磁盘，再更新为新页面，更新page元数据(data, is_dirty, page_id)和page table
- * @param {Page*} page 写回页指针
+ * @description: 按replacer的淘汰顺序查找并占用一个未固定的帧，调用者需持有shard.latch_。
+ *              上次扫描以来被固定过的帧不会被淘汰，而是在replacer中补记一次访问（pin后unpin），
+ *              相当于把无锁命中时省略的replacer更新推迟到这里批量进行。扫描范围内只有这样的帧时，
+ *              它们的标记已被清除，再扫描一遍（即时钟算法的第二次机会）。已退役的帧不会被选中
+ * @return {bool} 是否找到了帧
+ * @param {BufferPoolShard&} shard 目标分片
+ * @param {frame_id_t*} frame_id 返回找到的帧
+ * @param {bool} clean_only 只选择干净的帧
+ * @param {size_t} max_scan 最多检查的帧数，0表示不限
+ */
+bool BufferPoolManager::victim_if(BufferPoolShard &shard, frame_id_t *frame_id, bool clean_only, size_t max_scan) {
+    Page *pages = shard.pages_;
+    size_t pool_size = shard.pool_size_;
+    std::vector<frame_id_t> referenced;
+    for (int pass = 0; pass < 2; pass++) {
+        referenced.clear();
+        bool found = shard.replacer_->victim_if(
+            frame_id,
+            [pages, pool_size, clean_only, &referenced](frame_id_t fid) {
+                if (static_cast<size_t>(fid) >= pool_size) {
+                    return false;
+                }
+                Page &page = pages[fid];
+                if (page.referenced_ && page.referenced_.exchange(false)) {
+                    referenced.push_back(fid);
+                    return false;
+                }
+                return !page.io_in_progress_ && !(clean_only && page.is_dirty_) && page.try_claim();
+            },
+            max_scan);
+        for (frame_id_t fid : referenced) {
+            shard.replacer_->pin(fid);
+            shard.replacer_->unpin(fid);
+        }
+        if (found || referenced.empty()) {
+            return found;
+        }
+    }
+    return false;
+}
+
+/**
+ * @description: 分片中是否有帧正在进行I/O，调用者需持有shard.latch_。没有可淘汰的帧时，
+ *              只有存在进行中的I/O才值得等待，否则所有帧都被固定，应当直接返回失败
+ * @param {BufferPoolShard&} shard 目标分片
+ */
+bool BufferPoolManager::io_pending(BufferPoolShard &shard) const {
+    return std::any_of(shard.pages_, shard.pages_ + shard.capacity_,
+                       [](const Page &page) { return page.io_in_progress_.load(); });
+}
+
+/**
+ * @description: 将帧替换为新页面：如果旧页面为脏页则需写入磁盘，再读入（或清空）新页面，更新page元数据和page table。
+ *              磁盘读写期间释放分片锁，帧处于io_in_progress_状态且保持被占用，访问新旧两个页面的线程都会等待I/O完成。
+ *              函数返回时重新持有分片锁，帧已固定（pin_count为1）并放回replacer
+ * @param {BufferPoolShard&} shard 页面所在的分片
+ * @param {unique_lock<mutex>&} lock 调用者持有的shard.latch_
+ * @param {Page*} page 被替换的帧，已被find_victim_page占用
  * @param {PageId} new_page_id 新的page_id
  * @param {frame_id_t} new_frame_id 新的帧frame_id
+ * @param {bool} read_from_disk 是否从磁盘读入新页面，为false时将帧内容清零（用于new_page）
  */
-void BufferPoolManager::update_page(Page *page, PageId new_page_id, frame_id_t new_frame_id) {
+void BufferPoolManager::update_page(BufferPoolShard &shard, std::unique_lock<std::mutex> &lock, Page *page,
+                                    PageId new_page_id, frame_id_t new_frame_id, bool read_from_disk) {
     PageId old_id = page->id_;
-    if (page->is_dirty_ && old_id.page_no != INVALID_PAGE_ID) {
-        disk_manager_->write_page(old_id.fd, old_id.page_no, page->data_, PAGE_SIZE);
-        page->is_dirty_ = false;
+    bool has_old = old_id.page_no != INVALID_PAGE_ID;
+    bool write_back = page->is_dirty_ && has_old;
+    page->io_in_progress_ = true;
+    page->read_ahead_marker_ = false;
+    shard.page_table_.insert(new_page_id, new_frame_id);
+    lock.unlock();
+
+    try {
+        if (write_back) {
+            disk_manager_->write_page(old_id.fd, old_id.page_no, checksummed_data(page, true, nullptr),
+                                      page->page_size_);
+        }
+    } catch (...) {
+        // 写回失败，旧页面仍然有效且为脏页，放回replacer
+        lock.lock();
+        shard.page_table_.erase(new_page_id);
+        page->io_in_progress_ = false;
+        page->pin_count_ = 0;
+        shard.replacer_->unpin(new_frame_id);
+        shard.io_cv_.notify_all();
+        throw;
+    }
+
+    try {
+        if (read_from_disk) {
+            disk_manager_->read_page(new_page_id.fd, new_page_id.page_no, page->data_, page->page_size_);
+            verify_checksum(new_page_id, page->data_, page->page_size_);
+        } else {
+            page->reset_memory();
+        }
+    } catch (...) {
+        // 读取失败或校验和不一致，旧页面已写回，帧归还free_list
+        lock.lock();
+        if (has_old) {
+            shard.page_table_.erase(old_id);
+        }
+        shard.page_table_.erase(new_page_id);
+        if (write_back) {
+            clear_dirty(shard, page, old_id);
+        }
+        page->id_ = {.fd = new_page_id.fd, .page_no = INVALID_PAGE_ID};
+        page->io_in_progress_ = false;
+        page->pin_count_ = 0;
+        free_frame(shard, new_frame_id);
+        shard.io_cv_.notify_all();
+        throw;
     }
-    if (old_id.page_no != INVALID_PAGE_ID) {
-        page_table_.erase(old_id);
+
+    lock.lock();
+    if (has_old) {
+        shard.page_table_.erase(old_id);
+    }
+    if (write_back) {
+        clear_dirty(shard, page, old_id);
+    }
+    if (has_old) {
+        (write_back ? stats_.evictions_dirty : stats_.evictions_clean).add();
     }
-    page->reset_memory();
     page->id_ = new_page_id;
-    page->pin_count_ = 0;
-    page->is_dirty_ = false;
-    page_table_[new_page_id] = new_frame_id;
+    page->referenced_ = false;
+    page->pin_count_ = 1;
+    page->io_in_progress_ = false;
+    // 记录一次访问后放回replacer，之后由try_claim()保证帧在被固定期间不会被淘汰
+    shard.replacer_->pin(new_frame_id);
+    shard.replacer_->unpin(new_frame_id);
+    shard.io_cv_.notify_all();
+}
+
+/**
+ * @description: 等待目标页面所在帧的I/O完成，调用者需持有shard.latch_，返回时页面不在缓冲池中或不在I/O中
+ * @param {BufferPoolShard&} shard 页面所在的分片
+ * @param {unique_lock<mutex>&} lock 调用者持有的shard.latch_
+ * @param {PageId&} page_id 目标页面
+ */
+void BufferPoolManager::wait_for_io(BufferPoolShard &shard, std::unique_lock<std::mutex> &lock,
+                                    const PageId &page_id) {
+    shard.io_cv_.wait(lock, [&shard, &page_id] {
+        frame_id_t frame_id;
+        return !shard.page_table_.find(page_id, &frame_id) || !shard.pages_[frame_id].io_in_progress_;
+    });
+}
+
+/**
+ * @description: 不获取分片锁，查找并固定缓冲池中的页面。先用CAS固定查到的帧（帧被占用时失败），
+ *              再验证帧中仍是目标页面且不在I/O中：帧被固定后不会被淘汰，验证通过即说明页面可用；
+ *              验证失败时撤销固定。淘汰、后台写回等操作先设置帧的状态再检查pin_count_，与这里的顺序相反，
+ *              保证两者并发时至少有一方发现冲突
+ * @return {Page*} 固定的页面，页面不在缓冲池中或需要加锁处理时返回nullptr
+ * @param {BufferPoolShard&} shard 页面所在的分片
+ * @param {PageId&} page_id 目标页面
+ */
+Page *BufferPoolManager::pin_resident_page(BufferPoolShard &shard, const PageId &page_id) {
+    frame_id_t fid;
+    if (!shard.page_table_.find(page_id, &fid)) {
+        return nullptr;
+    }
+    Page *page = shard.pages_ + fid;
+    if (!page->try_pin()) {
+        return nullptr;
+    }
+    if (!(page->id_.load() == page_id) || page->io_in_progress_) {
+        // 查到的帧已被替换为其他页面或正在I/O；撤销固定后帧仍在replacer或free_list中，不需要其他处理
+        page->pin_count_--;
+        return nullptr;
+    }
+    if (!page->referenced_) {
+        page->referenced_ = true;
+    }
+    return page;
 }
 
 /**
  * @description: 从buffer pool获取需要的页。
- *              如果页表中存在page_id（说明该page在缓冲池中），并且pin_count++。
+ *              如果页表中存在page_id（说明该page在缓冲池中），并且pin_count++。命中时先不加锁地查找并固定页面，
+ *              页面正在进行I/O或查找与页表的修改并发而失败时，才获取分片锁重新查找。
  *              如果页表不存在page_id（说明该page在磁盘中），则找缓冲池victim page，将其替换为磁盘中读取的page，pin_count置1。
+ *              开启预读时，未命中和命中预读标记都会交给read_ahead检测顺序访问。
  * @return {Page*} 若获得了需要的页则将其返回，否则返回nullptr
  * @param {PageId} page_id 需要获取的页的PageId
+ * @param {BufferAccessStrategy*} strategy 访问策略，未命中时在其环形缓冲区中复用帧；为nullptr时使用普通的淘汰流程
  */
-Page* BufferPoolManager::fetch_page(PageId page_id) {
-    std::scoped_lock lock{latch_};
-    auto it = page_table_.find(page_id);
-    if (it != page_table_.end()) {
-        frame_id_t fid = it->second;
-        Page *page = pages_ + fid;
-        page->pin_count_++;
-        replacer_->pin(fid);
+Page* BufferPoolManager::fetch_page(PageId page_id, BufferAccessStrategy *strategy) {
+    if (MappedFile *mapped = mapped_file(page_id.fd)) {
+        return fetch_mapped_page(*mapped, page_id, strategy);
+    }
+    size_t shard_idx = shard_index(page_id);
+    BufferPoolShard &shard = *shards_[shard_idx];
+    // 命中只按采样计时，避免每次命中都读取时钟
+    uint64_t start = BufferPoolStats::sample_hit() ? stats_now_ns() : 0;
+    if (Page *page = lock_free_hits_ ? pin_resident_page(shard, page_id) : nullptr) {
+        stats_.hits.add();
+        if (start != 0) {
+            stats_.hit_latency.record(stats_now_ns() - start);
+        }
+        if (page->read_ahead_marker_ && page->read_ahead_marker_.exchange(false)) {
+            read_ahead(page_id, false, strategy);
+        }
         return page;
     }
+    bool timed_hit = start != 0;
+    start = stats_now_ns();
+    std::unique_lock lock{shard.latch_};
+    BufferAccessStrategy::RingSlot *slot = nullptr;
     frame_id_t victim;
-    if (!find_victim_page(&victim)) {
-        return nullptr;
+    while (true) {
+        wait_for_io(shard, lock, page_id);
+        frame_id_t fid;
+        if (shard.page_table_.find(page_id, &fid)) {
+            // 持有分片锁且I/O已完成时，帧不会处于被占用状态
+            Page *page = shard.pages_ + fid;
+            [[maybe_unused]] bool pinned = page->try_pin();
+            assert(pinned);
+            page->referenced_ = true;
+            stats_.hits.add();
+            if (timed_hit) {
+                stats_.hit_latency.record(stats_now_ns() - start);
+            }
+            if (page->read_ahead_marker_.exchange(false)) {
+                lock.unlock();
+                read_ahead(page_id, false, strategy);
+            }
+            return page;
+        }
+        if (slot == nullptr && strategy != nullptr) {
+            slot = strategy->next_slot(shard_idx);
+        }
+        if (find_victim_page(shard, &victim, slot)) {
+            break;
+        }
+        if (!io_pending(shard)) {
+            return nullptr;
+        }
+        shard.io_cv_.wait(lock);
     }
-    Page *page = pages_ + victim;
-    update_page(page, page_id, victim);
-    disk_manager_->read_page(page_id.fd, page_id.page_no, page->data_, PAGE_SIZE);
-    page->pin_count_ = 1;
-    replacer_->pin(victim);
+    if (shard.pages_[victim].is_dirty_) {
+        // 没有干净帧可以淘汰，唤醒后台写线程
+        bg_cv_.notify_one();
+    }
+    if (slot != nullptr) {
+        slot->frame_id = victim;
+        slot->page_id = page_id;
+    }
+    Page *page = shard.pages_ + victim;
+    update_page(shard, lock, page, page_id, victim, true);
+    lock.unlock();
+    stats_.misses.add();
+    stats_.miss_latency.record(stats_now_ns() - start);
+    read_ahead(page_id, true, strategy);
     return page;
 }
 
 /**
- * @description: 取消固定pin_count>0的在缓冲池中的page
+ * @description: 获取页面并加共享锁，返回的守卫析构时自动解锁并unpin。页面锁在释放分片锁之后获取，
+ *              持有页面锁等待时不会阻塞同一分片上的其他页面
+ * @return {ReadPageGuard} 页面的读守卫，获取页面失败时守卫为空（is_valid()为false）
+ * @param {PageId} page_id 需要获取的页的PageId
+ * @param {BufferAccessStrategy*} strategy 访问策略，同fetch_page
+ */
+ReadPageGuard BufferPoolManager::fetch_page_read(PageId page_id, BufferAccessStrategy *strategy) {
+    Page *page = fetch_page(page_id, strategy);
+    if (page == nullptr) {
+        return {};
+    }
+    page->rlatch();
+    return {this, page};
+}
+
+/**
+ * @description: 获取页面并加排他锁，返回的守卫析构时自动解锁并unpin，通过守卫修改过的页面被标记为脏页。
+ *              只读映射的文件不允许获取写守卫
+ * @return {WritePageGuard} 页面的写守卫，获取页面失败时守卫为空（is_valid()为false）
+ * @param {PageId} page_id 需要获取的页的PageId
+ * @param {BufferAccessStrategy*} strategy 访问策略，同fetch_page
+ */
+WritePageGuard BufferPoolManager::fetch_page_write(PageId page_id, BufferAccessStrategy *strategy) {
+    if (mapped_file(page_id.fd) != nullptr) {
+        // 映射文件的页面视图指向只读内存，不能交给写者
+        throw InternalError("BufferPoolManager::fetch_page_write: file is mapped read-only");
+    }
+    Page *page = fetch_page(page_id, strategy);
+    if (page == nullptr) {
+        return {};
+    }
+    page->wlatch();
+    return {this, page};
+}
+
+/**
+ * @description: 创建新页面并加排他锁，新页面在守卫释放时以脏页的状态unpin
+ * @return {WritePageGuard} 新页面的写守卫，创建失败时守卫为空（is_valid()为false）
+ * @param {PageId*} page_id 当成功创建一个新的page时存储其page_id
+ * @param {BufferAccessStrategy*} strategy 访问策略，同new_page
+ */
+WritePageGuard BufferPoolManager::new_page_guarded(PageId *page_id, BufferAccessStrategy *strategy) {
+    Page *page = new_page(page_id, strategy);
+    if (page == nullptr) {
+        return {};
+    }
+    page->wlatch();
+    WritePageGuard guard(this, page);
+    guard.set_dirty();
+    return guard;
+}
+
+/**
+ * @description: 取消固定pin_count>0的在缓冲池中的page。被固定的页面不会被淘汰，
+ *              因此无锁查到的帧中是目标页面时可以直接减少pin_count；帧仍留在replacer中，不需要修改replacer。
+ *              页面由干净变脏时需要加入分片的脏页表，只有这种情况需要获取分片锁
  * @return {bool} 如果目标页的pin_count<=0则返回false，否则返回true
  * @param {PageId} page_id 目标page的page_id
  * @param {bool} is_dirty 若目标page应该被标记为dirty则为true，否则为false
  */
 bool BufferPoolManager::unpin_page(PageId page_id, bool is_dirty) {
-    std::scoped_lock lock{latch_};
-    auto it = page_table_.find(page_id);
-    if (it == page_table_.end()) {
+    if (mapped_file(page_id.fd) != nullptr) {
+        // 只读映射的页面不需要固定
+        return true;
+    }
+    BufferPoolShard &shard = shard_of(page_id);
+    frame_id_t fid;
+    if (lock_free_hits_ && shard.page_table_.find(page_id, &fid) && shard.pages_[fid].id_.load() == page_id) {
+        // 页面被固定期间，其他线程不会清除它的脏页标记
+        Page &page = shard.pages_[fid];
+        if (!is_dirty || page.is_dirty_) {
+            return page.try_unpin(false);
+        }
+    }
+    std::scoped_lock lock{shard.latch_};
+    if (!shard.page_table_.find(page_id, &fid)) {
         return false;
     }
-    Page *page = pages_ + it->second;
+    Page *page = shard.pages_ + fid;
     if (page->pin_count_ <= 0) {
         return false;
     }
-    page->pin_count_--;
-    if (page->pin_count_ == 0) {
-        replacer_->unpin(it->second);
-    }
     if (is_dirty) {
-        page->is_dirty_ = true;
+        mark_dirty(shard, page);
     }
-    return true;
+    return page->try_unpin(false);
 }
 
 /**
- * @description: 将目标页写回磁盘，不考虑当前页面是否正在被使用
+ * @description: 将目标页写回磁盘，不考虑当前页面是否正在被使用。写回时仍被固定的页面保持为脏页。
+ *              与update_page相同，磁盘写入期间帧处于io_in_progress_状态并释放分片锁
  * @return {bool} 成功则返回true，否则返回false(只有page_table_中没有目标页时)
  * @param {PageId} page_id 目标页的page_id，不能为INVALID_PAGE_ID
  */
 bool BufferPoolManager::flush_page(PageId page_id) {
-    std::scoped_lock lock{latch_};
-    auto it = page_table_.find(page_id);
-    if (it == page_table_.end()) {
+    if (mapped_file(page_id.fd) != nullptr) {
+        return true;
+    }
+    uint64_t start = stats_now_ns();
+    BufferPoolShard &shard = shard_of(page_id);
+    std::unique_lock lock{shard.latch_};
+    wait_for_io(shard, lock, page_id);
+    frame_id_t fid;
+    if (!shard.page_table_.find(page_id, &fid)) {
         return false;
     }
-    Page *page = pages_ + it->second;
-    disk_manager_->write_page(page_id.fd, page_id.page_no, page->data_, PAGE_SIZE);
-    page->is_dirty_ = false;
+    Page *page = shard.pages_ + fid;
+    // 与flush_pages相同，先设置I/O标记再检查pin_count_，写回期间无锁的fetch_page无法固定该页面
+    page->io_in_progress_ = true;
+    bool unpinned = page->pin_count_ == 0;
+    lock.unlock();
+    try {
+        AlignedBuffer copy;
+        disk_manager_->write_page(page_id.fd, page_id.page_no, checksummed_data(page, unpinned, &copy),
+                                  page->page_size_);
+    } catch (...) {
+        lock.lock();
+        page->io_in_progress_ = false;
+        shard.io_cv_.notify_all();
+        throw;
+    }
+    lock.lock();
+    if (unpinned && page->is_dirty_) {
+        clear_dirty(shard, page, page_id);
+    }
+    page->io_in_progress_ = false;
+    shard.io_cv_.notify_all();
+    stats_.flushed_pages.add();
+    stats_.flush_latency.record(stats_now_ns() - start);
     return true;
 }
 
 /**
  * @description: 创建一个新的page，即从磁盘中移动一个新建的空page到缓冲池某个位置。
+ *              新页号决定了页面所属的分片，因此在获取分片锁之前分配页号：分配时可能用fallocate预分配文件的区，
+ *              不能阻塞同一分片上的其他访问。分片中没有可用帧时将页号归还给文件的空闲页面，下次分配时重新使用。
+ *              新页号可能是回收的空闲页面，若它仍缓存在缓冲池中则直接复用其帧；若它仍被固定（例如释放之前开始的扫描
+ *              还没有取消固定），则换一个页号，该页号在返回前归还给文件的空闲页面，之后再分配。
  * @return {Page*} 返回新创建的page，若创建失败则返回nullptr
  * @param {PageId*} page_id 当成功创建一个新的page时存储其page_id
+ * @param {BufferAccessStrategy*} strategy 访问策略，批量写入时在其环形缓冲区中复用帧；为nullptr时使用普通的淘汰流程
  */
-Page* BufferPoolManager::new_page(PageId* page_id) {
-    std::scoped_lock lock{latch_};
-    frame_id_t victim;
-    if (!find_victim_page(&victim)) {
-        return nullptr;
+Page* BufferPoolManager::new_page(PageId* page_id, BufferAccessStrategy *strategy) {
+    if (mapped_file(page_id->fd) != nullptr) {
+        throw InternalError("BufferPoolManager::new_page: file is mapped read-only");
     }
-    Page *page = pages_ + victim;
     PageId new_id;
     new_id.fd = page_id->fd;
-    new_id.page_no = disk_manager_->allocate_page(new_id.fd);
-    update_page(page, new_id, victim);
-    page->pin_count_ = 1;
-    page->is_dirty_ = true;
-    replacer_->pin(victim);
+    std::vector<page_id_t> pinned_pages;    // 仍被固定而跳过的回收页面
+    auto return_pinned_pages = [&]() {
+        for (auto it = pinned_pages.rbegin(); it != pinned_pages.rend(); ++it) {
+            disk_manager_->deallocate_page(new_id.fd, *it);
+        }
+    };
+    size_t shard_idx;
+    std::unique_lock<std::mutex> lock;
+    while (true) {
+        new_id.page_no = disk_manager_->allocate_page(new_id.fd);
+        shard_idx = shard_index(new_id);
+        BufferPoolShard &shard = *shards_[shard_idx];
+        lock = std::unique_lock{shard.latch_};
+        wait_for_io(shard, lock, new_id);
+        frame_id_t fid;
+        if (!shard.page_table_.find(new_id, &fid)) {
+            break;
+        }
+        // 回收的页面仍在缓冲池中：上层释放页面前已取消固定，内容作废，重新清零即可
+        Page *page = shard.pages_ + fid;
+        if (page->try_claim()) {
+            page->read_ahead_marker_ = false;
+            page->reset_memory();
+            mark_dirty(shard, page);
+            page->pin_count_ = 1;
+            lock.unlock();
+            return_pinned_pages();
+            *page_id = new_id;
+            return page;
+        }
+        lock.unlock();
+        pinned_pages.push_back(new_id.page_no);
+    }
+    BufferPoolShard &shard = *shards_[shard_idx];
+    BufferAccessStrategy::RingSlot *slot = strategy != nullptr ? strategy->next_slot(shard_idx) : nullptr;
+    frame_id_t victim;
+    while (!find_victim_page(shard, &victim, slot)) {
+        if (!io_pending(shard)) {
+            lock.unlock();
+            disk_manager_->deallocate_page(new_id.fd, new_id.page_no);
+            return_pinned_pages();
+            return nullptr;
+        }
+        shard.io_cv_.wait(lock);
+    }
+    if (slot != nullptr) {
+        slot->frame_id = victim;
+        slot->page_id = new_id;
+    }
+    Page *page = shard.pages_ + victim;
+    try {
+        update_page(shard, lock, page, new_id, victim, false);
+    } catch (...) {
+        // 被淘汰的脏页写回失败，新页号没有被使用，归还给文件的空闲页面
+        disk_manager_->deallocate_page(new_id.fd, new_id.page_no);
+        return_pinned_pages();
+        throw;
+    }
+    mark_dirty(shard, page);
+    lock.unlock();
+    return_pinned_pages();
     *page_id = new_id;
     return page;
 }
 
 /**
- * @description: 从buffer_pool删除目标页
+ * @description: 从buffer_pool删除目标页，脏页先写回磁盘，写回期间帧处于io_in_progress_状态并释放分片锁
  * @return {bool} 如果目标页不存在于buffer_pool或者成功被删除则返回true，若其存在于buffer_pool但无法删除则返回false
  * @param {PageId} page_id 目标页
  */
 bool BufferPoolManager::delete_page(PageId page_id) {
-    std::scoped_lock lock{latch_};
-    auto it = page_table_.find(page_id);
-    if (it == page_table_.end()) {
+    if (mapped_file(page_id.fd) != nullptr) {
+        return true;
+    }
+    BufferPoolShard &shard = shard_of(page_id);
+    std::unique_lock lock{shard.latch_};
+    wait_for_io(shard, lock, page_id);
+    frame_id_t fid;
+    if (!shard.page_table_.find(page_id, &fid)) {
         return true;
     }
-    Page *page = pages_ + it->second;
-    if (page->pin_count_ > 0) {
+    Page *page = shard.pages_ + fid;
+    if (!page->try_claim()) {
         return false;
     }
-    replacer_->pin(it->second);
+    shard.replacer_->pin(fid);
     if (page->is_dirty_) {
-        disk_manager_->write_page(page_id.fd, page_id.page_no, page->data_, PAGE_SIZE);
+        page->io_in_progress_ = true;
+        lock.unlock();
+        try {
+            disk_manager_->write_page(page_id.fd, page_id.page_no, checksummed_data(page, true, nullptr),
+                                      page->page_size_);
+        } catch (...) {
+            // 写回失败，页面仍然有效且为脏页，放回replacer
+            lock.lock();
+            page->io_in_progress_ = false;
+            page->pin_count_ = 0;
+            shard.replacer_->unpin(fid);
+            shard.io_cv_.notify_all();
+            throw;
+        }
+        lock.lock();
+        page->io_in_progress_ = false;
+        clear_dirty(shard, page, page_id);
+        shard.io_cv_.notify_all();
     }
-    page_table_.erase(it);
+    shard.page_table_.erase(page_id);
     page->reset_memory();
-    page->id_.page_no = INVALID_PAGE_ID;
-    page->id_.fd = page_id.fd;
-    page->is_dirty_ = false;
+    page->id_ = {.fd = page_id.fd, .page_no = INVALID_PAGE_ID};
+    page->read_ahead_marker_ = false;
     page->pin_count_ = 0;
-    free_list_.push_back(static_cast<frame_id_t>(page - pages_));
+    free_frame(shard, fid);
     return true;
 }
 
 /**
- * @description: 将buffer_pool中的所有页写回到磁盘
+ * @description: 将buffer_pool中属于指定文件的所有脏页写回到磁盘
  * @param {int} fd 文件句柄
  */
 void BufferPoolManager::flush_all_pages(int fd) {
-    std::scoped_lock lock{latch_};
-    for (auto &entry : page_table_) {
-        if (entry.first.fd == fd) {
-            PageId pid = entry.first;
-            Page *page = pages_ + entry.second;
-            disk_manager_->write_page(pid.fd, pid.page_no, page->data_, PAGE_SIZE);
-            page->is_dirty_ = false;
+    // 文件即将关闭，取消该文件上尚未完成的预读
+    drain_read_ahead(fd);
+    flush_pages(fd);
+}
+
+/**
+ * @description: 将buffer_pool中所有文件的脏页写回到磁盘，用于检查点
+ */
+void BufferPoolManager::flush_all_pages() {
+    flush_pages(-1);
+}
+
+/**
+ * @description: 返回缓冲池当前的脏页表，用于检查点记录和故障恢复的分析阶段
+ * @return {vector<PageId>} 所有脏页
+ * @note 页面的修改目前不写日志，页面LSN不被维护，因此脏页表不记录recLSN；
+ *       页面修改开始写日志后，由写日志的调用者在标记脏页时提供recLSN
+ */
+std::vector<PageId> BufferPoolManager::get_dirty_page_table() {
+    std::vector<PageId> entries;
+    for (auto &shard : shards_) {
+        std::scoped_lock lock{shard->latch_};
+        for (auto &[fd, page_nos] : shard->dirty_pages_) {
+            for (page_id_t page_no : page_nos) {
+                entries.push_back({.fd = fd, .page_no = page_no});
+            }
+        }
+    }
+    return entries;
+}
+
+/**
+ * @description: 将页面标记为脏页，页面原本是干净的时加入分片的脏页表，调用者需持有shard.latch_，
+ *              且页面已被固定或占用
+ * @param {BufferPoolShard&} shard 页面所在的分片
+ * @param {Page*} page 目标页面
+ */
+void BufferPoolManager::mark_dirty(BufferPoolShard &shard, Page *page) {
+    if (page->is_dirty_) {
+        return;
+    }
+    PageId page_id = page->get_page_id();
+    shard.dirty_pages_[page_id.fd].insert(page_id.page_no);
+    page->is_dirty_ = true;
+}
+
+/**
+ * @description: 页面写回后清除脏页标记并将其移出分片的脏页表，调用者需持有shard.latch_
+ * @param {BufferPoolShard&} shard 页面所在的分片
+ * @param {Page*} page 目标页面
+ * @param {PageId&} page_id 写回的页面，帧正在被替换时可能与page->id_不同
+ */
+void BufferPoolManager::clear_dirty(BufferPoolShard &shard, Page *page, const PageId &page_id) {
+    auto it = shard.dirty_pages_.find(page_id.fd);
+    if (it != shard.dirty_pages_.end()) {
+        it->second.erase(page_id.page_no);
+        if (it->second.empty()) {
+            shard.dirty_pages_.erase(it);
+        }
+    }
+    page->is_dirty_ = false;
+}
+
+/**
+ * @description: 分片中是否有属于fd的脏页正在进行I/O（淘汰或后台写回），调用者需持有shard.latch_
+ * @param {BufferPoolShard&} shard 目标分片
+ * @param {int} fd 文件句柄，为-1时检查所有文件
+ */
+bool BufferPoolManager::dirty_io_pending(BufferPoolShard &shard, int fd) const {
+    for (auto &[file, page_nos] : shard.dirty_pages_) {
+        if (fd != -1 && file != fd) {
+            continue;
+        }
+        for (page_id_t page_no : page_nos) {
+            frame_id_t fid;
+            if (shard.page_table_.find({.fd = file, .page_no = page_no}, &fid) && shard.pages_[fid].io_in_progress_) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+/**
+ * @description: 将文件的脏页写回到磁盘。只遍历各分片的脏页表：先等待这些脏页上进行中的I/O结束，将它们标记为io_in_progress_，
+ *              然后释放分片锁，按文件分组、按页号排序后用DiskManager::write_pages批量写回，页号连续的页面合并为一次系统调用。
+ *              写回期间仍被固定的页面可能被继续修改，因此写回后仍保持为脏页
+ * @param {int} fd 文件句柄，为-1时写回所有文件的脏页
+ */
+void BufferPoolManager::flush_pages(int fd) {
+    struct FlushItem {
+        Page *page;
+        BufferPoolShard *shard;
+        bool unpinned;  // 标记时未被固定，写回期间不会被修改
+    };
+    uint64_t start = stats_now_ns();
+    std::vector<FlushItem> items;
+    for (auto &shard : shards_) {
+        std::unique_lock lock{shard->latch_};
+        // 等待这些脏页上所有进行中的写回结束，保证返回后可以安全地关闭文件
+        shard->io_cv_.wait(lock, [this, &shard, fd] { return !dirty_io_pending(*shard, fd); });
+        for (auto &[file, page_nos] : shard->dirty_pages_) {
+            if (fd != -1 && file != fd) {
+                continue;
+            }
+            for (page_id_t page_no : page_nos) {
+                frame_id_t fid;
+                [[maybe_unused]] bool found = shard->page_table_.find({.fd = file, .page_no = page_no}, &fid);
+                assert(found);
+                Page *page = shard->pages_ + fid;
+                // 先设置I/O标记再检查pin_count_，之后无锁的fetch_page看到标记会退回加锁路径
+                page->io_in_progress_ = true;
+                items.push_back({page, shard.get(), page->pin_count_ == 0});
+            }
+        }
+    }
+    std::sort(items.begin(), items.end(), [](const FlushItem &a, const FlushItem &b) {
+        PageId x = a.page->get_page_id(), y = b.page->get_page_id();
+        return x.fd != y.fd ? x.fd < y.fd : x.page_no < y.page_no;
+    });
+
+    std::vector<bool> written(items.size(), false);
+    std::exception_ptr error;
+    std::vector<page_id_t> page_nos;
+    std::vector<const char *> bufs;
+    std::vector<AlignedBuffer> copies(items.size());
+    for (size_t begin = 0, end; begin < items.size(); begin = end) {
+        int fd = items[begin].page->get_page_id().fd;
+        page_nos.clear();
+        bufs.clear();
+        for (end = begin; end < items.size() && items[end].page->get_page_id().fd == fd; end++) {
+            page_nos.push_back(items[end].page->get_page_id().page_no);
+            bufs.push_back(checksummed_data(items[end].page, items[end].unpinned, &copies[end]));
+        }
+        try {
+            disk_manager_->write_pages(fd, page_nos.data(), bufs.data(), static_cast<int>(page_nos.size()));
+            std::fill(written.begin() + begin, written.begin() + end, true);
+        } catch (...) {
+            error = std::current_exception();
+        }
+    }
+
+    for (size_t i = 0; i < items.size(); i++) {
+        std::scoped_lock lock{items[i].shard->latch_};
+        Page *page = items[i].page;
+        if (written[i] && items[i].unpinned) {
+            clear_dirty(*items[i].shard, page, page->get_page_id());
         }
+        page->io_in_progress_ = false;
+        items[i].shard->io_cv_.notify_all();
+    }
+    stats_.flushed_pages.add(std::count(written.begin(), written.end(), true));
+    stats_.flush_latency.record(stats_now_ns() - start);
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+/**
+ * @description: 后台写回一遍各分片中即将被淘汰的脏页，使淘汰窗口内的帧尽量保持干净
+ * @return {size_t} 本次写回的页面数
+ */
+size_t BufferPoolManager::write_back_cold_pages() {
+    auto aio = disk_manager_->create_async_io();
+    return write_back_cold_pages(*aio);
+}
+
+/**
+ * @description: 写回各分片淘汰窗口内的脏页。先在各分片中将这些脏页标记为io_in_progress_（它们仍留在replacer中以保持淘汰顺序），
+ *              释放分片锁后通过异步I/O上下文同时提交多个写请求，全部完成后再清除脏页标记
+ * @return {size_t} 写回的页面数
+ * @param {AsyncIO&} aio 异步I/O上下文
+ */
+size_t BufferPoolManager::write_back_cold_pages(AsyncIO &aio) {
+    struct WriteBackItem {
+        Page *page;
+        BufferPoolShard *shard;
+    };
+    std::vector<WriteBackItem> batch;
+    std::vector<frame_id_t> frames;
+    for (auto &shard : shards_) {
+        std::scoped_lock lock{shard->latch_};
+        frames.clear();
+        shard->replacer_->candidates(&frames, clean_window(*shard));
+        for (frame_id_t fid : frames) {
+            Page *page = shard->pages_ + fid;
+            if (!page->is_dirty_ || page->io_in_progress_) {
+                continue;
+            }
+            // 被固定的帧也留在replacer中；先设置I/O标记再检查pin_count_，避免与无锁的fetch_page同时成功
+            page->io_in_progress_ = true;
+            if (page->pin_count_ == 0) {
+                batch.push_back({page, shard.get()});
+            } else {
+                page->io_in_progress_ = false;
+            }
+        }
+    }
+    if (batch.empty()) {
+        return 0;
+    }
+
+    std::vector<bool> done(batch.size(), false);
+    std::vector<AsyncIOCompletion> completions;
+    size_t next = 0;
+    try {
+        while (next < batch.size() || aio.in_flight() > 0) {
+            while (next < batch.size() &&
+                   aio.prep_write(batch[next].page->get_page_id().fd, batch[next].page->get_page_id().page_no,
+                                  checksummed_data(batch[next].page, true, nullptr), next)) {
+                next++;
+            }
+            aio.submit();
+            completions.clear();
+            aio.wait(&completions, 1);
+            for (auto &completion : completions) {
+                // 写回失败的页面保持为脏页，留待淘汰时再次写回
+                done[completion.user_data] = completion.result == 0;
+            }
+        }
+    } catch (UniBaseError &e) {
+        // 异步I/O上下文出错，没有确认完成的页面保持为脏页
+    }
+
+    size_t written = 0;
+    for (size_t i = 0; i < batch.size(); ++i) {
+        std::scoped_lock lock{batch[i].shard->latch_};
+        if (done[i]) {
+            clear_dirty(*batch[i].shard, batch[i].page, batch[i].page->get_page_id());
+            written++;
+        }
+        batch[i].page->io_in_progress_ = false;
+        batch[i].shard->io_cv_.notify_all();
+    }
+    stats_.background_writes.add(written);
+    return written;
+}
+
+/**
+ * @description: 启动后台写线程，每隔interval（或在淘汰遇到脏页时）写回一遍即将被淘汰的脏页
+ * @param {milliseconds} interval 后台写线程的唤醒间隔
+ */
+void BufferPoolManager::start_background_writer(std::chrono::milliseconds interval) {
+    if (bg_writer_.joinable()) {
+        return;
+    }
+    bg_stop_ = false;
+    bg_writer_ = std::thread([this, interval] {
+        // 后台写线程独占一个异步I/O上下文，一次写回可以同时进行多个写请求
+        auto aio = disk_manager_->create_async_io();
+        std::unique_lock lock{bg_latch_};
+        while (!bg_stop_) {
+            lock.unlock();
+            write_back_cold_pages(*aio);
+            lock.lock();
+            bg_cv_.wait_for(lock, interval, [this] { return bg_stop_; });
+        }
+    });
+}
+
+/**
+ * @description: 停止后台写线程
+ */
+void BufferPoolManager::stop_background_writer() {
+    if (!bg_writer_.joinable()) {
+        return;
+    }
+    {
+        std::scoped_lock lock{bg_latch_};
+        bg_stop_ = true;
+    }
+    bg_cv_.notify_all();
+    bg_writer_.join();
+}
+
+/**
+ * @description: 汇总缓冲池和磁盘I/O的统计，用于SHOW BUFFER STATUS和定期输出。
+ *              计数器和直方图不加锁读取，是近似的快照；驻留页面数和脏页数逐个分片加锁统计
+ * @return {BufferPoolStatus} 各项指标和每个已打开文件的页面读写次数
+ */
+BufferPoolStatus BufferPoolManager::get_status() {
+    size_t resident = 0;
+    size_t dirty = 0;
+    for (auto &shard : shards_) {
+        std::scoped_lock lock{shard->latch_};
+        resident += shard->page_table_.size();
+        for (auto &[fd, page_nos] : shard->dirty_pages_) {
+            dirty += page_nos.size();
+        }
+    }
+    uint64_t hits = stats_.hits.load();
+    uint64_t misses = stats_.misses.load();
+    LatencySnapshot hit_latency = stats_.hit_latency.snapshot();
+    LatencySnapshot miss_latency = stats_.miss_latency.snapshot();
+    LatencySnapshot flush_latency = stats_.flush_latency.snapshot();
+    LatencySnapshot read_latency = disk_manager_->get_read_latency();
+    LatencySnapshot write_latency = disk_manager_->get_write_latency();
+    auto fixed = [](double value, int precision) {
+        std::ostringstream os;
+        os << std::fixed << std::setprecision(precision) << value;
+        return os.str();
+    };
+
+    BufferPoolStatus status;
+    status.metrics = {
+        {"pool_size", std::to_string(get_pool_size())},
+        {"max_pool_size", std::to_string(get_max_pool_size())},
+        {"resident_pages", std::to_string(resident)},
+        {"dirty_pages", std::to_string(dirty)},
+        {"hits", std::to_string(hits)},
+        {"misses", std::to_string(misses)},
+        {"hit_ratio", fixed(hits + misses == 0 ? 0 : static_cast<double>(hits) / (hits + misses), 4)},
+        {"hit_p50_us", fixed(hit_latency.percentile_us(0.5), 3)},
+        {"hit_p99_us", fixed(hit_latency.percentile_us(0.99), 3)},
+        {"miss_avg_us", fixed(miss_latency.mean_us(), 3)},
+        {"miss_p99_us", fixed(miss_latency.percentile_us(0.99), 3)},
+        {"evict_clean", std::to_string(stats_.evictions_clean.load())},
+        {"evict_dirty", std::to_string(stats_.evictions_dirty.load())},
+        {"bg_writes", std::to_string(stats_.background_writes.load())},
+        {"flushed_pages", std::to_string(stats_.flushed_pages.load())},
+        {"flush_p99_us", fixed(flush_latency.percentile_us(0.99), 3)},
+        {"prefetch_pages", std::to_string(stats_.prefetched_pages.load())},
+        {"checksum_errors", std::to_string(stats_.checksum_failures.load())},
+        {"scrubbed_pages", std::to_string(stats_.scrubbed_pages.load())},
+        {"disk_reads", std::to_string(disk_manager_->get_num_page_reads())},
+        {"disk_writes", std::to_string(disk_manager_->get_num_page_writes())},
+        {"read_p99_us", fixed(read_latency.percentile_us(0.99), 3)},
+        {"write_p99_us", fixed(write_latency.percentile_us(0.99), 3)},
+    };
+    status.files = disk_manager_->get_file_stats();
+    return status;
+}
+
+/**
+ * @description: 启动统计输出线程，每隔interval将get_status()的结果连同时间戳追加到path
+ * @param {string&} path 输出文件的路径
+ * @param {milliseconds} interval 输出的间隔
+ */
+void BufferPoolManager::start_stats_dump(const std::string &path, std::chrono::milliseconds interval) {
+    if (stats_dumper_.joinable()) {
+        return;
+    }
+    stats_dump_stop_ = false;
+    stats_dumper_ = std::thread([this, path, interval] {
+        std::unique_lock lock{stats_dump_latch_};
+        while (!stats_dump_cv_.wait_for(lock, interval, [this] { return stats_dump_stop_; })) {
+            lock.unlock();
+            std::time_t now = std::time(nullptr);
+            std::tm tm{};
+            localtime_r(&now, &tm);
+            std::ofstream out(path, std::ios::app);
+            out << "==== " << std::put_time(&tm, "%Y-%m-%d %H:%M:%S") << " ====\n" << get_status().to_string();
+            lock.lock();
+        }
+    });
+}
+
+/**
+ * @description: 停止统计输出线程
+ */
+void BufferPoolManager::stop_stats_dump() {
+    if (!stats_dumper_.joinable()) {
+        return;
+    }
+    {
+        std::scoped_lock lock{stats_dump_latch_};
+        stats_dump_stop_ = true;
+    }
+    stats_dump_cv_.notify_all();
+    stats_dumper_.join();
+}
+
+/**
+ * @description: 检测对文件的顺序访问并发起预读。
+ *              未命中的页面紧接在上一次检测的页面或已预读范围之后时，视为顺序访问，预读其后的window个页面；
+ *              访问到预读窗口的第一个页面（预读标记）时，发起下一个窗口的预读，窗口大小随之翻倍，直到上限。
+ *              已预读的页面在被访问之前就被淘汰而再次未命中时，说明窗口相对扫描速度过大，窗口减半；
+ *              未命中的页面还在排队中的预读请求里时，说明扫描快于预读线程，由调用者直接完成该请求
+ * @param {PageId} page_id 被访问的页面
+ * @param {bool} miss 页面是否未命中（否则为命中预读标记）
+ * @param {BufferAccessStrategy*} strategy 访问页面时使用的访问策略，预读的页面同样放入其环形缓冲区
+ */
+void BufferPoolManager::read_ahead(PageId page_id, bool miss, BufferAccessStrategy *strategy) {
+    if (!ra_enabled_.load(std::memory_order_relaxed)) {
+        return;
+    }
+    int max_window = READ_AHEAD_MAX_PAGES;
+    if (strategy != nullptr) {
+        // 环形缓冲区需要同时容纳正在扫描的窗口和下一个窗口
+        max_window = std::min<int>(max_window, std::max<size_t>(1, strategy->ring_capacity() / 2));
+    }
+    std::unique_lock lock{ra_latch_};
+    ReadAheadState &state = ra_states_[page_id.fd];
+    page_id_t start;
+    if (miss) {
+        bool in_window = state.window > 0 && page_id.page_no > state.last_page_no && page_id.page_no < state.ahead_end;
+        if (in_window) {
+            auto it = std::find_if(ra_queue_.begin(), ra_queue_.end(), [&page_id](const ReadAheadRequest &req) {
+                return req.start.fd == page_id.fd && page_id.page_no >= req.start.page_no &&
+                       page_id.page_no < req.start.page_no + req.num_pages;
+            });
+            if (it != ra_queue_.end()) {
+                // 扫描快于预读线程，由调用者直接完成这个请求中剩余的部分，避免预读线程之后重复读入
+                ReadAheadRequest req = std::move(*it);
+                ra_queue_.erase(it);
+                lock.unlock();
+                int end = req.start.page_no + req.num_pages;
+                prefetch_pages({page_id.fd, page_id.page_no + 1}, end - page_id.page_no - 1, req.strategy.get());
+                return;
+            }
+            state.window = std::max(READ_AHEAD_MIN_PAGES, state.window / 2);
+            start = std::max(state.ahead_end, page_id.page_no + 1);
+        } else if (page_id.page_no == state.last_page_no + 1 ||
+                   (state.window > 0 && page_id.page_no == state.ahead_end)) {
+            state.window = state.window == 0 ? READ_AHEAD_MIN_PAGES : std::min(state.window * 2, max_window);
+            start = page_id.page_no + 1;
+        } else {
+            // 随机访问，重置检测状态
+            state.last_page_no = page_id.page_no;
+            state.ahead_end = INVALID_PAGE_ID;
+            state.window = 0;
+            return;
+        }
+    } else {
+        if (state.window == 0) {
+            return;
+        }
+        state.window = std::min(state.window * 2, max_window);
+        start = std::max(state.ahead_end, page_id.page_no + 1);
+    }
+    state.window = std::min(state.window, max_window);
+    state.last_page_no = page_id.page_no;
+    int num_pages = std::min(state.window, disk_manager_->get_fd2pageno(page_id.fd) - start);
+    if (num_pages <= 0) {
+        return;
+    }
+    state.ahead_end = start + num_pages;
+    ra_queue_.push_back({{page_id.fd, start}, num_pages, strategy != nullptr ? strategy->shared_from_this() : nullptr});
+    ra_cv_.notify_all();
+}
+
+/**
+ * @description: 将从start开始的至多num_pages个连续页面读入缓冲池，预读的页面处于未固定状态。
+ *              跳过开头已在缓冲池中的页面，遇到下一个已在缓冲池中的页面或没有干净的帧可用时停止，
+ *              剩余的连续页面用一次向量读读入。预读不会为腾出帧而写回脏页
+ * @return {int} 实际读入的页面个数
+ * @param {PageId} start 第一个页面
+ * @param {int} num_pages 最多读入的页面个数
+ * @param {BufferAccessStrategy*} strategy 访问策略，预读的页面放入其环形缓冲区；为nullptr时使用普通的淘汰流程
+ */
+int BufferPoolManager::prefetch_pages(PageId start, int num_pages, BufferAccessStrategy *strategy) {
+    if (MappedFile *mapped = mapped_file(start.fd)) {
+        num_pages = std::max(0, std::min(num_pages, mapped->num_pages - start.page_no));
+        disk_manager_->advise_mapping(mapped->addr, static_cast<size_t>(start.page_no) * mapped->page_size,
+                                      static_cast<size_t>(num_pages) * mapped->page_size, MADV_WILLNEED);
+        return num_pages;
+    }
+    num_pages = std::min(num_pages, disk_manager_->get_fd2pageno(start.fd) - start.page_no);
+    std::vector<Page *> pages;
+    std::vector<char *> bufs;
+    for (int i = 0; i < num_pages; i++) {
+        PageId page_id{start.fd, start.page_no + static_cast<page_id_t>(pages.size())};
+        size_t shard_idx = shard_index(page_id);
+        BufferPoolShard &shard = *shards_[shard_idx];
+        std::scoped_lock lock{shard.latch_};
+        if (shard.page_table_.contains(page_id)) {
+            if (!pages.empty()) {
+                break;
+            }
+            start.page_no++;
+            continue;
+        }
+        BufferAccessStrategy::RingSlot *slot = strategy != nullptr ? strategy->next_slot(shard_idx) : nullptr;
+        frame_id_t frame_id;
+        if (!find_victim_page(shard, &frame_id, slot, true)) {
+            break;
+        }
+        // 帧在读入完成前保持被占用，无锁的fetch_page无法固定它
+        Page *page = shard.pages_ + frame_id;
+        if (page->get_page_id().page_no != INVALID_PAGE_ID) {
+            shard.page_table_.erase(page->get_page_id());
+            stats_.evictions_clean.add();
+        }
+        page->id_ = page_id;
+        page->is_dirty_ = false;
+        page->referenced_ = false;
+        page->io_in_progress_ = true;
+        page->read_ahead_marker_ = pages.empty();
+        shard.page_table_.insert(page_id, frame_id);
+        if (slot != nullptr) {
+            slot->frame_id = frame_id;
+            slot->page_id = page_id;
+        }
+        pages.push_back(page);
+        bufs.push_back(page->data_);
+    }
+    if (pages.empty()) {
+        return 0;
+    }
+
+    std::exception_ptr error;
+    try {
+        disk_manager_->read_pages(start.fd, start.page_no, bufs.data(), static_cast<int>(pages.size()));
+    } catch (...) {
+        error = std::current_exception();
+    }
+    int num_read = 0;
+    for (Page *page : pages) {
+        PageId page_id = page->get_page_id();
+        // 校验和不一致的页面不放入缓冲池，之后访问它时由fetch_page重新读取并报告错误
+        bool valid = !error && (!verify_checksums_ || !disk_manager_->has_page_checksums(page_id.fd) ||
+                                verify_page_checksum(page->data_, page->page_size_, page_id.page_no));
+        BufferPoolShard &shard = shard_of(page_id);
+        std::scoped_lock lock{shard.latch_};
+        frame_id_t frame_id = static_cast<frame_id_t>(page - shard.pages_);
+        if (!valid) {
+            shard.page_table_.erase(page_id);
+            page->id_ = {.fd = page_id.fd, .page_no = INVALID_PAGE_ID};
+            page->read_ahead_marker_ = false;
+            page->pin_count_ = 0;
+            page->io_in_progress_ = false;
+            free_frame(shard, frame_id);
+        } else {
+            page->pin_count_ = 0;
+            page->io_in_progress_ = false;
+            shard.replacer_->unpin(frame_id);
+            num_read++;
+        }
+        shard.io_cv_.notify_all();
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+    stats_.prefetched_pages.add(num_read);
+    return num_read;
+}
+
+/**
+ * @description: 取消文件上排队中的预读请求，并等待预读线程处理完该文件上正在进行的请求
+ * @param {int} fd 文件句柄
+ */
+void BufferPoolManager::drain_read_ahead(int fd) {
+    std::unique_lock lock{ra_latch_};
+    ra_queue_.erase(std::remove_if(ra_queue_.begin(), ra_queue_.end(),
+                                   [fd](const ReadAheadRequest &req) { return req.start.fd == fd; }),
+                    ra_queue_.end());
+    ra_states_.erase(fd);
+    ra_cv_.wait(lock, [this, fd] { return ra_inflight_fd_ != fd; });
+}
+
+/**
+ * @description: 启动预读线程，之后fetch_page会检测顺序访问并将预读请求交给该线程异步完成
+ */
+void BufferPoolManager::start_read_ahead() {
+    if (ra_worker_.joinable()) {
+        return;
+    }
+    ra_stop_ = false;
+    ra_enabled_ = true;
+    ra_worker_ = std::thread([this] {
+        std::unique_lock lock{ra_latch_};
+        while (true) {
+            ra_cv_.wait(lock, [this] { return ra_stop_ || !ra_queue_.empty(); });
+            if (ra_stop_) {
+                break;
+            }
+            ReadAheadRequest req = std::move(ra_queue_.front());
+            ra_queue_.pop_front();
+            ra_inflight_fd_ = req.start.fd;
+            lock.unlock();
+            try {
+                prefetch_pages(req.start, req.num_pages, req.strategy.get());
+            } catch (UniBaseError &e) {
+                // 预读失败不影响正确性，之后访问这些页面时会同步读取
+            }
+            req.strategy.reset();
+            lock.lock();
+            ra_inflight_fd_ = -1;
+            ra_cv_.notify_all();
+        }
+    });
+}
+
+/**
+ * @description: 停止预读线程，丢弃尚未处理的预读请求
+ */
+void BufferPoolManager::stop_read_ahead() {
+    if (!ra_worker_.joinable()) {
+        return;
+    }
+    {
+        std::scoped_lock lock{ra_latch_};
+        ra_stop_ = true;
+        ra_enabled_ = false;
+        ra_queue_.clear();
+        ra_states_.clear();
+    }
+    ra_cv_.notify_all();
+    ra_worker_.join();
+}
+
+/**
+ * @description: 在线调整缓冲池的大小，不需要停止访问缓冲池的其他线程。各大小类别按构造时的比例一起调整，逐个分片进行，
+ *              同一时刻只阻塞一个分片上需要加锁的操作。扩大时新的帧直接加入分片的free_list；缩小时编号靠后的帧退役：
+ *              空闲的帧移出free_list，缓存着页面的帧在未被固定时淘汰（脏页先写回），仍被固定的帧等待其被取消固定后再淘汰，
+ *              全部淘汰后将这些帧的内存归还给操作系统
+ * @param {size_t} pool_size 默认大小类别（PAGE_SIZE）的新的总帧数，不能小于分片个数，也不能超过get_max_pool_size()
+ * @param {milliseconds} timeout 缩小时等待被固定的帧的总时长，超时抛出BufferPoolResizeTimeoutError
+ * @note 写回失败或等待超时时，正在调整的分片恢复原来的大小并抛出异常，已调整的分片保持新的大小
+ */
+void BufferPoolManager::resize(size_t pool_size, std::chrono::milliseconds timeout) {
+    std::scoped_lock resize_lock{resize_latch_};
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    const SizeClass &default_class = size_classes_[0];
+    if (pool_size < default_class.num_shards || pool_size > default_class.capacity) {
+        throw InvalidBufferPoolSizeError(pool_size, default_class.num_shards, default_class.capacity);
+    }
+    for (int i = 0; i < NUM_PAGE_SIZE_CLASSES; ++i) {
+        SizeClass &size_class = size_classes_[i];
+        size_t class_size = std::clamp(class_pool_size(pool_size, i), size_class.num_shards, size_class.capacity);
+        try {
+            for (size_t j = 0; j < size_class.num_shards; ++j) {
+                resize_shard(*shards_[size_class.first_shard + j],
+                             shard_pool_size(class_size, size_class.num_shards, j), deadline);
+            }
+        } catch (...) {
+            // 部分分片已经调整，按各分片的实际大小更新类别的帧数
+            size_t resized = 0;
+            for (size_t j = 0; j < size_class.num_shards; ++j) {
+                BufferPoolShard &shard = *shards_[size_class.first_shard + j];
+                std::scoped_lock lock{shard.latch_};
+                resized += shard.pool_size_;
+            }
+            size_class.pool_size = resized;
+            throw;
+        }
+        size_class.pool_size = class_size;
+    }
+}
+
+/**
+ * @description: 调整一个分片的可用帧数，见resize
+ * @param {BufferPoolShard&} shard 目标分片
+ * @param {size_t} pool_size 分片新的可用帧数，不超过shard.capacity_
+ * @param {time_point} deadline 缩小时等待被固定的帧的截止时间
+ */
+void BufferPoolManager::resize_shard(BufferPoolShard &shard, size_t pool_size,
+                                     std::chrono::steady_clock::time_point deadline) {
+    std::unique_lock lock{shard.latch_};
+    size_t old_size = shard.pool_size_;
+    if (pool_size >= old_size) {
+        shard.pool_size_ = pool_size;
+        add_frames(shard, old_size, pool_size);
+        return;
+    }
+    // 先缩小可用范围，之后退役的帧不会再被find_victim_page选中，也不会再回到free_list
+    shard.pool_size_ = pool_size;
+    shard.free_list_.remove_if([pool_size](frame_id_t fid) { return static_cast<size_t>(fid) >= pool_size; });
+    try {
+        while (true) {
+            bool drained = true;
+            for (size_t i = pool_size; i < old_size; ++i) {
+                frame_id_t fid = static_cast<frame_id_t>(i);
+                Page *page = shard.pages_ + fid;
+                PageId page_id = page->get_page_id();
+                if (page_id.page_no == INVALID_PAGE_ID) {
+                    // 空闲的帧可能正被查到过期页表项的线程短暂固定，或正在读入退役前分配给它的页面
+                    drained = drained && page->pin_count_ == 0 && !page->io_in_progress_;
+                    continue;
+                }
+                // 与淘汰相同，占用后的帧不会再被无锁地固定
+                if (page->io_in_progress_ || !page->try_claim()) {
+                    drained = false;
+                    continue;
+                }
+                shard.replacer_->pin(fid);
+                (page->is_dirty_ ? stats_.evictions_dirty : stats_.evictions_clean).add();
+                if (page->is_dirty_) {
+                    page->io_in_progress_ = true;
+                    lock.unlock();
+                    try {
+                        disk_manager_->write_page(page_id.fd, page_id.page_no, checksummed_data(page, true, nullptr),
+                                                  page->page_size_);
+                    } catch (...) {
+                        // 写回失败，页面仍然有效且为脏页，放回replacer
+                        lock.lock();
+                        page->io_in_progress_ = false;
+                        page->pin_count_ = 0;
+                        shard.replacer_->unpin(fid);
+                        shard.io_cv_.notify_all();
+                        throw;
+                    }
+                    lock.lock();
+                    clear_dirty(shard, page, page_id);
+                }
+                shard.page_table_.erase(page_id);
+                page->id_ = {.fd = page_id.fd, .page_no = INVALID_PAGE_ID};
+                page->read_ahead_marker_ = false;
+                page->referenced_ = false;
+                page->io_in_progress_ = false;
+                page->pin_count_ = 0;
+                shard.io_cv_.notify_all();
+            }
+            if (drained) {
+                break;
+            }
+            if (std::chrono::steady_clock::now() >= deadline) {
+                throw BufferPoolResizeTimeoutError();
+            }
+            // 固定页面的线程取消固定时不会通知，定期重新检查
+            shard.io_cv_.wait_for(lock, std::chrono::milliseconds(1));
+        }
+    } catch (...) {
+        shard.pool_size_ = old_size;
+        add_frames(shard, pool_size, old_size);
+        throw;
+    }
+    arena_->release(shard.frames_ + pool_size * shard.page_size_, (old_size - pool_size) * shard.page_size_);
+}
+
+/**
+ * @description: 将分片中编号在[begin, end)之间的空闲帧加入free_list，用于扩大分片，调用者需持有shard.latch_。
+ *              缩小失败而仍缓存着页面的帧已经在replacer中，不需要处理
+ * @param {BufferPoolShard&} shard 目标分片
+ * @param {size_t} begin 第一个帧
+ * @param {size_t} end 最后一个帧之后的位置
+ */
+void BufferPoolManager::add_frames(BufferPoolShard &shard, size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+        Page *page = shard.pages_ + i;
+        if (page->get_page_id().page_no != INVALID_PAGE_ID || page->io_in_progress_) {
+            continue;
+        }
+        // 空闲帧只可能被查到过期页表项的线程短暂固定，它们验证失败后会立即释放
+        while (!page->try_claim()) {
+            std::this_thread::yield();
+        }
+        page->pin_count_ = 0;
+        shard.free_list_.push_back(static_cast<frame_id_t>(i));
+    }
+    shard.io_cv_.notify_all();
+}
+
+/**
+ * @description: 将不再缓存页面的帧归还free_list，已退役的帧（编号不小于pool_size_）不再使用，调用者需持有shard.latch_
+ * @param {BufferPoolShard&} shard 帧所在的分片
+ * @param {frame_id_t} frame_id 空闲的帧，pin_count_已经为0
+ */
+void BufferPoolManager::free_frame(BufferPoolShard &shard, frame_id_t frame_id) {
+    if (static_cast<size_t>(frame_id) < shard.pool_size_) {
+        shard.free_list_.push_back(frame_id);
+    }
+}
+
+/**
+ * @description: 在页头中写入校验和，返回要写回磁盘的页面内容。
+ *              帧已被占用或未被固定且处于I/O中时页面不会被修改，直接在帧中写入；
+ *              仍被固定的页面可能正被其他线程修改，先复制一份再计算，避免写入磁盘的内容与校验和不一致；
+ *              旧布局的文件没有校验和字段，直接写回帧中的内容
+ * @return {char*} 写回磁盘的页面内容
+ * @param {Page*} page 要写回的页面
+ * @param {bool} stable 写回期间页面是否不会被修改
+ * @param {AlignedBuffer*} copy stable为false时存放页面的副本，需要保持到写回完成
+ */
+const char *BufferPoolManager::checksummed_data(Page *page, bool stable, AlignedBuffer *copy) {
+    PageId page_id = page->get_page_id();
+    if (!disk_manager_->has_page_checksums(page_id.fd)) {
+        return page->data_;
+    }
+    if (stable) {
+        set_page_checksum(page->data_, page->page_size_, page_id.page_no);
+        return page->data_;
+    }
+    *copy = DiskManager::alloc_aligned(page->page_size_);
+    memcpy(copy->get(), page->data_, page->page_size_);
+    set_page_checksum(copy->get(), page->page_size_, page_id.page_no);
+    return copy->get();
+}
+
+/**
+ * @description: 检查从磁盘读入的页面的校验和，不一致时抛出PageChecksumError；旧布局的文件不检查
+ * @param {PageId&} page_id 页面
+ * @param {char*} data 读入的页面内容
+ * @param {int} page_size 页面大小
+ */
+void BufferPoolManager::verify_checksum(const PageId &page_id, const char *data, int page_size) {
+    if (verify_checksums_ && disk_manager_->has_page_checksums(page_id.fd) &&
+        !verify_page_checksum(data, page_size, page_id.page_no)) {
+        stats_.checksum_failures.add();
+        throw PageChecksumError(disk_manager_->get_file_name(page_id.fd), page_id.page_no);
+    }
+}
+
+/**
+ * @description: 巡检文件：从磁盘批量读出first_page之后的所有页面并检查校验和，不经过缓冲池，也不占用帧。
+ *              读取时页面可能正在被写回，校验和不一致的页面在等待其写回结束后重新读取一次再判断：
+ *              页面在缓冲池中时固定其帧并标记为I/O中，重新读取期间不会开始新的写回，读取本身不持有分片锁
+ * @return {ScrubResult} 检查的页面个数和校验和不一致的页面；旧布局的文件没有校验和，不检查任何页面
+ * @param {int} fd 文件句柄，巡检期间文件不能被关闭
+ * @param {page_id_t} first_page 第一个要检查的页面，之前的文件头页面不带校验和
+ */
+ScrubResult BufferPoolManager::scrub_file(int fd, page_id_t first_page) {
+    ScrubResult result;
+    if (!disk_manager_->has_page_checksums(fd)) {
+        return result;
+    }
+    int page_size = disk_manager_->get_page_size(fd);
+    page_id_t num_pages = disk_manager_->get_fd2pageno(fd);
+    AlignedBuffer buf = DiskManager::alloc_aligned(static_cast<size_t>(SCRUB_BATCH_PAGES) * page_size);
+    std::vector<char *> bufs(SCRUB_BATCH_PAGES);
+    for (int i = 0; i < SCRUB_BATCH_PAGES; i++) {
+        bufs[i] = buf.get() + static_cast<size_t>(i) * page_size;
+    }
+    for (page_id_t start = first_page; start < num_pages; start += SCRUB_BATCH_PAGES) {
+        int n = std::min(SCRUB_BATCH_PAGES, num_pages - start);
+        disk_manager_->read_pages(fd, start, bufs.data(), n);
+        for (int i = 0; i < n; i++) {
+            if (verify_page_checksum(bufs[i], page_size, start + i)) {
+                continue;
+            }
+            PageId page_id{fd, start + i};
+            BufferPoolShard &shard = shard_of(page_id);
+            std::unique_lock lock{shard.latch_};
+            while (true) {
+                wait_for_io(shard, lock, page_id);
+                frame_id_t fid;
+                Page *page = nullptr;
+                if (shard.page_table_.find(page_id, &fid)) {
+                    // 持有分片锁且I/O已完成时，帧不会处于被占用状态
+                    page = shard.pages_ + fid;
+                    [[maybe_unused]] bool pinned = page->try_pin();
+                    assert(pinned);
+                    page->io_in_progress_ = true;
+                }
+                lock.unlock();
+                try {
+                    disk_manager_->read_page(fd, page_id.page_no, bufs[i], page_size);
+                } catch (...) {
+                    if (page != nullptr) {
+                        lock.lock();
+                        page->io_in_progress_ = false;
+                        page->try_unpin(false);
+                        shard.io_cv_.notify_all();
+                    }
+                    throw;
+                }
+                lock.lock();
+                if (page != nullptr) {
+                    page->io_in_progress_ = false;
+                    page->try_unpin(false);
+                    shard.io_cv_.notify_all();
+                    break;
+                }
+                if (!shard.page_table_.find(page_id, &fid)) {
+                    break;
+                }
+                // 读取期间页面被读入缓冲池，之后的写回可能与读取重叠，固定其帧后重新读取
+            }
+            lock.unlock();
+            if (!verify_page_checksum(bufs[i], page_size, page_id.page_no)) {
+                stats_.checksum_failures.add();
+                result.corrupt_pages.push_back(page_id.page_no);
+            }
+        }
+        result.num_pages += n;
+        stats_.scrubbed_pages.add(n);
+    }
+    return result;
+}
+
+/**
+ * @description: 在后台线程中巡检文件，见scrub_file
+ * @return {future<ScrubResult>} 巡检的结果，读取出错时其中保存该异常
+ * @param {int} fd 文件句柄，巡检完成之前文件不能被关闭
+ * @param {page_id_t} first_page 第一个要检查的页面
+ */
+std::future<ScrubResult> BufferPoolManager::scrub_file_async(int fd, page_id_t first_page) {
+    return std::async(std::launch::async, [this, fd, first_page] { return scrub_file(fd, first_page); });
+}
+
+/**
+ * @description: 将文件只读地映射到内存中。之后fetch_page直接返回指向映射区域的Page视图，不拷贝页面数据，也不占用缓冲池的帧；
+ *              unpin_page、flush_page和delete_page对该文件不做任何事，new_page会抛出异常，写入映射页面会导致段错误。
+ *              用于数据文件在加载后不再修改的只读库
+ * @param {int} fd 文件句柄，映射前会先将该文件在缓冲池中的脏页写回，使映射区域看到最新的数据
+ * @note 映射期间其他线程不能通过缓冲池访问该文件；映射的页面数在映射时确定，之后文件不能再增长
+ */
+void BufferPoolManager::map_file(int fd) {
+    if (is_mapped(fd)) {
+        return;
+    }
+    flush_all_pages(fd);
+    auto mapped = std::make_unique<MappedFile>();
+    mapped->addr = disk_manager_->map_file(fd, &mapped->num_pages);
+    mapped->page_size = disk_manager_->get_page_size(fd);
+    mapped->pages = std::make_unique<Page[]>(mapped->num_pages);
+    for (int i = 0; i < mapped->num_pages; ++i) {
+        Page &page = mapped->pages[i];
+        page.id_ = {fd, i};
+        page.data_ = mapped->addr + static_cast<size_t>(i) * mapped->page_size;
+        page.page_size_ = mapped->page_size;
+    }
+    mapped_files_[fd].store(mapped.release(), std::memory_order_release);
+}
+
+/**
+ * @description: 解除文件的只读映射，之后该文件重新通过缓冲池的帧访问
+ * @param {int} fd 文件句柄
+ * @note 调用者需保证不再使用该文件的Page视图
+ */
+void BufferPoolManager::unmap_file(int fd) {
+    std::unique_ptr<MappedFile> mapped(mapped_files_[fd].exchange(nullptr, std::memory_order_acq_rel));
+    if (mapped != nullptr) {
+        disk_manager_->unmap_file(mapped->addr, static_cast<size_t>(mapped->num_pages) * mapped->page_size);
+    }
+}
+
+/**
+ * @description: 获取只读映射文件中的页面。使用访问策略的扫描每进入一个新的预读窗口，就提示内核提前读入下一个窗口
+ * @return {Page*} 指向映射区域的Page视图，页面超出映射范围时返回nullptr
+ * @param {MappedFile&} mapped 页面所在的映射文件
+ * @param {PageId} page_id 需要获取的页面
+ * @param {BufferAccessStrategy*} strategy 访问策略，不为nullptr时视为顺序扫描
+ */
+Page *BufferPoolManager::fetch_mapped_page(MappedFile &mapped, PageId page_id, BufferAccessStrategy *strategy) {
+    if (page_id.page_no < 0 || page_id.page_no >= mapped.num_pages) {
+        return nullptr;
+    }
+    if (strategy != nullptr && page_id.page_no % READ_AHEAD_MAX_PAGES == 0) {
+        int num_pages = std::min(2 * READ_AHEAD_MAX_PAGES, mapped.num_pages - page_id.page_no);
+        disk_manager_->advise_mapping(mapped.addr, static_cast<size_t>(page_id.page_no) * mapped.page_size,
+                                      static_cast<size_t>(num_pages) * mapped.page_size, MADV_WILLNEED);
     }
+    return &mapped.pages[page_id.page_no];
 }
@@ -2,72 +2,388 @@
 #include <fcntl.h>
 #include <unistd.h>
 
+#include <algorithm>
 #include <cassert>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
 #include <list>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
 #include <unordered_map>
 #include <vector>
 
+#include "buffer_stats.h"
 #include "disk_manager.h"
 #include "errors.h"
+#include "frame_arena.h"
 #include "page.h"
+#include "page_checksum.h"
+#include "page_guard.h"
+#include "page_table.h"
+#include "replacer/clock_replacer.h"
+#include "replacer/lru_k_replacer.h"
 #include "replacer/lru_replacer.h"
 #include "replacer/replacer.h"
 
+/**
+ * @description: 缓冲池的一个分片，拥有独立的帧数组、页表、空闲链表、替换器和锁。
+ * PageId通过哈希映射到唯一的分片，不同分片上的操作互不阻塞。分片内的frame_id是分片内的局部编号。
+ * 一个分片中的帧大小相同，页面按所属文件的页面大小进入对应大小类别的分片。
+ * 缓冲池中的页面（固定或未固定）都留在replacer中，淘汰时通过Page::try_claim()跳过被固定的帧；
+ * 命中时只用CAS增加pin_count_，不获取latch_，也不修改replacer，对replacer的访问记录推迟到淘汰扫描时进行。
+ * 页面由干净变脏总是在持有latch_时进行，并同时加入dirty_pages_，因此写回时只需遍历脏页表而不是整个页表。
+ * 分片按capacity_预留帧，只使用编号小于pool_size_的帧；缩小时编号更大的帧退役，不再进入free_list_，也不会被选为淘汰的帧。
+ */
+struct BufferPoolShard {
+    size_t capacity_;       // 分片预留的帧数，Page数组、页表和replacer都按这个大小创建
+    size_t pool_size_;      // 分片中可用的帧数，编号不小于pool_size_的帧已退役，只在持有latch_时读写
+    int page_size_;         // 分片中每个帧的大小
+    Page *pages_;           // 分片中的Page对象数组，大小为capacity_
+    char *frames_;          // 分片中所有帧的数据，位于缓冲池的FrameArena中，pages_[i]的数据位于frames_ + i * page_size_
+    PageTable<> page_table_;  // 页面PageId到分片内帧编号的映射，命中时无锁查找
+    std::list<frame_id_t> free_list_;   // 空闲帧编号的链表
+    std::unordered_map<int, std::set<page_id_t>> dirty_pages_;   // 分片的脏页表：每个文件在本分片中的脏页页号，按页号有序
+    Replacer *replacer_;    // 分片内的置换策略
+    std::mutex latch_;      // 保护本分片内的共享数据结构
+    std::condition_variable io_cv_;     // 帧的I/O完成时通知等待该帧的线程，与latch_配合使用
+
+    BufferPoolShard(size_t capacity, size_t pool_size, int page_size, char *frames, const std::string &replacer_type);
+
+    ~BufferPoolShard();
+};
+
+/**
+ * @description: 缓冲区访问策略（环形缓冲区）。大表顺序扫描等批量操作通过它访问页面时，未命中的页面会循环复用
+ * 一小组私有的帧，而不是不断从replacer中淘汰其他页面，从而避免一次扫描冲掉B+树内部结点等热点页面。
+ * 每个分片各有一个环，环中的帧被其他线程固定或已被淘汰时，才退回到普通的淘汰流程。
+ * 分片的环只在持有该分片的latch_时访问；每个扫描独占一个策略对象，预读线程通过shared_ptr与扫描共享它
+ */
+class BufferAccessStrategy : public std::enable_shared_from_this<BufferAccessStrategy> {
+    friend class BufferPoolManager;
+
+   public:
+    /**
+     * @param {size_t} ring_size 环形缓冲区的总帧数
+     * @param {vector<size_t>&} shard_ring_sizes 每个分片的环的大小，环形缓冲区的帧平均分配到同一大小类别的各个分片
+     */
+    BufferAccessStrategy(size_t ring_size, const std::vector<size_t> &shard_ring_sizes)
+        : ring_size_(ring_size), next_(shard_ring_sizes.size(), 0) {
+        for (size_t size : shard_ring_sizes) {
+            rings_.emplace_back(std::max<size_t>(1, size));
+        }
+    }
+
+    // 环形缓冲区的总帧数
+    size_t ring_capacity() const { return ring_size_; }
+
+   private:
+    struct RingSlot {
+        frame_id_t frame_id = INVALID_FRAME_ID;     // 该位置上次使用的帧
+        PageId page_id;                             // 该位置上次装入的页面，帧中不再是该页面时不能复用
+    };
+
+    // 取出分片的下一个环位置
+    RingSlot *next_slot(size_t shard_idx) {
+        auto &ring = rings_[shard_idx];
+        RingSlot *slot = &ring[next_[shard_idx]];
+        next_[shard_idx] = (next_[shard_idx] + 1) % ring.size();
+        return slot;
+    }
+
+    size_t ring_size_;                          // 环形缓冲区的总帧数
+    std::vector<std::vector<RingSlot>> rings_;  // 每个分片的环
+    std::vector<size_t> next_;                  // 每个分片的环中下一个要使用的位置
+};
+
+/* 一次文件巡检的结果 */
+struct ScrubResult {
+    size_t num_pages = 0;                   // 检查的页面个数
+    std::vector<page_id_t> corrupt_pages;   // 校验和不一致的页面
+};
+
 class BufferPoolManager {
    private:
-    size_t pool_size_;      // buffer_pool中可容纳页面的个数，即帧的个数
-    Page *pages_;           // buffer_pool中的Page对象数组，在构造空间中申请内存空间，在析构函数中释放，大小为BUFFER_POOL_SIZE
-    std::unordered_map<PageId, frame_id_t, PageIdHash> page_table_; // 帧号和页面号的映射哈希表，用于根据页面的PageId定位该页面的帧编号
-    std::list<frame_id_t> free_list_;   // 空闲帧编号的链表
+    /* 页面大小类别：页面大小为PAGE_SIZE << i的文件，其页面只进入第i个类别的分片 */
+    struct SizeClass {
+        size_t first_shard;     // 类别的第一个分片在shards_中的下标
+        size_t num_shards;      // 类别的分片个数
+        size_t capacity;        // 类别预留的帧数之和，即类别最多可以扩大到的帧数
+        std::atomic<size_t> pool_size;  // 类别当前可用的帧数之和
+    };
+
+    std::unique_ptr<FrameArena> arena_;     // 所有分片的帧数据，按各类别预留的帧数分配
+    std::vector<std::unique_ptr<BufferPoolShard>> shards_;  // 缓冲池分片，按大小类别依次排列，数量在构造时确定
+    SizeClass size_classes_[NUM_PAGE_SIZE_CLASSES];         // 各个页面大小类别的分片范围
     DiskManager *disk_manager_;
-    Replacer *replacer_;    // buffer_pool的置换策略，当前赛题中为LRU置换策略
-    std::mutex latch_;      // 用于共享数据结构的并发控制
+    std::mutex resize_latch_;   // 串行化resize
+    bool lock_free_hits_ = true;    // 命中和unpin是否走无锁路径，关闭时总是获取分片锁（用于对比测试）
+    bool verify_checksums_ = VERIFY_PAGE_CHECKSUMS; // 从磁盘读入页面时是否检查校验和
+    BufferPoolStats stats_;         // 命中、淘汰、写回等统计
+
+    std::thread stats_dumper_;              // 定期将统计输出到文件的线程
+    std::mutex stats_dump_latch_;           // 保护stats_dump_stop_
+    std::condition_variable stats_dump_cv_; // 用于唤醒统计输出线程
+    bool stats_dump_stop_ = false;          // 通知统计输出线程退出
+
+    double clean_fraction_ = BUFFER_POOL_CLEAN_FRACTION;   // 后台写线程需要保持干净的未固定帧比例
+    std::thread bg_writer_;                 // 后台写线程
+    std::mutex bg_latch_;                   // 保护bg_stop_
+    std::condition_variable bg_cv_;         // 用于唤醒后台写线程
+    bool bg_stop_ = false;                  // 通知后台写线程退出
+
+    /* 顺序预读：检测到某个文件的顺序访问后，由预读线程将后续页面用一次向量读读入空闲帧 */
+    struct ReadAheadState {
+        page_id_t last_page_no = INVALID_PAGE_ID;   // 上一次触发检测的页面
+        page_id_t ahead_end = INVALID_PAGE_ID;      // 已发起预读的页面范围的末尾（不含）
+        int window = 0;                             // 当前预读窗口大小，为0表示未检测到顺序访问
+    };
+    struct ReadAheadRequest {
+        PageId start;                                   // 预读的第一个页面
+        int num_pages;                                  // 预读的页面个数
+        std::shared_ptr<BufferAccessStrategy> strategy; // 发起预读的扫描所使用的访问策略，可为空
+    };
+    std::atomic<bool> ra_enabled_{false};   // 预读线程是否在运行
+    std::thread ra_worker_;                 // 预读线程
+    std::mutex ra_latch_;                   // 保护以下预读相关的数据结构
+    std::condition_variable ra_cv_;         // 唤醒预读线程，或通知等待预读结束的线程
+    std::unordered_map<int, ReadAheadState> ra_states_;  // 每个文件的顺序访问检测状态
+    std::deque<ReadAheadRequest> ra_queue_; // 待处理的预读请求
+    int ra_inflight_fd_ = -1;               // 预读线程正在处理的请求所属的文件，没有时为-1
+    bool ra_stop_ = false;                  // 通知预读线程退出
+
+    /* 只读映射的文件：页面是指向映射区域的Page视图，不经过页表，也不占用缓冲池的帧 */
+    struct MappedFile {
+        char *addr;                     // 映射区域的首地址
+        int num_pages;                  // 映射的页面个数
+        int page_size;                  // 文件的页面大小
+        std::unique_ptr<Page[]> pages;  // 每个页面的Page视图
+    };
+    std::unique_ptr<std::atomic<MappedFile *>[]> mapped_files_;  // 按fd索引，未映射的文件为nullptr
 
    public:
-    BufferPoolManager(size_t pool_size, DiskManager *disk_manager)
-        : pool_size_(pool_size), disk_manager_(disk_manager) {
-        // 为buffer pool分配一块连续的内存空间
-        pages_ = new Page[pool_size_];
-        // 可以被Replacer改变
-        if (REPLACER_TYPE.compare("LRU"))
-            replacer_ = new LRUReplacer(pool_size_);
-        else if (REPLACER_TYPE.compare("CLOCK"))
-            replacer_ = new LRUReplacer(pool_size_);
-        else {
-            replacer_ = new LRUReplacer(pool_size_);
+    /**
+     * @param {size_t} pool_size 默认大小类别（PAGE_SIZE）的总帧数
+     * @param {DiskManager*} disk_manager
+     * @param {size_t} num_shards 每个大小类别的分片个数，默认为1即退化为单锁缓冲池
+     * @param {string&} replacer_type 置换策略，可选"LRU"、"CLOCK"、"LRU-K"，默认使用配置中的REPLACER_TYPE
+     * @param {bool} huge_pages 帧内存是否尝试使用大页，默认使用配置中的BUFFER_POOL_HUGE_PAGES
+     * @param {size_t} max_pool_size resize可以扩大到的默认大小类别的总帧数，小于pool_size时取pool_size
+     * @note 更大页面的每个大小类别占用默认类别BUFFER_POOL_LARGE_PAGE_FRACTION比例的内存，且至少有
+     *       BUFFER_POOL_MIN_CLASS_FRAMES个帧；所有类别的帧按max_pool_size预留在同一个FrameArena中，
+     *       帧内存在第一次使用时才由操作系统真正分配（MAP_HUGETLB的大页除外）
+     */
+    BufferPoolManager(size_t pool_size, DiskManager *disk_manager, size_t num_shards = 1,
+                      const std::string &replacer_type = REPLACER_TYPE, bool huge_pages = BUFFER_POOL_HUGE_PAGES,
+                      size_t max_pool_size = 0)
+        : disk_manager_(disk_manager),
+          mapped_files_(std::make_unique<std::atomic<MappedFile *>[]>(DiskManager::MAX_FD)) {
+        max_pool_size = std::max(max_pool_size, pool_size);
+        size_t arena_size = 0;
+        for (int i = 0; i < NUM_PAGE_SIZE_CLASSES; ++i) {
+            SizeClass &size_class = size_classes_[i];
+            size_class.pool_size = class_pool_size(pool_size, i);
+            size_class.capacity = class_pool_size(max_pool_size, i);
+            size_class.num_shards = std::max<size_t>(1, std::min(num_shards, size_class.pool_size.load()));
+            arena_size += size_class.capacity * (PAGE_SIZE << i);
         }
-        // 初始化时，所有的page都在free_list_中
-        for (size_t i = 0; i < pool_size_; ++i) {
-            free_list_.emplace_back(static_cast<frame_id_t>(i));  // static_cast转换数据类型
+        arena_ = std::make_unique<FrameArena>(arena_size, huge_pages);
+        // 各类别的帧在arena中依次排列，每个帧的起始地址都按PAGE_SIZE对齐
+        char *frames = arena_->data();
+        for (int i = 0; i < NUM_PAGE_SIZE_CLASSES; ++i) {
+            int page_size = PAGE_SIZE << i;
+            SizeClass &size_class = size_classes_[i];
+            size_class.first_shard = shards_.size();
+            for (size_t j = 0; j < size_class.num_shards; ++j) {
+                size_t shard_capacity = shard_pool_size(size_class.capacity, size_class.num_shards, j);
+                size_t shard_size = shard_pool_size(size_class.pool_size, size_class.num_shards, j);
+                shards_.emplace_back(
+                    std::make_unique<BufferPoolShard>(shard_capacity, shard_size, page_size, frames, replacer_type));
+                frames += shard_capacity * page_size;
+            }
         }
     }
 
     ~BufferPoolManager() {
-        delete[] pages_;
-        delete replacer_;
+        stop_stats_dump();
+        stop_read_ahead();
+        stop_background_writer();
+        for (int fd = 0; fd < DiskManager::MAX_FD; ++fd) {
+            unmap_file(fd);
+        }
+    }
+
+    /**
+     * @description: 将目标页面标记为脏页，页面原本是干净的时加入脏页表
+     * @param {Page*} page 脏页，调用者需已固定该页面
+     */
+    void mark_dirty(Page* page) {
+        BufferPoolShard &shard = shard_of(page->get_page_id());
+        std::scoped_lock lock{shard.latch_};
+        mark_dirty(shard, page);
+    }
+
+    // 可容纳页面大小为page_size的页面个数
+    size_t get_pool_size(int page_size = PAGE_SIZE) const { return size_classes_[size_class_of(page_size)].pool_size; }
+
+    // resize可以扩大到的页面大小为page_size的页面个数
+    size_t get_max_pool_size(int page_size = PAGE_SIZE) const {
+        return size_classes_[size_class_of(page_size)].capacity;
     }
 
+    // 每个大小类别的分片个数
+    size_t get_num_shards() const { return size_classes_[0].num_shards; }
+
+    // 帧内存实际使用的页面类型
+    FrameArena::Backing get_frame_backing() const { return arena_->backing(); }
+
     /**
-     * @description: 将目标页面标记为脏页
-     * @param {Page*} page 脏页
+     * @description: 创建一个环形缓冲区访问策略，供大表顺序扫描、批量写入等操作使用
+     * @param {size_t} ring_size 环形缓冲区的总帧数
      */
-    static void mark_dirty(Page* page) { page->is_dirty_ = true; }
+    std::shared_ptr<BufferAccessStrategy> make_ring_strategy(size_t ring_size = BUFFER_RING_SIZE) {
+        std::vector<size_t> shard_ring_sizes;
+        for (auto &size_class : size_classes_) {
+            shard_ring_sizes.insert(shard_ring_sizes.end(), size_class.num_shards,
+                                    (ring_size + size_class.num_shards - 1) / size_class.num_shards);
+        }
+        return std::make_shared<BufferAccessStrategy>(ring_size, shard_ring_sizes);
+    }
 
-   public: 
-    Page* fetch_page(PageId page_id);
+   public:
+    Page* fetch_page(PageId page_id, BufferAccessStrategy *strategy = nullptr);
 
     bool unpin_page(PageId page_id, bool is_dirty);
 
     bool flush_page(PageId page_id);
 
-    Page* new_page(PageId* page_id);
+    Page* new_page(PageId* page_id, BufferAccessStrategy *strategy = nullptr);
+
+    ReadPageGuard fetch_page_read(PageId page_id, BufferAccessStrategy *strategy = nullptr);
+
+    WritePageGuard fetch_page_write(PageId page_id, BufferAccessStrategy *strategy = nullptr);
+
+    WritePageGuard new_page_guarded(PageId *page_id, BufferAccessStrategy *strategy = nullptr);
 
     bool delete_page(PageId page_id);
 
     void flush_all_pages(int fd);
 
+    void flush_all_pages();
+
+    std::vector<PageId> get_dirty_page_table();
+
+    void start_background_writer(std::chrono::milliseconds interval = std::chrono::milliseconds(BG_WRITER_INTERVAL_MS));
+
+    void stop_background_writer();
+
+    size_t write_back_cold_pages();
+
+    void start_read_ahead();
+
+    void stop_read_ahead();
+
+    int prefetch_pages(PageId start, int num_pages, BufferAccessStrategy *strategy = nullptr);
+
+    void resize(size_t pool_size,
+                std::chrono::milliseconds timeout = std::chrono::milliseconds(BUFFER_POOL_RESIZE_TIMEOUT_MS));
+
+    BufferPoolStatus get_status();
+
+    void start_stats_dump(const std::string &path = BUFFER_STATS_FILE_NAME,
+                          std::chrono::milliseconds interval = std::chrono::milliseconds(BUFFER_STATS_DUMP_INTERVAL_MS));
+
+    void stop_stats_dump();
+
+    void map_file(int fd);
+
+    void unmap_file(int fd);
+
+    bool is_mapped(int fd) const { return mapped_files_[fd].load(std::memory_order_acquire) != nullptr; }
+
+    ScrubResult scrub_file(int fd, page_id_t first_page = 1);
+
+    std::future<ScrubResult> scrub_file_async(int fd, page_id_t first_page = 1);
+
+    // 只能在没有其他线程访问缓冲池时调用
+    void set_lock_free_hits(bool enabled) { lock_free_hits_ = enabled; }
+
+    // 只能在没有其他线程访问缓冲池时调用；写回时总是计算校验和
+    void set_verify_checksums(bool enabled) { verify_checksums_ = enabled; }
+
    private:
-    bool find_victim_page(frame_id_t* frame_id);
+    // 页面大小所属的大小类别
+    static size_t size_class_of(int page_size) { return __builtin_ctz(static_cast<unsigned>(page_size / PAGE_SIZE)); }
+
+    size_t shard_index(const PageId &page_id) const {
+        const SizeClass &size_class = size_classes_[size_class_of(disk_manager_->get_page_size(page_id.fd))];
+        // 同一文件的连续页面轮流落在各个分片上，使顺序扫描和预读的页面均匀分布；不同文件从fd的哈希决定的分片开始
+        size_t first = PageIdHash()({.fd = page_id.fd, .page_no = 0}) >> 32;
+        return size_class.first_shard + (first + static_cast<size_t>(page_id.page_no)) % size_class.num_shards;
+    }
+
+    BufferPoolShard &shard_of(const PageId &page_id) { return *shards_[shard_index(page_id)]; }
+
+    // 默认大小类别的帧数为pool_size时，第size_class个大小类别的帧数
+    static size_t class_pool_size(size_t pool_size, int size_class) {
+        if (size_class == 0) {
+            return pool_size;
+        }
+        return std::max<size_t>(BUFFER_POOL_MIN_CLASS_FRAMES,
+                                pool_size * BUFFER_POOL_LARGE_PAGE_FRACTION / (1 << size_class));
+    }
+
+    // 将类别的帧尽量平均地分配到各个分片中，第shard个分片的帧数
+    static size_t shard_pool_size(size_t class_size, size_t num_shards, size_t shard) {
+        return class_size / num_shards + (shard < class_size % num_shards ? 1 : 0);
+    }
+
+    void resize_shard(BufferPoolShard &shard, size_t pool_size, std::chrono::steady_clock::time_point deadline);
+
+    void add_frames(BufferPoolShard &shard, size_t begin, size_t end);
+
+    void free_frame(BufferPoolShard &shard, frame_id_t frame_id);
+
+    const char *checksummed_data(Page *page, bool stable, AlignedBuffer *copy);
+
+    void verify_checksum(const PageId &page_id, const char *data, int page_size);
+
+    size_t clean_window(BufferPoolShard &shard) const;
+
+    bool find_victim_page(BufferPoolShard &shard, frame_id_t* frame_id,
+                          BufferAccessStrategy::RingSlot *slot = nullptr, bool clean_only = false);
+
+    bool victim_if(BufferPoolShard &shard, frame_id_t *frame_id, bool clean_only, size_t max_scan);
+
+    bool io_pending(BufferPoolShard &shard) const;
+
+    Page *pin_resident_page(BufferPoolShard &shard, const PageId &page_id);
+
+    void update_page(BufferPoolShard &shard, std::unique_lock<std::mutex> &lock, Page* page, PageId new_page_id,
+                     frame_id_t new_frame_id, bool read_from_disk);
+
+    void wait_for_io(BufferPoolShard &shard, std::unique_lock<std::mutex> &lock, const PageId &page_id);
+
+    size_t write_back_cold_pages(AsyncIO &aio);
+
+    void flush_pages(int fd);
+
+    void mark_dirty(BufferPoolShard &shard, Page *page);
+
+    void clear_dirty(BufferPoolShard &shard, Page *page, const PageId &page_id);
+
+    bool dirty_io_pending(BufferPoolShard &shard, int fd) const;
+
+    void read_ahead(PageId page_id, bool miss, BufferAccessStrategy *strategy);
+
+    void drain_read_ahead(int fd);
+
+    MappedFile *mapped_file(int fd) const { return mapped_files_[fd].load(std::memory_order_acquire); }
 
-    void update_page(Page* page, PageId new_page_id, frame_id_t new_frame_id);
-};
\ No newline at end of file
+    Page *fetch_mapped_page(MappedFile &mapped, PageId page_id, BufferAccessStrategy *strategy);
+};
@@ -0,0 +1,55 @@
+#include "storage/buffer_stats.h"
+
+#include <iomanip>
+#include <sstream>
+
+/**
+ * @description: 估计延迟的百分位数，返回第一个累计样本数达到比例p的桶的上界
+ * @return {double} 延迟的上界估计，单位为微秒，没有样本时为0
+ * @param {double} p 百分位，取值范围为(0, 1]
+ */
+double LatencySnapshot::percentile_us(double p) const {
+    if (count == 0) {
+        return 0;
+    }
+    uint64_t target = std::max<uint64_t>(1, static_cast<uint64_t>(p * count + 0.5));
+    uint64_t seen = 0;
+    for (int i = 0; i < NUM_BUCKETS; i++) {
+        seen += buckets[i];
+        if (seen >= target) {
+            return static_cast<double>(1ULL << i) / 1000;
+        }
+    }
+    return static_cast<double>(1ULL << (NUM_BUCKETS - 1)) / 1000;
+}
+
+/**
+ * @description: 合并所有线程的槽位，得到直方图的快照
+ */
+LatencySnapshot LatencyHistogram::snapshot() const {
+    LatencySnapshot snapshot;
+    for (auto &stripe : stripes_) {
+        snapshot.sum_ns += stripe.sum_ns.load(std::memory_order_relaxed);
+        for (int i = 0; i < LatencySnapshot::NUM_BUCKETS; i++) {
+            uint64_t n = stripe.buckets[i].load(std::memory_order_relaxed);
+            snapshot.buckets[i] += n;
+            snapshot.count += n;
+        }
+    }
+    return snapshot;
+}
+
+/**
+ * @description: 将指标和文件的读写次数格式化为多行文本，每行一项，用于定期输出到文件
+ */
+std::string BufferPoolStatus::to_string() const {
+    std::ostringstream os;
+    for (auto &[name, value] : metrics) {
+        os << std::left << std::setw(20) << name << value << '\n';
+    }
+    for (auto &file : files) {
+        os << "file " << file.name << ": page_reads=" << file.page_reads << " page_writes=" << file.page_writes
+           << '\n';
+    }
+    return os.str();
+}
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "common/config.h"
+
+// 当前线程使用的统计槽位，线程第一次更新统计时分配，线程数超过槽位数时多个线程共用一个槽位
+inline size_t stats_stripe() {
+    static std::atomic<size_t> next_stripe{0};
+    thread_local size_t stripe = next_stripe.fetch_add(1, std::memory_order_relaxed) % BUFFER_STATS_STRIPES;
+    return stripe;
+}
+
+// 单调时钟的当前时间，单位为纳秒，用于计算延迟
+inline uint64_t stats_now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+/**
+ * @description: 按线程分散的计数器。每个线程只更新自己的缓存行，热路径上的计数不会在线程之间争用同一缓存行；
+ * 读取时把所有槽位加起来，结果是近似的快照
+ */
+class StripedCounter {
+   public:
+    void add(uint64_t n = 1) { slots_[stats_stripe()].value.fetch_add(n, std::memory_order_relaxed); }
+
+    uint64_t load() const {
+        uint64_t sum = 0;
+        for (auto &slot : slots_) {
+            sum += slot.value.load(std::memory_order_relaxed);
+        }
+        return sum;
+    }
+
+   private:
+    struct alignas(64) Slot {
+        std::atomic<uint64_t> value{0};
+    };
+    Slot slots_[BUFFER_STATS_STRIPES];
+};
+
+/* 延迟直方图的快照 */
+struct LatencySnapshot {
+    static constexpr int NUM_BUCKETS = 40;  // 第i个桶记录[2^(i-1), 2^i)纳秒的样本，最后一个桶记录更大的样本
+
+    uint64_t count = 0;                     // 样本个数
+    uint64_t sum_ns = 0;                    // 样本之和
+    uint64_t buckets[NUM_BUCKETS] = {};     // 每个桶的样本个数
+
+    double mean_us() const { return count == 0 ? 0 : static_cast<double>(sum_ns) / count / 1000; }
+
+    double percentile_us(double p) const;
+};
+
+/**
+ * @description: 按线程分散的延迟直方图，桶按2的幂划分，记录一个样本只需要两次无竞争的原子加法
+ */
+class LatencyHistogram {
+   public:
+    void record(uint64_t latency_ns) {
+        Stripe &stripe = stripes_[stats_stripe()];
+        int bucket = std::min(64 - __builtin_clzll(latency_ns | 1), LatencySnapshot::NUM_BUCKETS - 1);
+        stripe.buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+        stripe.sum_ns.fetch_add(latency_ns, std::memory_order_relaxed);
+    }
+
+    LatencySnapshot snapshot() const;
+
+   private:
+    struct alignas(64) Stripe {
+        std::atomic<uint64_t> sum_ns{0};
+        std::atomic<uint64_t> buckets[LatencySnapshot::NUM_BUCKETS] = {};
+    };
+    Stripe stripes_[BUFFER_STATS_STRIPES];
+};
+
+/* 缓冲池的统计，计数从缓冲池创建时开始累计 */
+struct BufferPoolStats {
+    StripedCounter hits;                // fetch_page命中的次数
+    StripedCounter misses;              // fetch_page从磁盘读入页面的次数
+    StripedCounter evictions_clean;     // 淘汰干净页面的次数
+    StripedCounter evictions_dirty;     // 淘汰时需要先写回的脏页个数
+    StripedCounter background_writes;   // 后台写线程写回的脏页个数
+    StripedCounter flushed_pages;       // flush_page/flush_all_pages写回的页面个数
+    StripedCounter prefetched_pages;    // 预读读入的页面个数
+    StripedCounter checksum_failures;   // 读入或巡检时发现校验和不一致的页面个数
+    StripedCounter scrubbed_pages;      // 巡检过的页面个数
+    LatencyHistogram hit_latency;       // 命中的fetch_page的延迟，每BUFFER_STATS_HIT_SAMPLE_INTERVAL次命中采样一次
+    LatencyHistogram miss_latency;      // 未命中的fetch_page的延迟，包括等待分片锁、写回被淘汰的脏页和读入页面
+    LatencyHistogram flush_latency;     // 每次flush_page/flush_all_pages的延迟
+
+    // 当前线程的这次命中是否需要计时
+    static bool sample_hit() {
+        thread_local uint32_t num_hits = 0;
+        return ++num_hits % BUFFER_STATS_HIT_SAMPLE_INTERVAL == 0;
+    }
+};
+
+/* 一个已打开文件的页面读写次数 */
+struct FileIOStats {
+    std::string name;       // 文件名
+    uint64_t page_reads;    // 文件打开以来读取的页面个数
+    uint64_t page_writes;   // 文件打开以来写入的页面个数
+};
+
+/* SHOW BUFFER STATUS和定期输出的内容：缓冲池和磁盘I/O的各项指标，以及每个文件的读写次数 */
+struct BufferPoolStatus {
+    std::vector<std::pair<std::string, std::string>> metrics;  // 指标名称和值
+    std::vector<FileIOStats> files;                             // 有读写的已打开文件
+
+    std::string to_string() const;
+};
@@ -3,11 +3,23 @@
 #include <assert.h>    // for assert
 #include <string.h>    // for memset
 #include <sys/stat.h>  // for stat
+#include <limits.h>    // for IOV_MAX
+#include <sys/mman.h>  // for mmap, madvise
+#include <sys/uio.h>   // for preadv, pwritev
 #include <unistd.h>    // for lseek
 
+#include <algorithm>
+#include <limits>
+#include <vector>
+
 #include "defs.h"
 
-DiskManager::DiskManager() { memset(fd2pageno_, 0, MAX_FD * (sizeof(std::atomic<page_id_t>) / sizeof(char))); }
+DiskManager::DiskManager(bool direct_io) : direct_io_(direct_io) {
+    memset(fd2pageno_, 0, MAX_FD * (sizeof(std::atomic<page_id_t>) / sizeof(char)));
+    for (auto &page_size : fd2pagesize_) {
+        page_size.store(PAGE_SIZE, std::memory_order_relaxed);
+    }
+}
 
 /**
  * @description: 将数据写入文件的指定磁盘页面中
@@ -17,14 +29,86 @@ DiskManager::DiskManager() { memset(fd2pageno_, 0, MAX_FD * (sizeof(std::atomic<
  * @param {int} num_bytes 要写入磁盘的数据大小
  */
 void DiskManager::write_page(int fd, page_id_t page_no, const char *offset, int num_bytes) {
-    off_t pos = static_cast<off_t>(page_no) * PAGE_SIZE;
-    if (lseek(fd, pos, SEEK_SET) == -1) {
-        throw UnixError();
+    // 缓冲池在不持锁的情况下并发读写同一文件，使用pwrite避免共享文件偏移量
+    const int page_size = get_page_size(fd);
+    off_t pos = static_cast<off_t>(page_no) * page_size;
+    if (needs_bounce(fd, offset, num_bytes)) {
+        // 实际写入的范围向上对齐，超出num_bytes的部分先从文件读出，保持原来的内容不变；
+        // 文件头等超过一个页面的数据也按对齐后的长度读写
+        int aligned_bytes = bounce_length(num_bytes, page_size);
+        AlignedBuffer buf = alloc_aligned(aligned_bytes);
+        if (num_bytes < aligned_bytes) {
+            read_page(fd, page_no, buf.get(), aligned_bytes);
+        }
+        memcpy(buf.get(), offset, num_bytes);
+        uint64_t start = stats_now_ns();
+        ssize_t written = pwrite(fd, buf.get(), aligned_bytes, pos);
+        write_latency_.record(stats_now_ns() - start);
+        if (written != aligned_bytes) {
+            throw InternalError("DiskManager::write_page Error");
+        }
+        count_page_writes(fd, 1);
+        return;
     }
-    ssize_t written = write(fd, offset, num_bytes);
+    uint64_t start = stats_now_ns();
+    ssize_t written = pwrite(fd, offset, num_bytes, pos);
+    write_latency_.record(stats_now_ns() - start);
     if (written != num_bytes) {
         throw InternalError("DiskManager::write_page Error");
     }
+    count_page_writes(fd, 1);
+}
+
+/**
+ * @description: 将同一文件的多个页面写入磁盘，页号连续的页面合并为一次pwritev
+ * @param {int} fd 磁盘文件的文件句柄
+ * @param {page_id_t*} page_nos 页面编号，按升序排列且不重复
+ * @param {char* const*} bufs 每个页面的数据，大小均为文件的页面大小
+ * @param {int} num_pages 页面个数
+ */
+void DiskManager::write_pages(int fd, const page_id_t *page_nos, const char *const *bufs, int num_pages) {
+    const int page_size = get_page_size(fd);
+    if (std::any_of(bufs, bufs + num_pages, [&](const char *buf) { return needs_bounce(fd, buf, page_size); })) {
+        for (int i = 0; i < num_pages; i++) {
+            write_page(fd, page_nos[i], bufs[i], page_size);
+        }
+        return;
+    }
+    std::vector<struct iovec> iov;
+    int begin = 0;
+    while (begin < num_pages) {
+        // 找出从begin开始页号连续的一段，长度不超过IOV_MAX
+        int end = begin + 1;
+        while (end < num_pages && end - begin < IOV_MAX && page_nos[end] == page_nos[end - 1] + 1) {
+            end++;
+        }
+        iov.resize(end - begin);
+        for (int i = begin; i < end; i++) {
+            iov[i - begin].iov_base = const_cast<char *>(bufs[i]);
+            iov[i - begin].iov_len = page_size;
+        }
+        off_t pos = static_cast<off_t>(page_nos[begin]) * page_size;
+        ssize_t total = static_cast<ssize_t>(end - begin) * page_size;
+        ssize_t done = 0;
+        int first = 0;
+        uint64_t start = stats_now_ns();
+        // pwritev可能只写入部分数据，继续写入剩余部分
+        while (done < total) {
+            ssize_t written = pwritev(fd, iov.data() + first, end - begin - first, pos + done);
+            if (written <= 0) {
+                throw InternalError("DiskManager::write_pages Error");
+            }
+            done += written;
+            first = done / page_size;
+            if (first < end - begin) {
+                iov[first].iov_base = const_cast<char *>(bufs[begin + first]) + done % page_size;
+                iov[first].iov_len = page_size - done % page_size;
+            }
+        }
+        write_latency_.record(stats_now_ns() - start);
+        count_page_writes(fd, end - begin);
+        begin = end;
+    }
 }
 
 /**
@@ -35,11 +119,26 @@ void DiskManager::write_page(int fd, page_id_t page_no, const char *offset, int
  * @param {int} num_bytes 读取的数据量大小
  */
 void DiskManager::read_page(int fd, page_id_t page_no, char *offset, int num_bytes) {
-    off_t pos = static_cast<off_t>(page_no) * PAGE_SIZE;
-    if (lseek(fd, pos, SEEK_SET) == -1) {
-        throw UnixError();
+    const int page_size = get_page_size(fd);
+    off_t pos = static_cast<off_t>(page_no) * page_size;
+    if (needs_bounce(fd, offset, num_bytes)) {
+        int aligned_bytes = bounce_length(num_bytes, page_size);
+        AlignedBuffer buf = alloc_aligned(aligned_bytes);
+        uint64_t start = stats_now_ns();
+        ssize_t rd = pread(fd, buf.get(), aligned_bytes, pos);
+        read_latency_.record(stats_now_ns() - start);
+        count_page_reads(fd, 1);
+        if (rd == -1) {
+            throw UnixError();
+        }
+        // alloc_aligned返回的缓冲区已清零，超出文件末尾的部分为0
+        memcpy(offset, buf.get(), num_bytes);
+        return;
     }
-    ssize_t rd = read(fd, offset, num_bytes);
+    uint64_t start = stats_now_ns();
+    ssize_t rd = pread(fd, offset, num_bytes, pos);
+    read_latency_.record(stats_now_ns() - start);
+    count_page_reads(fd, 1);
     if (rd == -1) {
         throw UnixError();
     }
@@ -49,17 +148,242 @@ void DiskManager::read_page(int fd, page_id_t page_no, char *offset, int num_byt
 }
 
 /**
- * @description: 分配一个新的页号
+ * @description: 用一次preadv读取文件中连续的多个页面，每个页面读入各自的缓冲区，用于顺序预读
+ * @param {int} fd 磁盘文件的文件句柄
+ * @param {page_id_t} start_page_no 第一个页面的编号
+ * @param {char* const*} bufs 每个页面的目标缓冲区，大小均为文件的页面大小
+ * @param {int} num_pages 页面个数，不超过IOV_MAX
+ */
+void DiskManager::read_pages(int fd, page_id_t start_page_no, char *const *bufs, int num_pages) {
+    const int page_size = get_page_size(fd);
+    if (std::any_of(bufs, bufs + num_pages, [&](const char *buf) { return needs_bounce(fd, buf, page_size); })) {
+        for (int i = 0; i < num_pages; i++) {
+            read_page(fd, start_page_no + i, bufs[i], page_size);
+        }
+        return;
+    }
+    std::vector<struct iovec> iov(num_pages);
+    for (int i = 0; i < num_pages; i++) {
+        iov[i].iov_base = bufs[i];
+        iov[i].iov_len = page_size;
+    }
+    off_t pos = static_cast<off_t>(start_page_no) * page_size;
+    ssize_t total = static_cast<ssize_t>(num_pages) * page_size;
+    ssize_t done = 0;
+    int first = 0;
+    uint64_t start = stats_now_ns();
+    // preadv可能只读取部分数据，继续读取剩余部分直到文件末尾
+    while (done < total) {
+        ssize_t rd = preadv(fd, iov.data() + first, num_pages - first, pos + done);
+        if (rd == -1) {
+            throw UnixError();
+        }
+        if (rd == 0) {
+            break;
+        }
+        done += rd;
+        first = done / page_size;
+        if (first < num_pages) {
+            iov[first].iov_base = bufs[first] + done % page_size;
+            iov[first].iov_len = page_size - done % page_size;
+        }
+    }
+    read_latency_.record(stats_now_ns() - start);
+    count_page_reads(fd, num_pages);
+    // 超出文件末尾的部分填充为0，与read_page一致
+    for (int i = done / page_size; i < num_pages; i++) {
+        int offset = (i == done / page_size) ? done % page_size : 0;
+        memset(bufs[i] + offset, 0, page_size - offset);
+    }
+}
+
+/**
+ * @description: 将文件只读地映射到内存中，映射区域按页面划分，第i个页面位于addr + i * 文件的页面大小
+ * @return {char*} 映射区域的首地址，文件为空时返回nullptr
+ * @param {int} fd 文件句柄
+ * @param {int*} num_pages 返回映射的页面个数，文件末尾不足一页的部分不被映射；
+ * 已知文件分配的页面个数时，预分配的区段中尚未分配的页面也不被映射
+ * @note 映射期间文件不能被写入或截断，否则访问映射区域的结果未定义
+ */
+char *DiskManager::map_file(int fd, int *num_pages) {
+    struct stat st;
+    if (fstat(fd, &st) == -1) {
+        throw UnixError();
+    }
+    const int page_size = get_page_size(fd);
+    *num_pages = static_cast<int>(st.st_size / page_size);
+    if (fd2pageno_[fd] > 0) {
+        *num_pages = std::min(*num_pages, static_cast<int>(fd2pageno_[fd]));
+    }
+    if (*num_pages == 0) {
+        return nullptr;
+    }
+    void *addr = mmap(nullptr, static_cast<size_t>(*num_pages) * page_size, PROT_READ, MAP_SHARED, fd, 0);
+    if (addr == MAP_FAILED) {
+        throw UnixError();
+    }
+    return static_cast<char *>(addr);
+}
+
+/**
+ * @description: 解除map_file建立的映射
+ * @param {char*} addr 映射区域的首地址
+ * @param {size_t} num_bytes 映射区域的大小
+ */
+void DiskManager::unmap_file(char *addr, size_t num_bytes) {
+    if (addr != nullptr && munmap(addr, num_bytes) == -1) {
+        throw UnixError();
+    }
+}
+
+/**
+ * @description: 对映射区域中的一段数据给出访问模式提示，例如扫描前用MADV_WILLNEED让内核提前读入
+ * @param {char*} addr 映射区域的首地址
+ * @param {size_t} offset 数据在映射区域中的偏移
+ * @param {size_t} num_bytes 数据的大小
+ * @param {int} advice madvise的访问模式
+ */
+void DiskManager::advise_mapping(char *addr, size_t offset, size_t num_bytes, int advice) {
+    if (num_bytes == 0) {
+        return;
+    }
+    // 提示只影响性能，失败时忽略
+    madvise(addr + offset, num_bytes, advice);
+}
+
+/**
+ * @description: 分配按DIRECT_IO_ALIGNMENT对齐并清零的缓冲区，大小向上取整到DIRECT_IO_ALIGNMENT的倍数，
+ *              用于以O_DIRECT打开的文件的读写
+ * @return {AlignedBuffer} 分配的缓冲区
+ * @param {size_t} num_bytes 需要的大小
+ */
+AlignedBuffer DiskManager::alloc_aligned(size_t num_bytes) {
+    size_t size = (std::max<size_t>(num_bytes, 1) + DIRECT_IO_ALIGNMENT - 1) / DIRECT_IO_ALIGNMENT * DIRECT_IO_ALIGNMENT;
+    void *ptr = nullptr;
+    if (posix_memalign(&ptr, DIRECT_IO_ALIGNMENT, size) != 0) {
+        throw std::bad_alloc();
+    }
+    memset(ptr, 0, size);
+    return AlignedBuffer(static_cast<char *>(ptr));
+}
+
+/**
+ * @description: 设置文件的页面大小，文件中所有页面（包括第0页的文件头）都按该大小定位。
+ *              上层模块在创建或打开文件时，根据文件头中记录的页面大小调用此函数
+ * @param {int} fd 文件句柄
+ * @param {int} page_size 页面大小，必须是PAGE_SIZE到MAX_PAGE_SIZE之间的2的幂
+ */
+void DiskManager::set_page_size(int fd, int page_size) {
+    assert(fd >= 0 && fd < MAX_FD);
+    if (page_size < PAGE_SIZE || page_size > MAX_PAGE_SIZE || (page_size & (page_size - 1)) != 0) {
+        throw InvalidPageSizeError(page_size);
+    }
+    fd2pagesize_[fd].store(page_size, std::memory_order_relaxed);
+}
+
+/**
+ * @description: 分配一个新的页号，优先复用文件中已释放的页面，没有空闲页面时才在文件末尾分配新页面；
+ *              新页面超出文件已分配的空间时，先预分配它所在的区
  * @return {page_id_t} 分配的新页号
  * @param {int} fd 指定文件的文件句柄
  */
 page_id_t DiskManager::allocate_page(int fd) {
-    // 简单的自增分配策略，指定文件的页面编号加1
     assert(fd >= 0 && fd < MAX_FD);
-    return fd2pageno_[fd]++;
+    {
+        std::scoped_lock lock{free_latch_};
+        auto it = free_pages_.find(fd);
+        if (it != free_pages_.end() && !it->second.empty()) {
+            page_id_t page_no = it->second.back();
+            it->second.pop_back();
+            return page_no;
+        }
+    }
+    // 没有空闲页面，使用自增分配策略，指定文件的页面编号加1
+    page_id_t page_no = fd2pageno_[fd]++;
+    if (extent_size_ > 0 &&
+        static_cast<off_t>(page_no + 1) * get_page_size(fd) > fd2filesize_[fd].load(std::memory_order_relaxed)) {
+        extend_file(fd, page_no);
+    }
+    return page_no;
+}
+
+/**
+ * @description: 用fallocate为文件预分配覆盖page_no所在的区（区按extent_size_对齐）的磁盘空间。
+ *              之后分配的连续页号落在文件系统一次分配的连续磁盘空间中，批量写入的页面在磁盘上连续，顺序扫描不需要寻道；
+ *              写入区内的页面也不再分配磁盘块。使用FALLOC_FL_KEEP_SIZE，文件大小不变，仍由实际写入的页面决定，
+ *              否则小文件也会被撑大到一个完整的区，文件大小和按文件大小计算的页面个数都不再反映文件的内容。
+ *              预分配失败时不抛出异常，页面写入时仍会逐页扩展文件；文件系统不支持fallocate时不再为该文件预分配
+ * @param {int} fd 文件句柄
+ * @param {page_id_t} page_no 新分配的页面
+ */
+void DiskManager::extend_file(int fd, page_id_t page_no) {
+    std::scoped_lock lock{extent_latch_};
+    off_t end = static_cast<off_t>(page_no + 1) * get_page_size(fd);
+    off_t size = fd2filesize_[fd].load(std::memory_order_relaxed);
+    if (end <= size) {
+        // 其他线程已经扩展了文件
+        return;
+    }
+    off_t extent = std::max(extent_size_.load(), get_page_size(fd));
+    off_t new_size = (end + extent - 1) / extent * extent;
+    if (fallocate(fd, FALLOC_FL_KEEP_SIZE, size, new_size - size) == -1) {
+        if (errno == EOPNOTSUPP || errno == ENOSYS) {
+            fd2filesize_[fd].store(std::numeric_limits<off_t>::max(), std::memory_order_relaxed);
+        }
+        return;
+    }
+    fd2filesize_[fd].store(new_size, std::memory_order_relaxed);
+    num_extents_.fetch_add(1, std::memory_order_relaxed);
+}
+
+/**
+ * @description: 释放文件中的一个页面，之后allocate_page会优先分配该页面，文件因此不会无限增长
+ * @param {int} fd 指定文件的文件句柄
+ * @param {page_id_t} page_no 被释放的页面，调用者保证不再访问它
+ * @note 空闲页面只记录在内存中，由文件的上层模块负责持久化（例如索引文件通过被释放页面串成的空闲链表），
+ *       并在打开文件时通过set_free_pages恢复
+ */
+void DiskManager::deallocate_page(int fd, page_id_t page_no) {
+    assert(fd >= 0 && fd < MAX_FD && page_no >= 0 && page_no < fd2pageno_[fd]);
+    std::scoped_lock lock{free_latch_};
+    free_pages_[fd].push_back(page_no);
+}
+
+/**
+ * @description: 获得下一次allocate_page将返回的页号，但不分配它
+ * @return {page_id_t} 下一个被分配的页号
+ * @param {int} fd 指定文件的文件句柄
+ * @note 调用者需保证在此期间没有其他线程对该文件分配或释放页面
+ */
+page_id_t DiskManager::get_next_page_no(int fd) {
+    assert(fd >= 0 && fd < MAX_FD);
+    std::scoped_lock lock{free_latch_};
+    auto it = free_pages_.find(fd);
+    if (it != free_pages_.end() && !it->second.empty()) {
+        return it->second.back();
+    }
+    return fd2pageno_[fd];
 }
 
-void DiskManager::deallocate_page(__attribute__((unused)) page_id_t page_id) {}
+/**
+ * @description: 设置文件的空闲页面，用于打开文件时恢复上层模块持久化的空闲页面
+ * @param {int} fd 指定文件的文件句柄
+ * @param {vector<page_id_t>} free_pages 空闲页面，末尾的页面最先被分配
+ */
+void DiskManager::set_free_pages(int fd, std::vector<page_id_t> free_pages) {
+    std::scoped_lock lock{free_latch_};
+    free_pages_[fd] = std::move(free_pages);
+}
+
+/**
+ * @description: 获得文件目前的空闲页面，末尾的页面最先被分配
+ * @param {int} fd 指定文件的文件句柄
+ */
+std::vector<page_id_t> DiskManager::get_free_pages(int fd) {
+    std::scoped_lock lock{free_latch_};
+    auto it = free_pages_.find(fd);
+    return it == free_pages_.end() ? std::vector<page_id_t>() : it->second;
+}
 
 bool DiskManager::is_dir(const std::string& path) {
     struct stat st;
@@ -131,15 +455,34 @@ void DiskManager::destroy_file(const std::string &path) {
  * @param {string} &path 文件所在路径
  */
 int DiskManager::open_file(const std::string &path) {
+    std::scoped_lock lock{files_latch_};
     if (path2fd_.count(path)) {
         path_refcnt_[path] += 1;
         return path2fd_[path];
     }
-    int fd = open(path.c_str(), O_RDWR);
+    int flags = O_RDWR;
+    if (direct_io_ && path != LOG_FILE_NAME) {
+        flags |= O_DIRECT;
+    }
+    int fd = open(path.c_str(), flags);
+    if (fd == -1 && (flags & O_DIRECT) && errno == EINVAL) {
+        // 文件系统不支持O_DIRECT（例如tmpfs），以普通方式打开
+        flags &= ~O_DIRECT;
+        fd = open(path.c_str(), flags);
+    }
     if (fd == -1) {
         throw FileNotFoundError(path);
     }
     assert(fd >= 0 && fd < MAX_FD);
+    struct stat st;
+    if (fstat(fd, &st) == -1) {
+        close(fd);
+        throw UnixError();
+    }
+    fd2filesize_[fd].store(st.st_size, std::memory_order_relaxed);
+    fd2direct_[fd].store(flags & O_DIRECT, std::memory_order_relaxed);
+    fd2reads_[fd].store(0, std::memory_order_relaxed);
+    fd2writes_[fd].store(0, std::memory_order_relaxed);
     path2fd_[path] = fd;
     fd2path_[fd] = path;
     path_refcnt_[path] = 1;
@@ -151,6 +494,7 @@ int DiskManager::open_file(const std::string &path) {
  * @param {int} fd 打开的文件的文件句柄
  */
 void DiskManager::close_file(int fd) {
+    std::scoped_lock files_lock{files_latch_};
     if (!fd2path_.count(fd)) {
         throw FileNotOpenError(fd);
     }
@@ -166,6 +510,11 @@ void DiskManager::close_file(int fd) {
         path_refcnt_.erase(ref_it);
         fd2path_.erase(fd);
         path2fd_.erase(path);
+        fd2pagesize_[fd].store(PAGE_SIZE, std::memory_order_relaxed);
+        fd2direct_[fd].store(false, std::memory_order_relaxed);
+        fd2legacy_[fd].store(false, std::memory_order_relaxed);
+        std::scoped_lock lock{free_latch_};
+        free_pages_.erase(fd);
     }
 }
 
@@ -187,6 +536,7 @@ int DiskManager::get_file_size(const std::string &file_name) {
  * @param {int} fd 文件句柄
  */
 std::string DiskManager::get_file_name(int fd) {
+    std::scoped_lock lock{files_latch_};
     if (!fd2path_.count(fd)) {
         throw FileNotOpenError(fd);
     }
@@ -199,10 +549,32 @@ std::string DiskManager::get_file_name(int fd) {
  * @param {string} &file_name 文件名
  */
 int DiskManager::get_file_fd(const std::string &file_name) {
-    if (!path2fd_.count(file_name)) {
-        return open_file(file_name);
+    {
+        std::scoped_lock lock{files_latch_};
+        auto it = path2fd_.find(file_name);
+        if (it != path2fd_.end()) {
+            return it->second;
+        }
+    }
+    return open_file(file_name);
+}
+
+/**
+ * @description: 获得所有已打开文件自打开以来的页面读写次数，没有读写过的文件不返回
+ * @return {vector<FileIOStats>} 每个文件的读写次数，按文件名排序
+ */
+std::vector<FileIOStats> DiskManager::get_file_stats() {
+    std::vector<FileIOStats> stats;
+    std::scoped_lock lock{files_latch_};
+    for (auto &[fd, path] : fd2path_) {
+        uint64_t reads = fd2reads_[fd].load(std::memory_order_relaxed);
+        uint64_t writes = fd2writes_[fd].load(std::memory_order_relaxed);
+        if (reads > 0 || writes > 0) {
+            stats.push_back({path, reads, writes});
+        }
     }
-    return path2fd_[file_name];
+    std::sort(stats.begin(), stats.end(), [](const FileIOStats &a, const FileIOStats &b) { return a.name < b.name; });
+    return stats;
 }
 
 
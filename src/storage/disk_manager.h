@@ -4,31 +4,108 @@
 #include <sys/stat.h>  
 #include <unistd.h>    
 
+#include <algorithm>
 #include <atomic>
 #include <fstream>
 #include <iostream>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
+#include "async_io.h"
+#include "buffer_stats.h"
 #include "common/config.h"
 #include "errors.h"  
 
+/* 释放posix_memalign分配的内存 */
+struct AlignedDeleter {
+    void operator()(char *ptr) const { free(ptr); }
+};
+
+/* 按DIRECT_IO_ALIGNMENT对齐的缓冲区，O_DIRECT模式下直接读写磁盘的缓冲区地址和大小都必须对齐 */
+using AlignedBuffer = std::unique_ptr<char[], AlignedDeleter>;
+
 /**
  * @description: DiskManager的作用主要是根据上层的需要对磁盘文件进行操作
  */
 class DiskManager {
    public:
-    explicit DiskManager();
+    /**
+     * @param {bool} direct_io 是否以O_DIRECT打开之后的表和索引文件，绕过操作系统的页缓存
+     */
+    explicit DiskManager(bool direct_io = ENABLE_DIRECT_IO);
 
     ~DiskManager() = default;
 
     void write_page(int fd, page_id_t page_no, const char *offset, int num_bytes);
 
+    void write_pages(int fd, const page_id_t *page_nos, const char *const *bufs, int num_pages);
+
     void read_page(int fd, page_id_t page_no, char *offset, int num_bytes);
 
+    void read_pages(int fd, page_id_t start_page_no, char *const *bufs, int num_pages);
+
+    /**
+     * @description: 创建一个异步I/O上下文，用于在一个线程中批量提交页面读写请求
+     * @param {unsigned} queue_depth 同时进行的最大请求数
+     */
+    std::unique_ptr<AsyncIO> create_async_io(unsigned queue_depth = IO_QUEUE_DEPTH) {
+        return std::make_unique<AsyncIO>(this, queue_depth);
+    }
+
+    char *map_file(int fd, int *num_pages);
+
+    void unmap_file(char *addr, size_t num_bytes);
+
+    void advise_mapping(char *addr, size_t offset, size_t num_bytes, int advice);
+
+    static AlignedBuffer alloc_aligned(size_t num_bytes);
+
+    /**
+     * @description: 设置之后打开的表和索引文件是否使用O_DIRECT，已经打开的文件不受影响。
+     *              日志文件总是追加写入不足一个块的数据，不使用O_DIRECT
+     */
+    void set_direct_io(bool direct_io) { direct_io_ = direct_io; }
+
+    bool get_direct_io() const { return direct_io_; }
+
+    /**
+     * @description: 设置文件增长时预分配的区的大小（字节），为0时不预分配，页面写入时才逐页扩展文件
+     */
+    void set_extent_size(int extent_size) { extent_size_ = extent_size; }
+
+    int get_extent_size() const { return extent_size_; }
+
+    // 预分配区的次数
+    uint64_t get_num_extents() const { return num_extents_.load(std::memory_order_relaxed); }
+
+    // 文件是否以O_DIRECT打开；文件系统不支持O_DIRECT时文件以普通方式打开
+    bool is_direct_io(int fd) const { return fd2direct_[fd].load(std::memory_order_relaxed); }
+
+    // 文件的页面使用Page::LAYOUT_LEGACY布局时没有校验和，缓冲池读写时不计算也不检查校验和；由打开文件的上层根据文件头设置
+    void set_legacy_layout(int fd, bool legacy) { fd2legacy_[fd].store(legacy, std::memory_order_relaxed); }
+
+    bool has_page_checksums(int fd) const { return !fd2legacy_[fd].load(std::memory_order_relaxed); }
+
+    void set_page_size(int fd, int page_size);
+
+    /**
+     * @description: 获得文件的页面大小，没有设置过时为PAGE_SIZE
+     * @param {int} fd 文件句柄
+     */
+    int get_page_size(int fd) const { return fd2pagesize_[fd].load(std::memory_order_relaxed); }
+
     page_id_t allocate_page(int fd);
 
-    void deallocate_page(page_id_t page_id);
+    void deallocate_page(int fd, page_id_t page_no);
+
+    page_id_t get_next_page_no(int fd);
+
+    void set_free_pages(int fd, std::vector<page_id_t> free_pages);
+
+    std::vector<page_id_t> get_free_pages(int fd);
 
     /*目录操作*/
     bool is_dir(const std::string &path);
@@ -77,14 +154,73 @@ class DiskManager {
      */
     page_id_t get_fd2pageno(int fd) { return fd2pageno_[fd]; }
 
+    /**
+     * @description: 获得通过read_page/read_pages从磁盘读取的页面总数，用于统计缓冲池未命中的次数
+     */
+    uint64_t get_num_page_reads() const { return num_page_reads_.load(std::memory_order_relaxed); }
+
+    // 获得写入磁盘的页面总数
+    uint64_t get_num_page_writes() const { return num_page_writes_.load(std::memory_order_relaxed); }
+
+    void count_page_reads(int fd, uint64_t num_pages) {
+        num_page_reads_.fetch_add(num_pages, std::memory_order_relaxed);
+        fd2reads_[fd].fetch_add(num_pages, std::memory_order_relaxed);
+    }
+
+    void count_page_writes(int fd, uint64_t num_pages) {
+        num_page_writes_.fetch_add(num_pages, std::memory_order_relaxed);
+        fd2writes_[fd].fetch_add(num_pages, std::memory_order_relaxed);
+    }
+
+    // 同步读写的延迟，每次pread/preadv/pwrite/pwritev（含部分完成后的重试）记录一个样本；异步I/O只计入读写次数
+    LatencySnapshot get_read_latency() const { return read_latency_.snapshot(); }
+
+    LatencySnapshot get_write_latency() const { return write_latency_.snapshot(); }
+
+    std::vector<FileIOStats> get_file_stats();
+
+   private:
+    void extend_file(int fd, page_id_t page_no);
+
+    // 以O_DIRECT打开的文件上，地址或大小没有对齐的缓冲区需要经过对齐的中转缓冲区读写
+    bool needs_bounce(int fd, const void *buf, size_t num_bytes) const {
+        return is_direct_io(fd) &&
+               (reinterpret_cast<uintptr_t>(buf) % DIRECT_IO_ALIGNMENT != 0 || num_bytes % DIRECT_IO_ALIGNMENT != 0);
+    }
+
+    // 经过中转缓冲区读写时实际读写的字节数：至少一个页面，向上取整到DIRECT_IO_ALIGNMENT的倍数
+    static int bounce_length(int num_bytes, int page_size) {
+        int len = std::max(num_bytes, page_size);
+        return (len + DIRECT_IO_ALIGNMENT - 1) / DIRECT_IO_ALIGNMENT * DIRECT_IO_ALIGNMENT;
+    }
+
+   public:
+
    static constexpr int MAX_FD = 8192;
 
    private:
     // 文件打开列表，用于记录文件是否被打开
+    std::mutex files_latch_;                        // 保护path2fd_、path_refcnt_和fd2path_
     std::unordered_map<std::string, int> path2fd_;  //<Page文件磁盘路径,Page fd>哈希表
     std::unordered_map<std::string, int> path_refcnt_;  // 记录每个已打开文件的引用计数
     std::unordered_map<int, std::string> fd2path_;  //<Page fd,Page文件磁盘路径>哈希表
 
+    bool direct_io_;                              // 之后打开的表和索引文件是否使用O_DIRECT
     int log_fd_ = -1;                             // WAL日志文件的文件句柄，默认为-1，代表未打开日志文件
     std::atomic<page_id_t> fd2pageno_[MAX_FD]{};  // 文件中已经分配的页面个数，初始值为0
+    std::atomic<int> fd2pagesize_[MAX_FD];        // 文件的页面大小，初始值为PAGE_SIZE
+    std::atomic<bool> fd2direct_[MAX_FD]{};       // 文件是否以O_DIRECT打开
+    std::atomic<bool> fd2legacy_[MAX_FD]{};       // 文件的页面是否没有校验和（Page::LAYOUT_LEGACY）
+    std::atomic<int> extent_size_{FILE_EXTENT_SIZE};  // 文件增长时预分配的区的大小
+    std::atomic<off_t> fd2filesize_[MAX_FD]{};    // 文件已预分配空间的末尾（打开文件时取文件大小），分配的页面在此范围内时不需要扩展文件
+    std::atomic<uint64_t> num_extents_{0};        // 预分配区的次数
+    std::mutex extent_latch_;                     // 串行化extend_file
+    std::atomic<uint64_t> num_page_reads_{0};     // 从磁盘读取的页面总数
+    std::atomic<uint64_t> num_page_writes_{0};    // 写入磁盘的页面总数
+    std::atomic<uint64_t> fd2reads_[MAX_FD]{};    // 文件打开以来读取的页面个数
+    std::atomic<uint64_t> fd2writes_[MAX_FD]{};   // 文件打开以来写入的页面个数
+    LatencyHistogram read_latency_;               // 同步读的延迟
+    LatencyHistogram write_latency_;              // 同步写的延迟
+    std::mutex free_latch_;                       // 保护free_pages_
+    std::unordered_map<int, std::vector<page_id_t>> free_pages_;  // 每个文件中已释放、可重新分配的页面，末尾的页面最先被分配
 };
@@ -0,0 +1,72 @@
+#include "storage/frame_arena.h"
+
+#include <sys/mman.h>  // for mmap, madvise
+#include <unistd.h>    // for sysconf
+
+#include <cstdint>
+
+#include "errors.h"
+
+FrameArena::FrameArena(size_t num_bytes, bool huge_pages) : num_bytes_(num_bytes) {
+    if (num_bytes_ == 0) {
+        return;
+    }
+    // 匿名映射的内存在第一次访问时才由操作系统分配并清零，未使用的帧不占用物理内存
+    if (huge_pages && num_bytes_ >= HUGE_PAGE_SIZE) {
+        size_t length = (num_bytes_ + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+        void *addr = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (addr != MAP_FAILED) {
+            addr_ = static_cast<char *>(addr);
+            mapped_bytes_ = length;
+            backing_ = Backing::HUGETLB;
+            return;
+        }
+        // 没有足够的预留大页，多映射一个大页的长度，截取其中按HUGE_PAGE_SIZE对齐的部分
+        addr = mmap(nullptr, length + HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (addr == MAP_FAILED) {
+            throw UnixError();
+        }
+        char *begin = static_cast<char *>(addr);
+        char *aligned = reinterpret_cast<char *>((reinterpret_cast<uintptr_t>(begin) + HUGE_PAGE_SIZE - 1) &
+                                                 ~static_cast<uintptr_t>(HUGE_PAGE_SIZE - 1));
+        if (aligned != begin) {
+            munmap(begin, aligned - begin);
+        }
+        size_t tail = HUGE_PAGE_SIZE - (aligned - begin);
+        if (tail > 0) {
+            munmap(aligned + length, tail);
+        }
+        addr_ = aligned;
+        mapped_bytes_ = length;
+        // 内核未开启透明大页时madvise失败，arena仍可以使用普通页面
+        backing_ = madvise(addr_, mapped_bytes_, MADV_HUGEPAGE) == 0 ? Backing::TRANSPARENT_HUGE_PAGES : Backing::NORMAL;
+        return;
+    }
+    void *addr = mmap(nullptr, num_bytes_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (addr == MAP_FAILED) {
+        throw UnixError();
+    }
+    addr_ = static_cast<char *>(addr);
+    mapped_bytes_ = num_bytes_;
+}
+
+/**
+ * @description: 将arena中不再使用的一段内存归还给操作系统，之后再次访问时重新分配并清零。
+ *              只释放其中完整的页面（MAP_HUGETLB时为完整的大页），madvise失败时内存仍然可用
+ * @param {char*} addr 内存段的起始地址，位于arena中
+ * @param {size_t} num_bytes 内存段的大小
+ */
+void FrameArena::release(char *addr, size_t num_bytes) {
+    uintptr_t granularity = backing_ == Backing::HUGETLB ? HUGE_PAGE_SIZE : static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+    uintptr_t begin = (reinterpret_cast<uintptr_t>(addr) + granularity - 1) & ~(granularity - 1);
+    uintptr_t end = (reinterpret_cast<uintptr_t>(addr) + num_bytes) & ~(granularity - 1);
+    if (begin < end) {
+        madvise(reinterpret_cast<void *>(begin), end - begin, MADV_DONTNEED);
+    }
+}
+
+FrameArena::~FrameArena() {
+    if (addr_ != nullptr) {
+        munmap(addr_, mapped_bytes_);
+    }
+}
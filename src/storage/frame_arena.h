@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+
+#include "common/config.h"
+
+/**
+ * @description: 缓冲池帧内存的arena，所有分片的帧数据位于同一块匿名映射中，起始地址至少按PAGE_SIZE对齐（满足O_DIRECT的要求）。
+ * 使用大页时优先用MAP_HUGETLB从系统预留的大页中分配；没有足够的预留大页时，按HUGE_PAGE_SIZE对齐映射并通过
+ * madvise(MADV_HUGEPAGE)请求透明大页，两者都可以减少扫描大缓冲池时的TLB缺失。帧的元数据（Page对象）另外存放在各分片的数组中
+ */
+class FrameArena {
+   public:
+    /* arena实际使用的内存类型 */
+    enum class Backing { HUGETLB, TRANSPARENT_HUGE_PAGES, NORMAL };
+
+    /**
+     * @param {size_t} num_bytes arena的大小
+     * @param {bool} huge_pages 是否尝试使用大页，arena小于HUGE_PAGE_SIZE时总是使用普通页面
+     */
+    FrameArena(size_t num_bytes, bool huge_pages);
+
+    ~FrameArena();
+
+    FrameArena(const FrameArena &) = delete;
+    FrameArena &operator=(const FrameArena &) = delete;
+
+    char *data() const { return addr_; }
+
+    size_t size() const { return num_bytes_; }
+
+    Backing backing() const { return backing_; }
+
+    void release(char *addr, size_t num_bytes);
+
+   private:
+    char *addr_ = nullptr;      // arena的起始地址
+    size_t num_bytes_;          // 请求的大小
+    size_t mapped_bytes_ = 0;   // 映射的大小，使用大页时向上取整到HUGE_PAGE_SIZE
+    Backing backing_ = Backing::NORMAL;
+};
@@ -1,5 +1,9 @@
 #pragma once
 
+#include <atomic>
+#include <cstring>
+#include <shared_mutex>
+
 #include "common/config.h"
 
 /**
@@ -10,8 +14,9 @@ struct PageId {
     page_id_t page_no = INVALID_PAGE_ID;
 
     friend bool operator==(const PageId &x, const PageId &y) { return x.fd == y.fd && x.page_no == y.page_no; }
+    // 先按fd再按page_no比较
     bool operator<(const PageId& x) const {
-        if(fd < x.fd) return true;
+        if (fd != x.fd) return fd < x.fd;
         return page_no < x.page_no;
     }
 
@@ -19,19 +24,27 @@ struct PageId {
         return "{fd: " + std::to_string(fd) + " page_no: " + std::to_string(page_no) + "}"; 
     }
 
+    // fd和page_no各占32位，不同的PageId得到不同的值
     inline int64_t Get() const {
-        return (static_cast<int64_t>(fd << 16) | page_no);
+        return static_cast<int64_t>((static_cast<uint64_t>(static_cast<uint32_t>(fd)) << 32) |
+                                    static_cast<uint32_t>(page_no));
     }
 };
 
 // PageId的自定义哈希算法, 用于构建unordered_map<PageId, frame_id_t, PageIdHash>
+// 对Get()做64位混合（splitmix64的终结函数），结果的每一位都依赖fd和page_no的所有位，高低位都可以用来分桶
 struct PageIdHash {
-    size_t operator()(const PageId &x) const { return (x.fd << 16) | x.page_no; }
+    size_t operator()(const PageId &x) const {
+        uint64_t h = static_cast<uint64_t>(x.Get());
+        h = (h ^ (h >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        h = (h ^ (h >> 27)) * 0x94d049bb133111ebULL;
+        return static_cast<size_t>(h ^ (h >> 31));
+    }
 };
 
 template <>
 struct std::hash<PageId> {
-    size_t operator()(const PageId &obj) const { return std::hash<int64_t>()(obj.Get()); }
+    size_t operator()(const PageId &obj) const { return PageIdHash()(obj); }
 };
 
 /**
@@ -40,41 +53,110 @@ struct std::hash<PageId> {
  */
 class Page {
     friend class BufferPoolManager;
+    friend struct BufferPoolShard;
 
    public:
     
-    Page() { reset_memory(); }
+    Page() = default;
 
     ~Page() = default;
 
-    PageId get_page_id() const { return id_; }
+    PageId get_page_id() const { return id_.load(); }
 
     inline char *get_data() { return data_; }
 
+    // 页面大小（字节），由页面所属的文件决定
+    int get_page_size() const { return page_size_; }
+
     bool is_dirty() const { return is_dirty_; }
 
+    // 页面读写锁，保护data_中的内容；调用者必须先pin住页面，持有页面锁期间不能再获取缓冲池的锁
+    void rlatch() { rwlatch_.lock_shared(); }
+
+    void runlatch() { rwlatch_.unlock_shared(); }
+
+    void wlatch() { rwlatch_.lock(); }
+
+    void wunlatch() { rwlatch_.unlock(); }
+
+    // 页头：LSN、校验和，之后是表页面或索引节点各自的页头
     static constexpr size_t OFFSET_PAGE_START = 0;
     static constexpr size_t OFFSET_LSN = 0;
-    static constexpr size_t OFFSET_PAGE_HDR = 4;
+    static constexpr size_t OFFSET_CHECKSUM = 4;
+    static constexpr size_t OFFSET_PAGE_HDR = 8;
+
+    // 页面布局的版本，记录在表和索引的文件头中。LAYOUT_LEGACY是加入校验和之前的布局：页面没有校验和字段，
+    // 表页面的页头从第4字节开始，索引节点的页头从第0字节开始；这样的文件保持原来的布局，读写时不计算校验和
+    static constexpr int LAYOUT_LEGACY = 0;
+    static constexpr int LAYOUT_CHECKSUM = 1;
 
     inline lsn_t get_page_lsn() { return *reinterpret_cast<lsn_t *>(get_data() + OFFSET_LSN) ; }
 
     inline void set_page_lsn(lsn_t page_lsn) { memcpy(get_data() + OFFSET_LSN, &page_lsn, sizeof(lsn_t)); }
 
    private:
-    void reset_memory() { memset(data_, OFFSET_PAGE_START, PAGE_SIZE); }  // 将data_的PAGE_SIZE个字节填充为0
+    void reset_memory() { memset(data_, OFFSET_PAGE_START, page_size_); }  // 将data_的page_size_个字节填充为0
+
+    // pin_count_为PIN_CLAIMED表示帧已被淘汰、删除或预读占用，此时不能被固定
+    static constexpr int PIN_CLAIMED = -1;
+
+    // 未被占用时将pin_count_加1，不需要持有分片锁
+    bool try_pin() {
+        int count = pin_count_.load();
+        while (count >= 0) {
+            if (pin_count_.compare_exchange_weak(count, count + 1)) {
+                return true;
+            }
+        }
+        return false;
+    }
 
-    /** page的唯一标识符 */
-    PageId id_;
+    // pin_count_大于0时将其减1，is_dirty为true时在减1之前标记脏页
+    bool try_unpin(bool is_dirty) {
+        int count = pin_count_.load();
+        while (count > 0) {
+            if (is_dirty) {
+                is_dirty_ = true;
+            }
+            if (pin_count_.compare_exchange_weak(count, count - 1)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // 未被固定时占用该帧，调用者需持有分片锁
+    bool try_claim() {
+        int count = 0;
+        return pin_count_.compare_exchange_strong(count, PIN_CLAIMED);
+    }
+
+    /** page的唯一标识符，无锁查找时用于验证帧中仍是目标页面 */
+    std::atomic<PageId> id_{PageId{}};
 
     /** The actual data that is stored within a page.
-     *  该页面在bufferPool中的偏移地址
+     *  该页面在bufferPool中的偏移地址，指向所在分片的帧内存；只读映射的文件中则直接指向映射区域
      */
-    char data_[PAGE_SIZE] = {};
+    char *data_ = nullptr;
+
+    /** data_的大小，文件的页面大小在PAGE_SIZE到MAX_PAGE_SIZE之间 */
+    int page_size_ = PAGE_SIZE;
 
     /** 脏页判断 */
-    bool is_dirty_ = false;
+    std::atomic<bool> is_dirty_{false};
+
+    /** The pin count of this page. 无锁固定通过CAS修改，其余修改只在帧被占用（PIN_CLAIMED）时进行 */
+    std::atomic<int> pin_count_{0};
+
+    /** 该帧正在进行磁盘读写（淘汰写回、读入或后台写回），期间其他线程需等待I/O完成后再访问 */
+    std::atomic<bool> io_in_progress_{false};
+
+    /** 预读窗口的第一个页面，被访问时触发下一个窗口的预读 */
+    std::atomic<bool> read_ahead_marker_{false};
+
+    /** 上次淘汰扫描以来被固定过，淘汰时在replacer中记录一次访问而不淘汰它 */
+    std::atomic<bool> referenced_{false};
 
-    /** The pin count of this page. */
-    int pin_count_ = 0;
+    /** 页面内容的读写锁，与pin_count_等由分片锁保护的元数据无关 */
+    std::shared_mutex rwlatch_;
 };
\ No newline at end of file
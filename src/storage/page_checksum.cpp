@@ -0,0 +1,167 @@
+#include "storage/page_checksum.h"
+
+#include <array>
+#include <cstring>
+
+#if defined(__x86_64__)
+#include <nmmintrin.h>
+#endif
+
+#include "storage/page.h"
+
+namespace {
+
+constexpr uint32_t CRC32C_POLY = 0x82f63b78;  // Castagnoli多项式，按位反转
+
+constexpr std::array<uint32_t, 256> make_crc32c_table() {
+    std::array<uint32_t, 256> table{};
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t crc = i;
+        for (int j = 0; j < 8; j++) {
+            crc = (crc >> 1) ^ ((crc & 1) ? CRC32C_POLY : 0);
+        }
+        table[i] = crc;
+    }
+    return table;
+}
+
+constexpr std::array<uint32_t, 256> CRC32C_TABLE = make_crc32c_table();
+
+// 查表计算，crc为未取反的中间状态
+uint32_t crc32c_update_sw(uint32_t crc, const unsigned char *p, size_t len) {
+    while (len-- > 0) {
+        crc = (crc >> 8) ^ CRC32C_TABLE[(crc ^ *p++) & 0xff];
+    }
+    return crc;
+}
+
+inline uint64_t load_u64(const unsigned char *p) {
+    uint64_t word;
+    memcpy(&word, p, sizeof(word));
+    return word;
+}
+
+#if defined(__x86_64__)
+__attribute__((target("sse4.2"))) uint32_t crc32c_update_hw(uint32_t crc, const unsigned char *p, size_t len) {
+    uint64_t crc64 = crc;
+    for (; len >= 8; p += 8, len -= 8) {
+        crc64 = _mm_crc32_u64(crc64, load_u64(p));
+    }
+    crc = static_cast<uint32_t>(crc64);
+    for (; len > 0; p++, len--) {
+        crc = _mm_crc32_u8(crc, *p);
+    }
+    return crc;
+}
+
+// 同时计算三段数据的CRC：crc32指令的延迟为3个周期、吞吐为每周期1条，三条相互独立的依赖链可以让它满载
+__attribute__((target("sse4.2"))) void crc32c_lanes_hw(uint32_t crc[3], const unsigned char *lane[3],
+                                                      size_t lane_words) {
+    uint64_t c0 = crc[0], c1 = crc[1], c2 = crc[2];
+    for (size_t i = 0; i < lane_words * 8; i += 8) {
+        c0 = _mm_crc32_u64(c0, load_u64(lane[0] + i));
+        c1 = _mm_crc32_u64(c1, load_u64(lane[1] + i));
+        c2 = _mm_crc32_u64(c2, load_u64(lane[2] + i));
+    }
+    crc[0] = static_cast<uint32_t>(c0);
+    crc[1] = static_cast<uint32_t>(c1);
+    crc[2] = static_cast<uint32_t>(c2);
+}
+
+const bool HAS_SSE42 = __builtin_cpu_supports("sse4.2");
+#else
+constexpr bool HAS_SSE42 = false;
+#endif
+
+uint32_t crc32c_update(uint32_t crc, const unsigned char *p, size_t len) {
+#if defined(__x86_64__)
+    if (HAS_SSE42) {
+        return crc32c_update_hw(crc, p, len);
+    }
+#endif
+    return crc32c_update_sw(crc, p, len);
+}
+
+}  // namespace
+
+/**
+ * @description: 计算CRC32C
+ * @return {uint32_t} data的CRC32C；crc传入之前数据的结果时，返回之前数据与data连接后的CRC32C
+ * @param {void*} data 数据
+ * @param {size_t} len 数据长度
+ * @param {uint32_t} crc 之前数据的CRC32C，第一段数据为0
+ */
+uint32_t crc32c(const void *data, size_t len, uint32_t crc) {
+    return ~crc32c_update(~crc, static_cast<const unsigned char *>(data), len);
+}
+
+/**
+ * @description: 计算页面的校验和。校验和字段之后的部分按8字节对齐地分为长度相近的三段，分别计算CRC32C
+ *              （LSN并入第一段），再对三段的结果计算一次CRC32C得到校验和；三段可以交错计算，页号作为每一段的初值。
+ *              任意一段内的错误都会改变该段的CRC，进而改变校验和，检错能力与对整页计算一次CRC32C相当
+ * @return {uint32_t} 校验和
+ * @param {char*} data 页面内容
+ * @param {int} page_size 页面大小，为8的倍数
+ * @param {page_id_t} page_no 页号
+ */
+uint32_t page_checksum(const char *data, int page_size, page_id_t page_no) {
+    auto bytes = reinterpret_cast<const unsigned char *>(data);
+    uint32_t seed = ~static_cast<uint32_t>(page_no);
+    uint32_t crc[3] = {crc32c_update(seed, bytes + Page::OFFSET_LSN, Page::OFFSET_CHECKSUM - Page::OFFSET_LSN),
+                       seed, seed};
+    const unsigned char *body = bytes + Page::OFFSET_CHECKSUM + sizeof(uint32_t);
+    size_t body_len = page_size - Page::OFFSET_CHECKSUM - sizeof(uint32_t);
+    size_t lane_words = body_len / 8 / 3;
+    const unsigned char *lane[3] = {body, body + lane_words * 8, body + lane_words * 16};
+    size_t lane2_len = body_len - lane_words * 16;  // 第三段包括剩余的所有字节
+#if defined(__x86_64__)
+    if (HAS_SSE42) {
+        crc32c_lanes_hw(crc, lane, lane_words);
+        crc[2] = crc32c_update_hw(crc[2], lane[2] + lane_words * 8, lane2_len - lane_words * 8);
+    } else
+#endif
+    {
+        crc[0] = crc32c_update_sw(crc[0], lane[0], lane_words * 8);
+        crc[1] = crc32c_update_sw(crc[1], lane[1], lane_words * 8);
+        crc[2] = crc32c_update_sw(crc[2], lane[2], lane2_len);
+    }
+    return ~crc32c_update(seed, reinterpret_cast<const unsigned char *>(crc), sizeof(crc));
+}
+
+/**
+ * @description: 计算页面的校验和并写入页头
+ * @param {char*} data 页面内容
+ * @param {int} page_size 页面大小
+ * @param {page_id_t} page_no 页号
+ */
+void set_page_checksum(char *data, int page_size, page_id_t page_no) {
+    uint32_t checksum = page_checksum(data, page_size, page_no);
+    memcpy(data + Page::OFFSET_CHECKSUM, &checksum, sizeof(checksum));
+}
+
+/**
+ * @description: 检查页头中的校验和
+ * @return {bool} 校验和一致，或者页面全为零时返回true
+ * @param {char*} data 页面内容
+ * @param {int} page_size 页面大小
+ * @param {page_id_t} page_no 页号
+ */
+bool verify_page_checksum(const char *data, int page_size, page_id_t page_no) {
+    uint32_t stored;
+    memcpy(&stored, data + Page::OFFSET_CHECKSUM, sizeof(stored));
+    if (stored == page_checksum(data, page_size, page_no)) {
+        return true;
+    }
+    // 新分配但从未写入的页面，读取时文件末尾之后的部分被填充为零
+    if (stored != 0) {
+        return false;
+    }
+    for (int i = 0; i < page_size; i += 8) {
+        uint64_t word;
+        memcpy(&word, data + i, sizeof(word));
+        if (word != 0) {
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "common/config.h"
+
+// CRC32C（Castagnoli多项式），crc为之前数据的结果，可以分段计算；支持SSE4.2的CPU上使用crc32指令
+uint32_t crc32c(const void *data, size_t len, uint32_t crc = 0);
+
+// 计算页面的校验和，覆盖页面中除校验和字段外的所有字节，并混入页号以发现写错位置的页面
+uint32_t page_checksum(const char *data, int page_size, page_id_t page_no);
+
+// 将校验和写入页头，页面写入磁盘前调用
+void set_page_checksum(char *data, int page_size, page_id_t page_no);
+
+// 检查页头中的校验和，全零的页面（从未写入过的页面）视为有效
+bool verify_page_checksum(const char *data, int page_size, page_id_t page_no);
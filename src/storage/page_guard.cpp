@@ -0,0 +1,72 @@
+#include "page_guard.h"
+
+#include "buffer_pool_manager.h"
+
+BasicPageGuard::BasicPageGuard(BasicPageGuard &&that) noexcept
+    : bpm_(that.bpm_), page_(that.page_), is_dirty_(that.is_dirty_) {
+    that.bpm_ = nullptr;
+    that.page_ = nullptr;
+    that.is_dirty_ = false;
+}
+
+BasicPageGuard &BasicPageGuard::operator=(BasicPageGuard &&that) noexcept {
+    if (this != &that) {
+        drop();
+        bpm_ = that.bpm_;
+        page_ = that.page_;
+        is_dirty_ = that.is_dirty_;
+        that.bpm_ = nullptr;
+        that.page_ = nullptr;
+        that.is_dirty_ = false;
+    }
+    return *this;
+}
+
+/**
+ * @description: 提前释放守卫持有的页面，unpin后守卫变为空；对空守卫调用无效果
+ */
+void BasicPageGuard::drop() {
+    if (page_ == nullptr) {
+        return;
+    }
+    bpm_->unpin_page(page_->get_page_id(), is_dirty_);
+    bpm_ = nullptr;
+    page_ = nullptr;
+    is_dirty_ = false;
+}
+
+ReadPageGuard &ReadPageGuard::operator=(ReadPageGuard &&that) noexcept {
+    if (this != &that) {
+        drop();
+        guard_ = std::move(that.guard_);
+    }
+    return *this;
+}
+
+/**
+ * @description: 先释放页面的共享锁，再unpin页面
+ */
+void ReadPageGuard::drop() {
+    if (guard_.page_ != nullptr) {
+        guard_.page_->runlatch();
+    }
+    guard_.drop();
+}
+
+WritePageGuard &WritePageGuard::operator=(WritePageGuard &&that) noexcept {
+    if (this != &that) {
+        drop();
+        guard_ = std::move(that.guard_);
+    }
+    return *this;
+}
+
+/**
+ * @description: 先释放页面的排他锁，再unpin页面；修改过的页面以脏页的状态unpin
+ */
+void WritePageGuard::drop() {
+    if (guard_.page_ != nullptr) {
+        guard_.page_->wunlatch();
+    }
+    guard_.drop();
+}
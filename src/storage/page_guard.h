@@ -0,0 +1,113 @@
+#pragma once
+
+#include "page.h"
+
+class BufferPoolManager;
+
+/**
+ * @description: 页面守卫的公共部分，持有页面的一次pin，析构或drop()时自动unpin
+ * 只能移动不能拷贝，保证每次pin恰好对应一次unpin，异常路径上也不会泄漏pin
+ */
+class BasicPageGuard {
+    friend class ReadPageGuard;
+    friend class WritePageGuard;
+
+   public:
+    BasicPageGuard() = default;
+
+    BasicPageGuard(BufferPoolManager *bpm, Page *page) : bpm_(bpm), page_(page) {}
+
+    BasicPageGuard(const BasicPageGuard &) = delete;
+
+    BasicPageGuard &operator=(const BasicPageGuard &) = delete;
+
+    BasicPageGuard(BasicPageGuard &&that) noexcept;
+
+    BasicPageGuard &operator=(BasicPageGuard &&that) noexcept;
+
+    ~BasicPageGuard() { drop(); }
+
+    void drop();
+
+    bool is_valid() const { return page_ != nullptr; }
+
+    PageId get_page_id() const { return page_->get_page_id(); }
+
+   private:
+    BufferPoolManager *bpm_ = nullptr;  // 页面所在的缓冲池
+    Page *page_ = nullptr;              // 被pin住的页面，为nullptr表示守卫为空
+    bool is_dirty_ = false;             // unpin时是否将页面标记为脏页
+};
+
+/**
+ * @description: 读页面守卫，持有页面的pin和共享锁，多个读者可以同时访问同一页面
+ */
+class ReadPageGuard {
+   public:
+    ReadPageGuard() = default;
+
+    // 传入的页面必须已经被pin住且加了共享锁
+    ReadPageGuard(BufferPoolManager *bpm, Page *page) : guard_(bpm, page) {}
+
+    ReadPageGuard(ReadPageGuard &&that) noexcept = default;
+
+    ReadPageGuard &operator=(ReadPageGuard &&that) noexcept;
+
+    ~ReadPageGuard() { drop(); }
+
+    void drop();
+
+    bool is_valid() const { return guard_.is_valid(); }
+
+    PageId get_page_id() const { return guard_.get_page_id(); }
+
+    // 持有共享锁，只能读取返回页面的内容
+    Page *get_page() const { return guard_.page_; }
+
+    const char *get_data() const { return guard_.page_->get_data(); }
+
+    template <class T>
+    const T *as() const { return reinterpret_cast<const T *>(get_data()); }
+
+   private:
+    BasicPageGuard guard_;
+};
+
+/**
+ * @description: 写页面守卫，持有页面的pin和排他锁；通过get_data()修改页面时自动标记为脏页
+ */
+class WritePageGuard {
+   public:
+    WritePageGuard() = default;
+
+    // 传入的页面必须已经被pin住且加了排他锁
+    WritePageGuard(BufferPoolManager *bpm, Page *page) : guard_(bpm, page) {}
+
+    WritePageGuard(WritePageGuard &&that) noexcept = default;
+
+    WritePageGuard &operator=(WritePageGuard &&that) noexcept;
+
+    ~WritePageGuard() { drop(); }
+
+    void drop();
+
+    bool is_valid() const { return guard_.is_valid(); }
+
+    PageId get_page_id() const { return guard_.get_page_id(); }
+
+    // 返回页面但不标记脏页，修改页面内容后需要调用set_dirty()
+    Page *get_page() const { return guard_.page_; }
+
+    void set_dirty() { guard_.is_dirty_ = true; }
+
+    char *get_data() {
+        set_dirty();
+        return guard_.page_->get_data();
+    }
+
+    template <class T>
+    T *as_mut() { return reinterpret_cast<T *>(get_data()); }
+
+   private:
+    BasicPageGuard guard_;
+};
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+
+#include "page.h"
+
+/**
+ * @description: 缓冲池分片的页表，PageId到分片内帧编号的开放寻址（线性探测）哈希表，容量在构造时确定。
+ * 插入和删除只在持有分片锁时进行（单写者），find()不加锁：删除时向前移动表项，并发的读者可能漏掉一个
+ * 存在的页面，或读到已被改写的帧编号。因此无锁查找的结果必须在帧上用Page::id_验证，查找失败时退回到加锁查找。
+ * 槽位由哈希值的低位决定，Hash的低位需要充分混合
+ */
+template <class Hash = PageIdHash>
+class PageTable {
+   public:
+    // max_entries为同时存在的表项个数上限，容量取不小于其两倍的2的幂
+    explicit PageTable(size_t max_entries) {
+        size_t capacity = 16;
+        while (capacity < 2 * max_entries) {
+            capacity <<= 1;
+        }
+        slots_ = std::make_unique<Slot[]>(capacity);
+        mask_ = capacity - 1;
+    }
+
+    // 查找page_id所在的帧，可以不持有分片锁
+    bool find(const PageId &page_id, frame_id_t *frame_id) const {
+        uint64_t key = pack(page_id);
+        for (size_t i = home(page_id), n = 0; n <= mask_; i = (i + 1) & mask_, n++) {
+            uint64_t slot_key = slots_[i].key.load(std::memory_order_acquire);
+            if (slot_key == EMPTY_KEY) {
+                return false;
+            }
+            if (slot_key == key) {
+                *frame_id = slots_[i].frame_id.load(std::memory_order_relaxed);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool contains(const PageId &page_id) const {
+        frame_id_t frame_id;
+        return find(page_id, &frame_id);
+    }
+
+    // 插入或更新page_id所在的帧，调用者需持有分片锁
+    void insert(const PageId &page_id, frame_id_t frame_id) {
+        uint64_t key = pack(page_id);
+        size_t i = home(page_id);
+        while (true) {
+            uint64_t slot_key = slots_[i].key.load(std::memory_order_relaxed);
+            if (slot_key == key) {
+                slots_[i].frame_id.store(frame_id, std::memory_order_release);
+                return;
+            }
+            if (slot_key == EMPTY_KEY) {
+                slots_[i].frame_id.store(frame_id, std::memory_order_relaxed);
+                slots_[i].key.store(key, std::memory_order_release);
+                size_++;
+                return;
+            }
+            i = (i + 1) & mask_;
+        }
+    }
+
+    // 删除page_id的表项，并将其后同一探测序列上的表项前移填补空位，调用者需持有分片锁
+    bool erase(const PageId &page_id) {
+        uint64_t key = pack(page_id);
+        size_t i = home(page_id);
+        while (true) {
+            uint64_t slot_key = slots_[i].key.load(std::memory_order_relaxed);
+            if (slot_key == EMPTY_KEY) {
+                return false;
+            }
+            if (slot_key == key) {
+                break;
+            }
+            i = (i + 1) & mask_;
+        }
+        size_t j = i;
+        while (true) {
+            j = (j + 1) & mask_;
+            uint64_t slot_key = slots_[j].key.load(std::memory_order_relaxed);
+            if (slot_key == EMPTY_KEY) {
+                break;
+            }
+            // 表项j的起始位置k在(i, j]之间时不能前移到i
+            size_t k = home(unpack(slot_key));
+            if (i <= j ? (i < k && k <= j) : (i < k || k <= j)) {
+                continue;
+            }
+            slots_[i].frame_id.store(slots_[j].frame_id.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            slots_[i].key.store(slot_key, std::memory_order_release);
+            i = j;
+        }
+        slots_[i].key.store(EMPTY_KEY, std::memory_order_release);
+        size_--;
+        return true;
+    }
+
+    size_t size() const { return size_; }
+
+    // 遍历所有表项，调用者需持有分片锁
+    template <class F>
+    void for_each(F &&f) const {
+        for (size_t i = 0; i <= mask_; i++) {
+            uint64_t slot_key = slots_[i].key.load(std::memory_order_relaxed);
+            if (slot_key != EMPTY_KEY) {
+                f(unpack(slot_key), slots_[i].frame_id.load(std::memory_order_relaxed));
+            }
+        }
+    }
+
+   private:
+    static constexpr uint64_t EMPTY_KEY = ~0ULL;   // fd和page_no都为-1，不是合法的PageId
+
+    struct Slot {
+        std::atomic<uint64_t> key{EMPTY_KEY};
+        std::atomic<frame_id_t> frame_id{INVALID_FRAME_ID};
+    };
+
+    static uint64_t pack(const PageId &page_id) {
+        return static_cast<uint64_t>(page_id.Get());
+    }
+
+    static PageId unpack(uint64_t key) {
+        return {.fd = static_cast<int>(key >> 32), .page_no = static_cast<page_id_t>(static_cast<uint32_t>(key))};
+    }
+
+    size_t home(const PageId &page_id) const { return Hash()(page_id) & mask_; }
+
+    std::unique_ptr<Slot[]> slots_;     // 哈希表的槽
+    size_t mask_;                       // 容量减1
+    size_t size_ = 0;                   // 表项个数，只在持有分片锁时读写
+};
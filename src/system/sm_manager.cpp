@@ -70,8 +70,10 @@ void SmManager::drop_db(const std::string& db_name) {
 /**
  * @description: 打开数据库，找到数据库对应的文件夹，并加载数据库元数据和相关文件
  * @param {string&} db_name 数据库名称，与文件夹同名
+ * @param {bool} read_only 以只读方式打开，表和索引文件被只读映射到内存中，访问页面时不经过缓冲池的帧拷贝，
+ *                         用于加载后不再修改的只读库
  */
-void SmManager::open_db(const std::string& db_name) {
+void SmManager::open_db(const std::string& db_name, bool read_only) {
     if (!is_dir(db_name)) {
         throw DatabaseNotFoundError(db_name);
     }
@@ -84,14 +86,22 @@ void SmManager::open_db(const std::string& db_name) {
     }
     ifs >> db_;
     db_.name_ = db_name;
+    read_only_ = read_only;
 
     // open all table files
     for (auto &entry : db_.tabs_) {
         auto &tab_name = entry.first;
         fhs_[tab_name] = rm_manager_->open_file(tab_name);
+        if (read_only_) {
+            buffer_pool_manager_->map_file(fhs_[tab_name]->GetFd());
+        }
         // open indexes on the table
         for (auto &index : entry.second.indexes) {
-            ihs_[ix_manager_->get_index_name(tab_name, index.cols)] = ix_manager_->open_index(tab_name, index.cols);
+            auto ix_name = ix_manager_->get_index_name(tab_name, index.cols);
+            ihs_[ix_name] = ix_manager_->open_index(tab_name, index.cols);
+            if (read_only_) {
+                buffer_pool_manager_->map_file(ihs_[ix_name]->get_fd());
+            }
         }
     }
 }
@@ -109,6 +119,22 @@ void SmManager::flush_meta() {
  * @description: 关闭数据库并把数据落盘
  */
 void SmManager::close_db() {
+    if (read_only_) {
+        // 只读打开的数据库没有被修改，只需解除映射并关闭文件
+        for (auto &entry : ihs_) {
+            buffer_pool_manager_->unmap_file(entry.second->get_fd());
+            disk_manager_->close_file(entry.second->get_fd());
+        }
+        ihs_.clear();
+        for (auto &entry : fhs_) {
+            buffer_pool_manager_->unmap_file(entry.second->GetFd());
+            disk_manager_->close_file(entry.second->GetFd());
+            disk_manager_->close_file(entry.second->get_fsm_fd());
+        }
+        fhs_.clear();
+        read_only_ = false;
+        return;
+    }
     // close index handles
     for (auto &entry : ihs_) {
         ix_manager_->close_index(entry.second.get());
@@ -122,6 +148,16 @@ void SmManager::close_db() {
     flush_meta();
 }
 
+/**
+ * @description: 检查当前数据库是否允许修改，DDL和DML语句执行前调用。只读打开的数据库的文件被只读映射，
+ *              写入页面会直接访问只读内存，因此必须在执行前拒绝
+ */
+void SmManager::check_writable() const {
+    if (read_only_) {
+        throw DatabaseReadOnlyError(db_.name_);
+    }
+}
+
 /**
  * @description: 显示所有的表,通过测试需要将其结果写入到output.txt,详情看题目文档
  * @param {Context*} context 
@@ -143,6 +179,41 @@ void SmManager::show_tables(Context* context) {
     outfile.close();
 }
 
+/**
+ * @description: 显示缓冲池和磁盘I/O的统计：各项指标，以及每个已打开文件读写的页面个数
+ * @param {Context*} context 
+ */
+void SmManager::show_buffer_status(Context* context) {
+    BufferPoolStatus status = buffer_pool_manager_->get_status();
+    std::fstream outfile;
+    outfile.open("output.txt", std::ios::out | std::ios::app);
+
+    RecordPrinter printer(2);
+    printer.print_separator(context);
+    printer.print_record({"Name", "Value"}, context);
+    printer.print_separator(context);
+    outfile << "| Name | Value |\n";
+    for (auto &[name, value] : status.metrics) {
+        printer.print_record({name, value}, context);
+        outfile << "| " << name << " | " << value << " |\n";
+    }
+    printer.print_separator(context);
+
+    RecordPrinter file_printer(3);
+    file_printer.print_separator(context);
+    file_printer.print_record({"File", "Reads", "Writes"}, context);
+    file_printer.print_separator(context);
+    outfile << "| File | Reads | Writes |\n";
+    for (auto &file : status.files) {
+        std::string reads = std::to_string(file.page_reads);
+        std::string writes = std::to_string(file.page_writes);
+        file_printer.print_record({file.name, reads, writes}, context);
+        outfile << "| " << file.name << " | " << reads << " | " << writes << " |\n";
+    }
+    file_printer.print_separator(context);
+    outfile.close();
+}
+
 /**
  * @description: 显示表的元数据
  * @param {string&} tab_name 表名称
@@ -171,8 +242,11 @@ void SmManager::desc_table(const std::string& tab_name, Context* context) {
  * @param {string&} tab_name 表的名称
  * @param {vector<ColDef>&} col_defs 表的字段
  * @param {Context*} context 
+ * @param {int} page_size 表数据文件的页面大小
  */
-void SmManager::create_table(const std::string& tab_name, const std::vector<ColDef>& col_defs, Context* context) {
+void SmManager::create_table(const std::string& tab_name, const std::vector<ColDef>& col_defs, Context* context,
+                             int page_size) {
+    check_writable();
     if (db_.is_table(tab_name)) {
         throw TableExistsError(tab_name);
     }
@@ -187,12 +261,18 @@ void SmManager::create_table(const std::string& tab_name, const std::vector<ColD
                        .len = col_def.len,
                        .offset = curr_offset,
                        .index = false};
-        curr_offset += col_def.len;
+        curr_offset += col.fixed_len();
         tab.cols.push_back(col);
     }
     // Create & open record file
     int record_size = curr_offset;  // record_size就是col meta所占的大小（表的元数据也是以记录的形式进行存储的）
-    rm_manager_->create_file(tab_name, record_size);
+    // 有变长字段时记录的最大长度还包括每个VARCHAR字段的最大长度，数据文件使用分槽格式
+    for (auto &col : tab.cols) {
+        if (col.type == TYPE_VARCHAR) {
+            record_size += col.len;
+        }
+    }
+    rm_manager_->create_file(tab_name, record_size, page_size, tab.is_varlen() ? RM_FORMAT_SLOTTED : RM_FORMAT_FIXED);
     db_.tabs_[tab_name] = tab;
     // fhs_[tab_name] = rm_manager_->open_file(tab_name);
     fhs_.emplace(tab_name, rm_manager_->open_file(tab_name));
@@ -206,6 +286,7 @@ void SmManager::create_table(const std::string& tab_name, const std::vector<ColD
  * @param {Context*} context
  */
 void SmManager::drop_table(const std::string& tab_name, Context* context) {
+    check_writable();
     if (!db_.is_table(tab_name)) {
         throw TableNotFoundError(tab_name);
     }
@@ -237,8 +318,11 @@ void SmManager::drop_table(const std::string& tab_name, Context* context) {
  * @param {string&} tab_name 表的名称
  * @param {vector<string>&} col_names 索引包含的字段名称
  * @param {Context*} context
+ * @param {int} page_size 索引文件的页面大小
  */
-void SmManager::create_index(const std::string& tab_name, const std::vector<std::string>& col_names, Context* context) {
+void SmManager::create_index(const std::string& tab_name, const std::vector<std::string>& col_names, Context* context,
+                             int page_size) {
+    check_writable();
     TabMeta &tab = db_.get_table(tab_name);
     if (tab.is_index(col_names)) {
         throw IndexExistsError(tab_name, col_names);
@@ -249,11 +333,14 @@ void SmManager::create_index(const std::string& tab_name, const std::vector<std:
         auto it = tab.get_col(name);
         cols.push_back(*it);
         tot_len += it->len;
-        it->index = true;
+    }
+    // 先创建索引文件，页面大小不合法时不修改表的元数据
+    ix_manager_->create_index(tab_name, cols, page_size);
+    for (auto &name : col_names) {
+        tab.get_col(name)->index = true;
     }
     IndexMeta meta{tab_name, tot_len, static_cast<int>(cols.size()), cols};
     tab.indexes.push_back(meta);
-    ix_manager_->create_index(tab_name, cols);
     ihs_[ix_manager_->get_index_name(tab_name, cols)] = ix_manager_->open_index(tab_name, cols);
     flush_meta();
 }
@@ -265,6 +352,7 @@ void SmManager::create_index(const std::string& tab_name, const std::vector<std:
  * @param {Context*} context
  */
 void SmManager::drop_index(const std::string& tab_name, const std::vector<std::string>& col_names, Context* context) {
+    check_writable();
     TabMeta &tab = db_.get_table(tab_name);
     auto it_meta = tab.get_index_meta(col_names);
     for (auto &name : col_names) {
@@ -25,6 +25,7 @@ class SmManager {
     BufferPoolManager* buffer_pool_manager_;
     RmManager* rm_manager_;
     IxManager* ix_manager_;
+    bool read_only_ = false;    // 数据库以只读方式打开，表和索引文件被只读映射，不允许修改
 
    public:
     SmManager(DiskManager* disk_manager, BufferPoolManager* buffer_pool_manager, RmManager* rm_manager,
@@ -48,7 +49,11 @@ class SmManager {
 
     void drop_db(const std::string& db_name);
 
-    void open_db(const std::string& db_name);
+    void open_db(const std::string& db_name, bool read_only = false);
+
+    bool is_read_only() const { return read_only_; }
+
+    void check_writable() const;
 
     void close_db();
 
@@ -56,13 +61,17 @@ class SmManager {
 
     void show_tables(Context* context);
 
+    void show_buffer_status(Context* context);
+
     void desc_table(const std::string& tab_name, Context* context);
 
-    void create_table(const std::string& tab_name, const std::vector<ColDef>& col_defs, Context* context);
+    void create_table(const std::string& tab_name, const std::vector<ColDef>& col_defs, Context* context,
+                      int page_size = PAGE_SIZE);
 
     void drop_table(const std::string& tab_name, Context* context);
 
-    void create_index(const std::string& tab_name, const std::vector<std::string>& col_names, Context* context);
+    void create_index(const std::string& tab_name, const std::vector<std::string>& col_names, Context* context,
+                      int page_size = PAGE_SIZE);
 
     void drop_index(const std::string& tab_name, const std::vector<std::string>& col_names, Context* context);
     
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <algorithm>
+#include <cstdint>
+#include <cstring>
 #include <iostream>
 #include <map>
 #include <string>
@@ -9,15 +11,44 @@
 #include "errors.h"
 #include "sm_defs.h"
 
+/* VARCHAR字段在记录定长部分中存放的内容，字段的值依次存放在记录的定长部分之后 */
+struct VarcharRef {
+    uint16_t offset;    // 字段的值在记录中的偏移量
+    uint16_t len;       // 字段的值的长度
+};
+
 /* 字段元数据 */
 struct ColMeta {
     std::string tab_name;   // 字段所属表名称
     std::string name;       // 字段名称
     ColType type;           // 字段类型
-    int len;                // 字段长度
-    int offset;             // 字段位于记录中的偏移量
+    int len;                // 字段长度，VARCHAR字段为最大长度
+    int offset;             // 字段位于记录（定长部分）中的偏移量
     bool index;             /** unused */
 
+    // 字段在记录定长部分中占用的字节数
+    int fixed_len() const { return type == TYPE_VARCHAR ? static_cast<int>(sizeof(VarcharRef)) : len; }
+
+    // 记录rec中该字段的值，value_len返回值的长度；CHAR字段的值包括末尾补的0
+    const char *get_value(const char *rec, int *value_len) const {
+        if (type != TYPE_VARCHAR) {
+            *value_len = len;
+            return rec + offset;
+        }
+        VarcharRef ref;
+        memcpy(&ref, rec + offset, sizeof(ref));
+        *value_len = ref.len;
+        return rec + ref.offset;
+    }
+
+    // 把记录rec中该字段的值写入len字节的索引键，VARCHAR的值末尾补0，与同样长度的CHAR字段的键相同
+    void copy_key(const char *rec, char *key) const {
+        int value_len;
+        const char *value = get_value(rec, &value_len);
+        memcpy(key, value, value_len);
+        memset(key + value_len, 0, len - value_len);
+    }
+
     friend std::ostream &operator<<(std::ostream &os, const ColMeta &col) {
         // ColMeta中有各个基本类型的变量，然后调用重载的这些变量的操作符<<（具体实现逻辑在defs.h）
         return os << col.tab_name << ' ' << col.name << ' ' << col.type << ' ' << col.len << ' ' << col.offset << ' '
@@ -68,6 +99,11 @@ struct TabMeta {
         for(auto col : other.cols) cols.push_back(col);
     }
 
+    /* 表中是否有变长字段，有变长字段的表的数据文件使用分槽格式 */
+    bool is_varlen() const {
+        return std::any_of(cols.begin(), cols.end(), [](const ColMeta &col) { return col.type == TYPE_VARCHAR; });
+    }
+
     /* 判断当前表中是否存在名为col_name的字段 */
     bool is_col(const std::string &col_name) const {
         auto pos = std::find_if(cols.begin(), cols.end(), [&](const ColMeta &col) { return col.name == col_name; });
@@ -491,4 +491,57 @@ TEST_F(BPlusTreeTests, LargeScaleTest) {
     }
     std::cout << "Insert keys count: " << add_cnt << '\n' << "Delete keys count: " << del_cnt << '\n';
     check_all(ih_.get(), mock);
-}
\ No newline at end of file
+}
+/**
+ * @brief 反复插入并删除同一批键值对，删除时释放的页面应被之后的插入复用，索引文件不再增长；
+ * 重新打开索引后，空闲链表中的页面仍然可以被复用
+ */
+TEST_F(BPlusTreeTests, FreePageReuseTest) {
+    const int order = 4;
+    const int scale = 200;
+    const int rounds = 5;
+    ih_->file_hdr_->btree_order_ = order;
+
+    // 始终保留一个键值对，以防变成空树
+    std::multimap<int, Rid> mock;
+    int last_key = scale;
+    Rid last_rid = {.page_no = 0, .slot_no = last_key};
+    ASSERT_NE(ih_->insert_entry((const char *)&last_key, last_rid, txn_.get()), IX_NO_PAGE);
+    mock.insert(std::make_pair(last_key, last_rid));
+
+    auto insert_all = [&](int round) {
+        for (int key = 0; key < scale; key++) {
+            Rid rid = {.page_no = round, .slot_no = key};
+            ASSERT_NE(ih_->insert_entry((const char *)&key, rid, txn_.get()), IX_NO_PAGE);
+            mock.insert(std::make_pair(key, rid));
+        }
+        check_all(ih_.get(), mock);
+    };
+
+    int num_pages = 0;
+    for (int round = 0; round < rounds; round++) {
+        insert_all(round);
+        if (round == 0) {
+            num_pages = ih_->file_hdr_->num_pages_;
+        }
+        // 每一轮插入后的树结构相同，所需页面全部来自上一轮释放的页面
+        EXPECT_EQ(ih_->file_hdr_->num_pages_, num_pages);
+        EXPECT_EQ(disk_manager_->get_fd2pageno(ih_->fd_), num_pages);
+        EXPECT_TRUE(disk_manager_->get_free_pages(ih_->fd_).empty());
+
+        for (int key = 0; key < scale; key++) {
+            ASSERT_TRUE(ih_->delete_entry((const char *)&key, txn_.get()));
+            mock.erase(key);
+        }
+        check_all(ih_.get(), mock);
+        EXPECT_FALSE(disk_manager_->get_free_pages(ih_->fd_).empty());
+    }
+
+    // 重新打开索引，空闲链表从文件中恢复
+    std::vector<page_id_t> free_pages = disk_manager_->get_free_pages(ih_->fd_);
+    ix_manager_->close_index(ih_.get());
+    ih_ = ix_manager_->open_index(TEST_FILE_NAME, TEST_COL);
+    EXPECT_EQ(disk_manager_->get_free_pages(ih_->fd_), free_pages);
+    insert_all(rounds);
+    EXPECT_EQ(ih_->file_hdr_->num_pages_, num_pages);
+}
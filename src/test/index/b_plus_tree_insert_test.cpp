@@ -412,4 +412,125 @@ TEST_F(BPlusTreeTests, LargeScaleTest) {
         scan.next();
     }
     EXPECT_EQ(current_key, keys.size() + 1);
-}
\ No newline at end of file
+}
+/**
+ * @brief 用insert_entries分批插入10000个key，每批内部无序，批与批之间有升序、随机两种顺序，
+ * 使用check_all检查树的结构和全部(key,rid)
+ */
+TEST_F(BPlusTreeTests, BatchInsertTest) {
+    const int scale = 10000;
+    const int batch_size = 500;
+    const int order = 8;
+
+    assert(order > 2 && order <= ih_->file_hdr_->btree_order_);
+    ih_->file_hdr_->btree_order_ = order;
+
+    // 前一半key按批升序（追加到树的最右端），后一半打乱后分批插入
+    std::vector<int> keys;
+    for (int key = 1; key <= scale; key++) {
+        keys.push_back(key);
+    }
+    auto rng = std::default_random_engine{};
+    std::shuffle(keys.begin() + scale / 2, keys.end(), rng);
+    for (int begin = 0; begin < scale / 2; begin += batch_size) {
+        std::shuffle(keys.begin() + begin, keys.begin() + begin + batch_size, rng);
+    }
+
+    std::multimap<int, Rid> mock;
+    for (int begin = 0; begin < scale; begin += batch_size) {
+        std::vector<std::pair<const char *, Rid>> entries;
+        for (int i = begin; i < begin + batch_size; i++) {
+            Rid rid = {.page_no = keys[i] / 100, .slot_no = keys[i] % 100};
+            entries.emplace_back((const char *)&keys[i], rid);
+            mock.insert({keys[i], rid});
+        }
+        ih_->insert_entries(std::move(entries), txn_.get());
+    }
+    check_all(ih_.get(), mock);
+
+    std::vector<Rid> rids;
+    for (int key : keys) {
+        rids.clear();
+        ih_->get_value((const char *)&key, &rids, txn_.get());
+        ASSERT_EQ(rids.size(), 1);
+        EXPECT_EQ(rids[0], mock.find(key)->second);
+    }
+}
+
+/**
+ * @brief 打开加入校验和之前的版本创建的索引文件：文件头中没有page_size_和layout_version_，IxPageHdr位于页面开头，
+ * 页面没有校验和。查找、插入（包括分裂）都按原来的布局进行，写回的页面不带校验和，重新打开后内容不变
+ */
+TEST_F(BPlusTreeTests, LegacyLayoutTest) {
+    // 按之前版本的IxManager::create_index写出索引文件，根节点是已有若干key的叶子
+    const std::vector<std::string> legacy_col = {"legacy"};
+    std::string ix_name = ix_manager_->get_index_name(TEST_FILE_NAME, legacy_col);
+    disk_manager_->create_file(ix_name);
+    int fd = disk_manager_->open_file(ix_name);
+
+    const int col_len = sizeof(int);
+    const int btree_order = static_cast<int>((PAGE_SIZE - sizeof(IxPageHdr)) / (col_len + sizeof(Rid)) - 1);
+    const int keys_size = (btree_order + 1) * col_len;
+    IxFileHdr hdr(IX_NO_PAGE, IX_INIT_NUM_PAGES, IX_INIT_ROOT_PAGE, 1, col_len, btree_order, keys_size,
+                  IX_INIT_ROOT_PAGE, IX_INIT_ROOT_PAGE);
+    hdr.col_types_.push_back(TYPE_INT);
+    hdr.col_lens_.push_back(col_len);
+    hdr.update_tot_len();
+    std::vector<char> page(PAGE_SIZE, 0);
+    hdr.serialize(page.data());
+    int legacy_tot_len = hdr.tot_len_ - 2 * static_cast<int>(sizeof(int));
+    memcpy(page.data(), &legacy_tot_len, sizeof(int));
+    disk_manager_->write_page(fd, IX_FILE_HDR_PAGE, page.data(), PAGE_SIZE);
+
+    std::fill(page.begin(), page.end(), 0);
+    IxPageHdr page_hdr = {IX_NO_PAGE, IX_NO_PAGE, 0, true, IX_INIT_ROOT_PAGE, IX_INIT_ROOT_PAGE};
+    memcpy(page.data() + IX_LEGACY_PAGE_HDR_OFFSET, &page_hdr, sizeof(page_hdr));
+    disk_manager_->write_page(fd, IX_LEAF_HEADER_PAGE, page.data(), PAGE_SIZE);
+
+    const int num_legacy = 4;
+    std::multimap<int, Rid> mock;
+    page_hdr = {IX_NO_PAGE, IX_NO_PAGE, num_legacy, true, IX_LEAF_HEADER_PAGE, IX_LEAF_HEADER_PAGE};
+    memcpy(page.data() + IX_LEGACY_PAGE_HDR_OFFSET, &page_hdr, sizeof(page_hdr));
+    char *keys = page.data() + IX_LEGACY_PAGE_HDR_OFFSET + sizeof(IxPageHdr);
+    auto rids = reinterpret_cast<Rid *>(keys + keys_size);
+    for (int i = 0; i < num_legacy; i++) {
+        int key = 2 * i;
+        memcpy(keys + i * col_len, &key, col_len);
+        rids[i] = {.page_no = key / 100, .slot_no = key % 100};
+        mock.insert({key, rids[i]});
+    }
+    disk_manager_->write_page(fd, IX_INIT_ROOT_PAGE, page.data(), PAGE_SIZE);
+    disk_manager_->close_file(fd);
+
+    auto ih = ix_manager_->open_index(TEST_FILE_NAME, legacy_col);
+    EXPECT_EQ(Page::LAYOUT_LEGACY, ih->file_hdr_->layout_version_);
+    EXPECT_EQ(PAGE_SIZE, ih->file_hdr_->page_size_);
+    EXPECT_FALSE(disk_manager_->has_page_checksums(ih->fd_));
+    check_all(ih.get(), mock);
+
+    // 减小order后插入足够多的key，使叶子和根节点分裂
+    ih->file_hdr_->btree_order_ = 4;
+    for (int key = 1; key < 100; key++) {
+        if (mock.count(key) > 0) {
+            continue;
+        }
+        Rid rid = {.page_no = key / 100, .slot_no = key % 100};
+        ASSERT_TRUE(ih->insert_entry((const char *)&key, rid, txn_.get()));
+        mock.insert({key, rid});
+    }
+    check_all(ih.get(), mock);
+    ix_manager_->close_index(ih.get());
+
+    // 写回的页面仍是原来的布局：叶子链表头的parent字段没有被校验和覆盖
+    fd = disk_manager_->open_file(ix_name);
+    disk_manager_->read_page(fd, IX_LEAF_HEADER_PAGE, page.data(), PAGE_SIZE);
+    disk_manager_->close_file(fd);
+    memcpy(&page_hdr, page.data() + IX_LEGACY_PAGE_HDR_OFFSET, sizeof(page_hdr));
+    EXPECT_EQ(IX_NO_PAGE, page_hdr.parent);
+    EXPECT_NE(IX_INIT_ROOT_PAGE, page_hdr.prev_leaf);
+
+    ih = ix_manager_->open_index(TEST_FILE_NAME, legacy_col);
+    EXPECT_EQ(Page::LAYOUT_LEGACY, ih->file_hdr_->layout_version_);
+    check_all(ih.get(), mock);
+    ix_manager_->close_index(ih.get());
+}
@@ -0,0 +1,93 @@
+#include <fcntl.h>
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "storage/disk_manager.h"
+
+const std::string TEST_DB_NAME = "AsyncIOBench_db";  // 以TEST_DB_NAME作为存放测试文件的根目录名
+
+class AsyncIOBench : public ::testing::Test {
+   public:
+    std::unique_ptr<DiskManager> disk_manager_;
+
+   public:
+    void SetUp() override {
+        ::testing::Test::SetUp();
+        disk_manager_ = std::make_unique<DiskManager>();
+        if (disk_manager_->is_dir(TEST_DB_NAME)) {
+            disk_manager_->destroy_dir(TEST_DB_NAME);
+        }
+        disk_manager_->create_dir(TEST_DB_NAME);
+        if (chdir(TEST_DB_NAME.c_str()) < 0) {
+            throw UnixError();
+        }
+    }
+
+    void TearDown() override {
+        if (chdir("..") < 0) {
+            throw UnixError();
+        }
+    }
+};
+
+/**
+ * @brief 随机读4KB页面的IOPS随队列深度的变化，比较io_uring与同步pread
+ * @note 同步模式下队列深度不影响IOPS；io_uring在存储设备支持并发请求时IOPS应随队列深度增长
+ */
+TEST_F(AsyncIOBench, QueueDepthScaling) {
+    const int num_pages = 16384;  // 64MB
+    const int num_ops = 50000;
+    const std::string filename = "qd_bench";
+    disk_manager_->create_file(filename);
+    int fd = disk_manager_->open_file(filename);
+    std::vector<char> page(PAGE_SIZE, 'x');
+    for (int i = 0; i < num_pages; i++) {
+        disk_manager_->write_page(fd, i, page.data(), PAGE_SIZE);
+    }
+    fsync(fd);
+
+    printf("%-9s %6s %12s\n", "backend", "qd", "IOPS");
+    for (bool use_io_uring : {false, true}) {
+        for (unsigned qd : {1, 2, 4, 8, 16, 32, 64}) {
+            AsyncIO aio(disk_manager_.get(), qd, use_io_uring);
+            if (use_io_uring && !aio.uses_io_uring()) {
+                printf("io_uring unavailable, skipped\n");
+                break;
+            }
+            posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+            std::vector<std::vector<char>> bufs(qd, std::vector<char>(PAGE_SIZE));
+            std::vector<AsyncIOCompletion> completions;
+            std::vector<uint64_t> free_bufs;
+            for (unsigned i = 0; i < qd; i++) {
+                free_bufs.push_back(i);
+            }
+            std::mt19937 rng(0);
+            int issued = 0;
+            int completed = 0;
+            auto start = std::chrono::steady_clock::now();
+            while (completed < num_ops) {
+                while (issued < num_ops && !free_bufs.empty()) {
+                    uint64_t buf = free_bufs.back();
+                    free_bufs.pop_back();
+                    ASSERT_TRUE(aio.prep_read(fd, rng() % num_pages, bufs[buf].data(), buf));
+                    issued++;
+                }
+                aio.submit();
+                completions.clear();
+                aio.wait(&completions, 1);
+                for (auto &completion : completions) {
+                    ASSERT_EQ(0, completion.result);
+                    free_bufs.push_back(completion.user_data);
+                    completed++;
+                }
+            }
+            double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            printf("%-9s %6u %12.0f\n", aio.uses_io_uring() ? "io_uring" : "pread", qd, num_ops / secs);
+        }
+    }
+    disk_manager_->close_file(fd);
+}
@@ -0,0 +1,487 @@
+#include <fcntl.h>
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "storage/buffer_pool_manager.h"
+#include "storage/page_table.h"
+
+const std::string TEST_DB_NAME = "BufferPoolManagerBench_db";  // 以TEST_DB_NAME作为存放测试文件的根目录名
+
+class BufferPoolManagerBench : public ::testing::Test {
+   public:
+    std::unique_ptr<DiskManager> disk_manager_;
+
+   public:
+    void SetUp() override {
+        ::testing::Test::SetUp();
+        disk_manager_ = std::make_unique<DiskManager>();
+        if (disk_manager_->is_dir(TEST_DB_NAME)) {
+            disk_manager_->destroy_dir(TEST_DB_NAME);
+        }
+        disk_manager_->create_dir(TEST_DB_NAME);
+        if (chdir(TEST_DB_NAME.c_str()) < 0) {
+            throw UnixError();
+        }
+    }
+
+    void TearDown() override {
+        if (chdir("..") < 0) {
+            throw UnixError();
+        }
+    }
+};
+
+/**
+ * @brief 多线程fetch/unpin吞吐随分片数的变化
+ * @note 所有页面常驻缓冲池，测量的是命中路径上的锁竞争；在多核机器上吞吐应随分片数近似线性增长
+ */
+TEST_F(BufferPoolManagerBench, ShardScaling) {
+    const int num_pages = 1024;
+    const int ops_per_thread = 200000;
+    const std::string filename = "shard_scaling";
+    disk_manager_->create_file(filename);
+    int fd = disk_manager_->open_file(filename);
+
+    int max_threads = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<int> thread_counts;
+    for (int t = 1; t <= max_threads && t <= 16; t *= 2) {
+        thread_counts.push_back(t);
+    }
+
+    printf("%8s %8s %14s\n", "shards", "threads", "ops/sec");
+    for (size_t num_shards : {1, 2, 4, 8, 16}) {
+        BufferPoolManager bpm(num_pages, disk_manager_.get(), num_shards);
+        std::vector<PageId> page_ids;
+        for (int i = 0; i < num_pages; i++) {
+            PageId page_id = {.fd = fd, .page_no = INVALID_PAGE_ID};
+            ASSERT_NE(nullptr, bpm.new_page(&page_id));
+            ASSERT_TRUE(bpm.unpin_page(page_id, false));
+            page_ids.push_back(page_id);
+        }
+        for (int num_threads : thread_counts) {
+            auto start = std::chrono::steady_clock::now();
+            std::vector<std::thread> threads;
+            for (int tid = 0; tid < num_threads; tid++) {
+                threads.emplace_back([&bpm, &page_ids, tid]() {
+                    std::mt19937 rng(tid);
+                    for (int i = 0; i < ops_per_thread; i++) {
+                        const PageId &page_id = page_ids[rng() % page_ids.size()];
+                        Page *page = bpm.fetch_page(page_id);
+                        EXPECT_NE(nullptr, page);
+                        bpm.unpin_page(page_id, false);
+                    }
+                });
+            }
+            for (auto &thread : threads) {
+                thread.join();
+            }
+            double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            printf("%8zu %8d %14.0f\n", num_shards, num_threads, num_threads * ops_per_thread / secs);
+        }
+        // 新文件中的页面被分配过，重新从0开始分配以便下一轮复用同一批页号
+        disk_manager_->set_fd2pageno(fd, 0);
+    }
+    disk_manager_->close_file(fd);
+}
+
+/**
+ * @brief 16个线程在常驻缓冲池的热点页面上fetch/unpin，对比加分片锁的命中路径与无锁命中路径的吞吐
+ * @note 热点集中在少数页面上，加锁时同一分片上的线程互相等待；无锁路径只在页面的pin_count上竞争
+ */
+TEST_F(BufferPoolManagerBench, HitPathThroughput) {
+    const int num_pages = 1024;
+    const int hot_pages = 64;
+    const int num_threads = 16;
+    const int ops_per_thread = 200000;
+    const std::string filename = "hit_path_throughput";
+    disk_manager_->create_file(filename);
+    int fd = disk_manager_->open_file(filename);
+    BufferPoolManager bpm(num_pages, disk_manager_.get(), BUFFER_POOL_NUM_SHARDS);
+    std::vector<PageId> page_ids;
+    for (int i = 0; i < num_pages; i++) {
+        PageId page_id = {.fd = fd, .page_no = INVALID_PAGE_ID};
+        ASSERT_NE(nullptr, bpm.new_page(&page_id));
+        ASSERT_TRUE(bpm.unpin_page(page_id, false));
+        page_ids.push_back(page_id);
+    }
+
+    printf("%-10s %8s %14s\n", "hit path", "threads", "ops/sec");
+    for (bool lock_free : {false, true}) {
+        bpm.set_lock_free_hits(lock_free);
+        auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> threads;
+        for (int tid = 0; tid < num_threads; tid++) {
+            threads.emplace_back([&bpm, &page_ids, tid]() {
+                std::mt19937 rng(tid);
+                for (int i = 0; i < ops_per_thread; i++) {
+                    // 90%的访问落在热点页面上
+                    const PageId &page_id = page_ids[rng() % 10 ? rng() % hot_pages : rng() % page_ids.size()];
+                    Page *page = bpm.fetch_page(page_id);
+                    EXPECT_NE(nullptr, page);
+                    bpm.unpin_page(page_id, false);
+                }
+            });
+        }
+        for (auto &thread : threads) {
+            thread.join();
+        }
+        double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        printf("%-10s %8d %14.0f\n", lock_free ? "lock-free" : "locked", num_threads,
+               num_threads * ops_per_thread / secs);
+    }
+    disk_manager_->close_file(fd);
+}
+
+/**
+ * @brief 大表顺序扫描与索引点查混合时，点查页面的命中率
+ * @note 索引页面常驻时命中率应接近1；不使用环形缓冲区时扫描会把索引页面挤出缓冲池
+ */
+TEST_F(BufferPoolManagerBench, ScanWithPointLookups) {
+    const int pool_size = 256;
+    const int num_index_pages = 160;
+    const int num_table_pages = 4 * pool_size;
+    const int lookups_per_page = 2;
+    disk_manager_->create_file("index_file");
+    disk_manager_->create_file("table_file");
+    int index_fd = disk_manager_->open_file("index_file");
+    int table_fd = disk_manager_->open_file("table_file");
+
+    printf("%-6s %14s %14s\n", "ring", "index hit", "scan pages/s");
+    for (bool use_ring : {false, true}) {
+        BufferPoolManager bpm(pool_size, disk_manager_.get(), BUFFER_POOL_NUM_SHARDS);
+        disk_manager_->set_fd2pageno(index_fd, 0);
+        disk_manager_->set_fd2pageno(table_fd, 0);
+        for (int fd : {table_fd, index_fd}) {
+            for (int i = 0; i < (fd == index_fd ? num_index_pages : num_table_pages); i++) {
+                PageId page_id = {.fd = fd, .page_no = INVALID_PAGE_ID};
+                ASSERT_NE(nullptr, bpm.new_page(&page_id));
+                bpm.unpin_page(page_id, true);
+            }
+            bpm.flush_all_pages(fd);
+        }
+
+        std::mt19937 rng(0);
+        auto strategy = use_ring ? bpm.make_ring_strategy() : nullptr;
+        size_t lookups = 0;
+        size_t misses = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (int round = 0; round < 2; round++) {
+            for (int page_no = 0; page_no < num_table_pages; page_no++) {
+                ASSERT_NE(nullptr, bpm.fetch_page({.fd = table_fd, .page_no = page_no}, strategy.get()));
+                bpm.unpin_page({.fd = table_fd, .page_no = page_no}, false);
+                for (int i = 0; i < lookups_per_page; i++) {
+                    PageId page_id = {.fd = index_fd, .page_no = static_cast<page_id_t>(rng() % num_index_pages)};
+                    uint64_t reads = disk_manager_->get_num_page_reads();
+                    ASSERT_NE(nullptr, bpm.fetch_page(page_id));
+                    bpm.unpin_page(page_id, false);
+                    misses += disk_manager_->get_num_page_reads() - reads;
+                    lookups++;
+                }
+            }
+        }
+        double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        printf("%-6s %14.4f %14.0f\n", use_ring ? "yes" : "no", 1.0 - static_cast<double>(misses) / lookups,
+               2 * num_table_pages / secs);
+    }
+    disk_manager_->close_file(index_fd);
+    disk_manager_->close_file(table_fd);
+}
+
+/**
+ * @brief 冷数据顺序扫描的吞吐，比较开启预读前后
+ * @note 每轮扫描前通过posix_fadvise丢弃文件在操作系统页缓存中的数据
+ */
+TEST_F(BufferPoolManagerBench, ColdSequentialScan) {
+    const int pool_size = 1024;
+    const int num_pages = 16 * pool_size;
+    const std::string filename = "cold_scan";
+    disk_manager_->create_file(filename);
+    int fd = disk_manager_->open_file(filename);
+    {
+        BufferPoolManager bpm(pool_size, disk_manager_.get(), BUFFER_POOL_NUM_SHARDS);
+        for (int i = 0; i < num_pages; i++) {
+            PageId page_id = {.fd = fd, .page_no = INVALID_PAGE_ID};
+            ASSERT_NE(nullptr, bpm.new_page(&page_id));
+            bpm.unpin_page(page_id, true);
+        }
+        bpm.flush_all_pages(fd);
+    }
+    fsync(fd);
+
+    printf("%-10s %-6s %14s %14s\n", "read-ahead", "ring", "pages/s", "pages read");
+    for (bool use_ring : {false, true}) {
+        for (bool use_read_ahead : {false, true}) {
+            posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+            BufferPoolManager bpm(pool_size, disk_manager_.get(), BUFFER_POOL_NUM_SHARDS);
+            if (use_read_ahead) {
+                bpm.start_read_ahead();
+            }
+            auto strategy = use_ring ? bpm.make_ring_strategy() : nullptr;
+            uint64_t reads = disk_manager_->get_num_page_reads();
+            auto start = std::chrono::steady_clock::now();
+            for (int i = 0; i < num_pages; i++) {
+                Page *page = bpm.fetch_page({.fd = fd, .page_no = i}, strategy.get());
+                ASSERT_NE(nullptr, page);
+                bpm.unpin_page({.fd = fd, .page_no = i}, false);
+            }
+            double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            printf("%-10s %-6s %14.0f %14lu\n", use_read_ahead ? "yes" : "no", use_ring ? "yes" : "no",
+                   num_pages / secs, disk_manager_->get_num_page_reads() - reads);
+            bpm.flush_all_pages(fd);
+        }
+    }
+    disk_manager_->close_file(fd);
+}
+
+/**
+ * @brief 只读映射与缓冲池两种访问方式下，随机点查和顺序扫描的单页延迟
+ * @note 文件大于缓冲池，缓冲池方式需要不断淘汰帧并从操作系统页缓存拷贝页面；映射方式直接访问页缓存
+ */
+TEST_F(BufferPoolManagerBench, MappedReadOnly) {
+    const int pool_size = 1024;
+    const int num_pages = 8 * pool_size;
+    const int num_lookups = 200000;
+    const std::string filename = "mapped_read_only";
+    disk_manager_->create_file(filename);
+    int fd = disk_manager_->open_file(filename);
+    {
+        BufferPoolManager bpm(pool_size, disk_manager_.get(), BUFFER_POOL_NUM_SHARDS);
+        for (int i = 0; i < num_pages; i++) {
+            PageId page_id = {.fd = fd, .page_no = INVALID_PAGE_ID};
+            ASSERT_NE(nullptr, bpm.new_page(&page_id));
+            bpm.unpin_page(page_id, true);
+        }
+        bpm.flush_all_pages(fd);
+    }
+
+    printf("%-8s %16s %16s\n", "mode", "lookup ns/page", "scan ns/page");
+    for (bool mapped : {false, true}) {
+        BufferPoolManager bpm(pool_size, disk_manager_.get(), BUFFER_POOL_NUM_SHARDS);
+        if (mapped) {
+            bpm.map_file(fd);
+        }
+        uint64_t checksum = 0;
+        std::mt19937 rng(0);
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < num_lookups; i++) {
+            PageId page_id = {.fd = fd, .page_no = static_cast<page_id_t>(rng() % num_pages)};
+            Page *page = bpm.fetch_page(page_id);
+            ASSERT_NE(nullptr, page);
+            checksum += page->get_data()[PAGE_SIZE / 2];
+            bpm.unpin_page(page_id, false);
+        }
+        double lookup_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+        auto strategy = bpm.make_ring_strategy();
+        start = std::chrono::steady_clock::now();
+        for (int round = 0; round < 4; round++) {
+            for (int i = 0; i < num_pages; i++) {
+                Page *page = bpm.fetch_page({.fd = fd, .page_no = i}, strategy.get());
+                ASSERT_NE(nullptr, page);
+                checksum += page->get_data()[PAGE_SIZE / 2];
+                bpm.unpin_page({.fd = fd, .page_no = i}, false);
+            }
+        }
+        double scan_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        printf("%-8s %16.1f %16.1f\n", mapped ? "mmap" : "buffered", lookup_ns / num_lookups,
+               scan_ns / (4 * num_pages));
+        EXPECT_EQ(0u, checksum);
+        bpm.unmap_file(fd);
+    }
+    disk_manager_->close_file(fd);
+}
+
+/**
+ * @brief 多个文件的页面同时在页表中时，分别使用旧的(fd << 16) | page_no哈希与PageIdHash的查找开销，
+ *        包括缓冲池分片使用的开放寻址页表和std::unordered_map
+ * @note 页表用哈希值的低位定位槽，旧哈希下不同文件的同一页号落在同一个位置，形成很长的探测序列；
+ *       每个文件超过65535个页面后旧哈希在不同文件之间直接冲突。PageIdHash下每次查找的开销只随工作集超出缓存而缓慢增长
+ */
+TEST_F(BufferPoolManagerBench, PageIdHashStress) {
+    struct LegacyPageIdHash {
+        size_t operator()(const PageId &x) const { return (x.fd << 16) | x.page_no; }
+    };
+    const int num_files = 16;
+    const int num_lookups = 1 << 20;
+
+    printf("%10s %16s %16s %16s %16s\n", "entries", "legacy table ns", "table ns", "legacy map ns", "map ns");
+    for (int pages_per_file : {1 << 12, 1 << 14, 1 << 16, 1 << 17}) {
+        int num_entries = num_files * pages_per_file;
+        std::vector<PageId> page_ids;
+        for (int fd = 0; fd < num_files; fd++) {
+            for (int page_no = 0; page_no < pages_per_file; page_no++) {
+                page_ids.push_back({.fd = fd + 3, .page_no = page_no});
+            }
+        }
+        std::mt19937 rng(0);
+        std::vector<PageId> lookups;
+        for (int i = 0; i < num_lookups; i++) {
+            lookups.push_back(page_ids[rng() % page_ids.size()]);
+        }
+
+        auto measure = [&lookups](auto &&lookup) {
+            auto start = std::chrono::steady_clock::now();
+            size_t found = 0;
+            for (auto &page_id : lookups) {
+                found += lookup(page_id);
+            }
+            EXPECT_EQ(lookups.size(), found);
+            return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() /
+                   lookups.size();
+        };
+        // 旧哈希下页表的插入本身也需要很长的探测，工作集很大时只测量unordered_map
+        double legacy_table_ns = -1;
+        if (num_entries <= (1 << 18)) {
+            PageTable<LegacyPageIdHash> legacy_table(num_entries);
+            for (int i = 0; i < num_entries; i++) {
+                legacy_table.insert(page_ids[i], i);
+            }
+            legacy_table_ns = measure([&](const PageId &page_id) {
+                frame_id_t frame_id;
+                return legacy_table.find(page_id, &frame_id);
+            });
+        }
+        PageTable<> table(num_entries);
+        std::unordered_map<PageId, frame_id_t, LegacyPageIdHash> legacy_map;
+        std::unordered_map<PageId, frame_id_t, PageIdHash> map;
+        for (int i = 0; i < num_entries; i++) {
+            table.insert(page_ids[i], i);
+            legacy_map[page_ids[i]] = i;
+            map[page_ids[i]] = i;
+        }
+        double table_ns = measure([&](const PageId &page_id) {
+            frame_id_t frame_id;
+            return table.find(page_id, &frame_id);
+        });
+        double legacy_map_ns = measure([&](const PageId &page_id) { return legacy_map.count(page_id); });
+        double map_ns = measure([&](const PageId &page_id) { return map.count(page_id); });
+        printf("%10d %16.1f %16.1f %16.1f %16.1f\n", num_entries, legacy_table_ns, table_ns, legacy_map_ns, map_ns);
+    }
+}
+
+/**
+ * @brief 帧内存使用普通页面与大页时，随机访问帧和命中路径的开销
+ * @note 工作集远大于TLB覆盖的范围时，每次随机访问帧都可能发生TLB缺失；使用大页后一个TLB表项覆盖512个帧，
+ *       随机访问的开销应明显下降。系统没有预留大页且未开启透明大页时两种模式的结果相同
+ */
+TEST_F(BufferPoolManagerBench, FrameArenaTlb) {
+    const size_t pool_size = BUFFER_POOL_SIZE;
+    const int num_accesses = 1 << 22;
+    const int num_fetches = 1 << 20;
+    const std::string filename = "frame_arena_tlb";
+    disk_manager_->create_file(filename);
+    int fd = disk_manager_->open_file(filename);
+    auto backing_name = [](FrameArena::Backing backing) {
+        switch (backing) {
+            case FrameArena::Backing::HUGETLB:
+                return "hugetlb";
+            case FrameArena::Backing::TRANSPARENT_HUGE_PAGES:
+                return "thp";
+            default:
+                return "4k";
+        }
+    };
+
+    printf("%-8s %16s %16s\n", "backing", "access ns/frame", "hit ns/fetch");
+    for (bool huge_pages : {false, true}) {
+        FrameArena arena(pool_size * PAGE_SIZE, huge_pages);
+        memset(arena.data(), 1, arena.size());
+        std::mt19937 rng(0);
+        uint64_t checksum = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < num_accesses; i++) {
+            checksum += arena.data()[(rng() % pool_size) * PAGE_SIZE + PAGE_SIZE / 2];
+        }
+        double access_ns =
+            std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / num_accesses;
+        EXPECT_EQ(static_cast<uint64_t>(num_accesses), checksum);
+
+        BufferPoolManager bpm(pool_size, disk_manager_.get(), BUFFER_POOL_NUM_SHARDS, REPLACER_TYPE, huge_pages);
+        for (size_t i = 0; i < pool_size; i++) {
+            PageId page_id = {.fd = fd, .page_no = INVALID_PAGE_ID};
+            ASSERT_NE(nullptr, bpm.new_page(&page_id));
+            ASSERT_TRUE(bpm.unpin_page(page_id, false));
+        }
+        checksum = 0;
+        start = std::chrono::steady_clock::now();
+        for (int i = 0; i < num_fetches; i++) {
+            PageId page_id = {.fd = fd, .page_no = static_cast<page_id_t>(rng() % pool_size)};
+            Page *page = bpm.fetch_page(page_id);
+            ASSERT_NE(nullptr, page);
+            checksum += page->get_data()[PAGE_SIZE / 2];
+            bpm.unpin_page(page_id, false);
+        }
+        double hit_ns =
+            std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / num_fetches;
+        EXPECT_EQ(0u, checksum);
+        printf("%-8s %16.1f %16.1f\n", backing_name(bpm.get_frame_backing()), access_ns, hit_ns);
+        // 重新从0开始分配页号，下一轮复用同一批页面
+        disk_manager_->set_fd2pageno(fd, 0);
+    }
+    disk_manager_->close_file(fd);
+}
+
+/**
+ * @brief 页面校验和的开销：计算一次校验和的时间，以及从操作系统页缓存读入页面时开启与关闭校验的单页延迟
+ * @note 缓冲池远小于文件，循环扫描时每次fetch_page都未命中；写回时总是计算校验和，开销与读入时相同
+ */
+TEST_F(BufferPoolManagerBench, PageChecksumOverhead) {
+    printf("%-10s %14s %14s\n", "page size", "ns/checksum", "GB/s");
+    for (int page_size = PAGE_SIZE; page_size <= MAX_PAGE_SIZE; page_size *= 4) {
+        std::vector<char> data(page_size);
+        std::mt19937 rng(page_size);
+        for (auto &c : data) {
+            c = static_cast<char>(rng());
+        }
+        const int rounds = 256 * MAX_PAGE_SIZE / page_size;
+        uint32_t sink = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < rounds; i++) {
+            sink ^= page_checksum(data.data(), page_size, i);
+        }
+        double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        printf("%-10d %14.1f %14.2f\n", page_size, secs * 1e9 / rounds,
+               static_cast<double>(page_size) * rounds / secs / 1e9);
+        EXPECT_NE(0u, sink | 1);
+    }
+
+    const int pool_size = 256;
+    const int num_pages = 16 * pool_size;
+    const std::string filename = "checksum_overhead";
+    disk_manager_->create_file(filename);
+    int fd = disk_manager_->open_file(filename);
+    {
+        BufferPoolManager bpm(pool_size, disk_manager_.get(), BUFFER_POOL_NUM_SHARDS);
+        for (int i = 0; i < num_pages; i++) {
+            PageId page_id = {.fd = fd, .page_no = INVALID_PAGE_ID};
+            Page *page = bpm.new_page(&page_id);
+            ASSERT_NE(nullptr, page);
+            memset(page->get_data() + Page::OFFSET_PAGE_HDR, i & 0xff, PAGE_SIZE - Page::OFFSET_PAGE_HDR);
+            bpm.unpin_page(page_id, true);
+        }
+        bpm.flush_all_pages(fd);
+    }
+
+    printf("%-10s %14s\n", "verify", "ns/miss");
+    const int rounds = 4;
+    for (bool verify : {false, true, false, true}) {
+        BufferPoolManager bpm(pool_size, disk_manager_.get(), BUFFER_POOL_NUM_SHARDS);
+        bpm.set_verify_checksums(verify);
+        auto start = std::chrono::steady_clock::now();
+        for (int r = 0; r < rounds; r++) {
+            for (int i = 0; i < num_pages; i++) {
+                ASSERT_NE(nullptr, bpm.fetch_page({.fd = fd, .page_no = i}));
+                bpm.unpin_page({.fd = fd, .page_no = i}, false);
+            }
+        }
+        double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        printf("%-10s %14.1f\n", verify ? "yes" : "no", secs * 1e9 / (rounds * num_pages));
+    }
+    disk_manager_->close_file(fd);
+}
@@ -1,8 +1,16 @@
 #include "storage/buffer_pool_manager.h"
+#include "storage/page_table.h"
+
+#include <fcntl.h>
+#include <unistd.h>
 
 #include <cassert>
 #include <cstring>
 #include <ctime>
+#include <fstream>
+#include <map>
+#include <random>
+#include <set>
 #include <string>
 #include <thread>
 #include <unordered_map>
@@ -59,6 +67,20 @@ class BufferPoolManagerTest : public ::testing::Test {
         }
     }
 
+    /**
+     * @brief 页面中存放测试数据的位置，页头中的LSN和校验和由缓冲池维护，测试数据写在页头之后
+     */
+    static char *page_content(Page *page) { return page->get_data() + Page::OFFSET_PAGE_HDR; }
+
+    /**
+     * @brief 比较两个页面的内容，跳过缓冲池写回时在页头中填写的校验和
+     */
+    static int cmp_content(const char *x, const char *y) {
+        const size_t rest = Page::OFFSET_CHECKSUM + sizeof(uint32_t);
+        int cmp = memcmp(x, y, Page::OFFSET_CHECKSUM);
+        return cmp != 0 ? cmp : memcmp(x + rest, y + rest, PAGE_SIZE - rest);
+    }
+
     /**
      * @brief 随机获取mock中的键
      */
@@ -97,8 +119,8 @@ TEST_F(BufferPoolManagerTest, SimpleTest) {
     EXPECT_EQ(0, tmp_page_id.page_no);
 
     // Scenario: Once we have a page, we should be able to read and write content.
-    snprintf(page0->get_data(), sizeof(page0->get_data()), "Hello");
-    EXPECT_EQ(0, strcmp(page0->get_data(), "Hello"));
+    snprintf(page_content(page0), sizeof(page0->get_data()), "Hello");
+    EXPECT_EQ(0, strcmp(page_content(page0), "Hello"));
 
     // Scenario: We should be able to create new pages until we fill up the buffer pool.
     for (size_t i = 1; i < buffer_pool_size; ++i) {
@@ -121,7 +143,7 @@ TEST_F(BufferPoolManagerTest, SimpleTest) {
 
     // Scenario: We should be able to fetch the data we wrote a while ago.
     page0 = bpm->fetch_page(PageId{fd, 0});
-    EXPECT_EQ(0, strcmp(page0->get_data(), "Hello"));
+    EXPECT_EQ(0, strcmp(page_content(page0), "Hello"));
     EXPECT_EQ(true, bpm->unpin_page(PageId{fd, 0}, true));
     // new_page again, and now all buffers are pinned. Page 0 would be failed to fetch.
     EXPECT_NE(nullptr, bpm->new_page(&tmp_page_id));
@@ -154,7 +176,7 @@ TEST_F(BufferPoolManagerTest, LargeScaleTest) {
         for (int j = 0; j < buffer_pool_size; j++) {
             auto new_page = bpm->new_page(&tmp_page_id);
             EXPECT_NE(nullptr, new_page);
-            strcpy(new_page->get_data(), std::to_string(tmp_page_id.page_no).c_str());
+            strcpy(page_content(new_page), std::to_string(tmp_page_id.page_no).c_str());
             page_ids.push_back(tmp_page_id);
         }
         for (unsigned int j = page_ids.size() - buffer_pool_size; j < page_ids.size(); j++) {
@@ -165,7 +187,7 @@ TEST_F(BufferPoolManagerTest, LargeScaleTest) {
     for (int i = 0; i < scale; i++) {
         auto page = bpm->fetch_page(page_ids[i]);
         EXPECT_NE(nullptr, page);
-        EXPECT_EQ(0, std::strcmp(std::to_string(page_ids[i].page_no).c_str(), page->get_data()));
+        EXPECT_EQ(0, std::strcmp(std::to_string(page_ids[i].page_no).c_str(), page_content(page)));
         EXPECT_EQ(true, bpm->unpin_page(page_ids[i], true));
         page_ids.push_back(tmp_page_id);
     }
@@ -226,7 +248,7 @@ TEST_F(BufferPoolManagerTest, MultipleFilesTest) {
             memcpy(mock_buf, buf, PAGE_SIZE);                 // buf -> mock
 
             // check cache: page data == mock data
-            EXPECT_EQ(memcmp(page->get_data(), mock_buf, PAGE_SIZE), 0);
+            EXPECT_EQ(cmp_content(page->get_data(), mock_buf), 0);
 
             bool unpin_flag = buffer_pool_manager->unpin_page(page->get_page_id(), true);  // unpin the page
             EXPECT_EQ(unpin_flag, true);
@@ -242,10 +264,10 @@ TEST_F(BufferPoolManagerTest, MultipleFilesTest) {
             // check disk: disk data == mock data
             disk_manager_->read_page(fd, page_no, buf, PAGE_SIZE);  // read page from disk (disk -> buf)
             char *mock_buf = &mock[fd][page_no * PAGE_SIZE];        // get mock address in (fd,page_no)
-            EXPECT_EQ(memcmp(buf, mock_buf, PAGE_SIZE), 0);
+            EXPECT_EQ(cmp_content(buf, mock_buf), 0);
             // check disk: disk data == page data
             Page *page = buffer_pool_manager->fetch_page(PageId{fd, page_no});
-            EXPECT_EQ(memcmp(buf, page->get_data(), PAGE_SIZE), 0);
+            EXPECT_EQ(cmp_content(buf, page->get_data()), 0);
             bool unpin_flag = buffer_pool_manager->unpin_page(page->get_page_id(), false);
             EXPECT_EQ(unpin_flag, true);
         }
@@ -257,7 +279,7 @@ TEST_F(BufferPoolManagerTest, MultipleFilesTest) {
         // fetch page
         Page *page = buffer_pool_manager->fetch_page(PageId{fd, page_no});
         char *mock_buf = &mock[fd][page_no * PAGE_SIZE];
-        assert(memcmp(page->get_data(), mock_buf, PAGE_SIZE) == 0);
+        assert(cmp_content(page->get_data(), mock_buf) == 0);
 
         // modify
         rand_buf(buf, PAGE_SIZE);
@@ -270,10 +292,10 @@ TEST_F(BufferPoolManagerTest, MultipleFilesTest) {
             // check disk: disk data == mock data
             disk_manager_->read_page(fd, page_no, buf, PAGE_SIZE);  // read page from disk (disk -> buf)
             char *mock_buf = &mock[fd][page_no * PAGE_SIZE];        // get mock address in (fd,page_no)
-            EXPECT_EQ(memcmp(buf, mock_buf, PAGE_SIZE), 0);
+            EXPECT_EQ(cmp_content(buf, mock_buf), 0);
         }
         // check cache: page data == mock data
-        EXPECT_EQ(memcmp(page->get_data(), mock_buf, PAGE_SIZE), 0);
+        EXPECT_EQ(cmp_content(page->get_data(), mock_buf), 0);
 
         bool unpin_flag = buffer_pool_manager->unpin_page(page->get_page_id(), true);  // unpin the page
         EXPECT_EQ(unpin_flag, true);
@@ -316,7 +338,7 @@ TEST_F(BufferPoolManagerTest, ConcurrencyTest) {
         for (int i = 0; i < buffer_pool_size; i++) {
             auto *new_page = bpm->new_page(&tmp_page_id);
             EXPECT_NE(nullptr, new_page);
-            strcpy(new_page->get_data(), std::to_string(tmp_page_id.page_no).c_str());
+            strcpy(page_content(new_page), std::to_string(tmp_page_id.page_no).c_str());
             page_ids.push_back(tmp_page_id);
         }
 
@@ -337,7 +359,7 @@ TEST_F(BufferPoolManagerTest, ConcurrencyTest) {
         for (int j = 0; j < buffer_pool_size; j++) {
             auto *page = bpm->fetch_page(page_ids[j]);
             EXPECT_NE(nullptr, page);
-            strcpy(page->get_data(), (std::string("Hard") + std::to_string(page_ids[j].page_no)).c_str());
+            strcpy(page_content(page), (std::string("Hard") + std::to_string(page_ids[j].page_no)).c_str());
         }
 
         for (int i = 0; i < buffer_pool_size; i++) {
@@ -367,7 +389,7 @@ TEST_F(BufferPoolManagerTest, ConcurrencyTest) {
                         }
                         EXPECT_NE(nullptr, page_local);
                         EXPECT_EQ(0,
-                                  std::strcmp(std::to_string(temp_page_id.page_no).c_str(), (page_local->get_data())));
+                                  std::strcmp(std::to_string(temp_page_id.page_no).c_str(), page_content(page_local)));
                         EXPECT_EQ(true, bpm->unpin_page(temp_page_id, false));
                         // If the page is still in buffer pool then put it in free list,
                         // else also we are happy
@@ -380,11 +402,11 @@ TEST_F(BufferPoolManagerTest, ConcurrencyTest) {
                     }
                     EXPECT_NE(nullptr, page);
                     if (j % 2 == 0) {
-                        EXPECT_EQ(0, std::strcmp(std::to_string(page_ids[j].page_no).c_str(), (page->get_data())));
+                        EXPECT_EQ(0, std::strcmp(std::to_string(page_ids[j].page_no).c_str(), page_content(page)));
                         EXPECT_EQ(true, bpm->unpin_page(page_ids[j], false));
                     } else {
                         EXPECT_EQ(0, std::strcmp((std::string("Hard") + std::to_string(page_ids[j].page_no)).c_str(),
-                                                 (page->get_data())));
+                                                 page_content(page)));
                         EXPECT_EQ(true, bpm->unpin_page(page_ids[j], false));
                     }
                     j = (j + 1);
@@ -394,7 +416,7 @@ TEST_F(BufferPoolManagerTest, ConcurrencyTest) {
                         page = bpm->new_page(&temp_page_id);
                     }
                     EXPECT_NE(nullptr, page);
-                    strcpy(page->get_data(), std::to_string(temp_page_id.page_no).c_str());
+                    strcpy(page_content(page), std::to_string(temp_page_id.page_no).c_str());
                     // FLush page instead of unpining with true
                     EXPECT_EQ(true, bpm->flush_page(temp_page_id));
                     EXPECT_EQ(true, bpm->unpin_page(temp_page_id, false));
@@ -427,3 +449,1032 @@ TEST_F(BufferPoolManagerTest, ConcurrencyTest) {
 
     disk_manager_->close_file(fd);
 }
+
+/**
+ * @brief 分片缓冲池测试（多文件、多线程），各线程读写互不相交的页面并不断触发淘汰
+ * @note 生成若干测试文件sharded_test_*
+ */
+TEST_F(BufferPoolManagerTest, ShardedTest) {
+    const int num_threads = 4;
+    const int num_files = 4;
+    const int pages_per_file = 64;
+    const size_t num_shards = 8;
+    // 缓冲池小于总页面数，保证运行过程中会不断发生淘汰和写回
+    auto bpm = std::make_unique<BufferPoolManager>(num_files * pages_per_file / 4, disk_manager_.get(), num_shards);
+    EXPECT_EQ(num_shards, bpm->get_num_shards());
+
+    std::vector<int> fds;
+    for (int i = 0; i < num_files; i++) {
+        std::string filename = "sharded_test_" + std::to_string(i);
+        disk_manager_->create_file(filename);
+        int fd = disk_manager_->open_file(filename);
+        for (int j = 0; j < pages_per_file; j++) {
+            PageId page_id = {.fd = fd, .page_no = INVALID_PAGE_ID};
+            Page *page = bpm->new_page(&page_id);
+            ASSERT_NE(nullptr, page);
+            EXPECT_EQ(j, page_id.page_no);
+            snprintf(page_content(page), PAGE_SIZE, "%d:%d:0", fd, page_id.page_no);
+            EXPECT_EQ(true, bpm->unpin_page(page_id, true));
+        }
+        fds.push_back(fd);
+    }
+
+    std::vector<std::thread> threads;
+    for (int tid = 0; tid < num_threads; tid++) {
+        threads.emplace_back([&bpm, &fds, tid]() {
+            // 线程tid只负责page_no % num_threads == tid的页面
+            for (int round = 1; round <= 3; round++) {
+                for (int fd : fds) {
+                    for (int page_no = tid; page_no < pages_per_file; page_no += num_threads) {
+                        PageId page_id = {.fd = fd, .page_no = page_no};
+                        Page *page = bpm->fetch_page(page_id);
+                        while (page == nullptr) {
+                            page = bpm->fetch_page(page_id);
+                        }
+                        char expected[64];
+                        snprintf(expected, sizeof(expected), "%d:%d:%d", fd, page_no, round - 1);
+                        EXPECT_EQ(0, strcmp(expected, page_content(page)));
+                        snprintf(page_content(page), PAGE_SIZE, "%d:%d:%d", fd, page_no, round);
+                        EXPECT_EQ(true, bpm->unpin_page(page_id, true));
+                    }
+                }
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+
+    for (int fd : fds) {
+        bpm->flush_all_pages(fd);
+        char buf[PAGE_SIZE];
+        for (int page_no = 0; page_no < pages_per_file; page_no++) {
+            disk_manager_->read_page(fd, page_no, buf, PAGE_SIZE);
+            char expected[64];
+            snprintf(expected, sizeof(expected), "%d:%d:3", fd, page_no);
+            EXPECT_EQ(0, strcmp(expected, buf + Page::OFFSET_PAGE_HDR));
+        }
+        disk_manager_->close_file(fd);
+    }
+}
+
+/**
+ * @brief 淘汰时优先选择干净页，后台写回即将被淘汰的脏页
+ * @note 生成测试文件write_back_test
+ */
+TEST_F(BufferPoolManagerTest, WriteBackTest) {
+    const std::string filename = "write_back_test";
+    disk_manager_->create_file(filename);
+    int fd = disk_manager_->open_file(filename);
+    auto bpm = std::make_unique<BufferPoolManager>(4, disk_manager_.get(), 1, "LRU");
+
+    // 新建页面0~3，按顺序取消固定，淘汰顺序为0,1,2,3
+    for (int i = 0; i < 4; i++) {
+        PageId page_id = {.fd = fd, .page_no = INVALID_PAGE_ID};
+        Page *page = bpm->new_page(&page_id);
+        ASSERT_NE(nullptr, page);
+        snprintf(page_content(page), PAGE_SIZE, "page %d", i);
+        EXPECT_EQ(true, bpm->unpin_page(page_id, true));
+    }
+    // 页面1变为干净页，新建页面时应跳过脏页0而淘汰页面1
+    EXPECT_EQ(true, bpm->flush_page({.fd = fd, .page_no = 1}));
+    PageId page_id = {.fd = fd, .page_no = INVALID_PAGE_ID};
+    ASSERT_NE(nullptr, bpm->new_page(&page_id));
+    EXPECT_EQ(4, page_id.page_no);
+    EXPECT_EQ(true, bpm->unpin_page(page_id, true));
+
+    char buf[PAGE_SIZE];
+    disk_manager_->read_page(fd, 0, buf, PAGE_SIZE);
+    EXPECT_EQ(0, buf[0]);  // 页面0仍在缓冲池中，没有被写回
+
+    // 淘汰顺序为0,2,3,4，写回窗口内的脏页0和2
+    EXPECT_EQ(2, bpm->write_back_cold_pages());
+    disk_manager_->read_page(fd, 0, buf, PAGE_SIZE);
+    EXPECT_STREQ("page 0", buf + Page::OFFSET_PAGE_HDR);
+    disk_manager_->read_page(fd, 3, buf, PAGE_SIZE);
+    EXPECT_EQ(0, buf[0]);
+
+    // 读入页面1淘汰干净页0，淘汰顺序变为2,3,4,1，后台写线程应写回窗口内的脏页3
+    bpm->start_background_writer(std::chrono::milliseconds(1));
+    Page *page = bpm->fetch_page({.fd = fd, .page_no = 1});
+    ASSERT_NE(nullptr, page);
+    EXPECT_STREQ("page 1", page_content(page));
+    EXPECT_EQ(true, bpm->unpin_page(page->get_page_id(), false));
+    for (int i = 0; i < 1000; i++) {
+        disk_manager_->read_page(fd, 3, buf, PAGE_SIZE);
+        if (buf[0] != 0) {
+            break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    EXPECT_STREQ("page 3", buf + Page::OFFSET_PAGE_HDR);
+    bpm->stop_background_writer();
+
+    bpm->flush_all_pages(fd);
+    disk_manager_->close_file(fd);
+}
+
+/**
+ * @brief 通过环形缓冲区顺序扫描大文件时，缓冲池中的热点页面不会被淘汰
+ * @note 生成测试文件ring_hot、ring_scan
+ */
+TEST_F(BufferPoolManagerTest, RingStrategyTest) {
+    const int pool_size = 16;
+    const int num_hot = 8;
+    const int num_scan = 100;
+    disk_manager_->create_file("ring_hot");
+    disk_manager_->create_file("ring_scan");
+    int hot_fd = disk_manager_->open_file("ring_hot");
+    int scan_fd = disk_manager_->open_file("ring_scan");
+    auto bpm = std::make_unique<BufferPoolManager>(pool_size, disk_manager_.get());
+
+    for (int fd : {hot_fd, scan_fd}) {
+        for (int i = 0; i < (fd == hot_fd ? num_hot : num_scan); i++) {
+            PageId page_id = {.fd = fd, .page_no = INVALID_PAGE_ID};
+            ASSERT_NE(nullptr, bpm->new_page(&page_id));
+            ASSERT_TRUE(bpm->unpin_page(page_id, true));
+        }
+        bpm->flush_all_pages(fd);
+    }
+    // 将热点页面读入缓冲池
+    for (int i = 0; i < num_hot; i++) {
+        ASSERT_NE(nullptr, bpm->fetch_page({.fd = hot_fd, .page_no = i}));
+        ASSERT_TRUE(bpm->unpin_page({.fd = hot_fd, .page_no = i}, false));
+    }
+
+    auto strategy = bpm->make_ring_strategy(4);
+    for (int i = 0; i < num_scan; i++) {
+        ASSERT_NE(nullptr, bpm->fetch_page({.fd = scan_fd, .page_no = i}, strategy.get()));
+        ASSERT_TRUE(bpm->unpin_page({.fd = scan_fd, .page_no = i}, false));
+    }
+
+    // 热点页面仍然全部命中
+    uint64_t reads = disk_manager_->get_num_page_reads();
+    for (int i = 0; i < num_hot; i++) {
+        ASSERT_NE(nullptr, bpm->fetch_page({.fd = hot_fd, .page_no = i}));
+        ASSERT_TRUE(bpm->unpin_page({.fd = hot_fd, .page_no = i}, false));
+    }
+    EXPECT_EQ(0, disk_manager_->get_num_page_reads() - reads);
+
+    disk_manager_->close_file(hot_fd);
+    disk_manager_->close_file(scan_fd);
+}
+
+/**
+ * @brief 预读：prefetch_pages用一次向量读读入连续页面；开启预读线程后顺序扫描读到的数据正确
+ * @note 生成测试文件read_ahead_test
+ */
+TEST_F(BufferPoolManagerTest, ReadAheadTest) {
+    const int num_pages = 200;
+    const std::string filename = "read_ahead_test";
+    disk_manager_->create_file(filename);
+    int fd = disk_manager_->open_file(filename);
+    auto bpm = std::make_unique<BufferPoolManager>(64, disk_manager_.get(), 4);
+    for (int i = 0; i < num_pages; i++) {
+        PageId page_id = {.fd = fd, .page_no = INVALID_PAGE_ID};
+        Page *page = bpm->new_page(&page_id);
+        ASSERT_NE(nullptr, page);
+        snprintf(page_content(page), PAGE_SIZE, "page %d", page_id.page_no);
+        ASSERT_TRUE(bpm->unpin_page(page_id, true));
+    }
+    bpm->flush_all_pages(fd);
+
+    // 页面100~107不在缓冲池中，预读后访问它们不再读磁盘
+    EXPECT_EQ(8, bpm->prefetch_pages({.fd = fd, .page_no = 100}, 8));
+    uint64_t reads = disk_manager_->get_num_page_reads();
+    for (int i = 100; i < 108; i++) {
+        Page *page = bpm->fetch_page({.fd = fd, .page_no = i});
+        ASSERT_NE(nullptr, page);
+        EXPECT_EQ("page " + std::to_string(i), std::string(page_content(page)));
+        ASSERT_TRUE(bpm->unpin_page({.fd = fd, .page_no = i}, false));
+    }
+    EXPECT_EQ(0, disk_manager_->get_num_page_reads() - reads);
+    // 已在缓冲池中的页面不会重复读入
+    EXPECT_EQ(0, bpm->prefetch_pages({.fd = fd, .page_no = 100}, 8));
+
+    // 开启预读线程，顺序扫描（使用或不使用环形缓冲区）读到的数据正确
+    bpm->start_read_ahead();
+    for (bool use_ring : {false, true}) {
+        auto strategy = use_ring ? bpm->make_ring_strategy(16) : nullptr;
+        for (int i = 0; i < num_pages; i++) {
+            Page *page = bpm->fetch_page({.fd = fd, .page_no = i}, strategy.get());
+            ASSERT_NE(nullptr, page);
+            EXPECT_EQ("page " + std::to_string(i), std::string(page_content(page)));
+            ASSERT_TRUE(bpm->unpin_page({.fd = fd, .page_no = i}, false));
+        }
+    }
+    bpm->flush_all_pages(fd);
+    bpm->stop_read_ahead();
+    disk_manager_->close_file(fd);
+}
+
+/**
+ * @brief flush_all_pages()批量写回所有文件的脏页（检查点），写回后页面变为干净页
+ * @note 生成测试文件flush_all_0、flush_all_1
+ */
+TEST_F(BufferPoolManagerTest, FlushAllTest) {
+    const int pages_per_file = 40;
+    auto bpm = std::make_unique<BufferPoolManager>(128, disk_manager_.get(), 8);
+    std::vector<int> fds;
+    for (int i = 0; i < 2; i++) {
+        std::string filename = "flush_all_" + std::to_string(i);
+        disk_manager_->create_file(filename);
+        int fd = disk_manager_->open_file(filename);
+        for (int j = 0; j < pages_per_file; j++) {
+            PageId page_id = {.fd = fd, .page_no = INVALID_PAGE_ID};
+            Page *page = bpm->new_page(&page_id);
+            ASSERT_NE(nullptr, page);
+            snprintf(page_content(page), PAGE_SIZE, "%d:%d", fd, j);
+            // 奇数页保持固定，写回后仍是脏页
+            if (j % 2 == 0) {
+                ASSERT_TRUE(bpm->unpin_page(page_id, true));
+            }
+        }
+        fds.push_back(fd);
+    }
+
+    bpm->flush_all_pages();
+    char buf[PAGE_SIZE];
+    for (int fd : fds) {
+        for (int j = 0; j < pages_per_file; j++) {
+            disk_manager_->read_page(fd, j, buf, PAGE_SIZE);
+            EXPECT_EQ(std::to_string(fd) + ":" + std::to_string(j), std::string(buf + Page::OFFSET_PAGE_HDR));
+            Page *page = bpm->fetch_page({.fd = fd, .page_no = j});
+            ASSERT_NE(nullptr, page);
+            EXPECT_EQ(j % 2 == 1, page->is_dirty());
+            ASSERT_TRUE(bpm->unpin_page({.fd = fd, .page_no = j}, false));
+            if (j % 2 == 1) {
+                ASSERT_TRUE(bpm->unpin_page({.fd = fd, .page_no = j}, false));
+            }
+        }
+    }
+    for (int fd : fds) {
+        bpm->flush_all_pages(fd);
+        disk_manager_->close_file(fd);
+    }
+}
+
+/**
+ * @brief 只读映射的文件：fetch_page返回指向映射区域的页面，不读盘也不占用缓冲池的帧，解除映射后恢复为普通访问
+ */
+TEST_F(BufferPoolManagerTest, MappedFileTest) {
+    const int num_pages = 64;
+    const int pool_size = 16;
+    auto bpm = std::make_unique<BufferPoolManager>(pool_size, disk_manager_.get(), 4);
+    const std::string filename = "mapped_file";
+    disk_manager_->create_file(filename);
+    int fd = disk_manager_->open_file(filename);
+    for (int i = 0; i < num_pages; i++) {
+        PageId page_id = {.fd = fd, .page_no = INVALID_PAGE_ID};
+        Page *page = bpm->new_page(&page_id);
+        ASSERT_NE(nullptr, page);
+        snprintf(page_content(page), PAGE_SIZE, "page %d", i);
+        ASSERT_TRUE(bpm->unpin_page(page_id, true));
+    }
+
+    // 映射前会写回缓冲池中的脏页
+    bpm->map_file(fd);
+    EXPECT_TRUE(bpm->is_mapped(fd));
+    uint64_t reads = disk_manager_->get_num_page_reads();
+    auto strategy = bpm->make_ring_strategy();
+    std::vector<Page *> pages;
+    for (int i = 0; i < num_pages; i++) {
+        // 所有页面同时被访问，远超缓冲池的帧数
+        Page *page = bpm->fetch_page({.fd = fd, .page_no = i}, i % 2 == 0 ? strategy.get() : nullptr);
+        ASSERT_NE(nullptr, page);
+        EXPECT_EQ("page " + std::to_string(i), std::string(page_content(page)));
+        EXPECT_EQ(fd, page->get_page_id().fd);
+        EXPECT_EQ(i, page->get_page_id().page_no);
+        pages.push_back(page);
+    }
+    EXPECT_EQ(pages[1]->get_data(), pages[0]->get_data() + PAGE_SIZE);
+    EXPECT_EQ(nullptr, bpm->fetch_page({.fd = fd, .page_no = num_pages}));
+    EXPECT_EQ(num_pages - 8, bpm->prefetch_pages({.fd = fd, .page_no = 8}, num_pages));
+    EXPECT_EQ(reads, disk_manager_->get_num_page_reads());
+    for (int i = 0; i < num_pages; i++) {
+        EXPECT_TRUE(bpm->unpin_page({.fd = fd, .page_no = i}, false));
+    }
+    PageId new_id = {.fd = fd, .page_no = INVALID_PAGE_ID};
+    EXPECT_THROW(bpm->new_page(&new_id), InternalError);
+    EXPECT_THROW(bpm->fetch_page_write({.fd = fd, .page_no = 0}), InternalError);
+
+    // 解除映射后重新通过缓冲池的帧访问
+    bpm->unmap_file(fd);
+    EXPECT_FALSE(bpm->is_mapped(fd));
+    for (int i = 0; i < num_pages; i++) {
+        Page *page = bpm->fetch_page({.fd = fd, .page_no = i});
+        ASSERT_NE(nullptr, page);
+        EXPECT_EQ("page " + std::to_string(i), std::string(page_content(page)));
+        ASSERT_TRUE(bpm->unpin_page({.fd = fd, .page_no = i}, false));
+    }
+    disk_manager_->close_file(fd);
+}
+
+/**
+ * @brief 不同页面大小的文件共用一个缓冲池：大页文件使用独立的帧，淘汰和写回按文件的页面大小进行
+ * @note 生成测试文件small_page_file、large_page_file
+ */
+TEST_F(BufferPoolManagerTest, LargePageTest) {
+    const int pool_size = 64;
+    const int large_page_size = 32768;
+    auto bpm = std::make_unique<BufferPoolManager>(pool_size, disk_manager_.get(), 4);
+    disk_manager_->create_file("small_page_file");
+    disk_manager_->create_file("large_page_file");
+    int small_fd = disk_manager_->open_file("small_page_file");
+    int large_fd = disk_manager_->open_file("large_page_file");
+    // 下面检查文件长度，不按区段预分配
+    disk_manager_->set_extent_size(0);
+    EXPECT_THROW(disk_manager_->set_page_size(large_fd, 3000), InvalidPageSizeError);
+    EXPECT_THROW(disk_manager_->set_page_size(large_fd, 2 * MAX_PAGE_SIZE), InvalidPageSizeError);
+    disk_manager_->set_page_size(large_fd, large_page_size);
+    EXPECT_EQ(PAGE_SIZE, disk_manager_->get_page_size(small_fd));
+    EXPECT_EQ(large_page_size, disk_manager_->get_page_size(large_fd));
+    EXPECT_EQ(static_cast<size_t>(pool_size), bpm->get_pool_size());
+    size_t large_pool_size = bpm->get_pool_size(large_page_size);
+    EXPECT_GE(large_pool_size, static_cast<size_t>(BUFFER_POOL_MIN_CLASS_FRAMES));
+
+    // 两个文件的页面数都超过各自的帧数，不断触发淘汰
+    const int num_pages = 2 * std::max(pool_size, static_cast<int>(large_pool_size));
+    for (int i = 0; i < num_pages; i++) {
+        for (int fd : {small_fd, large_fd}) {
+            int page_size = disk_manager_->get_page_size(fd);
+            PageId page_id = {.fd = fd, .page_no = INVALID_PAGE_ID};
+            Page *page = bpm->new_page(&page_id);
+            ASSERT_NE(nullptr, page);
+            ASSERT_EQ(page_size, page->get_page_size());
+            snprintf(page_content(page), page_size, "page %d", i);
+            // 页尾也写入数据，检查整个大页都被写回
+            page->get_data()[page_size - 1] = static_cast<char>(i);
+            ASSERT_TRUE(bpm->unpin_page(page_id, true));
+        }
+    }
+    bpm->flush_all_pages(small_fd);
+    bpm->flush_all_pages(large_fd);
+    EXPECT_EQ(static_cast<off_t>(num_pages) * PAGE_SIZE, lseek(small_fd, 0, SEEK_END));
+    EXPECT_EQ(static_cast<off_t>(num_pages) * large_page_size, lseek(large_fd, 0, SEEK_END));
+
+    for (int i = num_pages - 1; i >= 0; i--) {
+        for (int fd : {small_fd, large_fd}) {
+            int page_size = disk_manager_->get_page_size(fd);
+            Page *page = bpm->fetch_page({.fd = fd, .page_no = i});
+            ASSERT_NE(nullptr, page);
+            EXPECT_EQ("page " + std::to_string(i), std::string(page_content(page)));
+            EXPECT_EQ(static_cast<char>(i), page->get_data()[page_size - 1]);
+            ASSERT_TRUE(bpm->unpin_page({.fd = fd, .page_no = i}, false));
+        }
+    }
+    disk_manager_->close_file(small_fd);
+    disk_manager_->close_file(large_fd);
+}
+
+/**
+ * @brief 页面守卫：析构或drop()时自动解锁并unpin；多个读守卫可以同时持有同一页面，写守卫与其互斥
+ * @note 生成测试文件page_guard_test
+ */
+TEST_F(BufferPoolManagerTest, PageGuardTest) {
+    const int pool_size = 4;
+    auto bpm = std::make_unique<BufferPoolManager>(pool_size, disk_manager_.get());
+    const std::string filename = "page_guard_test";
+    disk_manager_->create_file(filename);
+    int fd = disk_manager_->open_file(filename);
+
+    PageId page_id = {.fd = fd, .page_no = INVALID_PAGE_ID};
+    {
+        auto guard = bpm->new_page_guarded(&page_id);
+        ASSERT_TRUE(guard.is_valid());
+        EXPECT_EQ(page_id, guard.get_page_id());
+        strcpy(guard.get_data() + Page::OFFSET_PAGE_HDR, "guarded");
+    }
+    // 守卫析构后页面已经unpin，并且被标记为脏页
+    EXPECT_FALSE(bpm->unpin_page(page_id, false));
+    EXPECT_TRUE(bpm->flush_page(page_id));
+    char buf[PAGE_SIZE];
+    disk_manager_->read_page(fd, page_id.page_no, buf, PAGE_SIZE);
+    EXPECT_STREQ("guarded", buf + Page::OFFSET_PAGE_HDR);
+
+    // 移动后只有新守卫持有pin，drop()之后守卫为空
+    {
+        auto guard = bpm->fetch_page_read(page_id);
+        ReadPageGuard moved = std::move(guard);
+        EXPECT_FALSE(guard.is_valid());
+        EXPECT_STREQ("guarded", moved.get_data() + Page::OFFSET_PAGE_HDR);
+        moved.drop();
+        EXPECT_FALSE(moved.is_valid());
+        EXPECT_FALSE(bpm->unpin_page(page_id, false));
+    }
+
+    // 异常路径上也会释放pin
+    EXPECT_THROW(
+        {
+            auto guard = bpm->fetch_page_write(page_id);
+            throw InternalError("abort");
+        },
+        InternalError);
+    EXPECT_FALSE(bpm->unpin_page(page_id, false));
+
+    // 所有帧都被守卫持有时无法获取新页面，释放一个守卫后恢复
+    {
+        std::vector<WritePageGuard> guards;
+        for (int i = 0; i < pool_size; i++) {
+            PageId new_id = {.fd = fd, .page_no = INVALID_PAGE_ID};
+            guards.push_back(bpm->new_page_guarded(&new_id));
+            ASSERT_TRUE(guards.back().is_valid());
+        }
+        PageId new_id = {.fd = fd, .page_no = INVALID_PAGE_ID};
+        EXPECT_FALSE(bpm->new_page_guarded(&new_id).is_valid());
+        guards.pop_back();
+        EXPECT_TRUE(bpm->fetch_page_read(page_id).is_valid());
+    }
+
+    // 两个线程可以同时持有读守卫；写守卫要等所有读守卫释放之后才能获得
+    std::atomic<int> readers{0};
+    std::atomic<bool> writer_done{false};
+    std::atomic<bool> release{false};
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 2; i++) {
+        threads.emplace_back([&]() {
+            auto guard = bpm->fetch_page_read(page_id);
+            readers++;
+            while (!release) {
+                std::this_thread::yield();
+            }
+        });
+    }
+    while (readers < 2) {
+        std::this_thread::yield();
+    }
+    threads.emplace_back([&]() {
+        auto guard = bpm->fetch_page_write(page_id);
+        strcpy(guard.get_data() + Page::OFFSET_PAGE_HDR, "written");
+        writer_done = true;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_FALSE(writer_done);
+    release = true;
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    EXPECT_TRUE(writer_done);
+    EXPECT_STREQ("written", bpm->fetch_page_read(page_id).get_data() + Page::OFFSET_PAGE_HDR);
+    EXPECT_FALSE(bpm->unpin_page(page_id, false));
+    disk_manager_->close_file(fd);
+}
+
+/**
+ * @brief 无锁命中路径：多个线程在缓冲池容纳不下的页面集合上随机fetch，命中与淘汰并发进行，
+ *        每次得到的页面都应是请求的页面；结束后所有帧都已unpin，可以全部被新页面占用
+ * @note 生成测试文件lock_free_hit_test
+ */
+TEST_F(BufferPoolManagerTest, LockFreeHitTest) {
+    const int pool_size = 16;
+    const int num_pages = 4 * pool_size;
+    const int num_threads = 8;
+    const int ops_per_thread = 20000;
+    auto bpm = std::make_unique<BufferPoolManager>(pool_size, disk_manager_.get(), 2);
+    const std::string filename = "lock_free_hit_test";
+    disk_manager_->create_file(filename);
+    int fd = disk_manager_->open_file(filename);
+    for (int i = 0; i < num_pages; i++) {
+        PageId page_id = {.fd = fd, .page_no = INVALID_PAGE_ID};
+        Page *page = bpm->new_page(&page_id);
+        ASSERT_NE(nullptr, page);
+        ASSERT_EQ(i, page_id.page_no);
+        memcpy(page->get_data(), &i, sizeof(i));
+        ASSERT_TRUE(bpm->unpin_page(page_id, true));
+    }
+
+    std::atomic<int> mismatches{0};
+    std::vector<std::thread> threads;
+    for (int tid = 0; tid < num_threads; tid++) {
+        threads.emplace_back([&, tid]() {
+            std::mt19937 rng(tid);
+            for (int i = 0; i < ops_per_thread; i++) {
+                // 一半的访问集中在前几个页面上，使命中与淘汰都频繁发生
+                int page_no = rng() % 2 ? static_cast<int>(rng() % 4) : static_cast<int>(rng() % num_pages);
+                PageId page_id = {.fd = fd, .page_no = page_no};
+                Page *page = bpm->fetch_page(page_id);
+                if (page == nullptr) {
+                    // 所有帧都被其他线程固定
+                    std::this_thread::yield();
+                    continue;
+                }
+                int stored;
+                memcpy(&stored, page->get_data(), sizeof(stored));
+                if (!(page->get_page_id() == page_id) || stored != page_no) {
+                    mismatches++;
+                }
+                if (!bpm->unpin_page(page_id, false)) {
+                    mismatches++;
+                }
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    EXPECT_EQ(0, mismatches);
+
+    for (int i = 0; i < pool_size; i++) {
+        PageId page_id = {.fd = fd, .page_no = INVALID_PAGE_ID};
+        EXPECT_NE(nullptr, bpm->new_page(&page_id));
+    }
+    disk_manager_->close_file(fd);
+}
+
+/**
+ * @brief PageId的比较与哈希：operator<按(fd, page_no)的字典序比较；页号超过65535时不同文件的页面不会得到相同的Get()值，
+ *        页表在删除后仍能找到同一探测序列上的其他页面
+ */
+TEST_F(BufferPoolManagerTest, PageIdTest) {
+    PageId a = {.fd = 3, .page_no = 100}, b = {.fd = 4, .page_no = 1}, c = {.fd = 4, .page_no = 2};
+    EXPECT_TRUE(a < b);
+    EXPECT_FALSE(b < a);
+    EXPECT_TRUE(b < c);
+    EXPECT_FALSE(a < a);
+
+    PageId x = {.fd = 3, .page_no = 1 << 16}, y = {.fd = 4, .page_no = 0};
+    EXPECT_NE(x.Get(), y.Get());
+    EXPECT_NE(PageIdHash()(x), PageIdHash()(y));
+
+    const int num_entries = 1000;
+    PageTable<> table(num_entries);
+    for (int i = 0; i < num_entries; i++) {
+        table.insert({.fd = 3 + i % 4, .page_no = (i / 4) << 16}, i);
+    }
+    for (int i = 0; i < num_entries; i += 2) {
+        EXPECT_TRUE(table.erase({.fd = 3 + i % 4, .page_no = (i / 4) << 16}));
+    }
+    EXPECT_EQ(static_cast<size_t>(num_entries / 2), table.size());
+    for (int i = 0; i < num_entries; i++) {
+        frame_id_t frame_id;
+        bool found = table.find({.fd = 3 + i % 4, .page_no = (i / 4) << 16}, &frame_id);
+        EXPECT_EQ(i % 2 == 1, found);
+        if (found) {
+            EXPECT_EQ(i, frame_id);
+        }
+    }
+}
+
+/**
+ * @brief 脏页表：只有被标记为脏页的页面出现在脏页表中，多次标记只出现一次；
+ *        写回文件后该文件的脏页移出脏页表，写回时仍被固定的页面保持为脏页
+ * @note 生成测试文件dirty_page_table_test_{0,1}
+ */
+TEST_F(BufferPoolManagerTest, DirtyPageTableTest) {
+    const int pool_size = 32;
+    const int num_pages = 8;
+    auto bpm = std::make_unique<BufferPoolManager>(pool_size, disk_manager_.get(), 4);
+    int fds[2];
+    for (int f = 0; f < 2; f++) {
+        std::string filename = "dirty_page_table_test_" + std::to_string(f);
+        disk_manager_->create_file(filename);
+        fds[f] = disk_manager_->open_file(filename);
+        for (int i = 0; i < num_pages; i++) {
+            PageId page_id = {.fd = fds[f], .page_no = INVALID_PAGE_ID};
+            ASSERT_NE(nullptr, bpm->new_page(&page_id));
+            ASSERT_TRUE(bpm->unpin_page(page_id, false));
+        }
+    }
+    bpm->flush_all_pages();
+    EXPECT_TRUE(bpm->get_dirty_page_table().empty());
+
+    // 修改两个文件中的奇数页，每页标记两次脏页
+    for (int f = 0; f < 2; f++) {
+        for (int i = 1; i < num_pages; i += 2) {
+            PageId page_id = {.fd = fds[f], .page_no = i};
+            Page *page = bpm->fetch_page(page_id);
+            ASSERT_NE(nullptr, page);
+            page->set_page_lsn(100 * f + i);
+            ASSERT_TRUE(bpm->unpin_page(page_id, true));
+            page = bpm->fetch_page(page_id);
+            page->set_page_lsn(1000);
+            ASSERT_TRUE(bpm->unpin_page(page_id, true));
+        }
+    }
+    std::vector<PageId> table = bpm->get_dirty_page_table();
+    std::set<PageId> dirty(table.begin(), table.end());
+    ASSERT_EQ(static_cast<size_t>(num_pages), table.size());
+    ASSERT_EQ(static_cast<size_t>(num_pages), dirty.size());
+    for (int f = 0; f < 2; f++) {
+        for (int i = 1; i < num_pages; i += 2) {
+            EXPECT_EQ(1u, dirty.count({.fd = fds[f], .page_no = i}));
+        }
+    }
+
+    // 写回第一个文件，其中第1页仍被固定，写回后保持为脏页
+    PageId pinned = {.fd = fds[0], .page_no = 1};
+    ASSERT_NE(nullptr, bpm->fetch_page(pinned));
+    bpm->flush_all_pages(fds[0]);
+    table = bpm->get_dirty_page_table();
+    dirty = std::set<PageId>(table.begin(), table.end());
+    EXPECT_EQ(static_cast<size_t>(num_pages / 2 + 1), dirty.size());
+    EXPECT_EQ(1u, dirty.count(pinned));
+    char buf[PAGE_SIZE];
+    for (int i = 1; i < num_pages; i += 2) {
+        disk_manager_->read_page(fds[0], i, buf, PAGE_SIZE);
+        EXPECT_EQ(1000, *reinterpret_cast<lsn_t *>(buf + Page::OFFSET_LSN));
+    }
+    ASSERT_TRUE(bpm->unpin_page(pinned, false));
+
+    // 淘汰写回的脏页同样移出脏页表
+    for (int i = 0; i < pool_size; i++) {
+        PageId page_id = {.fd = fds[1], .page_no = INVALID_PAGE_ID};
+        ASSERT_NE(nullptr, bpm->new_page(&page_id));
+        ASSERT_TRUE(bpm->unpin_page(page_id, false));
+    }
+    bpm->flush_all_pages();
+    EXPECT_TRUE(bpm->get_dirty_page_table().empty());
+    disk_manager_->close_file(fds[0]);
+    disk_manager_->close_file(fds[1]);
+}
+
+/**
+ * @brief 新建页面时被淘汰的脏页写回失败：new_page抛出异常，分配的页号归还给文件，之后新建的页面重新使用该页号
+ * @note 生成测试文件new_page_victim_{0,1}
+ */
+TEST_F(BufferPoolManagerTest, NewPageWriteBackFailureTest) {
+    const int pool_size = 4;
+    auto bpm = std::make_unique<BufferPoolManager>(pool_size, disk_manager_.get());
+    disk_manager_->create_file("new_page_victim_0");
+    disk_manager_->create_file("new_page_victim_1");
+    int dirty_fd = disk_manager_->open_file("new_page_victim_0");
+    int fd = disk_manager_->open_file("new_page_victim_1");
+    for (int i = 0; i < pool_size; i++) {
+        PageId page_id = {.fd = dirty_fd, .page_no = INVALID_PAGE_ID};
+        ASSERT_NE(nullptr, bpm->new_page(&page_id));
+        ASSERT_TRUE(bpm->unpin_page(page_id, true));
+    }
+
+    // 把脏页所在文件的句柄换成只读句柄，写回失败
+    int saved_fd = dup(dirty_fd);
+    int read_only_fd = open("new_page_victim_0", O_RDONLY);
+    ASSERT_GE(saved_fd, 0);
+    ASSERT_GE(read_only_fd, 0);
+    ASSERT_EQ(dirty_fd, dup2(read_only_fd, dirty_fd));
+    PageId page_id = {.fd = fd, .page_no = INVALID_PAGE_ID};
+    EXPECT_THROW(bpm->new_page(&page_id), InternalError);
+    EXPECT_EQ(0, disk_manager_->get_next_page_no(fd));
+
+    // 恢复句柄后新建页面，使用的仍是第0页，失败的写回可以重试
+    ASSERT_EQ(dirty_fd, dup2(saved_fd, dirty_fd));
+    close(saved_fd);
+    close(read_only_fd);
+    page_id = {.fd = fd, .page_no = INVALID_PAGE_ID};
+    ASSERT_NE(nullptr, bpm->new_page(&page_id));
+    EXPECT_EQ(0, page_id.page_no);
+    ASSERT_TRUE(bpm->unpin_page(page_id, true));
+    bpm->flush_all_pages();
+    EXPECT_TRUE(bpm->get_dirty_page_table().empty());
+    disk_manager_->close_file(dirty_fd);
+    disk_manager_->close_file(fd);
+}
+
+/**
+ * @brief 新建页面时重新分配回收的页面：仍缓存在缓冲池中的回收页面直接复用其帧；仍被固定时换用新页号，
+ *        被跳过的页号归还给文件，取消固定后再被分配
+ * @note 生成测试文件recycled_page_test
+ */
+TEST_F(BufferPoolManagerTest, RecycledPageTest) {
+    auto bpm = std::make_unique<BufferPoolManager>(16, disk_manager_.get());
+    disk_manager_->create_file("recycled_page_test");
+    int fd = disk_manager_->open_file("recycled_page_test");
+    const int num_pages = 4;
+    std::vector<Page *> pages;
+    for (int i = 0; i < num_pages; i++) {
+        PageId page_id = {.fd = fd, .page_no = INVALID_PAGE_ID};
+        Page *page = bpm->new_page(&page_id);
+        ASSERT_NE(nullptr, page);
+        ASSERT_EQ(i, page_id.page_no);
+        snprintf(page_content(page), PAGE_SIZE, "page %d", i);
+        pages.push_back(page);
+    }
+
+    // 释放第1页时它仍被固定，新建页面分配新的页号，第1页仍留在空闲页面中
+    const page_id_t recycled = 1;
+    ASSERT_TRUE(bpm->unpin_page({.fd = fd, .page_no = 0}, true));
+    disk_manager_->deallocate_page(fd, recycled);
+    PageId page_id = {.fd = fd, .page_no = INVALID_PAGE_ID};
+    ASSERT_NE(nullptr, bpm->new_page(&page_id));
+    EXPECT_EQ(num_pages, page_id.page_no);
+    EXPECT_EQ(recycled, disk_manager_->get_next_page_no(fd));
+    ASSERT_TRUE(bpm->unpin_page(page_id, true));
+
+    // 取消固定后再新建页面，复用第1页所在的帧，内容被清零
+    ASSERT_TRUE(bpm->unpin_page({.fd = fd, .page_no = recycled}, true));
+    page_id = {.fd = fd, .page_no = INVALID_PAGE_ID};
+    EXPECT_EQ(pages[recycled], bpm->new_page(&page_id));
+    EXPECT_EQ(recycled, page_id.page_no);
+    EXPECT_EQ(std::string(), std::string(page_content(pages[recycled])));
+    EXPECT_EQ(num_pages + 1, disk_manager_->get_next_page_no(fd));
+    ASSERT_TRUE(bpm->unpin_page(page_id, true));
+    for (int i = 2; i < num_pages; i++) {
+        ASSERT_TRUE(bpm->unpin_page({.fd = fd, .page_no = i}, true));
+    }
+    bpm->flush_all_pages(fd);
+    disk_manager_->close_file(fd);
+}
+
+/**
+ * @brief 帧内存位于FrameArena中：无论是否使用大页，每个大小类别的帧都按PAGE_SIZE对齐，新页面的内容为全零
+ * @note 生成测试文件frame_arena_test_{4096,16384}
+ */
+TEST_F(BufferPoolManagerTest, FrameArenaTest) {
+    for (bool huge_pages : {false, true}) {
+        // 默认类别共4MB，使用大页时arena不小于一个大页
+        auto bpm = std::make_unique<BufferPoolManager>(1024, disk_manager_.get(), 4, REPLACER_TYPE, huge_pages);
+        if (!huge_pages) {
+            EXPECT_EQ(FrameArena::Backing::NORMAL, bpm->get_frame_backing());
+        }
+        for (int page_size : {PAGE_SIZE, 4 * PAGE_SIZE}) {
+            std::string filename = "frame_arena_test_" + std::to_string(page_size);
+            disk_manager_->create_file(filename);
+            int fd = disk_manager_->open_file(filename);
+            disk_manager_->set_page_size(fd, page_size);
+            for (int i = 0; i < 8; i++) {
+                PageId page_id = {.fd = fd, .page_no = INVALID_PAGE_ID};
+                Page *page = bpm->new_page(&page_id);
+                ASSERT_NE(nullptr, page);
+                EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(page->get_data()) % PAGE_SIZE);
+                EXPECT_EQ(page_size, page->get_page_size());
+                EXPECT_EQ(std::string(page_size, '\0'), std::string(page->get_data(), page_size));
+                ASSERT_TRUE(bpm->unpin_page(page_id, true));
+            }
+            bpm->flush_all_pages(fd);
+            disk_manager_->close_file(fd);
+            disk_manager_->destroy_file(filename);
+        }
+    }
+}
+
+/**
+ * @brief 测试在线调整缓冲池大小：扩大后可以同时固定更多页面；缩小时等待退役帧中被固定的页面取消固定，
+ * 淘汰时写回脏页；调整期间其他线程持续读写页面，页面内容保持正确
+ */
+TEST_F(BufferPoolManagerTest, ResizeTest) {
+    const int num_pages = 64;
+    auto bpm = std::make_unique<BufferPoolManager>(8, disk_manager_.get(), 2, REPLACER_TYPE, false, 32);
+    EXPECT_EQ(8u, bpm->get_pool_size());
+    EXPECT_EQ(32u, bpm->get_max_pool_size());
+    EXPECT_THROW(bpm->resize(1), InvalidBufferPoolSizeError);
+    EXPECT_THROW(bpm->resize(33), InvalidBufferPoolSizeError);
+
+    disk_manager_->create_file("resize_test");
+    int fd = disk_manager_->open_file("resize_test");
+    disk_manager_->set_fd2pageno(fd, 0);
+    // 每个页面在页头之后记录自己的页号和写入次数
+    auto content = [](Page *page) { return reinterpret_cast<int *>(page->get_data() + Page::OFFSET_PAGE_HDR); };
+    for (int i = 0; i < num_pages; i++) {
+        PageId page_id = {.fd = fd, .page_no = INVALID_PAGE_ID};
+        Page *page = bpm->new_page(&page_id);
+        ASSERT_NE(nullptr, page);
+        content(page)[0] = page_id.page_no;
+        ASSERT_TRUE(bpm->unpin_page(page_id, true));
+    }
+    // 依次固定页面直到没有可用的帧，相邻页面落在不同的分片上，能固定的页面数等于缓冲池大小
+    std::vector<PageId> pinned;
+    auto pin_all = [&]() {
+        for (int i = 0; i < num_pages; i++) {
+            PageId page_id = {.fd = fd, .page_no = i};
+            Page *page = bpm->fetch_page(page_id);
+            if (page == nullptr) {
+                break;
+            }
+            content(page)[1]++;
+            pinned.push_back(page_id);
+        }
+        return pinned.size();
+    };
+    auto unpin_all = [&]() {
+        for (auto &page_id : pinned) {
+            ASSERT_TRUE(bpm->unpin_page(page_id, true));
+        }
+        pinned.clear();
+    };
+    EXPECT_EQ(8u, pin_all());
+    unpin_all();
+    bpm->resize(16);
+    EXPECT_EQ(16u, bpm->get_pool_size());
+    EXPECT_EQ(16u, pin_all());
+
+    // 页面在超时之前一直被固定，缩小失败，缓冲池保持原来的大小，被固定的页面仍然可用
+    EXPECT_THROW(bpm->resize(4, std::chrono::milliseconds(20)), BufferPoolResizeTimeoutError);
+    EXPECT_EQ(16u, bpm->get_pool_size());
+    for (auto &page_id : pinned) {
+        Page *page = bpm->fetch_page(page_id);
+        ASSERT_NE(nullptr, page);
+        EXPECT_EQ(page_id.page_no, content(page)[0]);
+        ASSERT_TRUE(bpm->unpin_page(page_id, false));
+    }
+
+    // 所有帧都被固定时缩小，resize等待页面取消固定后才完成
+    std::atomic<bool> unpinned{false};
+    std::thread unpinner([&] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        unpinned = true;
+        unpin_all();
+    });
+    bpm->resize(4);
+    EXPECT_TRUE(unpinned);
+    unpinner.join();
+    EXPECT_EQ(4u, bpm->get_pool_size());
+    EXPECT_EQ(4u, pin_all());
+    unpin_all();
+
+    // 调整大小的同时，其他线程随机读写页面
+    const int num_threads = 4;
+    std::atomic<bool> stop{false};
+    std::vector<int> writes(num_pages, 0);
+    std::mutex writes_latch;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads; t++) {
+        threads.emplace_back([&, t] {
+            std::mt19937 rng(t);
+            while (!stop) {
+                PageId page_id = {.fd = fd, .page_no = static_cast<page_id_t>(rng() % num_pages)};
+                WritePageGuard guard = bpm->fetch_page_write(page_id);
+                if (!guard.is_valid()) {
+                    // 分片中的帧都被其他线程固定
+                    std::this_thread::yield();
+                    continue;
+                }
+                int *data = reinterpret_cast<int *>(guard.get_data() + Page::OFFSET_PAGE_HDR);
+                EXPECT_EQ(page_id.page_no, data[0]);
+                data[2]++;
+                std::scoped_lock lock{writes_latch};
+                writes[page_id.page_no]++;
+            }
+        });
+    }
+    for (size_t pool_size : {24, 4, 32, 2, 16}) {
+        bpm->resize(pool_size);
+        EXPECT_EQ(pool_size, bpm->get_pool_size());
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    stop = true;
+    for (auto &thread : threads) {
+        thread.join();
+    }
+
+    bpm->flush_all_pages(fd);
+    char buf[PAGE_SIZE];
+    for (int i = 0; i < num_pages; i++) {
+        disk_manager_->read_page(fd, i, buf, PAGE_SIZE);
+        int *data = reinterpret_cast<int *>(buf + Page::OFFSET_PAGE_HDR);
+        EXPECT_EQ(i, data[0]);
+        EXPECT_EQ(writes[i], data[2]);
+    }
+    disk_manager_->close_file(fd);
+}
+
+TEST_F(BufferPoolManagerTest, StatsTest) {
+    LatencyHistogram histogram;
+    for (int i = 0; i < 99; i++) {
+        histogram.record(1000);
+    }
+    histogram.record(1000000);
+    LatencySnapshot snapshot = histogram.snapshot();
+    EXPECT_EQ(100u, snapshot.count);
+    EXPECT_DOUBLE_EQ(1.024, snapshot.percentile_us(0.5));
+    EXPECT_DOUBLE_EQ(1.024, snapshot.percentile_us(0.99));
+    EXPECT_DOUBLE_EQ(1048.576, snapshot.percentile_us(1));
+    EXPECT_DOUBLE_EQ(10.99, snapshot.mean_us());
+
+    const int pool_size = 4;
+    const int num_pages = 8;
+    auto bpm = std::make_unique<BufferPoolManager>(pool_size, disk_manager_.get());
+    disk_manager_->create_file("stats_test");
+    int fd = disk_manager_->open_file("stats_test");
+    disk_manager_->set_fd2pageno(fd, 0);
+    // 新建的页面都是脏页，缓冲池放不下的页面在淘汰时写回
+    for (int i = 0; i < num_pages; i++) {
+        PageId page_id = {.fd = fd, .page_no = INVALID_PAGE_ID};
+        ASSERT_NE(nullptr, bpm->new_page(&page_id));
+        ASSERT_TRUE(bpm->unpin_page(page_id, true));
+    }
+    const int num_hits = 2 * BUFFER_STATS_HIT_SAMPLE_INTERVAL;
+    for (int i = 0; i < num_hits; i++) {
+        PageId page_id = {.fd = fd, .page_no = num_pages - 1};
+        ASSERT_NE(nullptr, bpm->fetch_page(page_id));
+        ASSERT_TRUE(bpm->unpin_page(page_id, false));
+    }
+    // 写回所有脏页后，读入页面淘汰的是干净页面
+    bpm->flush_all_pages(fd);
+    PageId first = {.fd = fd, .page_no = 0};
+    ASSERT_NE(nullptr, bpm->fetch_page(first));
+    ASSERT_TRUE(bpm->unpin_page(first, false));
+
+    BufferPoolStatus status = bpm->get_status();
+    std::map<std::string, std::string> metrics(status.metrics.begin(), status.metrics.end());
+    EXPECT_EQ(std::to_string(pool_size), metrics["pool_size"]);
+    EXPECT_EQ(std::to_string(pool_size), metrics["resident_pages"]);
+    EXPECT_EQ("0", metrics["dirty_pages"]);
+    EXPECT_EQ(std::to_string(num_hits), metrics["hits"]);
+    EXPECT_EQ("1", metrics["misses"]);
+    EXPECT_EQ(std::to_string(num_pages - pool_size), metrics["evict_dirty"]);
+    EXPECT_EQ("1", metrics["evict_clean"]);
+    EXPECT_EQ(std::to_string(pool_size), metrics["flushed_pages"]);
+    EXPECT_GT(std::stod(metrics["hit_p50_us"]), 0);
+    EXPECT_GT(std::stod(metrics["miss_avg_us"]), 0);
+    ASSERT_EQ(1u, status.files.size());
+    EXPECT_EQ("stats_test", status.files[0].name);
+    EXPECT_EQ(1u, status.files[0].page_reads);
+    EXPECT_EQ(static_cast<uint64_t>(num_pages), status.files[0].page_writes);
+
+    // 定期输出的统计追加到文件中
+    bpm->start_stats_dump("stats_test.log", std::chrono::milliseconds(5));
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    bpm->stop_stats_dump();
+    std::ifstream log("stats_test.log");
+    std::string text((std::istreambuf_iterator<char>(log)), std::istreambuf_iterator<char>());
+    EXPECT_NE(std::string::npos, text.find("==== "));
+    EXPECT_NE(std::string::npos, text.find("file stats_test: page_reads=1"));
+    disk_manager_->close_file(fd);
+}
+
+TEST_F(BufferPoolManagerTest, ChecksumTest) {
+    const char *digits = "123456789";
+    EXPECT_EQ(0xe3069283u, crc32c(digits, 9));
+    EXPECT_EQ(0xe3069283u, crc32c(digits + 4, 5, crc32c(digits, 4)));
+
+    // 三段交错计算的结果与逐段计算一致
+    std::vector<char> data(PAGE_SIZE);
+    std::mt19937 rng(0);
+    for (auto &c : data) {
+        c = static_cast<char>(rng());
+    }
+    const page_id_t page_no = 7;
+    const size_t body = Page::OFFSET_CHECKSUM + sizeof(uint32_t);
+    const size_t lane_len = (PAGE_SIZE - body) / 8 / 3 * 8;
+    uint32_t lanes[3] = {crc32c(data.data() + lane_len * 0 + body, lane_len, crc32c(data.data(), 4, page_no)),
+                         crc32c(data.data() + lane_len * 1 + body, lane_len, page_no),
+                         crc32c(data.data() + lane_len * 2 + body, PAGE_SIZE - body - 2 * lane_len, page_no)};
+    for (auto &lane : lanes) {
+        lane = ~lane;
+    }
+    EXPECT_EQ(crc32c(lanes, sizeof(lanes), page_no), page_checksum(data.data(), PAGE_SIZE, page_no));
+
+    set_page_checksum(data.data(), PAGE_SIZE, page_no);
+    EXPECT_TRUE(verify_page_checksum(data.data(), PAGE_SIZE, page_no));
+    EXPECT_FALSE(verify_page_checksum(data.data(), PAGE_SIZE, page_no + 1));
+    data[PAGE_SIZE / 2] ^= 1;
+    EXPECT_FALSE(verify_page_checksum(data.data(), PAGE_SIZE, page_no));
+    std::vector<char> zeros(PAGE_SIZE, 0);
+    EXPECT_TRUE(verify_page_checksum(zeros.data(), PAGE_SIZE, page_no));
+
+    const int num_pages = 8;
+    auto bpm = std::make_unique<BufferPoolManager>(4, disk_manager_.get());
+    disk_manager_->create_file("checksum_test");
+    int fd = disk_manager_->open_file("checksum_test");
+    disk_manager_->set_fd2pageno(fd, 0);
+    for (int i = 0; i < num_pages; i++) {
+        PageId page_id = {.fd = fd, .page_no = INVALID_PAGE_ID};
+        Page *page = bpm->new_page(&page_id);
+        ASSERT_NE(nullptr, page);
+        snprintf(page_content(page), PAGE_SIZE, "page %d", i);
+        ASSERT_TRUE(bpm->unpin_page(page_id, true));
+    }
+    bpm->flush_all_pages(fd);
+    ScrubResult result = bpm->scrub_file(fd, 0);
+    EXPECT_EQ(static_cast<size_t>(num_pages), result.num_pages);
+    EXPECT_TRUE(result.corrupt_pages.empty());
+
+    // 绕过缓冲池损坏一个不在缓冲池中的页面，读入时发现校验和不一致
+    const page_id_t corrupt = 1;
+    char buf[PAGE_SIZE];
+    disk_manager_->read_page(fd, corrupt, buf, PAGE_SIZE);
+    buf[PAGE_SIZE - 1] ^= 0x10;
+    disk_manager_->write_page(fd, corrupt, buf, PAGE_SIZE);
+    EXPECT_THROW(bpm->fetch_page({.fd = fd, .page_no = corrupt}), PageChecksumError);
+    for (int i = 0; i < num_pages; i++) {
+        if (i == corrupt) {
+            continue;
+        }
+        Page *page = bpm->fetch_page({.fd = fd, .page_no = i});
+        ASSERT_NE(nullptr, page);
+        EXPECT_EQ("page " + std::to_string(i), std::string(page_content(page)));
+        ASSERT_TRUE(bpm->unpin_page({.fd = fd, .page_no = i}, false));
+    }
+
+    result = bpm->scrub_file_async(fd, 0).get();
+    EXPECT_EQ(static_cast<size_t>(num_pages), result.num_pages);
+    EXPECT_EQ(std::vector<page_id_t>{corrupt}, result.corrupt_pages);
+
+    bpm->set_verify_checksums(false);
+    Page *page = bpm->fetch_page({.fd = fd, .page_no = corrupt});
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ("page 1", std::string(page_content(page)));
+
+    // 损坏的页面在缓冲池中被固定时，重新读取期间固定其帧并标记为I/O中，之后恢复原来的状态
+    result = bpm->scrub_file(fd, 0);
+    EXPECT_EQ(std::vector<page_id_t>{corrupt}, result.corrupt_pages);
+    ASSERT_TRUE(bpm->unpin_page({.fd = fd, .page_no = corrupt}, false));
+    EXPECT_FALSE(bpm->unpin_page({.fd = fd, .page_no = corrupt}, false));
+    EXPECT_EQ(page, bpm->fetch_page({.fd = fd, .page_no = corrupt}));
+    ASSERT_TRUE(bpm->unpin_page({.fd = fd, .page_no = corrupt}, false));
+
+    BufferPoolStatus status = bpm->get_status();
+    std::map<std::string, std::string> metrics(status.metrics.begin(), status.metrics.end());
+    EXPECT_EQ("3", metrics["checksum_errors"]);
+    EXPECT_EQ(std::to_string(3 * num_pages), metrics["scrubbed_pages"]);
+    disk_manager_->close_file(fd);
+}
@@ -0,0 +1,103 @@
+#include "replacer/clock_replacer.h"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+/**
+ * @brief 简单测试ClockReplacer的基本功能
+ */
+TEST(ClockReplacerTest, SimpleTest) {
+    ClockReplacer clock_replacer(7);
+
+    // unpin六个帧，引用位均为1
+    for (int i = 1; i <= 6; i++) {
+        clock_replacer.unpin(i);
+    }
+    clock_replacer.unpin(1);
+    EXPECT_EQ(6, clock_replacer.Size());
+
+    // 第一圈清除所有引用位，第二圈按指针顺序淘汰
+    int value;
+    EXPECT_TRUE(clock_replacer.victim(&value));
+    EXPECT_EQ(1, value);
+    EXPECT_TRUE(clock_replacer.victim(&value));
+    EXPECT_EQ(2, value);
+    EXPECT_TRUE(clock_replacer.victim(&value));
+    EXPECT_EQ(3, value);
+
+    // 3已被淘汰，pin 3不产生影响
+    clock_replacer.pin(3);
+    clock_replacer.pin(4);
+    EXPECT_EQ(2, clock_replacer.Size());
+
+    // 重新unpin 4，4获得二次机会
+    clock_replacer.unpin(4);
+    EXPECT_TRUE(clock_replacer.victim(&value));
+    EXPECT_EQ(5, value);
+    EXPECT_TRUE(clock_replacer.victim(&value));
+    EXPECT_EQ(6, value);
+    EXPECT_TRUE(clock_replacer.victim(&value));
+    EXPECT_EQ(4, value);
+    EXPECT_FALSE(clock_replacer.victim(&value));
+}
+
+/**
+ * @brief 测试ClockReplacer的victim_if和candidates
+ */
+TEST(ClockReplacerTest, FilterTest) {
+    ClockReplacer clock_replacer(8);
+    for (int i = 0; i < 8; i++) {
+        clock_replacer.unpin(i);
+    }
+    int value;
+    EXPECT_TRUE(clock_replacer.victim(&value));
+    EXPECT_EQ(0, value);
+    // 此时1~7引用位均为0，unpin 0后其引用位为1，排在最后
+    clock_replacer.unpin(0);
+
+    std::vector<frame_id_t> frames;
+    clock_replacer.candidates(&frames, 3);
+    EXPECT_EQ(std::vector<frame_id_t>({1, 2, 3}), frames);
+
+    // 窗口内只有偶数帧2满足条件
+    EXPECT_TRUE(clock_replacer.victim_if(&value, [](frame_id_t f) { return f % 2 == 0; }, 3));
+    EXPECT_EQ(2, value);
+    EXPECT_FALSE(clock_replacer.victim_if(&value, [](frame_id_t f) { return f == 0; }, 4));
+    EXPECT_TRUE(clock_replacer.victim_if(&value, [](frame_id_t f) { return f == 0; }, 0));
+    EXPECT_EQ(0, value);
+    EXPECT_EQ(6, clock_replacer.Size());
+}
+
+/**
+ * @brief 随机pin/unpin后，所有可淘汰帧都恰好被淘汰一次
+ */
+TEST(ClockReplacerTest, MixTest) {
+    const int value_size = 10000;
+    ClockReplacer clock_replacer(value_size);
+    std::vector<int> value(value_size);
+    for (int i = 0; i < value_size; i++) {
+        value[i] = i;
+    }
+    auto rng = std::default_random_engine{};
+    std::shuffle(value.begin(), value.end(), rng);
+    for (int v : value) {
+        clock_replacer.unpin(v);
+    }
+    for (int i = 0; i < value_size / 2; i++) {
+        clock_replacer.pin(value[i]);
+    }
+    EXPECT_EQ(value_size / 2, clock_replacer.Size());
+
+    std::vector<int> out_values;
+    int result;
+    while (clock_replacer.victim(&result)) {
+        out_values.push_back(result);
+    }
+    std::vector<int> expected(value.begin() + value_size / 2, value.end());
+    std::sort(expected.begin(), expected.end());
+    std::sort(out_values.begin(), out_values.end());
+    EXPECT_EQ(expected, out_values);
+}
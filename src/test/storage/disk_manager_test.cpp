@@ -1,5 +1,6 @@
 #include "storage/disk_manager.h"
 
+#include <algorithm>
 #include <cassert>
 #include <cstring>
 #include <unordered_map>
@@ -147,3 +148,235 @@ TEST_F(DiskManagerTest, PageOperation) {
     disk_manager_->destroy_file(filename);
     EXPECT_EQ(disk_manager_->is_file(filename), false);
 }
+
+/**
+ * @brief 测试批量读写页面：write_pages合并页号连续的页面，read_pages一次读取连续页面
+ */
+TEST_F(DiskManagerTest, BatchPageOperation) {
+    const std::string filename = "BatchPageOperationTestFile";
+    if (disk_manager_->is_file(filename)) {
+        disk_manager_->destroy_file(filename);
+    }
+    disk_manager_->create_file(filename);
+    int fd = disk_manager_->open_file(filename);
+
+    // 写入页面0~3、5、8~9，中间的空洞读出来应为全0
+    std::vector<page_id_t> page_nos = {0, 1, 2, 3, 5, 8, 9};
+    std::vector<std::vector<char>> data(page_nos.size(), std::vector<char>(PAGE_SIZE));
+    std::vector<const char *> bufs;
+    for (auto &page : data) {
+        rand_buf(page.data(), PAGE_SIZE);
+        bufs.push_back(page.data());
+    }
+    disk_manager_->write_pages(fd, page_nos.data(), bufs.data(), page_nos.size());
+
+    const int num_pages = 12;
+    std::vector<std::vector<char>> out(num_pages, std::vector<char>(PAGE_SIZE, 1));
+    std::vector<char *> out_bufs;
+    for (auto &page : out) {
+        out_bufs.push_back(page.data());
+    }
+    disk_manager_->read_pages(fd, 0, out_bufs.data(), num_pages);
+    std::vector<char> zero(PAGE_SIZE, 0);
+    for (int page_no = 0; page_no < num_pages; page_no++) {
+        auto it = std::find(page_nos.begin(), page_nos.end(), page_no);
+        const std::vector<char> &expected = it == page_nos.end() ? zero : data[it - page_nos.begin()];
+        EXPECT_EQ(expected, out[page_no]);
+    }
+
+    disk_manager_->close_file(fd);
+    disk_manager_->destroy_file(filename);
+}
+
+/**
+ * @brief 测试异步I/O上下文：批量提交写请求和读请求，检查完成结果和读出的数据（io_uring和同步两种模式）
+ */
+TEST_F(DiskManagerTest, AsyncPageOperation) {
+    const std::string filename = "AsyncPageOperationTestFile";
+    if (disk_manager_->is_file(filename)) {
+        disk_manager_->destroy_file(filename);
+    }
+    disk_manager_->create_file(filename);
+    int fd = disk_manager_->open_file(filename);
+
+    const int num_pages = 40;
+    std::vector<std::vector<char>> data(num_pages, std::vector<char>(PAGE_SIZE));
+    for (auto &page : data) {
+        rand_buf(page.data(), PAGE_SIZE);
+    }
+    for (bool use_io_uring : {true, false}) {
+        AsyncIO aio(disk_manager_.get(), 8, use_io_uring);
+        EXPECT_EQ(8, aio.queue_depth());
+        std::vector<AsyncIOCompletion> completions;
+        // 队列深度小于请求数，队列满时先等待一部分请求完成
+        int next = 0;
+        while (next < num_pages || aio.in_flight() > 0) {
+            while (next < num_pages && aio.prep_write(fd, next, data[next].data(), next)) {
+                next++;
+            }
+            aio.submit();
+            aio.wait(&completions, 1);
+        }
+        ASSERT_EQ(num_pages, completions.size());
+        std::vector<bool> seen(num_pages, false);
+        for (auto &completion : completions) {
+            EXPECT_EQ(0, completion.result);
+            seen[completion.user_data] = true;
+        }
+        EXPECT_EQ(std::vector<bool>(num_pages, true), seen);
+
+        // 读取全部页面以及文件末尾之后的一个页面
+        std::vector<std::vector<char>> out(num_pages + 1, std::vector<char>(PAGE_SIZE, 1));
+        completions.clear();
+        for (int i = 0; i <= num_pages; i++) {
+            if (!aio.prep_read(fd, i, out[i].data(), i)) {
+                aio.submit();
+                aio.wait(&completions, 1);
+                ASSERT_TRUE(aio.prep_read(fd, i, out[i].data(), i));
+            }
+        }
+        aio.submit();
+        aio.wait(&completions, aio.in_flight());
+        EXPECT_EQ(0, aio.in_flight());
+        ASSERT_EQ(num_pages + 1, completions.size());
+        for (int i = 0; i < num_pages; i++) {
+            EXPECT_EQ(data[i], out[i]);
+        }
+        EXPECT_EQ(std::vector<char>(PAGE_SIZE, 0), out[num_pages]);
+    }
+
+    disk_manager_->close_file(fd);
+    disk_manager_->destroy_file(filename);
+}
+
+/**
+ * @brief 测试O_DIRECT模式：对齐的整页读写直接进行，未对齐或不足一页的读写经过中转缓冲区，且不破坏页面其余部分
+ * 文件系统不支持O_DIRECT时文件以普通方式打开，读写结果相同
+ */
+TEST_F(DiskManagerTest, DirectIOOperation) {
+    const std::string filename = "DirectIOTestFile";
+    if (disk_manager_->is_file(filename)) {
+        disk_manager_->destroy_file(filename);
+    }
+    disk_manager_->create_file(filename);
+    disk_manager_->set_direct_io(true);
+    int fd = disk_manager_->open_file(filename);
+    disk_manager_->set_fd2pageno(fd, 0);
+
+    AlignedBuffer data = DiskManager::alloc_aligned(PAGE_SIZE);
+    AlignedBuffer buf = DiskManager::alloc_aligned(PAGE_SIZE);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(data.get()) % DIRECT_IO_ALIGNMENT, 0);
+
+    // 对齐的整页读写
+    for (int page_no = 0; page_no < 4; page_no++) {
+        disk_manager_->allocate_page(fd);
+        rand_buf(data.get(), PAGE_SIZE);
+        disk_manager_->write_page(fd, page_no, data.get(), PAGE_SIZE);
+        disk_manager_->read_page(fd, page_no, buf.get(), PAGE_SIZE);
+        EXPECT_EQ(std::memcmp(buf.get(), data.get(), PAGE_SIZE), 0);
+    }
+
+    // 未对齐的部分页写入只覆盖页面开头，其余部分保持不变
+    char hdr[37];
+    rand_buf(hdr, sizeof(hdr));
+    disk_manager_->write_page(fd, 3, hdr, sizeof(hdr));
+    std::memcpy(data.get(), hdr, sizeof(hdr));
+    disk_manager_->read_page(fd, 3, buf.get(), PAGE_SIZE);
+    EXPECT_EQ(std::memcmp(buf.get(), data.get(), PAGE_SIZE), 0);
+
+    // 未对齐的部分页读取
+    char hdr_read[37] = {0};
+    disk_manager_->read_page(fd, 3, hdr_read, sizeof(hdr_read));
+    EXPECT_EQ(std::memcmp(hdr_read, hdr, sizeof(hdr)), 0);
+
+    // 未对齐的缓冲区批量读写
+    std::vector<char> unaligned(2 * PAGE_SIZE + 1);
+    char *bufs[2] = {unaligned.data() + 1, unaligned.data() + 1 + PAGE_SIZE};
+    rand_buf(bufs[0], PAGE_SIZE);
+    rand_buf(bufs[1], PAGE_SIZE);
+    page_id_t page_nos[2] = {0, 1};
+    disk_manager_->write_pages(fd, page_nos, bufs, 2);
+    for (int i = 0; i < 2; i++) {
+        disk_manager_->read_page(fd, i, buf.get(), PAGE_SIZE);
+        EXPECT_EQ(std::memcmp(buf.get(), bufs[i], PAGE_SIZE), 0);
+    }
+
+    // 超过一个页面且长度未对齐的写入（如索引文件头），只覆盖写入的范围，之后的内容保持不变
+    std::vector<char> long_hdr(PAGE_SIZE + 100);
+    rand_buf(long_hdr.data(), static_cast<int>(long_hdr.size()));
+    std::vector<char> page1(bufs[1], bufs[1] + PAGE_SIZE);
+    disk_manager_->write_page(fd, 0, long_hdr.data(), static_cast<int>(long_hdr.size()));
+    std::vector<char> long_read(long_hdr.size());
+    disk_manager_->read_page(fd, 0, long_read.data(), static_cast<int>(long_read.size()));
+    EXPECT_EQ(long_hdr, long_read);
+    disk_manager_->read_page(fd, 1, buf.get(), PAGE_SIZE);
+    EXPECT_EQ(std::memcmp(buf.get(), long_hdr.data() + PAGE_SIZE, 100), 0);
+    EXPECT_EQ(std::memcmp(buf.get() + 100, page1.data() + 100, PAGE_SIZE - 100), 0);
+
+    disk_manager_->close_file(fd);
+    EXPECT_FALSE(disk_manager_->is_direct_io(fd));
+    disk_manager_->set_direct_io(false);
+    disk_manager_->destroy_file(filename);
+}
+
+/**
+ * @brief 测试按区预分配文件空间：分配超出已分配空间的页面时按区预分配磁盘空间，区内的页面不再扩展文件；
+ * 预分配不改变文件大小，文件大小只随写入的页面增长
+ */
+TEST_F(DiskManagerTest, ExtentAllocation) {
+    const std::string filename = "ExtentAllocationTestFile";
+    if (disk_manager_->is_file(filename)) {
+        disk_manager_->destroy_file(filename);
+    }
+    disk_manager_->create_file(filename);
+    const int pages_per_extent = 16;
+    disk_manager_->set_extent_size(pages_per_extent * PAGE_SIZE);
+    int fd = disk_manager_->open_file(filename);
+    disk_manager_->set_fd2pageno(fd, 0);
+
+    EXPECT_EQ(0, disk_manager_->allocate_page(fd));
+    EXPECT_EQ(1u, disk_manager_->get_num_extents());
+    EXPECT_EQ(0, disk_manager_->get_file_size(filename));
+    struct stat st;
+    ASSERT_EQ(0, fstat(fd, &st));
+    EXPECT_GE(st.st_blocks * 512, pages_per_extent * PAGE_SIZE);
+
+    // 区内的页面不需要扩展文件，写入页面后文件大小到该页面的末尾
+    char data[PAGE_SIZE];
+    char buf[PAGE_SIZE];
+    for (int i = 1; i < pages_per_extent; i++) {
+        EXPECT_EQ(i, disk_manager_->allocate_page(fd));
+    }
+    rand_buf(data, PAGE_SIZE);
+    disk_manager_->write_page(fd, 1, data, PAGE_SIZE);
+    EXPECT_EQ(1u, disk_manager_->get_num_extents());
+    EXPECT_EQ(2 * PAGE_SIZE, disk_manager_->get_file_size(filename));
+    disk_manager_->read_page(fd, 1, buf, PAGE_SIZE);
+    EXPECT_EQ(0, std::memcmp(data, buf, PAGE_SIZE));
+    // 预分配但未写入的页面读出全零
+    disk_manager_->read_page(fd, pages_per_extent - 1, buf, PAGE_SIZE);
+    EXPECT_EQ(std::string(PAGE_SIZE, '\0'), std::string(buf, PAGE_SIZE));
+
+    EXPECT_EQ(pages_per_extent, disk_manager_->allocate_page(fd));
+    EXPECT_EQ(2u, disk_manager_->get_num_extents());
+    EXPECT_EQ(2 * PAGE_SIZE, disk_manager_->get_file_size(filename));
+    ASSERT_EQ(0, fstat(fd, &st));
+    EXPECT_GE(st.st_blocks * 512, 2 * pages_per_extent * PAGE_SIZE);
+
+    // 写入第二个区的最后一页，重新打开文件后已预分配的区不再扩展，关闭预分配时文件只在写入时增长
+    disk_manager_->write_page(fd, 2 * pages_per_extent - 1, data, PAGE_SIZE);
+    disk_manager_->close_file(fd);
+    fd = disk_manager_->open_file(filename);
+    disk_manager_->set_fd2pageno(fd, pages_per_extent + 1);
+    for (int i = pages_per_extent + 1; i < 2 * pages_per_extent; i++) {
+        EXPECT_EQ(i, disk_manager_->allocate_page(fd));
+    }
+    EXPECT_EQ(2u, disk_manager_->get_num_extents());
+    disk_manager_->set_extent_size(0);
+    EXPECT_EQ(2 * pages_per_extent, disk_manager_->allocate_page(fd));
+    EXPECT_EQ(2u, disk_manager_->get_num_extents());
+    EXPECT_EQ(2 * pages_per_extent * PAGE_SIZE, disk_manager_->get_file_size(filename));
+
+    disk_manager_->close_file(fd);
+    disk_manager_->destroy_file(filename);
+}
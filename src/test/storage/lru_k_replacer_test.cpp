@@ -0,0 +1,83 @@
+#include "replacer/lru_k_replacer.h"
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+/**
+ * @brief 简单测试LRUKReplacer(K=2)的基本功能
+ */
+TEST(LRUKReplacerTest, SimpleTest) {
+    LRUKReplacer lru_k_replacer(7, 2);
+
+    // 帧1~6各访问一次，帧1~3再访问一次
+    for (int i = 1; i <= 6; i++) {
+        lru_k_replacer.pin(i);
+        lru_k_replacer.unpin(i);
+    }
+    for (int i = 1; i <= 3; i++) {
+        lru_k_replacer.pin(i);
+        lru_k_replacer.unpin(i);
+    }
+    EXPECT_EQ(6, lru_k_replacer.Size());
+
+    // 访问不足两次的帧4~6后向距离为无穷大，按首次访问时间先被淘汰
+    int value;
+    EXPECT_TRUE(lru_k_replacer.victim(&value));
+    EXPECT_EQ(4, value);
+    EXPECT_TRUE(lru_k_replacer.victim(&value));
+    EXPECT_EQ(5, value);
+
+    // 帧1再访问一次，倒数第二次访问变为其第二次访问，晚于帧2、3的倒数第二次访问
+    lru_k_replacer.pin(1);
+    lru_k_replacer.unpin(1);
+    lru_k_replacer.pin(3);
+    EXPECT_EQ(3, lru_k_replacer.Size());
+
+    std::vector<frame_id_t> frames;
+    lru_k_replacer.candidates(&frames, 0);
+    EXPECT_TRUE(frames.empty());
+    lru_k_replacer.candidates(&frames, 3);
+    EXPECT_EQ(std::vector<frame_id_t>({6, 2, 1}), frames);
+
+    EXPECT_TRUE(lru_k_replacer.victim_if(&value, [](frame_id_t f) { return f != 6; }, 2));
+    EXPECT_EQ(2, value);
+    EXPECT_FALSE(lru_k_replacer.victim_if(&value, [](frame_id_t f) { return f == 1; }, 1));
+    EXPECT_TRUE(lru_k_replacer.victim(&value));
+    EXPECT_EQ(6, value);
+    EXPECT_TRUE(lru_k_replacer.victim(&value));
+    EXPECT_EQ(1, value);
+    EXPECT_FALSE(lru_k_replacer.victim(&value));
+
+    // 被淘汰的帧访问历史被清空，重新装入页面后按新页面计算
+    lru_k_replacer.unpin(3);
+    lru_k_replacer.pin(6);
+    lru_k_replacer.unpin(6);
+    EXPECT_TRUE(lru_k_replacer.victim(&value));
+    EXPECT_EQ(6, value);
+}
+
+/**
+ * @brief 一次性扫描的页面不应挤掉多次访问的热点页面
+ */
+TEST(LRUKReplacerTest, ScanResistanceTest) {
+    const int num_frames = 16;
+    LRUKReplacer lru_k_replacer(num_frames, 2);
+    // 帧0~7为热点页面，访问两次
+    for (int round = 0; round < 2; round++) {
+        for (int i = 0; i < num_frames / 2; i++) {
+            lru_k_replacer.pin(i);
+            lru_k_replacer.unpin(i);
+        }
+    }
+    // 帧8~15为扫描页面，只访问一次
+    for (int i = num_frames / 2; i < num_frames; i++) {
+        lru_k_replacer.pin(i);
+        lru_k_replacer.unpin(i);
+    }
+    int value;
+    for (int i = num_frames / 2; i < num_frames; i++) {
+        EXPECT_TRUE(lru_k_replacer.victim(&value));
+        EXPECT_EQ(i, value);
+    }
+}
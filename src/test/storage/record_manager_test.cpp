@@ -8,6 +8,8 @@
 #include <cstring>
 #include <ctime>
 #include <iostream>
+#include <random>
+#include <thread>
 #include <unordered_map>
 
 #include "gtest/gtest.h"
@@ -38,6 +40,10 @@ void check_equal(const RmFileHandle *file_handle,
         auto mock_buf = (char *)entry.second.c_str();
         auto rec = file_handle->get_record(rid, context);
         assert(memcmp(mock_buf, rec->data, file_handle->file_hdr_.record_size) == 0);
+        ReadPageGuard guard;
+        RecordView view = file_handle->get_record_view(rid, &guard, context);
+        assert(view.size == file_handle->file_hdr_.record_size);
+        assert(memcmp(mock_buf, view.data, view.size) == 0);
     }
     // Randomly get record
     for (int i = 0; i < 10; i++) {
@@ -51,8 +57,9 @@ void check_equal(const RmFileHandle *file_handle,
     size_t num_records = 0;
     for (RmScan scan(file_handle); !scan.is_end(); scan.next()) {
         assert(mock.count(scan.rid()) > 0);
-        auto rec = file_handle->get_record(scan.rid(), context);
-        assert(memcmp(rec->data, mock.at(scan.rid()).c_str(), file_handle->file_hdr_.record_size) == 0);
+        // 扫描持有当前页面的共享锁，直接读取扫描返回的视图
+        RecordView view = scan.record();
+        assert(memcmp(view.data, mock.at(scan.rid()).c_str(), file_handle->file_hdr_.record_size) == 0);
         num_records++;
     }
     assert(num_records == mock.size());
@@ -223,4 +230,575 @@ TEST(RecordManagerTest, MultipleFilesTest) {
         std::string filename = filenames[i];
         rm_manager->destroy_file(filename);
     }
-}
\ No newline at end of file
+}
+/**
+ * @brief 测试空闲空间映射：删除记录后的插入复用有空闲slot的页面，FSM在重新打开文件后仍然有效，FSM文件缺失时被重建
+ * @note 页面个数超过一个FSM页面能记录的个数，查找需要跨越多个FSM页面
+ */
+TEST(RecordManagerTest, FreeSpaceMapTest) {
+    auto disk_manager = std::make_unique<DiskManager>();
+    auto buffer_pool_manager = std::make_unique<BufferPoolManager>(BUFFER_POOL_SIZE, disk_manager.get());
+    auto rm_manager = std::make_unique<RmManager>(disk_manager.get(), buffer_pool_manager.get());
+    std::string filename = "fsm.txt";
+    if (disk_manager->is_file(filename)) {
+        rm_manager->destroy_file(filename);
+    }
+    rm_manager->create_file(filename, RM_MAX_RECORD_SIZE);
+    auto file_handle = rm_manager->open_file(filename);
+    ASSERT_TRUE(disk_manager->is_file(RmManager::get_fsm_name(filename)));
+
+    // 写满若干页面，最后一个页面恰好写满，之后的插入只能通过FSM找到空闲slot
+    const int records_per_page = file_handle->file_hdr_.num_records_per_page;
+    const int num_pages = 2100;
+    char buf[RM_MAX_RECORD_SIZE] = {};
+    for (int i = 0; i < num_pages * records_per_page; i++) {
+        Rid rid = file_handle->insert_record(buf, nullptr);
+        ASSERT_EQ(RM_FIRST_RECORD_PAGE + i / records_per_page, rid.page_no);
+    }
+    ASSERT_EQ(num_pages + 1, file_handle->file_hdr_.num_pages);
+
+    // 删除后的插入填补被删除的slot
+    for (int page_no : {2, num_pages - 50}) {
+        file_handle->delete_record({page_no, 3}, nullptr);
+        Rid rid = file_handle->insert_record(buf, nullptr);
+        EXPECT_EQ(page_no, rid.page_no);
+        EXPECT_EQ(3, rid.slot_no);
+    }
+    // 没有空闲slot时分配新页面
+    EXPECT_EQ(num_pages + 1, file_handle->insert_record(buf, nullptr).page_no);
+    file_handle->delete_record({num_pages + 1, 0}, nullptr);
+
+    // 重新打开文件后FSM仍然记录着空闲slot
+    file_handle->delete_record({num_pages - 10, 1}, nullptr);
+    rm_manager->close_file(file_handle.get());
+    file_handle = rm_manager->open_file(filename);
+    EXPECT_EQ(num_pages - 10, file_handle->insert_record(buf, nullptr).page_no);
+
+    // FSM文件缺失时扫描数据文件重建
+    file_handle->delete_record({7, 5}, nullptr);
+    rm_manager->close_file(file_handle.get());
+    disk_manager->destroy_file(RmManager::get_fsm_name(filename));
+    file_handle = rm_manager->open_file(filename);
+    Rid rid = file_handle->insert_record(buf, nullptr);
+    EXPECT_EQ(7, rid.page_no);
+    EXPECT_EQ(5, rid.slot_no);
+
+    rm_manager->close_file(file_handle.get());
+    rm_manager->destroy_file(filename);
+    EXPECT_FALSE(disk_manager->is_file(RmManager::get_fsm_name(filename)));
+}
+
+/**
+ * @brief 记录长度不是页面大小1/256的整数倍时，只剩一个空闲slot的页面的等级与一条记录需要的等级取整方式一致，
+ * 仍能通过FSM找到
+ */
+TEST(RecordManagerTest, FreeSpaceMapRoundingTest) {
+    auto disk_manager = std::make_unique<DiskManager>();
+    auto buffer_pool_manager = std::make_unique<BufferPoolManager>(BUFFER_POOL_SIZE, disk_manager.get());
+    auto rm_manager = std::make_unique<RmManager>(disk_manager.get(), buffer_pool_manager.get());
+    std::string filename = "fsm_rounding.txt";
+    if (disk_manager->is_file(filename)) {
+        rm_manager->destroy_file(filename);
+    }
+    const int record_size = 100;
+    rm_manager->create_file(filename, record_size);
+    auto file_handle = rm_manager->open_file(filename);
+    const int records_per_page = file_handle->file_hdr_.num_records_per_page;
+    ASSERT_NE(0, record_size * 256 % PAGE_SIZE);
+
+    // 写满两个页面，删除第一个页面中的一条记录，它只剩一个空闲slot
+    char buf[record_size] = {};
+    for (int i = 0; i < 2 * records_per_page; i++) {
+        file_handle->insert_record(buf, nullptr);
+    }
+    ASSERT_EQ(RM_NO_PAGE, file_handle->insert_page_no_);
+    file_handle->delete_record({RM_FIRST_RECORD_PAGE, 7}, nullptr);
+    Rid rid = file_handle->insert_record(buf, nullptr);
+    EXPECT_EQ(RM_FIRST_RECORD_PAGE, rid.page_no);
+    EXPECT_EQ(7, rid.slot_no);
+    EXPECT_EQ(RM_FIRST_RECORD_PAGE + 2, file_handle->file_hdr_.num_pages);
+
+    rm_manager->close_file(file_handle.get());
+    rm_manager->destroy_file(filename);
+}
+
+/**
+ * @brief insert_records批量插入：先填补已有页面中被删除的slot，再写满新页面，返回的rid与记录内容一一对应
+ */
+TEST(RecordManagerTest, BatchInsertTest) {
+    auto disk_manager = std::make_unique<DiskManager>();
+    auto buffer_pool_manager = std::make_unique<BufferPoolManager>(BUFFER_POOL_SIZE, disk_manager.get());
+    auto rm_manager = std::make_unique<RmManager>(disk_manager.get(), buffer_pool_manager.get());
+    std::string filename = "batch.txt";
+    if (disk_manager->is_file(filename)) {
+        rm_manager->destroy_file(filename);
+    }
+    const int record_size = 8;
+    rm_manager->create_file(filename, record_size);
+    auto file_handle = rm_manager->open_file(filename);
+    const int records_per_page = file_handle->file_hdr_.num_records_per_page;
+
+    // 写满一个页面后删除其中不连续的slot，留下长度不同的空洞
+    char buf[record_size] = {};
+    for (int i = 0; i < records_per_page; i++) {
+        file_handle->insert_record(buf, nullptr);
+    }
+    std::vector<int> holes = {0, 1, 2, 5, 9, 10, records_per_page - 1};
+    for (int slot_no : holes) {
+        file_handle->delete_record({RM_FIRST_RECORD_PAGE, slot_no}, nullptr);
+    }
+
+    const int num_records = static_cast<int>(holes.size()) + 2 * records_per_page + 3;
+    std::vector<char> records(static_cast<size_t>(num_records) * record_size);
+    for (int i = 0; i < num_records; i++) {
+        memcpy(records.data() + i * record_size, &i, sizeof(i));
+        records[i * record_size + record_size - 1] = static_cast<char>(i);
+    }
+    std::vector<Rid> rids = file_handle->insert_records(records.data(), num_records, nullptr);
+    ASSERT_EQ(num_records, static_cast<int>(rids.size()));
+
+    // 空洞按slot顺序被填补，之后依次写满新页面
+    for (size_t i = 0; i < holes.size(); i++) {
+        EXPECT_EQ(Rid({RM_FIRST_RECORD_PAGE, holes[i]}), rids[i]);
+    }
+    for (int i = holes.size(); i < num_records; i++) {
+        int n = i - static_cast<int>(holes.size());
+        EXPECT_EQ(Rid({RM_FIRST_RECORD_PAGE + 1 + n / records_per_page, n % records_per_page}), rids[i]);
+    }
+    for (int i = 0; i < num_records; i++) {
+        auto rec = file_handle->get_record(rids[i], nullptr);
+        EXPECT_EQ(0, memcmp(rec->data, records.data() + i * record_size, record_size));
+    }
+    EXPECT_EQ(RM_FIRST_RECORD_PAGE + 4, file_handle->file_hdr_.num_pages);
+
+    // 未写满的页面之后还能继续插入
+    Rid rid = file_handle->insert_record(buf, nullptr);
+    EXPECT_EQ(Rid({RM_FIRST_RECORD_PAGE + 3, 3}), rid);
+
+    rm_manager->close_file(file_handle.get());
+    rm_manager->destroy_file(filename);
+}
+
+/**
+ * @brief 文件末尾被删空的页面被释放：num_pages减少，扫描不再访问它们，之后的插入按顺序重新使用这些页号；
+ * 回滚删除时在已释放页面上的原位置插入，文件重新扩展到该页面
+ */
+TEST(RecordManagerTest, EmptyTailPageTest) {
+    auto disk_manager = std::make_unique<DiskManager>();
+    auto buffer_pool_manager = std::make_unique<BufferPoolManager>(BUFFER_POOL_SIZE, disk_manager.get());
+    auto rm_manager = std::make_unique<RmManager>(disk_manager.get(), buffer_pool_manager.get());
+    std::string filename = "empty_tail.txt";
+    if (disk_manager->is_file(filename)) {
+        rm_manager->destroy_file(filename);
+    }
+    const int record_size = 8;
+    rm_manager->create_file(filename, record_size);
+    auto file_handle = rm_manager->open_file(filename);
+    const int records_per_page = file_handle->file_hdr_.num_records_per_page;
+
+    // 写满三个页面，删空中间的页面时它不在文件末尾，不被释放
+    char buf[record_size] = {};
+    std::vector<Rid> rids;
+    for (int i = 0; i < 3 * records_per_page; i++) {
+        rids.push_back(file_handle->insert_record(buf, nullptr));
+    }
+    ASSERT_EQ(RM_FIRST_RECORD_PAGE + 3, file_handle->file_hdr_.num_pages);
+    for (int i = records_per_page; i < 2 * records_per_page; i++) {
+        file_handle->delete_record(rids[i], nullptr);
+    }
+    EXPECT_EQ(RM_FIRST_RECORD_PAGE + 3, file_handle->file_hdr_.num_pages);
+
+    // 删空最后一个页面后，它和之前的空页面一起被释放，扫描只访问第一个页面
+    for (int i = 2 * records_per_page; i < 3 * records_per_page; i++) {
+        file_handle->delete_record(rids[i], nullptr);
+    }
+    EXPECT_EQ(RM_FIRST_RECORD_PAGE + 1, file_handle->file_hdr_.num_pages);
+    int num_scanned = 0;
+    for (RmScan scan(file_handle.get()); !scan.is_end(); scan.next()) {
+        EXPECT_EQ(RM_FIRST_RECORD_PAGE, scan.rid().page_no);
+        num_scanned++;
+    }
+    EXPECT_EQ(records_per_page, num_scanned);
+
+    // 回滚删除：在已释放的第三个页面上插入，文件重新扩展
+    Rid restored = rids[2 * records_per_page + 1];
+    buf[0] = 'r';
+    file_handle->insert_record(restored, buf);
+    EXPECT_EQ(RM_FIRST_RECORD_PAGE + 3, file_handle->file_hdr_.num_pages);
+    EXPECT_EQ('r', file_handle->get_record(restored, nullptr)->data[0]);
+    EXPECT_FALSE(file_handle->is_record(rids[records_per_page]));
+
+    // 之后的插入先使用扩展出来的空页面，不再增长文件
+    buf[0] = 0;
+    Rid rid = file_handle->insert_record(buf, nullptr);
+    EXPECT_LT(rid.page_no, RM_FIRST_RECORD_PAGE + 3);
+    EXPECT_EQ(RM_FIRST_RECORD_PAGE + 3, file_handle->file_hdr_.num_pages);
+
+    rm_manager->close_file(file_handle.get());
+    rm_manager->destroy_file(filename);
+}
+
+/**
+ * @brief 一个线程反复在文件末尾插入并删除记录，使末尾的页面不断被释放，其他线程同时插入记录：
+ * 释放页面与插入并发时不会丢失已插入的记录
+ */
+TEST(RecordManagerTest, EmptyTailConcurrentTest) {
+    auto disk_manager = std::make_unique<DiskManager>();
+    auto buffer_pool_manager = std::make_unique<BufferPoolManager>(BUFFER_POOL_SIZE, disk_manager.get());
+    auto rm_manager = std::make_unique<RmManager>(disk_manager.get(), buffer_pool_manager.get());
+    std::string filename = "empty_tail_concurrent.txt";
+    if (disk_manager->is_file(filename)) {
+        rm_manager->destroy_file(filename);
+    }
+    const int record_size = 8;
+    rm_manager->create_file(filename, record_size);
+    auto file_handle = rm_manager->open_file(filename);
+
+    const int num_inserters = 3;
+    const int num_records = 2000;
+    std::vector<std::vector<Rid>> rids(num_inserters);
+    std::vector<std::thread> threads;
+    threads.emplace_back([&]() {
+        int buf[2] = {-1, -1};
+        for (int i = 0; i < num_inserters * num_records; i++) {
+            Rid rid = file_handle->insert_record(reinterpret_cast<char *>(buf), nullptr);
+            file_handle->delete_record(rid, nullptr);
+        }
+    });
+    for (int t = 0; t < num_inserters; t++) {
+        threads.emplace_back([&, t]() {
+            for (int i = 0; i < num_records; i++) {
+                int buf[2] = {t, i};
+                rids[t].push_back(file_handle->insert_record(reinterpret_cast<char *>(buf), nullptr));
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+
+    for (int t = 0; t < num_inserters; t++) {
+        for (int i = 0; i < num_records; i++) {
+            auto rec = file_handle->get_record(rids[t][i], nullptr);
+            const int *data = reinterpret_cast<const int *>(rec->data);
+            EXPECT_EQ(t, data[0]);
+            EXPECT_EQ(i, data[1]);
+        }
+    }
+    int num_scanned = 0;
+    for (RmScan scan(file_handle.get()); !scan.is_end(); scan.next()) {
+        num_scanned++;
+    }
+    EXPECT_EQ(num_inserters * num_records, num_scanned);
+
+    rm_manager->close_file(file_handle.get());
+    rm_manager->destroy_file(filename);
+}
+
+/**
+ * @brief 打开加入校验和之前的版本创建的表文件：文件头只有前5个字段，页面中RmPageHdr紧跟在LSN之后，没有校验和。
+ * 读取、扫描、插入和删除都按原来的布局进行，写回的页面不带校验和，重新打开后内容不变
+ */
+TEST(RecordManagerTest, LegacyLayoutTest) {
+    auto disk_manager = std::make_unique<DiskManager>();
+    auto buffer_pool_manager = std::make_unique<BufferPoolManager>(BUFFER_POOL_SIZE, disk_manager.get());
+    auto rm_manager = std::make_unique<RmManager>(disk_manager.get(), buffer_pool_manager.get());
+    std::string filename = "legacy.txt";
+    if (disk_manager->is_file(filename)) {
+        rm_manager->destroy_file(filename);
+    }
+
+    // 按之前版本的RmManager::create_file和RmFileHandle写出文件头和一个数据页面
+    struct LegacyFileHdr {
+        int record_size;
+        int num_pages;
+        int num_records_per_page;
+        int first_free_page_no;
+        int bitmap_size;
+    };
+    const int record_size = 8;
+    LegacyFileHdr legacy_hdr{};
+    legacy_hdr.record_size = record_size;
+    legacy_hdr.num_pages = RM_FIRST_RECORD_PAGE + 1;
+    legacy_hdr.num_records_per_page =
+        (BITMAP_WIDTH * (PAGE_SIZE - 1 - (int)sizeof(LegacyFileHdr)) + 1) / (1 + record_size * BITMAP_WIDTH);
+    legacy_hdr.first_free_page_no = RM_FIRST_RECORD_PAGE;
+    legacy_hdr.bitmap_size = (legacy_hdr.num_records_per_page + BITMAP_WIDTH - 1) / BITMAP_WIDTH;
+    const int num_legacy = 10;
+    std::vector<char> page(PAGE_SIZE, 0);
+    RmPageHdr page_hdr{RM_NO_PAGE, num_legacy};
+    memcpy(page.data() + RM_LEGACY_PAGE_HDR_OFFSET, &page_hdr, sizeof(page_hdr));
+    char *bitmap = page.data() + RM_LEGACY_PAGE_HDR_OFFSET + sizeof(RmPageHdr);
+    char *slots = bitmap + legacy_hdr.bitmap_size;
+    std::unordered_map<Rid, std::string, rid_hash_t, rid_equal_t> mock;
+    for (int i = 0; i < num_legacy; i++) {
+        Bitmap::set(bitmap, i);
+        rand_buf(record_size, slots + i * record_size);
+        mock[{RM_FIRST_RECORD_PAGE, i}] = std::string(slots + i * record_size, record_size);
+    }
+    disk_manager->create_file(filename);
+    int fd = disk_manager->open_file(filename);
+    disk_manager->write_page(fd, RM_FILE_HDR_PAGE, (char *)&legacy_hdr, sizeof(legacy_hdr));
+    disk_manager->write_page(fd, RM_FIRST_RECORD_PAGE, page.data(), PAGE_SIZE);
+    disk_manager->close_file(fd);
+
+    auto file_handle = rm_manager->open_file(filename);
+    EXPECT_EQ(Page::LAYOUT_LEGACY, file_handle->file_hdr_.layout_version);
+    EXPECT_FALSE(disk_manager->has_page_checksums(file_handle->fd_));
+    check_equal(file_handle.get(), mock);
+
+    // 插入写满第一个页面并新建页面，再删除第一个页面中原有的一半记录
+    char buf[record_size];
+    for (int i = 0; i < legacy_hdr.num_records_per_page; i++) {
+        rand_buf(record_size, buf);
+        Rid rid = file_handle->insert_record(buf, nullptr);
+        mock[rid] = std::string(buf, record_size);
+    }
+    EXPECT_EQ(RM_FIRST_RECORD_PAGE + 2, file_handle->file_hdr_.num_pages);
+    for (int i = 0; i < num_legacy; i += 2) {
+        file_handle->delete_record({RM_FIRST_RECORD_PAGE, i}, nullptr);
+        mock.erase({RM_FIRST_RECORD_PAGE, i});
+    }
+    check_equal(file_handle.get(), mock);
+    rm_manager->close_file(file_handle.get());
+
+    // 写回的页面仍是原来的布局，LSN之后没有写入校验和
+    fd = disk_manager->open_file(filename);
+    disk_manager->read_page(fd, RM_FIRST_RECORD_PAGE, page.data(), PAGE_SIZE);
+    disk_manager->close_file(fd);
+    memcpy(&page_hdr, page.data() + RM_LEGACY_PAGE_HDR_OFFSET, sizeof(page_hdr));
+    EXPECT_EQ(RM_NO_PAGE, page_hdr.next_free_page_no);
+    EXPECT_EQ(legacy_hdr.num_records_per_page - num_legacy / 2, page_hdr.num_records);
+
+    file_handle = rm_manager->open_file(filename);
+    EXPECT_EQ(Page::LAYOUT_LEGACY, file_handle->file_hdr_.layout_version);
+    check_equal(file_handle.get(), mock);
+    rm_manager->close_file(file_handle.get());
+    rm_manager->destroy_file(filename);
+}
+
+// 分槽格式的记录长度各不相同，按mock中每条记录自己的长度比较，并检查扫描不重复、不遗漏
+void check_slotted(const RmFileHandle *file_handle,
+                   const std::unordered_map<Rid, std::string, rid_hash_t, rid_equal_t> &mock) {
+    for (auto &entry : mock) {
+        auto rec = file_handle->get_record(entry.first, nullptr);
+        ASSERT_EQ(entry.second, std::string(rec->data, rec->size)) << entry.first;
+        ASSERT_TRUE(file_handle->is_record(entry.first));
+    }
+    std::unordered_map<Rid, std::string, rid_hash_t, rid_equal_t> scanned;
+    for (RmScan scan(file_handle); !scan.is_end(); scan.next()) {
+        RecordView view = scan.record();
+        ASSERT_TRUE(scanned.emplace(scan.rid(), std::string(view.data, view.size)).second) << scan.rid();
+    }
+    ASSERT_EQ(mock, scanned);
+}
+
+/**
+ * @brief 分槽格式的变长记录：随机插入、删除、变长和变短的更新，以及回滚删除时在原位置插入，
+ * 更新变长放不下时记录迁移到其他页面，Rid保持不变；重新打开文件后内容不变
+ */
+TEST(RecordManagerTest, SlottedFileTest) {
+    auto disk_manager = std::make_unique<DiskManager>();
+    auto buffer_pool_manager = std::make_unique<BufferPoolManager>(BUFFER_POOL_SIZE, disk_manager.get());
+    auto rm_manager = std::make_unique<RmManager>(disk_manager.get(), buffer_pool_manager.get());
+    std::string filename = "slotted.txt";
+    if (disk_manager->is_file(filename)) {
+        rm_manager->destroy_file(filename);
+    }
+    // 分槽格式的记录可以超过定长格式的上限
+    const int max_record_size = 2000;
+    EXPECT_THROW(rm_manager->create_file(filename, max_record_size), InvalidRecordSizeError);
+    rm_manager->create_file(filename, max_record_size, PAGE_SIZE, RM_FORMAT_SLOTTED);
+    auto file_handle = rm_manager->open_file(filename);
+    ASSERT_TRUE(file_handle->is_slotted());
+    EXPECT_THROW(file_handle->insert_record(std::string(max_record_size + 1, 'x').c_str(), max_record_size + 1, nullptr),
+                 InvalidRecordSizeError);
+
+    std::mt19937 rng(42);
+    auto random_record = [&](int max_len) {
+        std::string record(1 + rng() % max_len, '\0');
+        for (auto &c : record) {
+            c = static_cast<char>('a' + rng() % 26);
+        }
+        return record;
+    };
+    std::unordered_map<Rid, std::string, rid_hash_t, rid_equal_t> mock;
+    std::vector<Rid> rids;
+    auto random_rid = [&]() {
+        std::uniform_int_distribution<size_t> dist(0, rids.size() - 1);
+        size_t i = dist(rng);
+        Rid rid = rids[i];
+        rids[i] = rids.back();
+        rids.pop_back();
+        return rid;
+    };
+    for (int round = 0; round < 20000; round++) {
+        int op = rng() % 10;
+        if (op < 4 || rids.empty()) {
+            std::string record = random_record(round % 100 == 0 ? max_record_size : 64);
+            Rid rid = file_handle->insert_record(record.c_str(), record.size(), nullptr);
+            ASSERT_EQ(0u, mock.count(rid));
+            mock[rid] = record;
+            rids.push_back(rid);
+        } else if (op < 6) {
+            // 删除后在原位置插入，相当于回滚删除
+            Rid rid = random_rid();
+            file_handle->delete_record(rid, nullptr);
+            ASSERT_FALSE(file_handle->is_record(rid));
+            if (op == 5) {
+                file_handle->insert_record(rid, mock[rid].c_str(), mock[rid].size());
+                rids.push_back(rid);
+            } else {
+                mock.erase(rid);
+            }
+        } else {
+            // 更新，变长的更新可能需要迁移记录
+            Rid rid = random_rid();
+            std::string record = random_record(op == 9 ? 1000 : 64);
+            file_handle->update_record(rid, record.c_str(), record.size(), nullptr);
+            mock[rid] = record;
+            rids.push_back(rid);
+        }
+        if (round % 5000 == 0) {
+            check_slotted(file_handle.get(), mock);
+        }
+    }
+    check_slotted(file_handle.get(), mock);
+
+    // 确实发生过迁移，迁移记录的Rid不变
+    int num_forwarded = 0;
+    for (int page_no = RM_FIRST_RECORD_PAGE; page_no < file_handle->file_hdr_.num_pages; page_no++) {
+        auto guard = file_handle->fetch_page_read(page_no);
+        RmSlottedPage page(guard.get_page(), file_handle->get_page_size());
+        for (int slot_no = 0; slot_no < page.num_slots(); slot_no++) {
+            num_forwarded += page.get_slot(slot_no).state == RM_SLOT_FORWARD;
+        }
+    }
+    EXPECT_GT(num_forwarded, 0);
+
+    rm_manager->close_file(file_handle.get());
+    file_handle = rm_manager->open_file(filename);
+    check_slotted(file_handle.get(), mock);
+
+    // 删除所有记录后页面全部被释放，重新使用这些页号的插入不会使文件超过原来的大小
+    int num_pages = file_handle->file_hdr_.num_pages;
+    for (auto &entry : mock) {
+        file_handle->delete_record(entry.first, nullptr);
+    }
+    mock.clear();
+    check_slotted(file_handle.get(), mock);
+    EXPECT_EQ(RM_FIRST_RECORD_PAGE, file_handle->file_hdr_.num_pages);
+    std::string record(100, 'z');
+    for (int i = 0; i < (num_pages - 1) * (PAGE_SIZE / 120); i++) {
+        file_handle->insert_record(record.c_str(), record.size(), nullptr);
+    }
+    EXPECT_LE(file_handle->file_hdr_.num_pages, num_pages);
+
+    rm_manager->close_file(file_handle.get());
+    rm_manager->destroy_file(filename);
+}
+
+/**
+ * @brief 分槽页面的整理：删除和缩短记录留下的碎片在空间不够时被回收，整理后槽号和记录内容不变
+ */
+TEST(RecordManagerTest, SlottedPageCompactTest) {
+    Page page;
+    std::vector<char> data(PAGE_SIZE);
+    page.data_ = data.data();
+    RmSlottedPage slotted(&page, PAGE_SIZE);
+    slotted.init();
+
+    // 写满页面
+    std::vector<std::string> records;
+    while (slotted.can_insert(40)) {
+        std::string record(40, static_cast<char>('a' + records.size() % 26));
+        int slot_no = slotted.insert(record.size(), RM_SLOT_NORMAL);
+        ASSERT_EQ(static_cast<int>(records.size()), slot_no);
+        memcpy(slotted.get_data(slot_no), record.data(), record.size());
+        records.push_back(record);
+    }
+    // 删除偶数槽，缩短奇数槽，空闲空间都是碎片
+    int free_before = slotted.free_space();
+    for (int slot_no = 0; slot_no < static_cast<int>(records.size()); slot_no++) {
+        if (slot_no % 2 == 0) {
+            slotted.erase(slot_no);
+            records[slot_no].clear();
+        } else {
+            ASSERT_TRUE(slotted.resize(slot_no, 10));
+            records[slot_no].resize(10);
+        }
+    }
+    EXPECT_GT(slotted.free_space(), free_before + 1000);
+    // 变长到超过连续的空闲空间，需要整理页面
+    int big_slot = 1;
+    int big_len = slotted.free_space() / 2;
+    ASSERT_TRUE(slotted.resize(big_slot, big_len));
+    records[big_slot] = std::string(big_len, '#');
+    memcpy(slotted.get_data(big_slot), records[big_slot].data(), big_len);
+    // 空闲槽被重新使用
+    EXPECT_EQ(0, slotted.insert(20, RM_SLOT_NORMAL));
+    records[0] = std::string(20, '0');
+    memcpy(slotted.get_data(0), records[0].data(), 20);
+    EXPECT_FALSE(slotted.resize(big_slot, big_len + slotted.free_space() + 1));
+
+    for (int slot_no = 0; slot_no < slotted.num_slots(); slot_no++) {
+        const RmSlot &slot = slotted.get_slot(slot_no);
+        if (records[slot_no].empty()) {
+            EXPECT_EQ(RM_SLOT_FREE, slot.state);
+        } else {
+            ASSERT_EQ(records[slot_no], std::string(slotted.get_data(slot_no), slot.len)) << slot_no;
+        }
+    }
+}
+
+/**
+ * @brief set_range与逐位set的结果一致
+ */
+TEST(BitmapTest, SetRangeMatchesBitByBit) {
+    char expected[16];
+    char actual[16];
+    for (int pos = 0; pos < 40; pos++) {
+        for (int n = 0; pos + n <= 128; n++) {
+            Bitmap::init(expected, sizeof(expected));
+            Bitmap::init(actual, sizeof(actual));
+            for (int i = pos; i < pos + n; i++) {
+                Bitmap::set(expected, i);
+            }
+            Bitmap::set_range(actual, pos, n);
+            ASSERT_EQ(0, memcmp(expected, actual, sizeof(expected))) << "pos " << pos << " n " << n;
+        }
+    }
+}
+
+/**
+ * @brief 逐字和AVX2的位图查找与逐位查找的结果一致
+ * @note 覆盖不同的位图长度（包括不是8和64的倍数的长度）和填充率
+ */
+TEST(BitmapTest, ScanBitsMatchesBitByBit) {
+    std::mt19937 rng(42);
+    char bm[512];
+    for (int max_n : {1, 7, 8, 63, 64, 65, 255, 256, 257, 1000, 4096}) {
+        for (double fill : {0.0, 0.01, 0.5, 0.99, 1.0}) {
+            Bitmap::init(bm, sizeof(bm));
+            std::bernoulli_distribution dist(fill);
+            for (int i = 0; i < max_n; i++) {
+                if (dist(rng)) {
+                    Bitmap::set(bm, i);
+                }
+            }
+            for (bool bit : {false, true}) {
+                for (int curr = -1; curr < max_n; curr++) {
+                    int expected = max_n;
+                    for (int i = curr + 1; i < max_n; i++) {
+                        if (Bitmap::is_set(bm, i) == bit) {
+                            expected = i;
+                            break;
+                        }
+                    }
+                    ASSERT_EQ(expected, Bitmap::scan_bits(bit, bm, max_n, curr, false));
+                    ASSERT_EQ(expected, Bitmap::scan_bits(bit, bm, max_n, curr, true));
+                }
+            }
+        }
+    }
+}
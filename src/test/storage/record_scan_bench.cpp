@@ -0,0 +1,270 @@
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <random>
+
+#include "gtest/gtest.h"
+#include "record/rm.h"
+
+const std::string TEST_DB_NAME = "RecordScanBench_db";  // 以TEST_DB_NAME作为存放测试文件的根目录名
+
+// 统计全局operator new和operator new[]的调用次数
+static std::atomic<uint64_t> num_allocations{0};
+
+static void *counted_malloc(size_t size) {
+    num_allocations.fetch_add(1, std::memory_order_relaxed);
+    void *p = malloc(size == 0 ? 1 : size);
+    if (p == nullptr) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void *operator new(size_t size) { return counted_malloc(size); }
+
+void *operator new[](size_t size) { return counted_malloc(size); }
+
+void operator delete(void *p) noexcept { free(p); }
+
+void operator delete(void *p, size_t) noexcept { free(p); }
+
+void operator delete[](void *p) noexcept { free(p); }
+
+void operator delete[](void *p, size_t) noexcept { free(p); }
+
+class RecordScanBench : public ::testing::Test {
+   public:
+    std::unique_ptr<DiskManager> disk_manager_;
+
+   public:
+    void SetUp() override {
+        ::testing::Test::SetUp();
+        disk_manager_ = std::make_unique<DiskManager>();
+        if (disk_manager_->is_dir(TEST_DB_NAME)) {
+            disk_manager_->destroy_dir(TEST_DB_NAME);
+        }
+        disk_manager_->create_dir(TEST_DB_NAME);
+        if (chdir(TEST_DB_NAME.c_str()) < 0) {
+            throw UnixError();
+        }
+    }
+
+    void TearDown() override {
+        if (chdir("..") < 0) {
+            throw UnixError();
+        }
+    }
+};
+
+/**
+ * @brief 全表扫描1000万条记录，比较逐条拷贝出RmRecord与直接读取RecordView的耗时和每条记录的内存分配次数
+ * @note 拷贝方式与get_record相同，每条记录分配RmRecord对象和数据两次；视图方式不应有任何分配
+ */
+TEST_F(RecordScanBench, FullScan) {
+    const int num_records = 10000000;
+    const int record_size = 16;
+    const std::string filename = "scan_table";
+    auto buffer_pool_manager = std::make_unique<BufferPoolManager>(BUFFER_POOL_SIZE, disk_manager_.get());
+    auto rm_manager = std::make_unique<RmManager>(disk_manager_.get(), buffer_pool_manager.get());
+    rm_manager->create_file(filename, record_size);
+    auto file_handle = rm_manager->open_file(filename);
+
+    char buf[record_size] = {};
+    int64_t expected_sum = 0;
+    for (int i = 0; i < num_records; i++) {
+        *reinterpret_cast<int *>(buf) = i;
+        file_handle->insert_record(buf, nullptr);
+        expected_sum += i;
+    }
+    printf("%d records in %d pages\n", num_records, file_handle->get_file_hdr().num_pages);
+
+    printf("%-12s %14s %14s %14s\n", "mode", "rows/s", "ns/row", "allocs/row");
+    for (bool use_view : {false, true}) {
+        int64_t sum = 0;
+        int rows = 0;
+        uint64_t allocs = num_allocations.load();
+        auto start = std::chrono::steady_clock::now();
+        for (RmScan scan(file_handle.get()); !scan.is_end(); scan.next()) {
+            if (use_view) {
+                RecordView view = scan.record();
+                sum += *reinterpret_cast<const int *>(view.data);
+            } else {
+                RecordView view = scan.record();
+                auto rec = std::make_unique<RmRecord>(view.size, view.data);
+                sum += *reinterpret_cast<int *>(rec->data);
+            }
+            rows++;
+        }
+        double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        // RmScan构造时可能分配环形缓冲区，不计入每条记录的分配
+        double allocs_per_row = static_cast<double>(num_allocations.load() - allocs) / rows;
+        printf("%-12s %14.0f %14.1f %14.3f\n", use_view ? "view" : "copy", rows / secs, secs * 1e9 / rows,
+               allocs_per_row);
+        EXPECT_EQ(num_records, rows);
+        EXPECT_EQ(expected_sum, sum);
+        if (use_view) {
+            EXPECT_LT(allocs_per_row, 0.001);
+        }
+    }
+    rm_manager->close_file(file_handle.get());
+}
+
+// 原来的逐位查找，作为基准
+static int next_bit_bitwise(bool bit, const char *bm, int max_n, int curr) {
+    for (int i = curr + 1; i < max_n; i++) {
+        if (Bitmap::is_set(bm, i) == bit) {
+            return i;
+        }
+    }
+    return max_n;
+}
+
+/**
+ * @brief 不同填充率下，逐位、逐字和逐字加AVX2三种位图查找的耗时
+ * @note 扫描对应RmScan：依次找出所有为1的位；插入对应insert_record：找第一个为0的位。
+ * 240位是4KB页面、16字节记录的位图，4096位是较大页面上小记录的位图
+ */
+TEST_F(RecordScanBench, BitmapScan) {
+    const int num_bitmaps = 1024;
+    const int rounds = 20;
+    std::mt19937 rng(42);
+    printf("%-6s %-6s %-8s %12s %12s %12s\n", "bits", "fill", "op", "bitwise ns", "word ns", "avx2 ns");
+    for (int max_n : {240, 4096}) {
+        const int bitmap_size = (max_n + BITMAP_WIDTH - 1) / BITMAP_WIDTH;
+        // 使用多个不同的位图，避免分支预测器记住单个位图的模式
+        std::vector<char> bitmaps(static_cast<size_t>(num_bitmaps) * bitmap_size);
+        for (double fill : {0.0, 0.01, 0.1, 0.5, 0.9, 0.99, 1.0}) {
+            Bitmap::init(bitmaps.data(), bitmaps.size());
+            std::bernoulli_distribution dist(fill);
+            for (int b = 0; b < num_bitmaps; b++) {
+                for (int i = 0; i < max_n; i++) {
+                    if (dist(rng)) {
+                        Bitmap::set(bitmaps.data() + b * bitmap_size, i);
+                    }
+                }
+            }
+            for (bool scan : {true, false}) {
+                double ns[3];
+                int results[3];
+                for (int impl = 0; impl < 3; impl++) {
+                    auto next = [&](bool bit, const char *bm, int curr) {
+                        return impl == 0 ? next_bit_bitwise(bit, bm, max_n, curr)
+                                         : Bitmap::scan_bits(bit, bm, max_n, curr, impl == 2);
+                    };
+                    int result = 0;
+                    auto start = std::chrono::steady_clock::now();
+                    for (int r = 0; r < rounds; r++) {
+                        for (int b = 0; b < num_bitmaps; b++) {
+                            const char *bm = bitmaps.data() + b * bitmap_size;
+                            if (scan) {
+                                for (int i = next(true, bm, -1); i < max_n; i = next(true, bm, i)) {
+                                    result++;
+                                }
+                            } else {
+                                result += next(false, bm, -1);
+                            }
+                        }
+                    }
+                    ns[impl] = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() /
+                               (rounds * num_bitmaps);
+                    results[impl] = result;
+                }
+                EXPECT_EQ(results[0], results[1]);
+                EXPECT_EQ(results[0], results[2]);
+                printf("%-6d %-6.2f %-8s %12.1f %12.1f %12.1f\n", max_n, fill, scan ? "scan" : "insert", ns[0], ns[1],
+                       ns[2]);
+            }
+        }
+    }
+}
+
+/**
+ * @brief 向空表装载100万条记录，比较逐条insert_record与按批insert_records的耗时
+ */
+TEST_F(RecordScanBench, BatchInsert) {
+    const int num_records = 1000000;
+    const int record_size = 16;
+    auto buffer_pool_manager = std::make_unique<BufferPoolManager>(BUFFER_POOL_SIZE, disk_manager_.get());
+    auto rm_manager = std::make_unique<RmManager>(disk_manager_.get(), buffer_pool_manager.get());
+    std::vector<char> records(static_cast<size_t>(num_records) * record_size);
+    for (int i = 0; i < num_records; i++) {
+        *reinterpret_cast<int *>(records.data() + static_cast<size_t>(i) * record_size) = i;
+    }
+
+    printf("%-12s %14s %14s\n", "batch", "rows/s", "ns/row");
+    for (int batch_size : {1, 100, 10000}) {
+        const std::string filename = "insert_table_" + std::to_string(batch_size);
+        rm_manager->create_file(filename, record_size);
+        auto file_handle = rm_manager->open_file(filename);
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < num_records; i += batch_size) {
+            char *buf = records.data() + static_cast<size_t>(i) * record_size;
+            if (batch_size == 1) {
+                file_handle->insert_record(buf, nullptr);
+            } else {
+                file_handle->insert_records(buf, std::min(batch_size, num_records - i), nullptr);
+            }
+        }
+        double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        printf("%-12d %14.0f %14.1f\n", batch_size, num_records / secs, secs * 1e9 / num_records);
+
+        int rows = 0;
+        for (RmScan scan(file_handle.get()); !scan.is_end(); scan.next()) {
+            EXPECT_EQ(rows, *reinterpret_cast<const int *>(scan.record().data));
+            rows++;
+        }
+        EXPECT_EQ(num_records, rows);
+        rm_manager->close_file(file_handle.get());
+    }
+}
+
+/**
+ * @brief 字符串为主的表：100万行(int, 平均约20字节的字符串)，比较CHAR(255)的定长格式与VARCHAR(255)的分槽格式
+ * 占用的页面数和全表扫描的耗时
+ */
+TEST_F(RecordScanBench, VarcharScan) {
+    const int num_records = 1000000;
+    const int max_len = 255;
+    auto buffer_pool_manager = std::make_unique<BufferPoolManager>(BUFFER_POOL_SIZE, disk_manager_.get());
+    auto rm_manager = std::make_unique<RmManager>(disk_manager_.get(), buffer_pool_manager.get());
+    std::mt19937 rng(42);
+    std::vector<std::string> strings(num_records);
+    for (auto &str : strings) {
+        str.assign(10 + rng() % 20, 'a' + rng() % 26);
+    }
+
+    printf("%-10s %10s %12s %12s\n", "format", "pages", "rows/s", "ns/row");
+    for (RmFormat format : {RM_FORMAT_FIXED, RM_FORMAT_SLOTTED}) {
+        // 定长格式中字符串补0到255字节；分槽格式中记录只包括int和字符串本身，字符串的长度由记录的长度得出
+        const std::string filename = format == RM_FORMAT_FIXED ? "char_table" : "varchar_table";
+        rm_manager->create_file(filename, sizeof(int) + max_len, PAGE_SIZE, format);
+        auto file_handle = rm_manager->open_file(filename);
+        char buf[sizeof(int) + max_len];
+        int64_t expected_len = 0;
+        for (int i = 0; i < num_records; i++) {
+            memset(buf, 0, sizeof(buf));
+            memcpy(buf, &i, sizeof(int));
+            memcpy(buf + sizeof(int), strings[i].data(), strings[i].size());
+            int size = format == RM_FORMAT_FIXED ? sizeof(buf) : sizeof(int) + strings[i].size();
+            file_handle->insert_record(buf, size, nullptr);
+            expected_len += strings[i].size();
+        }
+
+        int64_t total_len = 0;
+        int rows = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (RmScan scan(file_handle.get()); !scan.is_end(); scan.next()) {
+            RecordView view = scan.record();
+            total_len += format == RM_FORMAT_FIXED ? strnlen(view.data + sizeof(int), max_len) : view.size - sizeof(int);
+            rows++;
+        }
+        double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        printf("%-10s %10d %12.0f %12.1f\n", format == RM_FORMAT_FIXED ? "char" : "varchar",
+               file_handle->get_file_hdr().num_pages, rows / secs, secs * 1e9 / rows);
+        EXPECT_EQ(num_records, rows);
+        EXPECT_EQ(expected_len, total_len);
+        rm_manager->close_file(file_handle.get());
+    }
+}
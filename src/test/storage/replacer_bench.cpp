@@ -0,0 +1,116 @@
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "replacer/clock_replacer.h"
+#include "replacer/lru_k_replacer.h"
+#include "replacer/lru_replacer.h"
+
+/**
+ * @brief 生成Zipf分布的页面访问序列，页面0最热
+ * @param {int} num_pages 页面总数
+ * @param {double} theta 倾斜程度，越大越集中
+ */
+static std::vector<int> zipf_trace(int num_pages, double theta, int length, std::mt19937 &rng) {
+    std::vector<double> cdf(num_pages);
+    double sum = 0;
+    for (int i = 0; i < num_pages; i++) {
+        sum += 1.0 / std::pow(i + 1, theta);
+        cdf[i] = sum;
+    }
+    std::uniform_real_distribution<double> dist(0, sum);
+    std::vector<int> trace(length);
+    for (auto &page : trace) {
+        page = std::lower_bound(cdf.begin(), cdf.end(), dist(rng)) - cdf.begin();
+    }
+    return trace;
+}
+
+/**
+ * @brief 在Zipf热点访问中周期性地插入对冷数据的顺序扫描
+ * @param {int} hot_pages 热点页面数，热点页面编号为[0, hot_pages)
+ * @param {int} scan_pages 每次扫描的页面数，扫描页面编号在hot_pages之后
+ * @param {int} scan_every 每scan_every次热点访问之后插入一次扫描
+ */
+static std::vector<int> scan_trace(int hot_pages, int scan_pages, int scan_every, int length, std::mt19937 &rng) {
+    std::vector<int> hot = zipf_trace(hot_pages, 0.8, length, rng);
+    std::vector<int> trace;
+    trace.reserve(length);
+    int next_scan = hot_pages;
+    for (int i = 0; (int)trace.size() < length; i++) {
+        trace.push_back(hot[i]);
+        if ((i + 1) % scan_every == 0) {
+            for (int j = 0; j < scan_pages && (int)trace.size() < length; j++) {
+                trace.push_back(next_scan++);
+            }
+        }
+    }
+    return trace;
+}
+
+/**
+ * @brief 模拟缓冲池：命中时pin/unpin，未命中时从空闲帧或replacer中取得帧并装入页面
+ * @return {double} 命中率
+ */
+static double replay(Replacer *replacer, size_t num_frames, const std::vector<int> &trace, double *ns_per_op) {
+    int max_page = *std::max_element(trace.begin(), trace.end());
+    std::vector<frame_id_t> page2frame(max_page + 1, INVALID_FRAME_ID);
+    std::vector<int> frame2page(num_frames, INVALID_PAGE_ID);
+    size_t used = 0;
+    size_t hits = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int page : trace) {
+        frame_id_t frame = page2frame[page];
+        if (frame != INVALID_FRAME_ID) {
+            hits++;
+        } else {
+            if (used < num_frames) {
+                frame = static_cast<frame_id_t>(used++);
+            } else {
+                EXPECT_TRUE(replacer->victim(&frame));
+                page2frame[frame2page[frame]] = INVALID_FRAME_ID;
+            }
+            frame2page[frame] = page;
+            page2frame[page] = frame;
+        }
+        replacer->pin(frame);
+        replacer->unpin(frame);
+    }
+    *ns_per_op = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / trace.size();
+    return static_cast<double>(hits) / trace.size();
+}
+
+/**
+ * @brief 比较各置换策略在不同访问序列上的命中率和每次访问的开销
+ */
+TEST(ReplacerBench, Replay) {
+    const size_t num_frames = 1024;
+    const int length = 2000000;
+    std::mt19937 rng(2023);
+    std::vector<std::pair<std::string, std::vector<int>>> traces;
+    traces.emplace_back("zipf-0.99", zipf_trace(16 * num_frames, 0.99, length, rng));
+    traces.emplace_back("zipf-0.7", zipf_trace(16 * num_frames, 0.7, length, rng));
+    traces.emplace_back("zipf+scan", scan_trace(num_frames, 2 * num_frames, 4 * num_frames, length, rng));
+
+    printf("%-10s %-6s %10s %10s\n", "trace", "policy", "hit ratio", "ns/op");
+    for (auto &[name, trace] : traces) {
+        for (std::string policy : {"LRU", "CLOCK", "LRU-K"}) {
+            std::unique_ptr<Replacer> replacer;
+            if (policy == "CLOCK") {
+                replacer = std::make_unique<ClockReplacer>(num_frames);
+            } else if (policy == "LRU-K") {
+                replacer = std::make_unique<LRUKReplacer>(num_frames, 2);
+            } else {
+                replacer = std::make_unique<LRUReplacer>(num_frames);
+            }
+            double ns_per_op;
+            double hit_ratio = replay(replacer.get(), num_frames, trace, &ns_per_op);
+            printf("%-10s %-6s %10.4f %10.1f\n", name.c_str(), policy.c_str(), hit_ratio, ns_per_op);
+        }
+    }
+}
@@ -0,0 +1,112 @@
+#include <unistd.h>
+
+#include <cstring>
+
+#include "gtest/gtest.h"
+
+#include "execution/executor_delete.h"
+#include "execution/executor_insert.h"
+#include "execution/executor_update.h"
+#include "record/rm.h"
+#include "storage/buffer_pool_manager.h"
+#include "system/sm.h"
+
+const std::string TEST_DB_NAME = "SmManagerTest_db";  // 以数据库名作为根目录
+const std::string TEST_TAB_NAME = "table1";
+const std::vector<std::string> TEST_COL = {"col1"};
+constexpr int TEST_NUM_RECORDS = 100;
+
+/** 对于每个测试点，先创建数据库TEST_DB_NAME，在其中建表、建索引并插入TEST_NUM_RECORDS条记录，
+ * 然后关闭数据库并以只读方式重新打开 */
+class SmManagerTest : public ::testing::Test {
+   public:
+    std::unique_ptr<DiskManager> disk_manager_;
+    std::unique_ptr<BufferPoolManager> buffer_pool_manager_;
+    std::unique_ptr<RmManager> rm_manager_;
+    std::unique_ptr<IxManager> ix_manager_;
+    std::unique_ptr<SmManager> sm_;
+
+   public:
+    // This function is called before every test.
+    void SetUp() override {
+        ::testing::Test::SetUp();
+        disk_manager_ = std::make_unique<DiskManager>();
+        buffer_pool_manager_ = std::make_unique<BufferPoolManager>(200, disk_manager_.get());
+        rm_manager_ = std::make_unique<RmManager>(disk_manager_.get(), buffer_pool_manager_.get());
+        ix_manager_ = std::make_unique<IxManager>(disk_manager_.get(), buffer_pool_manager_.get());
+        sm_ = std::make_unique<SmManager>(disk_manager_.get(), buffer_pool_manager_.get(), rm_manager_.get(),
+                                          ix_manager_.get());
+        // 如果测试目录已存在，则先删除
+        if (sm_->is_dir(TEST_DB_NAME)) {
+            sm_->drop_db(TEST_DB_NAME);
+        }
+        sm_->create_db(TEST_DB_NAME);
+        std::vector<ColDef> col_defs = {{"col1", TYPE_INT, 4}, {"col2", TYPE_INT, 4}};
+        sm_->create_table(TEST_TAB_NAME, col_defs, nullptr);
+        sm_->create_index(TEST_TAB_NAME, TEST_COL, nullptr);
+        auto fh = sm_->fhs_.at(TEST_TAB_NAME).get();
+        auto ih = sm_->ihs_.at(ix_manager_->get_index_name(TEST_TAB_NAME, TEST_COL)).get();
+        for (int i = 0; i < TEST_NUM_RECORDS; i++) {
+            int buf[2] = {i, -i};
+            Rid rid = fh->insert_record(reinterpret_cast<char *>(buf), nullptr);
+            ih->insert_entry(reinterpret_cast<const char *>(&i), rid, nullptr);
+        }
+        sm_->close_db();
+        if (chdir("..") < 0) {
+            throw UnixError();
+        }
+        sm_->open_db(TEST_DB_NAME, true);
+    }
+
+    // This function is called after every test.
+    void TearDown() override {
+        sm_->close_db();
+        // 返回上一层目录
+        if (chdir("..") < 0) {
+            throw UnixError();
+        }
+    }
+
+    // 检查表中的记录没有被修改
+    void check_records() {
+        auto fh = sm_->fhs_.at(TEST_TAB_NAME).get();
+        int count = 0;
+        for (RmScan scan(fh); !scan.is_end(); scan.next()) {
+            const int *rec = reinterpret_cast<const int *>(scan.record().data);
+            EXPECT_EQ(-rec[0], rec[1]);
+            count++;
+        }
+        EXPECT_EQ(TEST_NUM_RECORDS, count);
+    }
+};
+
+/**
+ * @brief 只读打开的数据库拒绝所有修改：DML在执行器构造时抛出DatabaseReadOnlyError，
+ *        绕过执行器直接写记录文件时，缓冲池也不会交出只读映射页面的写视图
+ */
+TEST_F(SmManagerTest, ReadOnlyTest) {
+    ASSERT_TRUE(sm_->is_read_only());
+    auto fh = sm_->fhs_.at(TEST_TAB_NAME).get();
+    std::vector<Rid> rids;
+    for (RmScan scan(fh); !scan.is_end(); scan.next()) {
+        rids.push_back(scan.rid());
+    }
+    ASSERT_EQ(TEST_NUM_RECORDS, static_cast<int>(rids.size()));
+
+    Value col1, col2;
+    col1.set_int(TEST_NUM_RECORDS);
+    col2.set_int(-TEST_NUM_RECORDS);
+    EXPECT_THROW(InsertExecutor(sm_.get(), TEST_TAB_NAME, {{col1, col2}}, nullptr), DatabaseReadOnlyError);
+    EXPECT_THROW(DeleteExecutor(sm_.get(), TEST_TAB_NAME, {}, rids, nullptr), DatabaseReadOnlyError);
+    std::vector<SetClause> set_clauses = {{{TEST_TAB_NAME, "col2"}, col2}};
+    EXPECT_THROW(UpdateExecutor(sm_.get(), TEST_TAB_NAME, set_clauses, {}, rids, nullptr), DatabaseReadOnlyError);
+    EXPECT_THROW(sm_->create_table("table2", {{"col1", TYPE_INT, 4}}, nullptr), DatabaseReadOnlyError);
+    EXPECT_THROW(sm_->drop_table(TEST_TAB_NAME, nullptr), DatabaseReadOnlyError);
+
+    // 记录文件的页面只读映射，写路径抛出异常而不是写入只读内存
+    int buf[2] = {TEST_NUM_RECORDS, -TEST_NUM_RECORDS};
+    EXPECT_THROW(fh->insert_record(reinterpret_cast<char *>(buf), nullptr), InternalError);
+    EXPECT_THROW(fh->update_record(rids[0], reinterpret_cast<char *>(buf), nullptr), InternalError);
+    EXPECT_THROW(fh->delete_record(rids[0], nullptr), InternalError);
+    check_records();
+}
@@ -83,9 +83,9 @@ void TransactionManager::abort(Transaction * txn, LogManager *log_manager) {
                 if (wtype == WType::INSERT_TUPLE) {
                     fh->delete_record(rid, nullptr);
                 } else if (wtype == WType::DELETE_TUPLE) {
-                    fh->insert_record(rid, write_record->GetRecord().data);
+                    fh->insert_record(rid, write_record->GetRecord().data, write_record->GetRecord().size);
                 } else if (wtype == WType::UPDATE_TUPLE) {
-                    fh->update_record(rid, write_record->GetRecord().data, nullptr);
+                    fh->update_record(rid, write_record->GetRecord().data, write_record->GetRecord().size, nullptr);
                 }
             }
             delete write_record;
@@ -19,7 +19,8 @@
 static bool should_exit = false;
 
 auto disk_manager = std::make_unique<DiskManager>();
-auto buffer_pool_manager = std::make_unique<BufferPoolManager>(BUFFER_POOL_SIZE, disk_manager.get());
+auto buffer_pool_manager = std::make_unique<BufferPoolManager>(BUFFER_POOL_SIZE, disk_manager.get(), BUFFER_POOL_NUM_SHARDS,
+                                                               REPLACER_TYPE, BUFFER_POOL_HUGE_PAGES, BUFFER_POOL_MAX_SIZE);
 auto rm_manager = std::make_unique<RmManager>(disk_manager.get(), buffer_pool_manager.get());
 auto ix_manager = std::make_unique<IxManager>(disk_manager.get(), buffer_pool_manager.get());
 auto sm_manager = std::make_unique<SmManager>(disk_manager.get(), buffer_pool_manager.get(), rm_manager.get(), ix_manager.get());
@@ -255,31 +256,66 @@ void start_server() {
 
 int main(int argc, char **argv) {
 
-    if (argc != 2) {
-        // 需要指定数据库名称
-        std::cerr << "Usage: " << argv[0] << " <database>" << std::endl;
+    // 需要指定数据库名称，--read-only表示以只读方式打开已有的数据库，--direct-io表示以O_DIRECT读写表和索引文件，
+    // --buffer-pool-size=N指定缓冲池的页面个数（不超过BUFFER_POOL_MAX_SIZE，运行时可以通过set buffer_pool_size调整）
+    bool read_only = false;
+    bool direct_io = ENABLE_DIRECT_IO;
+    size_t pool_size = BUFFER_POOL_SIZE;
+    bool bad_args = argc < 2;
+    const std::string pool_size_arg = "--buffer-pool-size=";
+    for (int i = 2; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--read-only") {
+            read_only = true;
+        } else if (arg == "--direct-io") {
+            direct_io = true;
+        } else if (arg.compare(0, pool_size_arg.size(), pool_size_arg) == 0) {
+            char *end = nullptr;
+            pool_size = std::strtoull(arg.c_str() + pool_size_arg.size(), &end, 10);
+            bad_args = bad_args || *end != '\0';
+        } else {
+            bad_args = true;
+        }
+    }
+    if (bad_args) {
+        std::cerr << "Usage: " << argv[0] << " <database> [--read-only] [--direct-io] [--buffer-pool-size=N]"
+                  << std::endl;
         exit(1);
     }
+    disk_manager->set_direct_io(direct_io);
 
     signal(SIGINT, sigint_handler);
     try {
+        // 缓冲池按BUFFER_POOL_MAX_SIZE预留帧，启动时还没有缓存任何页面，调整大小不需要淘汰
+        if (pool_size != BUFFER_POOL_SIZE) {
+            buffer_pool_manager->resize(pool_size);
+        }
         std::cout << "Welcome to UniBase!\n"
                      "Type 'help;' for help.\n"
                      "\n";
         // Database name is passed by args
         std::string db_name = argv[1];
 
-        if (!sm_manager->is_dir(db_name)) {
+        if (!sm_manager->is_dir(db_name) && !read_only) {
             // Database not found, create a new one
             sm_manager->create_db(db_name);
         }
         // Open database
-        sm_manager->open_db(db_name);
+        sm_manager->open_db(db_name, read_only);
 
-        // recovery database
-        recovery->analyze();
-        recovery->redo();
-        recovery->undo();
+        if (!read_only) {
+            // recovery database
+            recovery->analyze();
+            recovery->redo();
+            recovery->undo();
+
+            // 恢复完成后启动缓冲池的后台写线程和预读线程；只读库的页面直接映射，不需要它们
+            buffer_pool_manager->start_background_writer();
+            buffer_pool_manager->start_read_ahead();
+        }
+        if (BUFFER_STATS_DUMP_INTERVAL_MS > 0) {
+            buffer_pool_manager->start_stats_dump();
+        }
         
         // 开启服务端，开始接受客户端连接
         start_server();